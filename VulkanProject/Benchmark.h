@@ -0,0 +1,33 @@
+// Benchmark.h
+#pragma once
+
+// Timing loop shared by the benchmark executables. Their output follows Google Benchmark's layout:
+// wall time per iteration, iteration count and throughput.
+
+#include <chrono>
+#include <cstdint>
+
+struct BenchmarkResult
+{
+    double secondsPerIteration = 0.0;
+    uint64_t iterations = 0;
+};
+
+// Runs body until at least minSeconds have passed, after one warm-up call
+template<typename Body>
+BenchmarkResult runBenchmark(Body&& body, double minSeconds = 0.5)
+{
+    body();
+
+    BenchmarkResult result;
+    auto start = std::chrono::high_resolution_clock::now();
+    double elapsed = 0.0;
+    while (elapsed < minSeconds)
+    {
+        body();
+        result.iterations++;
+        elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+    result.secondsPerIteration = elapsed / double(result.iterations);
+    return result;
+}
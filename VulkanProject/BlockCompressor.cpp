@@ -0,0 +1,688 @@
+#include "BlockCompressor.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    constexpr int BC7_WEIGHTS_4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    // Writes bit fields LSB first, the way every BCn format packs them
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(unsigned char* pData) : m_pData(pData) { memset(m_pData, 0, 16); }
+
+        void write(uint32_t value, int bitCount)
+        {
+            for (int i = 0; i < bitCount; ++i, ++m_Position)
+            {
+                if (value & (1u << i))
+                {
+                    m_pData[m_Position >> 3] |= static_cast<unsigned char>(1u << (m_Position & 7));
+                }
+            }
+        }
+
+    private:
+        unsigned char* m_pData;
+        int m_Position = 0;
+    };
+
+    class BitReader
+    {
+    public:
+        explicit BitReader(const unsigned char* pData) : m_pData(pData) {}
+
+        uint32_t read(int bitCount)
+        {
+            uint32_t value = 0;
+            for (int i = 0; i < bitCount; ++i, ++m_Position)
+            {
+                value |= static_cast<uint32_t>((m_pData[m_Position >> 3] >> (m_Position & 7)) & 1u) << i;
+            }
+            return value;
+        }
+
+    private:
+        const unsigned char* m_pData;
+        int m_Position = 0;
+    };
+
+    // Principal axis of channelCount-dimensional points, found by power iteration on the covariance
+    template<int N>
+    void computePrincipalAxis(const float (*points)[N], float* mean, float* axis)
+    {
+        for (int c = 0; c < N; ++c)
+        {
+            mean[c] = 0.0f;
+            for (int i = 0; i < 16; ++i)
+            {
+                mean[c] += points[i][c];
+            }
+            mean[c] /= 16.0f;
+        }
+
+        float covariance[N][N] = {};
+        for (int i = 0; i < 16; ++i)
+        {
+            for (int a = 0; a < N; ++a)
+            {
+                for (int b = 0; b < N; ++b)
+                {
+                    covariance[a][b] += (points[i][a] - mean[a]) * (points[i][b] - mean[b]);
+                }
+            }
+        }
+
+        for (int c = 0; c < N; ++c)
+        {
+            axis[c] = 1.0f;
+        }
+        for (int iteration = 0; iteration < 8; ++iteration)
+        {
+            float next[N] = {};
+            float length = 0.0f;
+            for (int a = 0; a < N; ++a)
+            {
+                for (int b = 0; b < N; ++b)
+                {
+                    next[a] += covariance[a][b] * axis[b];
+                }
+                length += next[a] * next[a];
+            }
+            if (length < 1e-12f)
+            {
+                break;
+            }
+            length = std::sqrt(length);
+            for (int c = 0; c < N; ++c)
+            {
+                axis[c] = next[c] / length;
+            }
+        }
+    }
+
+    uint16_t packRGB565(const float* color)
+    {
+        const uint32_t r = static_cast<uint32_t>(std::clamp(std::lround(color[0] * 31.0f / 255.0f), 0l, 31l));
+        const uint32_t g = static_cast<uint32_t>(std::clamp(std::lround(color[1] * 63.0f / 255.0f), 0l, 63l));
+        const uint32_t b = static_cast<uint32_t>(std::clamp(std::lround(color[2] * 31.0f / 255.0f), 0l, 31l));
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    void unpackRGB565(uint16_t packed, int* color)
+    {
+        const int r = (packed >> 11) & 31;
+        const int g = (packed >> 5) & 63;
+        const int b = packed & 31;
+        color[0] = (r << 3) | (r >> 2);
+        color[1] = (g << 2) | (g >> 4);
+        color[2] = (b << 3) | (b >> 2);
+    }
+
+    int squaredDistance(const int* a, const unsigned char* b, int channelCount)
+    {
+        int sum = 0;
+        for (int c = 0; c < channelCount; ++c)
+        {
+            const int delta = a[c] - b[c];
+            sum += delta * delta;
+        }
+        return sum;
+    }
+
+    // Palette and index choice for one BC7 mode 6 candidate; returns the squared error
+    int evaluateBC7Mode6(const unsigned char* pTexels, const int* endpoint0, const int* endpoint1, uint8_t* indices)
+    {
+        int palette[16][4];
+        for (int i = 0; i < 16; ++i)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                palette[i][c] = ((64 - BC7_WEIGHTS_4[i]) * endpoint0[c] + BC7_WEIGHTS_4[i] * endpoint1[c] + 32) >> 6;
+            }
+        }
+
+        int totalError = 0;
+        for (int t = 0; t < 16; ++t)
+        {
+            int bestError = INT32_MAX;
+            for (int i = 0; i < 16; ++i)
+            {
+                const int error = squaredDistance(palette[i], pTexels + t * 4, 4);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    indices[t] = static_cast<uint8_t>(i);
+                }
+            }
+            totalError += bestError;
+        }
+        return totalError;
+    }
+
+    // Quantizes float endpoints to 7 bits + shared p-bit, trying every p-bit pair
+    int fitBC7Mode6(const unsigned char* pTexels, const float* low, const float* high,
+        int* bestEndpoint0, int* bestEndpoint1, int* bestPBits, uint8_t* bestIndices)
+    {
+        int bestError = INT32_MAX;
+        for (int pBits = 0; pBits < 4; ++pBits)
+        {
+            const int p0 = pBits & 1;
+            const int p1 = pBits >> 1;
+            int endpoint0[4];
+            int endpoint1[4];
+            for (int c = 0; c < 4; ++c)
+            {
+                const int q0 = std::clamp(static_cast<int>(std::lround((low[c] - p0) / 2.0f)), 0, 127);
+                const int q1 = std::clamp(static_cast<int>(std::lround((high[c] - p1) / 2.0f)), 0, 127);
+                endpoint0[c] = (q0 << 1) | p0;
+                endpoint1[c] = (q1 << 1) | p1;
+            }
+
+            uint8_t indices[16];
+            const int error = evaluateBC7Mode6(pTexels, endpoint0, endpoint1, indices);
+            if (error < bestError)
+            {
+                bestError = error;
+                *bestPBits = pBits;
+                memcpy(bestEndpoint0, endpoint0, sizeof(endpoint0));
+                memcpy(bestEndpoint1, endpoint1, sizeof(endpoint1));
+                memcpy(bestIndices, indices, sizeof(indices));
+            }
+        }
+        return bestError;
+    }
+}
+
+size_t BlockCompressor::getBlockSize(Format format)
+{
+    return format == Format::BC1 ? 8 : 16;
+}
+
+const char* BlockCompressor::getName(Format format)
+{
+    switch (format)
+    {
+    case Format::BC1: return "BC1";
+    case Format::BC3: return "BC3";
+    case Format::BC5: return "BC5";
+    case Format::BC7: return "BC7";
+    }
+    return "unknown";
+}
+
+void BlockCompressor::encodeBlock(Format format, const unsigned char* pTexels, unsigned char* pBlock)
+{
+    switch (format)
+    {
+    case Format::BC1:
+        encodeBC1(pTexels, pBlock);
+        break;
+    case Format::BC3:
+        encodeBC4(pTexels, 3, pBlock);
+        encodeBC1(pTexels, pBlock + 8);
+        break;
+    case Format::BC5:
+        encodeBC4(pTexels, 0, pBlock);
+        encodeBC4(pTexels, 1, pBlock + 8);
+        break;
+    case Format::BC7:
+        encodeBC7Mode6(pTexels, pBlock);
+        break;
+    }
+}
+
+void BlockCompressor::decodeBlock(Format format, const unsigned char* pBlock, unsigned char* pTexels)
+{
+    switch (format)
+    {
+    case Format::BC1:
+        decodeBC1(pBlock, pTexels);
+        break;
+    case Format::BC3:
+        decodeBC1(pBlock + 8, pTexels);
+        decodeBC4(pBlock, 3, pTexels);
+        break;
+    case Format::BC5:
+        for (int t = 0; t < 16; ++t)
+        {
+            pTexels[t * 4 + 2] = 0;
+            pTexels[t * 4 + 3] = 255;
+        }
+        decodeBC4(pBlock, 0, pTexels);
+        decodeBC4(pBlock + 8, 1, pTexels);
+        break;
+    case Format::BC7:
+        decodeBC7Mode6(pBlock, pTexels);
+        break;
+    }
+}
+
+std::vector<unsigned char> BlockCompressor::compressImage(Format format, const unsigned char* pPixels,
+    uint32_t width, uint32_t height, ThreadPool* pThreadPool)
+{
+    const uint32_t blocksX = (width + 3) / 4;
+    const uint32_t blocksY = (height + 3) / 4;
+    const size_t blockSize = getBlockSize(format);
+    std::vector<unsigned char> blocks(size_t(blocksX) * blocksY * blockSize);
+
+    auto encodeRow = [&](size_t blockY)
+        {
+            unsigned char texels[64];
+            for (uint32_t blockX = 0; blockX < blocksX; ++blockX)
+            {
+                for (uint32_t y = 0; y < 4; ++y)
+                {
+                    const uint32_t srcY = std::min(static_cast<uint32_t>(blockY) * 4 + y, height - 1);
+                    for (uint32_t x = 0; x < 4; ++x)
+                    {
+                        const uint32_t srcX = std::min(blockX * 4 + x, width - 1);
+                        memcpy(texels + (y * 4 + x) * 4, pPixels + (size_t(srcY) * width + srcX) * 4, 4);
+                    }
+                }
+                encodeBlock(format, texels, blocks.data() + (blockY * blocksX + blockX) * blockSize);
+            }
+        };
+
+    if (pThreadPool)
+    {
+        pThreadPool->parallelFor(blocksY, encodeRow);
+    }
+    else
+    {
+        for (size_t blockY = 0; blockY < blocksY; ++blockY)
+        {
+            encodeRow(blockY);
+        }
+    }
+
+    return blocks;
+}
+
+std::vector<unsigned char> BlockCompressor::decompressImage(Format format, const unsigned char* pBlocks,
+    uint32_t width, uint32_t height)
+{
+    const uint32_t blocksX = (width + 3) / 4;
+    const uint32_t blocksY = (height + 3) / 4;
+    const size_t blockSize = getBlockSize(format);
+    std::vector<unsigned char> pixels(size_t(width) * height * 4);
+
+    unsigned char texels[64];
+    for (uint32_t blockY = 0; blockY < blocksY; ++blockY)
+    {
+        for (uint32_t blockX = 0; blockX < blocksX; ++blockX)
+        {
+            decodeBlock(format, pBlocks + (size_t(blockY) * blocksX + blockX) * blockSize, texels);
+            for (uint32_t y = 0; y < 4 && blockY * 4 + y < height; ++y)
+            {
+                for (uint32_t x = 0; x < 4 && blockX * 4 + x < width; ++x)
+                {
+                    memcpy(pixels.data() + (size_t(blockY * 4 + y) * width + blockX * 4 + x) * 4, texels + (y * 4 + x) * 4, 4);
+                }
+            }
+        }
+    }
+    return pixels;
+}
+
+void BlockCompressor::encodeBC1(const unsigned char* pTexels, unsigned char* pBlock)
+{
+    float colors[16][3];
+    for (int t = 0; t < 16; ++t)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            colors[t][c] = pTexels[t * 4 + c];
+        }
+    }
+
+    float mean[3];
+    float axis[3];
+    computePrincipalAxis<3>(colors, mean, axis);
+
+    float minProjection = 0.0f;
+    float maxProjection = 0.0f;
+    for (int t = 0; t < 16; ++t)
+    {
+        float projection = 0.0f;
+        for (int c = 0; c < 3; ++c)
+        {
+            projection += (colors[t][c] - mean[c]) * axis[c];
+        }
+        minProjection = std::min(minProjection, projection);
+        maxProjection = std::max(maxProjection, projection);
+    }
+
+    float high[3];
+    float low[3];
+    for (int c = 0; c < 3; ++c)
+    {
+        high[c] = mean[c] + axis[c] * maxProjection;
+        low[c] = mean[c] + axis[c] * minProjection;
+    }
+
+    uint16_t color0 = packRGB565(high);
+    uint16_t color1 = packRGB565(low);
+    // color0 > color1 selects the four-colour mode, which BC3 also assumes
+    if (color0 < color1)
+    {
+        std::swap(color0, color1);
+    }
+
+    uint32_t indexBits = 0;
+    if (color0 != color1)
+    {
+        int palette[4][3];
+        unpackRGB565(color0, palette[0]);
+        unpackRGB565(color1, palette[1]);
+        for (int c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        for (int t = 0; t < 16; ++t)
+        {
+            int bestIndex = 0;
+            int bestError = INT32_MAX;
+            for (int i = 0; i < 4; ++i)
+            {
+                const int error = squaredDistance(palette[i], pTexels + t * 4, 3);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    bestIndex = i;
+                }
+            }
+            indexBits |= static_cast<uint32_t>(bestIndex) << (t * 2);
+        }
+    }
+
+    pBlock[0] = static_cast<unsigned char>(color0 & 0xFF);
+    pBlock[1] = static_cast<unsigned char>(color0 >> 8);
+    pBlock[2] = static_cast<unsigned char>(color1 & 0xFF);
+    pBlock[3] = static_cast<unsigned char>(color1 >> 8);
+    memcpy(pBlock + 4, &indexBits, 4);
+}
+
+void BlockCompressor::encodeBC4(const unsigned char* pTexels, int channel, unsigned char* pBlock)
+{
+    int minValue = 255;
+    int maxValue = 0;
+    for (int t = 0; t < 16; ++t)
+    {
+        minValue = std::min<int>(minValue, pTexels[t * 4 + channel]);
+        maxValue = std::max<int>(maxValue, pTexels[t * 4 + channel]);
+    }
+
+    // endpoint0 > endpoint1 selects eight interpolated values
+    pBlock[0] = static_cast<unsigned char>(maxValue);
+    pBlock[1] = static_cast<unsigned char>(minValue);
+
+    uint64_t indexBits = 0;
+    if (maxValue != minValue)
+    {
+        int palette[8];
+        palette[0] = maxValue;
+        palette[1] = minValue;
+        for (int i = 1; i < 7; ++i)
+        {
+            palette[i + 1] = ((7 - i) * maxValue + i * minValue) / 7;
+        }
+
+        for (int t = 0; t < 16; ++t)
+        {
+            const int value = pTexels[t * 4 + channel];
+            int bestIndex = 0;
+            int bestError = INT32_MAX;
+            for (int i = 0; i < 8; ++i)
+            {
+                const int error = std::abs(palette[i] - value);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    bestIndex = i;
+                }
+            }
+            indexBits |= static_cast<uint64_t>(bestIndex) << (t * 3);
+        }
+    }
+
+    for (int i = 0; i < 6; ++i)
+    {
+        pBlock[2 + i] = static_cast<unsigned char>((indexBits >> (i * 8)) & 0xFF);
+    }
+}
+
+void BlockCompressor::encodeBC7Mode6(const unsigned char* pTexels, unsigned char* pBlock)
+{
+    float colors[16][4];
+    for (int t = 0; t < 16; ++t)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            colors[t][c] = pTexels[t * 4 + c];
+        }
+    }
+
+    float mean[4];
+    float axis[4];
+    computePrincipalAxis<4>(colors, mean, axis);
+
+    float minProjection = 0.0f;
+    float maxProjection = 0.0f;
+    for (int t = 0; t < 16; ++t)
+    {
+        float projection = 0.0f;
+        for (int c = 0; c < 4; ++c)
+        {
+            projection += (colors[t][c] - mean[c]) * axis[c];
+        }
+        minProjection = std::min(minProjection, projection);
+        maxProjection = std::max(maxProjection, projection);
+    }
+
+    float low[4];
+    float high[4];
+    for (int c = 0; c < 4; ++c)
+    {
+        low[c] = std::clamp(mean[c] + axis[c] * minProjection, 0.0f, 255.0f);
+        high[c] = std::clamp(mean[c] + axis[c] * maxProjection, 0.0f, 255.0f);
+    }
+
+    int endpoint0[4];
+    int endpoint1[4];
+    int pBits = 0;
+    uint8_t indices[16];
+    int error = fitBC7Mode6(pTexels, low, high, endpoint0, endpoint1, &pBits, indices);
+
+    // One least-squares pass: refit the endpoints to the chosen weights
+    if (error > 0)
+    {
+        float aa = 0.0f;
+        float ab = 0.0f;
+        float bb = 0.0f;
+        float ax[4] = {};
+        float bx[4] = {};
+        for (int t = 0; t < 16; ++t)
+        {
+            const float w = BC7_WEIGHTS_4[indices[t]] / 64.0f;
+            aa += (1.0f - w) * (1.0f - w);
+            ab += (1.0f - w) * w;
+            bb += w * w;
+            for (int c = 0; c < 4; ++c)
+            {
+                ax[c] += (1.0f - w) * colors[t][c];
+                bx[c] += w * colors[t][c];
+            }
+        }
+
+        const float determinant = aa * bb - ab * ab;
+        if (std::abs(determinant) > 1e-6f)
+        {
+            float refinedLow[4];
+            float refinedHigh[4];
+            for (int c = 0; c < 4; ++c)
+            {
+                refinedLow[c] = std::clamp((ax[c] * bb - bx[c] * ab) / determinant, 0.0f, 255.0f);
+                refinedHigh[c] = std::clamp((bx[c] * aa - ax[c] * ab) / determinant, 0.0f, 255.0f);
+            }
+
+            int refinedEndpoint0[4];
+            int refinedEndpoint1[4];
+            int refinedPBits = 0;
+            uint8_t refinedIndices[16];
+            const int refinedError = fitBC7Mode6(pTexels, refinedLow, refinedHigh,
+                refinedEndpoint0, refinedEndpoint1, &refinedPBits, refinedIndices);
+            if (refinedError < error)
+            {
+                error = refinedError;
+                pBits = refinedPBits;
+                memcpy(endpoint0, refinedEndpoint0, sizeof(endpoint0));
+                memcpy(endpoint1, refinedEndpoint1, sizeof(endpoint1));
+                memcpy(indices, refinedIndices, sizeof(indices));
+            }
+        }
+    }
+
+    // The anchor index is stored with its top bit implied zero
+    int p0 = pBits & 1;
+    int p1 = pBits >> 1;
+    if (indices[0] & 8)
+    {
+        std::swap(endpoint0, endpoint1);
+        std::swap(p0, p1);
+        for (uint8_t& index : indices)
+        {
+            index = static_cast<uint8_t>(15 - index);
+        }
+    }
+
+    BitWriter writer(pBlock);
+    writer.write(1u << 6, 7);
+    for (int c = 0; c < 4; ++c)
+    {
+        writer.write(static_cast<uint32_t>(endpoint0[c] >> 1), 7);
+        writer.write(static_cast<uint32_t>(endpoint1[c] >> 1), 7);
+    }
+    writer.write(static_cast<uint32_t>(p0), 1);
+    writer.write(static_cast<uint32_t>(p1), 1);
+    writer.write(indices[0], 3);
+    for (int t = 1; t < 16; ++t)
+    {
+        writer.write(indices[t], 4);
+    }
+}
+
+void BlockCompressor::decodeBC1(const unsigned char* pBlock, unsigned char* pTexels)
+{
+    const uint16_t color0 = static_cast<uint16_t>(pBlock[0] | (pBlock[1] << 8));
+    const uint16_t color1 = static_cast<uint16_t>(pBlock[2] | (pBlock[3] << 8));
+    uint32_t indexBits;
+    memcpy(&indexBits, pBlock + 4, 4);
+
+    int palette[4][4];
+    unpackRGB565(color0, palette[0]);
+    unpackRGB565(color1, palette[1]);
+    palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+    for (int c = 0; c < 3; ++c)
+    {
+        if (color0 > color1)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        else
+        {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+    if (color0 <= color1)
+    {
+        palette[3][3] = 0;
+    }
+
+    for (int t = 0; t < 16; ++t)
+    {
+        const int index = (indexBits >> (t * 2)) & 3;
+        for (int c = 0; c < 4; ++c)
+        {
+            pTexels[t * 4 + c] = static_cast<unsigned char>(palette[index][c]);
+        }
+    }
+}
+
+void BlockCompressor::decodeBC4(const unsigned char* pBlock, int channel, unsigned char* pTexels)
+{
+    const int value0 = pBlock[0];
+    const int value1 = pBlock[1];
+    uint64_t indexBits = 0;
+    for (int i = 0; i < 6; ++i)
+    {
+        indexBits |= static_cast<uint64_t>(pBlock[2 + i]) << (i * 8);
+    }
+
+    int palette[8];
+    palette[0] = value0;
+    palette[1] = value1;
+    if (value0 > value1)
+    {
+        for (int i = 1; i < 7; ++i)
+        {
+            palette[i + 1] = ((7 - i) * value0 + i * value1) / 7;
+        }
+    }
+    else
+    {
+        for (int i = 1; i < 5; ++i)
+        {
+            palette[i + 1] = ((5 - i) * value0 + i * value1) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    for (int t = 0; t < 16; ++t)
+    {
+        pTexels[t * 4 + channel] = static_cast<unsigned char>(palette[(indexBits >> (t * 3)) & 7]);
+    }
+}
+
+void BlockCompressor::decodeBC7Mode6(const unsigned char* pBlock, unsigned char* pTexels)
+{
+    BitReader reader(pBlock);
+    if (reader.read(7) != (1u << 6))
+    {
+        throw std::runtime_error("Only BC7 mode 6 blocks can be decoded");
+    }
+
+    int endpoint0[4];
+    int endpoint1[4];
+    for (int c = 0; c < 4; ++c)
+    {
+        endpoint0[c] = static_cast<int>(reader.read(7)) << 1;
+        endpoint1[c] = static_cast<int>(reader.read(7)) << 1;
+    }
+    const int p0 = static_cast<int>(reader.read(1));
+    const int p1 = static_cast<int>(reader.read(1));
+    for (int c = 0; c < 4; ++c)
+    {
+        endpoint0[c] |= p0;
+        endpoint1[c] |= p1;
+    }
+
+    for (int t = 0; t < 16; ++t)
+    {
+        const int index = static_cast<int>(reader.read(t == 0 ? 3 : 4));
+        for (int c = 0; c < 4; ++c)
+        {
+            pTexels[t * 4 + c] = static_cast<unsigned char>(
+                ((64 - BC7_WEIGHTS_4[index]) * endpoint0[c] + BC7_WEIGHTS_4[index] * endpoint1[c] + 32) >> 6);
+        }
+    }
+}
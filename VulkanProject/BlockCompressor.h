@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+//
+// CPU encoder/decoder for the BCn formats used by cooked textures.
+// BC7 output only uses mode 6 (one subset, RGBA endpoints, 4-bit indices), which is fast
+// to search and good enough for albedo and packed material maps. The decoder only has to
+// understand what the encoder produces; it exists to measure compression error.
+//
+class BlockCompressor
+{
+public:
+    enum class Format
+    {
+        BC1,    // RGB, 4 bpp
+        BC3,    // RGBA, 8 bpp (BC1 colour + BC4 alpha)
+        BC5,    // RG, 8 bpp (two BC4 channels)
+        BC7     // RGBA, 8 bpp
+    };
+
+    static size_t getBlockSize(Format format);
+    static const char* getName(Format format);
+
+    // pTexels is a 4x4 block of RGBA8 texels, row-major
+    static void encodeBlock(Format format, const unsigned char* pTexels, unsigned char* pBlock);
+    static void decodeBlock(Format format, const unsigned char* pBlock, unsigned char* pTexels);
+
+    // Encodes one RGBA8 image; partial edge blocks repeat the last row/column.
+    // Rows of blocks are spread over pThreadPool when one is given.
+    static std::vector<unsigned char> compressImage(Format format, const unsigned char* pPixels,
+        uint32_t width, uint32_t height, ThreadPool* pThreadPool = nullptr);
+    static std::vector<unsigned char> decompressImage(Format format, const unsigned char* pBlocks,
+        uint32_t width, uint32_t height);
+
+private:
+    static void encodeBC1(const unsigned char* pTexels, unsigned char* pBlock);
+    static void encodeBC4(const unsigned char* pTexels, int channel, unsigned char* pBlock);
+    static void encodeBC7Mode6(const unsigned char* pTexels, unsigned char* pBlock);
+
+    static void decodeBC1(const unsigned char* pBlock, unsigned char* pTexels);
+    static void decodeBC4(const unsigned char* pBlock, int channel, unsigned char* pTexels);
+    static void decodeBC7Mode6(const unsigned char* pBlock, unsigned char* pTexels);
+};
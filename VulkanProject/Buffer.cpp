@@ -6,7 +6,8 @@ Buffer::Buffer(VmaAllocator allocator,
                VkDeviceSize size,
                VkBufferUsageFlags usage,
                VmaMemoryUsage memoryUsage,
-               VmaAllocationCreateFlags allocFlags)
+               VmaAllocationCreateFlags allocFlags,
+               VkMemoryPropertyFlags requiredFlags)
     : m_Allocator(allocator), m_BufferSize(size) 
 {
     VkBufferCreateInfo bufferInfo{};
@@ -18,6 +19,7 @@ Buffer::Buffer(VmaAllocator allocator,
     VmaAllocationCreateInfo allocInfo{};
     allocInfo.usage = memoryUsage;
     allocInfo.flags = allocFlags;
+    allocInfo.requiredFlags = requiredFlags;
 
     if (vmaCreateBuffer(m_Allocator, &bufferInfo, &allocInfo, &m_Buffer, &m_Allocation, nullptr) != VK_SUCCESS) 
     {
@@ -60,9 +62,14 @@ void Buffer::unmap()
     }
 }
 
-void Buffer::flush(VkDeviceSize size) 
+void Buffer::flush(VkDeviceSize size, VkDeviceSize offset) 
 {
-    vmaFlushAllocation(m_Allocator, m_Allocation, 0, size);
+    vmaFlushAllocation(m_Allocator, m_Allocation, offset, size);
+}
+
+void Buffer::invalidate(VkDeviceSize size)
+{
+    vmaInvalidateAllocation(m_Allocator, m_Allocation, 0, size);
 }
 
 void Buffer::copyTo(CommandPool* commandPool,VkQueue queue, Buffer* dstBuffer)
@@ -12,14 +12,17 @@ public:
            VkDeviceSize size,
            VkBufferUsageFlags usage,
            VmaMemoryUsage memoryUsage,
-           VmaAllocationCreateFlags allocFlags = 0);
+           VmaAllocationCreateFlags allocFlags = 0,
+           VkMemoryPropertyFlags requiredFlags = 0);
 
     ~Buffer();
 
     VkBuffer get() const;
     void* map();
     void unmap();
-    void flush(VkDeviceSize size = VK_WHOLE_SIZE);
+    void flush(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
+    // Makes GPU writes visible to mapped reads on non-coherent memory
+    void invalidate(VkDeviceSize size = VK_WHOLE_SIZE);
 	void copyTo(CommandPool* commandPool,VkQueue queue, Buffer* dstBuffer);
 
 private:
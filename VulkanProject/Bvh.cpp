@@ -0,0 +1,355 @@
+#include "Bvh.h"
+#include "Frustum.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cfloat>
+#include <numeric>
+#include <utility>
+
+namespace
+{
+    constexpr int BIN_COUNT = 16;
+    // Leaves may hold more than one item when splitting them further is not worth it by SAH
+    constexpr uint32_t MAX_LEAF_SIZE = 4;
+    // Below this many items the build stays on the calling thread
+    constexpr uint32_t MIN_PARALLEL_ITEMS = 1024;
+
+    struct Bin
+    {
+        glm::vec3 boundsMin{ FLT_MAX };
+        glm::vec3 boundsMax{ -FLT_MAX };
+        uint32_t count = 0;
+    };
+
+    float getSurfaceArea(const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+    {
+        const glm::vec3 size = boundsMax - boundsMin;
+        if (size.x < 0.0f || size.y < 0.0f || size.z < 0.0f)
+        {
+            return 0.0f;
+        }
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    int getBinIndex(float centroid, float centroidMin, float scale)
+    {
+        return std::min(static_cast<int>((centroid - centroidMin) * scale), BIN_COUNT - 1);
+    }
+}
+
+void Bvh::build(const std::vector<glm::vec3>& boxMins, const std::vector<glm::vec3>& boxMaxs, ThreadPool* pThreadPool)
+{
+    m_Nodes.clear();
+    m_ItemIndices.clear();
+
+    const uint32_t itemCount = static_cast<uint32_t>(boxMins.size());
+    if (itemCount == 0)
+    {
+        return;
+    }
+
+    m_pBoxMins = &boxMins;
+    m_pBoxMaxs = &boxMaxs;
+    m_Centroids.resize(itemCount);
+    for (uint32_t i = 0; i < itemCount; ++i)
+    {
+        m_Centroids[i] = (boxMins[i] + boxMaxs[i]) * 0.5f;
+    }
+
+    m_ItemIndices.resize(itemCount);
+    std::iota(m_ItemIndices.begin(), m_ItemIndices.end(), 0u);
+
+    // A binary tree with one item per leaf has 2n - 1 nodes, so the array never has to grow
+    // and workers can fill their subtrees in place
+    m_Nodes.resize(2 * size_t(itemCount) - 1);
+    m_NodeCount = 1;
+
+    const BuildTask root{ 0, 0, itemCount };
+    if (pThreadPool && itemCount >= MIN_PARALLEL_ITEMS)
+    {
+        // Split the top of the tree here until there are enough subtrees to keep every worker busy
+        const uint32_t parallelThreshold = std::max(itemCount / (pThreadPool->getThreadCount() * 4 + 1), 256u);
+        std::vector<BuildTask> deferred;
+        subdivide(root, parallelThreshold, &deferred);
+
+        pThreadPool->parallelFor(deferred.size(), [&](size_t i)
+        {
+            subdivide(deferred[i], 0, nullptr);
+        });
+    }
+    else
+    {
+        subdivide(root, 0, nullptr);
+    }
+
+    m_Nodes.resize(m_NodeCount);
+
+    m_Centroids.clear();
+    m_Centroids.shrink_to_fit();
+    m_pBoxMins = nullptr;
+    m_pBoxMaxs = nullptr;
+}
+
+uint32_t Bvh::allocateNodePair()
+{
+    return m_NodeCount.fetch_add(2, std::memory_order_relaxed);
+}
+
+void Bvh::subdivide(const BuildTask& task, uint32_t parallelThreshold, std::vector<BuildTask>* pDeferred)
+{
+    const std::vector<glm::vec3>& boxMins = *m_pBoxMins;
+    const std::vector<glm::vec3>& boxMaxs = *m_pBoxMaxs;
+    const auto first = m_ItemIndices.begin() + task.first;
+    const auto last = first + task.count;
+
+    Node& node = m_Nodes[task.nodeIndex];
+    node.boundsMin = glm::vec3(FLT_MAX);
+    node.boundsMax = glm::vec3(-FLT_MAX);
+    glm::vec3 centroidMin(FLT_MAX);
+    glm::vec3 centroidMax(-FLT_MAX);
+    for (auto it = first; it != last; ++it)
+    {
+        node.boundsMin = glm::min(node.boundsMin, boxMins[*it]);
+        node.boundsMax = glm::max(node.boundsMax, boxMaxs[*it]);
+        centroidMin = glm::min(centroidMin, m_Centroids[*it]);
+        centroidMax = glm::max(centroidMax, m_Centroids[*it]);
+    }
+
+    node.leftOrFirst = task.first;
+    node.itemCount = task.count;
+    if (task.count == 1)
+    {
+        return;
+    }
+
+    // Find the cheapest bin boundary on any axis
+    int bestAxis = -1;
+    int bestSplit = 0;
+    float bestCost = FLT_MAX;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float extent = centroidMax[axis] - centroidMin[axis];
+        if (extent <= 0.0f)
+        {
+            continue;
+        }
+        const float scale = BIN_COUNT / extent;
+
+        Bin bins[BIN_COUNT];
+        for (auto it = first; it != last; ++it)
+        {
+            Bin& bin = bins[getBinIndex(m_Centroids[*it][axis], centroidMin[axis], scale)];
+            bin.boundsMin = glm::min(bin.boundsMin, boxMins[*it]);
+            bin.boundsMax = glm::max(bin.boundsMax, boxMaxs[*it]);
+            bin.count++;
+        }
+
+        // leftArea[i] / leftCount[i] describe bins 0..i, the right side bins i+1..BIN_COUNT-1
+        float leftArea[BIN_COUNT - 1];
+        uint32_t leftCount[BIN_COUNT - 1];
+        glm::vec3 sweepMin(FLT_MAX);
+        glm::vec3 sweepMax(-FLT_MAX);
+        uint32_t sweepCount = 0;
+        for (int i = 0; i < BIN_COUNT - 1; ++i)
+        {
+            sweepMin = glm::min(sweepMin, bins[i].boundsMin);
+            sweepMax = glm::max(sweepMax, bins[i].boundsMax);
+            sweepCount += bins[i].count;
+            leftArea[i] = getSurfaceArea(sweepMin, sweepMax);
+            leftCount[i] = sweepCount;
+        }
+
+        sweepMin = glm::vec3(FLT_MAX);
+        sweepMax = glm::vec3(-FLT_MAX);
+        sweepCount = 0;
+        for (int i = BIN_COUNT - 1; i > 0; --i)
+        {
+            sweepMin = glm::min(sweepMin, bins[i].boundsMin);
+            sweepMax = glm::max(sweepMax, bins[i].boundsMax);
+            sweepCount += bins[i].count;
+
+            const int split = i - 1;
+            if (leftCount[split] == 0 || sweepCount == 0)
+            {
+                continue;
+            }
+            const float cost = leftArea[split] * leftCount[split] + getSurfaceArea(sweepMin, sweepMax) * sweepCount;
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = split;
+            }
+        }
+    }
+
+    uint32_t leftCount;
+    if (bestAxis < 0)
+    {
+        // Every centroid is in the same spot, so no bin boundary separates them
+        if (task.count <= MAX_LEAF_SIZE)
+        {
+            return;
+        }
+        leftCount = task.count / 2;
+    }
+    else
+    {
+        const float leafCost = getSurfaceArea(node.boundsMin, node.boundsMax) * task.count;
+        if (bestCost >= leafCost && task.count <= MAX_LEAF_SIZE)
+        {
+            return;
+        }
+
+        const float scale = BIN_COUNT / (centroidMax[bestAxis] - centroidMin[bestAxis]);
+        const auto middle = std::partition(first, last, [&](uint32_t item)
+        {
+            return getBinIndex(m_Centroids[item][bestAxis], centroidMin[bestAxis], scale) <= bestSplit;
+        });
+        leftCount = static_cast<uint32_t>(middle - first);
+    }
+
+    const uint32_t leftChild = allocateNodePair();
+    node.leftOrFirst = leftChild;
+    node.itemCount = 0;
+
+    const BuildTask children[2] = {
+        { leftChild, task.first, leftCount },
+        { leftChild + 1, task.first + leftCount, task.count - leftCount }
+    };
+    for (const BuildTask& child : children)
+    {
+        if (pDeferred && child.count < parallelThreshold)
+        {
+            pDeferred->push_back(child);
+        }
+        else
+        {
+            subdivide(child, parallelThreshold, pDeferred);
+        }
+    }
+}
+
+void Bvh::cullFrustum(const Frustum& frustum, std::vector<uint32_t>& visibleItems) const
+{
+    if (m_Nodes.empty())
+    {
+        return;
+    }
+
+    // Node index and the planes its parent was not yet fully inside of
+    std::vector<std::pair<uint32_t, uint32_t>> stack;
+    stack.reserve(64);
+    stack.push_back({ 0, Frustum::ALL_PLANES });
+
+    while (!stack.empty())
+    {
+        auto [nodeIndex, planeMask] = stack.back();
+        stack.pop_back();
+        const Node& node = m_Nodes[nodeIndex];
+
+        const Frustum::Containment containment = frustum.classifyBox(node.boundsMin, node.boundsMax, planeMask);
+        if (containment == Frustum::Containment::Outside)
+        {
+            continue;
+        }
+
+        if (node.isLeaf())
+        {
+            visibleItems.insert(visibleItems.end(), m_ItemIndices.begin() + node.leftOrFirst,
+                m_ItemIndices.begin() + node.leftOrFirst + node.itemCount);
+        }
+        else if (containment == Frustum::Containment::Inside)
+        {
+            // A subtree's items are contiguous, from its leftmost leaf to its rightmost one
+            const Node* pLeftmost = &node;
+            while (!pLeftmost->isLeaf())
+            {
+                pLeftmost = &m_Nodes[pLeftmost->leftOrFirst];
+            }
+            const Node* pRightmost = &node;
+            while (!pRightmost->isLeaf())
+            {
+                pRightmost = &m_Nodes[pRightmost->leftOrFirst + 1];
+            }
+            visibleItems.insert(visibleItems.end(), m_ItemIndices.begin() + pLeftmost->leftOrFirst,
+                m_ItemIndices.begin() + pRightmost->leftOrFirst + pRightmost->itemCount);
+        }
+        else
+        {
+            stack.push_back({ node.leftOrFirst, planeMask });
+            stack.push_back({ node.leftOrFirst + 1, planeMask });
+        }
+    }
+}
+
+void Bvh::traverseRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+    const std::function<float(uint32_t item, float maxDistance)>& visit) const
+{
+    if (m_Nodes.empty())
+    {
+        return;
+    }
+
+    const glm::vec3 inverseDirection(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+
+    // Distance at which the ray enters the node, or FLT_MAX when it misses
+    auto intersect = [&](const Node& node)
+    {
+        const glm::vec3 t0 = (node.boundsMin - origin) * inverseDirection;
+        const glm::vec3 t1 = (node.boundsMax - origin) * inverseDirection;
+        const glm::vec3 tNear = glm::min(t0, t1);
+        const glm::vec3 tFar = glm::max(t0, t1);
+        const float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+        const float exit = std::min(std::min(tFar.x, tFar.y), tFar.z);
+        return enter <= exit ? enter : FLT_MAX;
+    };
+
+    std::vector<std::pair<uint32_t, float>> stack;
+    stack.reserve(64);
+    const float rootDistance = intersect(m_Nodes[0]);
+    if (rootDistance < maxDistance)
+    {
+        stack.push_back({ 0, rootDistance });
+    }
+
+    while (!stack.empty())
+    {
+        auto [nodeIndex, entryDistance] = stack.back();
+        stack.pop_back();
+        if (entryDistance >= maxDistance)
+        {
+            continue;
+        }
+
+        const Node& node = m_Nodes[nodeIndex];
+        if (node.isLeaf())
+        {
+            for (uint32_t i = 0; i < node.itemCount; ++i)
+            {
+                maxDistance = visit(m_ItemIndices[node.leftOrFirst + i], maxDistance);
+            }
+            continue;
+        }
+
+        uint32_t nearChild = node.leftOrFirst;
+        uint32_t farChild = node.leftOrFirst + 1;
+        float nearDistance = intersect(m_Nodes[nearChild]);
+        float farDistance = intersect(m_Nodes[farChild]);
+        if (farDistance < nearDistance)
+        {
+            std::swap(nearChild, farChild);
+            std::swap(nearDistance, farDistance);
+        }
+
+        // Pushed far first so the near child is visited first
+        if (farDistance < maxDistance)
+        {
+            stack.push_back({ farChild, farDistance });
+        }
+        if (nearDistance < maxDistance)
+        {
+            stack.push_back({ nearChild, nearDistance });
+        }
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class Frustum;
+class ThreadPool;
+
+//
+// Bounding volume hierarchy over axis-aligned boxes, one item per box (the model uses one per submesh).
+// Built top-down with binned SAH: the top levels are split on the calling thread and the subtrees below
+// them are built in parallel. Nodes live in one flat array of 32-byte entries with siblings next to each other.
+//
+class Bvh
+{
+public:
+    struct Node
+    {
+        glm::vec3 boundsMin;
+        uint32_t leftOrFirst;   // index of the left child (right is +1), or of the first item for leaves
+        glm::vec3 boundsMax;
+        uint32_t itemCount;     // 0 for interior nodes
+
+        bool isLeaf() const { return itemCount > 0; }
+    };
+    static_assert(sizeof(Node) == 32, "BVH nodes are expected to be 32 bytes");
+
+    void build(const std::vector<glm::vec3>& boxMins, const std::vector<glm::vec3>& boxMaxs, ThreadPool* pThreadPool = nullptr);
+
+    // Appends every item whose box intersects the frustum. Subtrees that are fully inside are accepted
+    // without testing their children, and subtrees that are fully outside are skipped.
+    void cullFrustum(const Frustum& frustum, std::vector<uint32_t>& visibleItems) const;
+
+    // Calls visit(item, maxDistance) for each item whose box the ray enters within maxDistance, nearer
+    // nodes first. visit returns the new maxDistance, so a closest-hit query shrinks the ray as it goes.
+    // direction does not have to be normalized; distances are in units of its length.
+    void traverseRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+        const std::function<float(uint32_t item, float maxDistance)>& visit) const;
+
+    const std::vector<Node>& getNodes() const { return m_Nodes; }
+    bool isEmpty() const { return m_Nodes.empty(); }
+
+private:
+    struct BuildTask
+    {
+        uint32_t nodeIndex;
+        uint32_t first;
+        uint32_t count;
+    };
+
+    // Splits one node; children smaller than parallelThreshold are appended to pDeferred instead of built
+    void subdivide(const BuildTask& task, uint32_t parallelThreshold, std::vector<BuildTask>* pDeferred);
+    uint32_t allocateNodePair();
+
+    std::vector<Node> m_Nodes;
+    std::vector<uint32_t> m_ItemIndices;
+
+    // Only valid during build()
+    const std::vector<glm::vec3>* m_pBoxMins = nullptr;
+    const std::vector<glm::vec3>* m_pBoxMaxs = nullptr;
+    std::vector<glm::vec3> m_Centroids;
+    std::atomic<uint32_t> m_NodeCount{ 0 };
+};
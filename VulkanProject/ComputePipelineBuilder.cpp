@@ -53,7 +53,7 @@ ComputePipeline* ComputePipelineBuilder::build()
 	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 	pipelineLayoutInfo.setLayoutCount = 1;
 	pipelineLayoutInfo.pSetLayouts = &m_PipelineLayout;
-	pipelineLayoutInfo.pushConstantRangeCount = 1; // Number of push constant ranges
+	pipelineLayoutInfo.pushConstantRangeCount = m_PushConstantSize > 0 ? 1 : 0; // Shaders without push constants leave the size at 0
 	pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange; // Pointer to the push constant ranges
 	VkPipelineLayout pipelineLayout;
 
@@ -0,0 +1,242 @@
+#include "DdsFile.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+    constexpr uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+
+    constexpr uint32_t makeFourCC(char a, char b, char c, char d)
+    {
+        return uint32_t(uint8_t(a)) | (uint32_t(uint8_t(b)) << 8) | (uint32_t(uint8_t(c)) << 16) | (uint32_t(uint8_t(d)) << 24);
+    }
+
+    constexpr uint32_t DDSD_CAPS = 0x1;
+    constexpr uint32_t DDSD_HEIGHT = 0x2;
+    constexpr uint32_t DDSD_WIDTH = 0x4;
+    constexpr uint32_t DDSD_PIXELFORMAT = 0x1000;
+    constexpr uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+    constexpr uint32_t DDSD_LINEARSIZE = 0x80000;
+    constexpr uint32_t DDPF_FOURCC = 0x4;
+    constexpr uint32_t DDSCAPS_COMPLEX = 0x8;
+    constexpr uint32_t DDSCAPS_TEXTURE = 0x1000;
+    constexpr uint32_t DDSCAPS_MIPMAP = 0x400000;
+    constexpr uint32_t DDS_DIMENSION_TEXTURE2D = 3;
+
+    struct DdsPixelFormat
+    {
+        uint32_t size;
+        uint32_t flags;
+        uint32_t fourCC;
+        uint32_t rgbBitCount;
+        uint32_t rBitMask;
+        uint32_t gBitMask;
+        uint32_t bBitMask;
+        uint32_t aBitMask;
+    };
+
+    struct DdsHeader
+    {
+        uint32_t size;
+        uint32_t flags;
+        uint32_t height;
+        uint32_t width;
+        uint32_t pitchOrLinearSize;
+        uint32_t depth;
+        uint32_t mipMapCount;
+        uint32_t reserved1[11];
+        DdsPixelFormat pixelFormat;
+        uint32_t caps;
+        uint32_t caps2;
+        uint32_t caps3;
+        uint32_t caps4;
+        uint32_t reserved2;
+    };
+
+    struct DdsHeaderDx10
+    {
+        uint32_t dxgiFormat;
+        uint32_t resourceDimension;
+        uint32_t miscFlag;
+        uint32_t arraySize;
+        uint32_t miscFlags2;
+    };
+
+    static_assert(sizeof(DdsHeader) == 124, "DDS header layout mismatch");
+    static_assert(sizeof(DdsHeaderDx10) == 20, "DDS DX10 header layout mismatch");
+
+    bool isBlockCompressed(uint32_t dxgiFormat)
+    {
+        return dxgiFormat >= DdsFile::DXGI_FORMAT_BC1_UNORM && dxgiFormat <= DdsFile::DXGI_FORMAT_BC7_UNORM_SRGB;
+    }
+
+    size_t getBlockSize(uint32_t dxgiFormat)
+    {
+        return (dxgiFormat == DdsFile::DXGI_FORMAT_BC1_UNORM || dxgiFormat == DdsFile::DXGI_FORMAT_BC1_UNORM_SRGB) ? 8 : 16;
+    }
+}
+
+size_t DdsFile::getLevelSize(uint32_t dxgiFormat, uint32_t width, uint32_t height)
+{
+    if (isBlockCompressed(dxgiFormat))
+    {
+        return size_t((width + 3) / 4) * ((height + 3) / 4) * getBlockSize(dxgiFormat);
+    }
+    return size_t(width) * height * 4;
+}
+
+bool DdsFile::read(const unsigned char* pData, size_t size, Description& outDescription)
+{
+    if (size < sizeof(uint32_t) + sizeof(DdsHeader))
+    {
+        return false;
+    }
+
+    uint32_t magic;
+    memcpy(&magic, pData, sizeof(magic));
+    DdsHeader header;
+    memcpy(&header, pData + sizeof(magic), sizeof(header));
+    if (magic != DDS_MAGIC || header.size != sizeof(DdsHeader) || header.pixelFormat.size != sizeof(DdsPixelFormat))
+    {
+        return false;
+    }
+    if (!(header.pixelFormat.flags & DDPF_FOURCC))
+    {
+        spdlog::warn("DDS file without FourCC is not supported");
+        return false;
+    }
+
+    size_t offset = sizeof(magic) + sizeof(header);
+    uint32_t dxgiFormat = DXGI_FORMAT_UNKNOWN;
+    switch (header.pixelFormat.fourCC)
+    {
+    case makeFourCC('D', 'X', '1', '0'):
+    {
+        if (size < offset + sizeof(DdsHeaderDx10))
+        {
+            return false;
+        }
+        DdsHeaderDx10 headerDx10;
+        memcpy(&headerDx10, pData + offset, sizeof(headerDx10));
+        offset += sizeof(headerDx10);
+        if (headerDx10.resourceDimension != DDS_DIMENSION_TEXTURE2D || headerDx10.arraySize > 1)
+        {
+            spdlog::warn("Only single-layer 2D DDS textures are supported");
+            return false;
+        }
+        dxgiFormat = headerDx10.dxgiFormat;
+        break;
+    }
+    case makeFourCC('D', 'X', 'T', '1'):
+        dxgiFormat = DXGI_FORMAT_BC1_UNORM;
+        break;
+    case makeFourCC('D', 'X', 'T', '5'):
+        dxgiFormat = DXGI_FORMAT_BC3_UNORM;
+        break;
+    case makeFourCC('A', 'T', 'I', '2'):
+    case makeFourCC('B', 'C', '5', 'U'):
+        dxgiFormat = DXGI_FORMAT_BC5_UNORM;
+        break;
+    default:
+        return false;
+    }
+
+    outDescription.dxgiFormat = dxgiFormat;
+    outDescription.width = header.width;
+    outDescription.height = header.height;
+    outDescription.pPayload = pData + offset;
+    outDescription.mipOffsets.clear();
+
+    const uint32_t mipCount = (header.flags & DDSD_MIPMAPCOUNT) ? std::max(header.mipMapCount, 1u) : 1u;
+    uint64_t levelOffset = 0;
+    for (uint32_t level = 0; level < mipCount; ++level)
+    {
+        outDescription.mipOffsets.push_back(levelOffset);
+        levelOffset += getLevelSize(dxgiFormat, std::max(header.width >> level, 1u), std::max(header.height >> level, 1u));
+    }
+
+    if (offset + levelOffset > size)
+    {
+        spdlog::warn("DDS file is truncated ({} bytes of payload expected)", levelOffset);
+        return false;
+    }
+    outDescription.payloadSize = static_cast<size_t>(levelOffset);
+    return true;
+}
+
+bool DdsFile::write(const std::string& path, uint32_t dxgiFormat, uint32_t width, uint32_t height,
+    const std::vector<std::vector<unsigned char>>& mipLevels)
+{
+    DdsHeader header{};
+    header.size = sizeof(DdsHeader);
+    header.flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+    header.height = height;
+    header.width = width;
+    header.pitchOrLinearSize = static_cast<uint32_t>(getLevelSize(dxgiFormat, width, height));
+    header.depth = 1;
+    header.mipMapCount = static_cast<uint32_t>(mipLevels.size());
+    header.pixelFormat.size = sizeof(DdsPixelFormat);
+    header.pixelFormat.flags = DDPF_FOURCC;
+    header.pixelFormat.fourCC = makeFourCC('D', 'X', '1', '0');
+    header.caps = DDSCAPS_TEXTURE | (mipLevels.size() > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0);
+
+    DdsHeaderDx10 headerDx10{};
+    headerDx10.dxgiFormat = dxgiFormat;
+    headerDx10.resourceDimension = DDS_DIMENSION_TEXTURE2D;
+    headerDx10.arraySize = 1;
+
+    // Written next to the final path and renamed, so a crash never leaves a half-written file behind
+    const std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            spdlog::error("Failed to open {} for writing", tempPath);
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char*>(&DDS_MAGIC), sizeof(DDS_MAGIC));
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(&headerDx10), sizeof(headerDx10));
+        for (const std::vector<unsigned char>& level : mipLevels)
+        {
+            file.write(reinterpret_cast<const char*>(level.data()), static_cast<std::streamsize>(level.size()));
+        }
+        if (!file.good())
+        {
+            spdlog::error("Failed to write {}", tempPath);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    if (error)
+    {
+        spdlog::error("Failed to move {} into place: {}", path, error.message());
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+    return true;
+}
+
+std::string DdsFile::getCookedPath(const std::string& sourcePath)
+{
+    return sourcePath + ".dds";
+}
+
+bool DdsFile::isCookedUpToDate(const std::string& cookedPath, const std::string& sourcePath)
+{
+    std::error_code error;
+    const auto cookedTime = std::filesystem::last_write_time(cookedPath, error);
+    if (error)
+    {
+        return false;
+    }
+
+    const auto sourceTime = std::filesystem::last_write_time(sourcePath, error);
+    return error || cookedTime >= sourceTime;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//
+// Minimal reader/writer for DDS containers with the DX10 extension header.
+// Only 2D textures with a single array layer are supported, which is all the texture cooker writes.
+// Legacy DXT1/DXT5/ATI2 FourCCs are accepted on read and mapped to their DXGI formats.
+//
+class DdsFile
+{
+public:
+    // Subset of DXGI_FORMAT values we read and write
+    enum DxgiFormat : uint32_t
+    {
+        DXGI_FORMAT_UNKNOWN = 0,
+        DXGI_FORMAT_R8G8B8A8_UNORM = 28,
+        DXGI_FORMAT_R8G8B8A8_UNORM_SRGB = 29,
+        DXGI_FORMAT_BC1_UNORM = 71,
+        DXGI_FORMAT_BC1_UNORM_SRGB = 72,
+        DXGI_FORMAT_BC3_UNORM = 77,
+        DXGI_FORMAT_BC3_UNORM_SRGB = 78,
+        DXGI_FORMAT_BC5_UNORM = 83,
+        DXGI_FORMAT_BC7_UNORM = 98,
+        DXGI_FORMAT_BC7_UNORM_SRGB = 99
+    };
+
+    struct Description
+    {
+        uint32_t dxgiFormat = DXGI_FORMAT_UNKNOWN;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        // Byte offset of each mip level inside the payload, relative to pPayload
+        std::vector<uint64_t> mipOffsets;
+        const unsigned char* pPayload = nullptr;
+        size_t payloadSize = 0;
+    };
+
+    // Parses a file already in memory; pPayload points into pData, so keep it alive
+    static bool read(const unsigned char* pData, size_t size, Description& outDescription);
+
+    // mipLevels[i] holds the encoded bytes of level i
+    static bool write(const std::string& path, uint32_t dxgiFormat, uint32_t width, uint32_t height,
+        const std::vector<std::vector<unsigned char>>& mipLevels);
+
+    // Bytes needed for one level; block formats round up to whole 4x4 blocks
+    static size_t getLevelSize(uint32_t dxgiFormat, uint32_t width, uint32_t height);
+
+    // Where the cooker writes a source image: next to it with .dds appended, so a.png and a.jpg stay apart
+    static std::string getCookedPath(const std::string& sourcePath);
+    // True if the cooked file exists and is not older than its source; a missing source counts as unchanged
+    static bool isCookedUpToDate(const std::string& cookedPath, const std::string& sourcePath);
+};
@@ -0,0 +1,211 @@
+// Benchmark for the importer's vertex deduplication on Sponza: the unordered_map path Model::processMesh
+// used before VertexDeduplicator against VertexDeduplicator, over the same mesh instances.
+// Both run single-threaded with one table per mesh instance, as the importer does, and must produce
+// identical vertex and index buffers.
+
+#include "Model.h"
+#include "VertexDeduplicator.h"
+#include "Benchmark.h"
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+    struct MeshInstance
+    {
+        const aiMesh* pMesh;
+        glm::mat4 transform;
+    };
+
+    struct DedupOutput
+    {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        // Where each instance's region starts in vertices; indices are local to it
+        std::vector<uint32_t> vertexOffsets;
+    };
+
+    void collectMeshInstances(const aiNode* node, const aiScene* scene, const glm::mat4& parentTransform, std::vector<MeshInstance>& instances)
+    {
+        // The same conversion as Model::collectMeshInstances
+        aiMatrix4x4 nodeTransformation = node->mTransformation;
+        const glm::mat4 nodeTransform = glm::transpose(glm::make_mat4(&nodeTransformation.a1));
+        const glm::mat4 currentTransform = parentTransform * nodeTransform;
+
+        for (unsigned int i = 0; i < node->mNumMeshes; i++)
+        {
+            instances.push_back({ scene->mMeshes[node->mMeshes[i]], currentTransform });
+        }
+        for (unsigned int i = 0; i < node->mNumChildren; i++)
+        {
+            collectMeshInstances(node->mChildren[i], scene, currentTransform, instances);
+        }
+    }
+
+    // The old path: every vertex is built and hashed once per vertex and again per face corner,
+    // with count() followed by operator[] for each
+    void dedupWithUnorderedMap(const std::vector<MeshInstance>& instances, DedupOutput& output)
+    {
+        for (const MeshInstance& instance : instances)
+        {
+            const aiMesh& mesh = *instance.pMesh;
+            const uint32_t vertexOffset = static_cast<uint32_t>(output.vertices.size());
+            output.vertexOffsets.push_back(vertexOffset);
+
+            std::unordered_map<Vertex, uint32_t> uniqueVertices;
+            for (unsigned int i = 0; i < mesh.mNumVertices; i++)
+            {
+                const Vertex vertex = readAssimpVertex(mesh, i, instance.transform);
+                if (uniqueVertices.count(vertex) == 0)
+                {
+                    uniqueVertices[vertex] = static_cast<uint32_t>(output.vertices.size()) - vertexOffset;
+                    output.vertices.push_back(vertex);
+                }
+            }
+
+            for (unsigned int i = 0; i < mesh.mNumFaces; i++)
+            {
+                const aiFace& face = mesh.mFaces[i];
+                for (unsigned int j = 0; j < face.mNumIndices; j++)
+                {
+                    const Vertex vertex = readAssimpVertex(mesh, face.mIndices[j], instance.transform);
+                    uint32_t index;
+                    if (uniqueVertices.count(vertex) == 0)
+                    {
+                        index = static_cast<uint32_t>(output.vertices.size()) - vertexOffset;
+                        uniqueVertices[vertex] = index;
+                        output.vertices.push_back(vertex);
+                    }
+                    else
+                    {
+                        index = uniqueVertices[vertex];
+                    }
+                    output.indices.push_back(index);
+                }
+            }
+        }
+    }
+
+    // The importer's path: one pass over the vertices, faces resolved through the remap
+    void dedupWithDeduplicator(const std::vector<MeshInstance>& instances, DedupOutput& output)
+    {
+        std::vector<uint32_t> remap;
+        for (const MeshInstance& instance : instances)
+        {
+            const aiMesh& mesh = *instance.pMesh;
+            const uint32_t vertexOffset = static_cast<uint32_t>(output.vertices.size());
+            output.vertexOffsets.push_back(vertexOffset);
+
+            VertexDeduplicator deduplicator(mesh.mNumVertices);
+            remap.resize(mesh.mNumVertices);
+            for (unsigned int i = 0; i < mesh.mNumVertices; i++)
+            {
+                remap[i] = deduplicator.insert(readAssimpVertex(mesh, i, instance.transform), output.vertices) - vertexOffset;
+            }
+
+            for (unsigned int i = 0; i < mesh.mNumFaces; i++)
+            {
+                const aiFace& face = mesh.mFaces[i];
+                for (unsigned int j = 0; j < face.mNumIndices; j++)
+                {
+                    output.indices.push_back(remap[face.mIndices[j]]);
+                }
+            }
+        }
+    }
+
+    void report(const std::string& name, const BenchmarkResult& result, size_t vertexCount)
+    {
+        spdlog::info("{:<28} {:>12.2f} ms {:>10} {:>10.2f} M vertices/s", name, result.secondsPerIteration * 1e3,
+            result.iterations, double(vertexCount) / result.secondsPerIteration / 1e6);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // The renderer's model, relative to the build directory the models are copied into
+    const std::string modelPath = argc > 1 ? argv[1] : "models/glTF/Sponza.gltf";
+
+    // The same post-processing as Model::loadFromAssimp, so the meshes match what the importer sees
+    auto importStart = std::chrono::high_resolution_clock::now();
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(modelPath, aiProcess_Triangulate |
+        aiProcess_CalcTangentSpace |
+        aiProcess_GenSmoothNormals |
+        aiProcess_FlipUVs |
+        aiProcess_JoinIdenticalVertices |
+        aiProcess_LimitBoneWeights |
+        aiProcess_OptimizeMeshes |
+        aiProcess_SortByPType);
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+    {
+        spdlog::error("Failed to load {}: {}", modelPath, importer.GetErrorString());
+        return 1;
+    }
+    const double importSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - importStart).count();
+
+    std::vector<MeshInstance> instances;
+    collectMeshInstances(scene->mRootNode, scene, glm::mat4(1.0f), instances);
+
+    size_t sourceVertexCount = 0;
+    size_t cornerCount = 0;
+    for (const MeshInstance& instance : instances)
+    {
+        sourceVertexCount += instance.pMesh->mNumVertices;
+        for (unsigned int i = 0; i < instance.pMesh->mNumFaces; i++)
+        {
+            cornerCount += instance.pMesh->mFaces[i].mNumIndices;
+        }
+    }
+
+    spdlog::info("{}: Assimp import in {:.1f} ms, {} mesh instances, {} vertices, {} face corners",
+        modelPath, importSeconds * 1e3, instances.size(), sourceVertexCount, cornerCount);
+    spdlog::info("{:<28} {:>15} {:>10} {:>21}", "Benchmark", "Time", "Iterations", "Throughput");
+
+    DedupOutput mapOutput;
+    const BenchmarkResult mapResult = runBenchmark([&]()
+    {
+        mapOutput = {};
+        dedupWithUnorderedMap(instances, mapOutput);
+    });
+    report("BM_DedupUnorderedMap", mapResult, sourceVertexCount);
+
+    DedupOutput deduplicatorOutput;
+    const BenchmarkResult deduplicatorResult = runBenchmark([&]()
+    {
+        deduplicatorOutput = {};
+        dedupWithDeduplicator(instances, deduplicatorOutput);
+    });
+    report("BM_DedupVertexDeduplicator", deduplicatorResult, sourceVertexCount);
+
+    spdlog::info("Load time (import + dedup): {:.1f} ms before, {:.1f} ms after; {} vertices -> {} unique (dedup ratio {:.3f} before, {:.3f} after)",
+        (importSeconds + mapResult.secondsPerIteration) * 1e3, (importSeconds + deduplicatorResult.secondsPerIteration) * 1e3,
+        sourceVertexCount, deduplicatorOutput.vertices.size(),
+        double(sourceVertexCount) / double(mapOutput.vertices.size()),
+        double(sourceVertexCount) / double(deduplicatorOutput.vertices.size()));
+
+    // The quantized keys may only merge what exact comparison merges on this data, so the buffers must match
+    int failures = 0;
+    if (mapOutput.vertexOffsets != deduplicatorOutput.vertexOffsets || mapOutput.vertices.size() != deduplicatorOutput.vertices.size())
+    {
+        spdlog::error("Vertex counts differ: {} with the unordered_map, {} with VertexDeduplicator",
+            mapOutput.vertices.size(), deduplicatorOutput.vertices.size());
+        failures++;
+    }
+    else if (memcmp(mapOutput.vertices.data(), deduplicatorOutput.vertices.data(), mapOutput.vertices.size() * sizeof(Vertex)) != 0)
+    {
+        spdlog::error("Vertex buffers differ");
+        failures++;
+    }
+    if (mapOutput.indices != deduplicatorOutput.indices)
+    {
+        spdlog::error("Index buffers differ");
+        failures++;
+    }
+
+    return failures == 0 ? 0 : 1;
+}
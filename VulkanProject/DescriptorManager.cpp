@@ -4,13 +4,19 @@
 #include <stdexcept>
 #include <spdlog/spdlog.h>
 
-DescriptorManager::DescriptorManager(VkDevice device, size_t maxFramesInFlight, size_t materialCount)
-    : m_Device(device), m_MaxFramesInFlight(maxFramesInFlight), m_MaterialCount(materialCount)
+DescriptorManager::DescriptorManager(VkDevice device, size_t maxFramesInFlight, size_t textureCount)
+    : m_Device(device), m_MaxFramesInFlight(maxFramesInFlight), m_TextureCount(textureCount)
 {
     //createDescriptorSetLayout();
     //createDescriptorPool();
 	m_FinalPassDescriptorSets.resize(maxFramesInFlight); // Initialize the final pass descriptor sets
 	m_ComputeDescriptorSets.resize(maxFramesInFlight); // Initialize the compute descriptor sets
+    m_DepthPyramidDescriptorSets.resize(maxFramesInFlight);
+    m_CullDescriptorSets.resize(maxFramesInFlight);
+    m_OcclusionDescriptorSets.resize(maxFramesInFlight);
+    m_MeshletCullDescriptorSets.resize(maxFramesInFlight);
+    m_LightCullDescriptorSets.resize(maxFramesInFlight);
+    m_LightAnimateDescriptorSets.resize(maxFramesInFlight);
     spdlog::debug("DescriptorManager created.");
 }
 
@@ -32,6 +38,30 @@ DescriptorManager::~DescriptorManager()
     {
         vkDestroyDescriptorSetLayout(m_Device, m_ComputeDescriptorSetLayout, nullptr);
     }
+    if (m_DepthPyramidDescriptorSetLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorSetLayout(m_Device, m_DepthPyramidDescriptorSetLayout, nullptr);
+    }
+    if (m_CullDescriptorSetLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorSetLayout(m_Device, m_CullDescriptorSetLayout, nullptr);
+    }
+    if (m_OcclusionDescriptorSetLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorSetLayout(m_Device, m_OcclusionDescriptorSetLayout, nullptr);
+    }
+    if (m_MeshletCullDescriptorSetLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorSetLayout(m_Device, m_MeshletCullDescriptorSetLayout, nullptr);
+    }
+    if (m_LightCullDescriptorSetLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorSetLayout(m_Device, m_LightCullDescriptorSetLayout, nullptr);
+    }
+    if (m_LightAnimateDescriptorSetLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorSetLayout(m_Device, m_LightAnimateDescriptorSetLayout, nullptr);
+    }
     spdlog::debug("DescriptorManager destroyed.");
 }
 
@@ -45,40 +75,31 @@ void DescriptorManager::createDescriptorSetLayout()
     // Binding for Uniform Buffer Object
     VkDescriptorSetLayoutBinding uboLayoutBinding{};
     uboLayoutBinding.binding = 0; // Binding 0 for the UBO
-    uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     uboLayoutBinding.descriptorCount = 1;
     uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT; // Allow usage in both shaders
     uboLayoutBinding.pImmutableSamplers = nullptr;
 
-    // Binding for Combined Image Sampler (Diffuse Texture)
-    VkDescriptorSetLayoutBinding diffuseSamplerBinding{};
-    diffuseSamplerBinding.binding = 1;
-    diffuseSamplerBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    diffuseSamplerBinding.descriptorCount = 1;
-    diffuseSamplerBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-    diffuseSamplerBinding.pImmutableSamplers = nullptr;
-
-    // Binding for Combined Image Sampler (normal Texture)
-    VkDescriptorSetLayoutBinding normalSamplerBinding{};
-    normalSamplerBinding.binding = 2;
-    normalSamplerBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    normalSamplerBinding.descriptorCount = 1;
-    normalSamplerBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-    normalSamplerBinding.pImmutableSamplers = nullptr;
-
-    // Binding for Combined Image Sampler (metallic roughness Texture)
-    VkDescriptorSetLayoutBinding metallicRoughnessSamplerBinding{};
-    metallicRoughnessSamplerBinding.binding = 3;
-    metallicRoughnessSamplerBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    metallicRoughnessSamplerBinding.descriptorCount = 1;
-    metallicRoughnessSamplerBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-    metallicRoughnessSamplerBinding.pImmutableSamplers = nullptr;
-
-    std::array<VkDescriptorSetLayoutBinding, 4> bindings = {
+    // Binding for the material storage buffer, indexed by the material index of the draw
+    VkDescriptorSetLayoutBinding materialBufferBinding{};
+    materialBufferBinding.binding = 1;
+    materialBufferBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    materialBufferBinding.descriptorCount = 1;
+    materialBufferBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    materialBufferBinding.pImmutableSamplers = nullptr;
+
+    // Binding for the bindless texture array, indexed through the material buffer
+    VkDescriptorSetLayoutBinding textureArrayBinding{};
+    textureArrayBinding.binding = 2;
+    textureArrayBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    textureArrayBinding.descriptorCount = static_cast<uint32_t>(m_TextureCount);
+    textureArrayBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    textureArrayBinding.pImmutableSamplers = nullptr;
+
+    std::array<VkDescriptorSetLayoutBinding, 3> bindings = {
         uboLayoutBinding,
-        diffuseSamplerBinding,
-        normalSamplerBinding,
-        metallicRoughnessSamplerBinding
+        materialBufferBinding,
+        textureArrayBinding
     };
 
     VkDescriptorSetLayoutCreateInfo layoutInfo{};
@@ -96,21 +117,22 @@ void DescriptorManager::createDescriptorSetLayout()
 void DescriptorManager::createDescriptorPool()
 {
     std::vector<VkDescriptorPoolSize> poolSizes = {
-        // Total uniform buffers (main pass + final pass)
-        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-          static_cast<uint32_t>(m_MaxFramesInFlight * (m_MaterialCount + 1)) },
+        // Total uniform buffers, all offsets into the uniform ring (main pass + final pass + light culling)
+        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+          static_cast<uint32_t>(m_MaxFramesInFlight * 4) },
 
-          // Total combined image samplers (main pass + final pass)
+          // Total combined image samplers (main pass + final pass + depth pyramid levels + occlusion, meshlet and light culling passes)
           { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-            static_cast<uint32_t>(m_MaxFramesInFlight * (m_MaterialCount * 3 + 4)) },
+            static_cast<uint32_t>(m_MaxFramesInFlight * (m_TextureCount + 7 + MAX_DEPTH_PYRAMID_LEVELS + 3)) },
 
-            // Total storage buffers (ubo, light buffer, sun matrix)
+            // Total storage buffers (material buffer, light buffer, light clusters, submesh, occlusion, meshlet,
+            // light culling and light animation pass inputs and outputs)
             { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-              static_cast<uint32_t>(3) },
+              static_cast<uint32_t>(m_MaxFramesInFlight * 21) },
 
-              // Total storage images (compute descriptors)
+              // Total storage images (tone mapping input and output, depth pyramid levels)
               { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-                static_cast<uint32_t>(m_MaxFramesInFlight * 2) }, // Input and output images per frame
+                static_cast<uint32_t>(m_MaxFramesInFlight * (2 + MAX_DEPTH_PYRAMID_LEVELS)) },
 
     };
 
@@ -121,9 +143,15 @@ void DescriptorManager::createDescriptorPool()
 
     // Corrected maxSets calculation
     poolInfo.maxSets = static_cast<uint32_t>(
-        m_MaxFramesInFlight * (m_MaterialCount + 1) + // Main pass descriptor sets
+        m_MaxFramesInFlight +                        // Main pass descriptor sets
         m_MaxFramesInFlight +                        // Final pass descriptor sets
-        m_MaxFramesInFlight                          // Compute descriptor sets
+        m_MaxFramesInFlight +                        // Compute descriptor sets
+        m_MaxFramesInFlight * MAX_DEPTH_PYRAMID_LEVELS + // Depth pyramid descriptor sets
+        m_MaxFramesInFlight +                        // Submesh culling descriptor sets
+        m_MaxFramesInFlight +                        // Occlusion descriptor sets
+        m_MaxFramesInFlight +                        // Meshlet culling descriptor sets
+        m_MaxFramesInFlight +                        // Light culling descriptor sets
+        m_MaxFramesInFlight                          // Light animation descriptor sets
         );
 
     if (vkCreateDescriptorPool(m_Device, &poolInfo, nullptr, &m_DescriptorPool) != VK_SUCCESS)
@@ -133,18 +161,20 @@ void DescriptorManager::createDescriptorPool()
 }
 
 void DescriptorManager::createDescriptorSets(
-    const std::vector<VkBuffer>& uniformBuffers,
-    const std::vector<Material*>& materials,
-    size_t uniformBufferObjectSize)
+    VkBuffer uniformBuffer,
+    size_t uniformBufferObjectSize,
+    VkBuffer materialBuffer,
+    VkDeviceSize materialBufferSize,
+    const std::vector<Texture*>& textures)
 {
-    if (materials.size() != m_MaterialCount)
+    if (textures.size() != m_TextureCount)
     {
-        throw std::runtime_error("Material count does not match the expected number.");
+        throw std::runtime_error("Texture count does not match the expected number.");
     }
 
-    m_DescriptorSets.resize(m_MaxFramesInFlight * m_MaterialCount);
+    m_DescriptorSets.resize(m_MaxFramesInFlight);
 
-    std::vector<VkDescriptorSetLayout> layouts(m_MaxFramesInFlight * m_MaterialCount, m_DescriptorSetLayout);
+    std::vector<VkDescriptorSetLayout> layouts(m_MaxFramesInFlight, m_DescriptorSetLayout);
     VkDescriptorSetAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocInfo.descriptorPool = m_DescriptorPool;
@@ -158,81 +188,72 @@ void DescriptorManager::createDescriptorSets(
 
     for (size_t frame = 0; frame < m_MaxFramesInFlight; frame++)
     {
-        for (size_t matIndex = 0; matIndex < m_MaterialCount; ++matIndex)
-        {
-            size_t descriptorSetIndex = frame * m_MaterialCount + matIndex;
-
-            VkDescriptorBufferInfo bufferInfo{};
-            bufferInfo.buffer = uniformBuffers[frame];
-            bufferInfo.offset = 0;
-            bufferInfo.range = uniformBufferObjectSize;
-
-            // Collect image infos from the material's textures
-            VkDescriptorImageInfo diffuseImageInfo{};
-            diffuseImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            diffuseImageInfo.imageView = materials[matIndex]->pDiffuseTexture->getTextureImageView();
-            diffuseImageInfo.sampler = Texture::getTextureSampler();
-
-            VkDescriptorImageInfo normalImageInfo{};
-            normalImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            normalImageInfo.imageView = materials[matIndex]->pNormalTexture->getTextureImageView();
-            normalImageInfo.sampler = Texture::getTextureSampler();
-
-            VkDescriptorImageInfo metallicRoughnessImageInfo{};
-            metallicRoughnessImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            metallicRoughnessImageInfo.imageView = materials[matIndex]->pMetallicRoughnessTexture->getTextureImageView();
-            metallicRoughnessImageInfo.sampler = Texture::getTextureSampler();
-
-            std::array<VkWriteDescriptorSet, 4> descriptorWrites{};
-
-            // Uniform Buffer
-            descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptorWrites[0].dstSet = m_DescriptorSets[descriptorSetIndex];
-            descriptorWrites[0].dstBinding = 0;
-            descriptorWrites[0].dstArrayElement = 0;
-            descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            descriptorWrites[0].descriptorCount = 1;
-            descriptorWrites[0].pBufferInfo = &bufferInfo;
-
-            // Diffuse Texture
-            descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptorWrites[1].dstSet = m_DescriptorSets[descriptorSetIndex];
-            descriptorWrites[1].dstBinding = 1;
-            descriptorWrites[1].dstArrayElement = 0;
-            descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            descriptorWrites[1].descriptorCount = 1;
-            descriptorWrites[1].pImageInfo = &diffuseImageInfo;
-
-            // Normal Texture
-            descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptorWrites[2].dstSet = m_DescriptorSets[descriptorSetIndex];
-            descriptorWrites[2].dstBinding = 2;
-            descriptorWrites[2].dstArrayElement = 0;
-            descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            descriptorWrites[2].descriptorCount = 1;
-            descriptorWrites[2].pImageInfo = &normalImageInfo;
-
-            // Metallic Roughness Texture
-            descriptorWrites[3].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptorWrites[3].dstSet = m_DescriptorSets[descriptorSetIndex];
-            descriptorWrites[3].dstBinding = 3;
-            descriptorWrites[3].dstArrayElement = 0;
-            descriptorWrites[3].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            descriptorWrites[3].descriptorCount = 1;
-            descriptorWrites[3].pImageInfo = &metallicRoughnessImageInfo;
-
-            vkUpdateDescriptorSets(
-                m_Device,
-                static_cast<uint32_t>(descriptorWrites.size()),
-                descriptorWrites.data(),
-                0,
-                nullptr
-            );
-            spdlog::debug("Descriptor set updated for frame {}, material {}", frame, matIndex);
-        }
+        VkDescriptorBufferInfo bufferInfo{};
+        bufferInfo.buffer = uniformBuffer;
+        bufferInfo.offset = 0;
+        bufferInfo.range = uniformBufferObjectSize;
+
+        VkDescriptorBufferInfo materialBufferInfo{};
+        materialBufferInfo.buffer = materialBuffer;
+        materialBufferInfo.offset = 0;
+        materialBufferInfo.range = materialBufferSize;
+
+        std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+
+        // Uniform Buffer
+        descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[0].dstSet = m_DescriptorSets[frame];
+        descriptorWrites[0].dstBinding = 0;
+        descriptorWrites[0].dstArrayElement = 0;
+        descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        descriptorWrites[0].descriptorCount = 1;
+        descriptorWrites[0].pBufferInfo = &bufferInfo;
+
+        // Material Buffer
+        descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[1].dstSet = m_DescriptorSets[frame];
+        descriptorWrites[1].dstBinding = 1;
+        descriptorWrites[1].dstArrayElement = 0;
+        descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrites[1].descriptorCount = 1;
+        descriptorWrites[1].pBufferInfo = &materialBufferInfo;
+
+        vkUpdateDescriptorSets(
+            m_Device,
+            static_cast<uint32_t>(descriptorWrites.size()),
+            descriptorWrites.data(),
+            0,
+            nullptr
+        );
+
+        updateTextureDescriptors(frame, textures);
+        spdlog::debug("Descriptor sets updated for frame {}", frame);
     }
 }
 
+void DescriptorManager::updateTextureDescriptors(size_t frameIndex, const std::vector<Texture*>& textures)
+{
+    // Textures that are still streaming in resolve to the placeholder view
+    std::vector<VkDescriptorImageInfo> imageInfos(m_TextureCount);
+    for (size_t textureIndex = 0; textureIndex < m_TextureCount; ++textureIndex)
+    {
+        imageInfos[textureIndex].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageInfos[textureIndex].imageView = textures[textureIndex]->getTextureImageView();
+        imageInfos[textureIndex].sampler = Texture::getTextureSampler();
+    }
+
+    VkWriteDescriptorSet descriptorWrite{};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = m_DescriptorSets[frameIndex];
+    descriptorWrite.dstBinding = 2;
+    descriptorWrite.dstArrayElement = 0;
+    descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descriptorWrite.descriptorCount = static_cast<uint32_t>(imageInfos.size());
+    descriptorWrite.pImageInfo = imageInfos.data();
+
+    vkUpdateDescriptorSets(m_Device, 1, &descriptorWrite, 0, nullptr);
+}
+
 
 VkDescriptorSetLayout DescriptorManager::getDescriptorSetLayout() const
 {
@@ -281,7 +302,7 @@ void DescriptorManager::createFinalPassDescriptorSetLayout()
 	// Binding for uniform buffer (binding = 4)
     VkDescriptorSetLayoutBinding uboLayoutBinding{};
     uboLayoutBinding.binding = 4;
-    uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     uboLayoutBinding.descriptorCount = 1;
     uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT; // Allow usage in both shaders
     uboLayoutBinding.pImmutableSamplers = nullptr;
@@ -321,12 +342,20 @@ void DescriptorManager::createFinalPassDescriptorSetLayout()
 	//Binding for sun matrix buffer (binding = 9)
 	VkDescriptorSetLayoutBinding sunMatrixBufferBinding{};
 	sunMatrixBufferBinding.binding = 9;
-	sunMatrixBufferBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	sunMatrixBufferBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 	sunMatrixBufferBinding.descriptorCount = 1;
 	sunMatrixBufferBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 	sunMatrixBufferBinding.pImmutableSamplers = nullptr;
 
-    std::array<VkDescriptorSetLayoutBinding, 10> bindings = { 
+    // Binding for the per-cluster light lists (binding = 10)
+    VkDescriptorSetLayoutBinding lightClusterBufferBinding{};
+    lightClusterBufferBinding.binding = 10;
+    lightClusterBufferBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    lightClusterBufferBinding.descriptorCount = 1;
+    lightClusterBufferBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    lightClusterBufferBinding.pImmutableSamplers = nullptr;
+
+    std::array<VkDescriptorSetLayoutBinding, 11> bindings = { 
         diffuseBinding,
         normalBinding,
         metallicRoughnessBinding,
@@ -336,7 +365,8 @@ void DescriptorManager::createFinalPassDescriptorSetLayout()
         skyboxBinding,
 		irradianceBinding,
 		shadowMapBinding,
-		sunMatrixBufferBinding
+		sunMatrixBufferBinding,
+        lightClusterBufferBinding
     };
 
     VkDescriptorSetLayoutCreateInfo layoutInfo{};
@@ -370,6 +400,8 @@ void DescriptorManager::createFinalPassDescriptorSet(
 	VkImageView shadowMapImageView,
 	VkImageView skyboxImageView,
 	VkImageView irradianceImageView,
+    VkBuffer lightClusterBuffer,
+    VkDeviceSize lightClusterBufferSize,
     VkSampler sampler)
 {
     // Allocate the descriptor set
@@ -435,7 +467,12 @@ void DescriptorManager::createFinalPassDescriptorSet(
 	sunMatrixBufferInfo.offset = 0;
 	sunMatrixBufferInfo.range = sunMatrixBufferObjectSize;
 
-    std::array<VkWriteDescriptorSet, 10> descriptorWrites{};
+    VkDescriptorBufferInfo lightClusterBufferInfo{};
+    lightClusterBufferInfo.buffer = lightClusterBuffer;
+    lightClusterBufferInfo.offset = 0;
+    lightClusterBufferInfo.range = lightClusterBufferSize;
+
+    std::array<VkWriteDescriptorSet, 11> descriptorWrites{};
 
     descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     descriptorWrites[0].dstSet = m_FinalPassDescriptorSets[frameIndex];
@@ -468,7 +505,7 @@ void DescriptorManager::createFinalPassDescriptorSet(
 	descriptorWrites[4].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
 	descriptorWrites[4].dstSet = m_FinalPassDescriptorSets[frameIndex];
 	descriptorWrites[4].dstBinding = 4;
-	descriptorWrites[4].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descriptorWrites[4].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 	descriptorWrites[4].descriptorCount = 1;
 	descriptorWrites[4].pBufferInfo = &bufferInfo;
 
@@ -503,10 +540,17 @@ void DescriptorManager::createFinalPassDescriptorSet(
 	descriptorWrites[9].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
 	descriptorWrites[9].dstSet = m_FinalPassDescriptorSets[frameIndex];
 	descriptorWrites[9].dstBinding = 9;
-	descriptorWrites[9].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descriptorWrites[9].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 	descriptorWrites[9].descriptorCount = 1;
 	descriptorWrites[9].pBufferInfo = &sunMatrixBufferInfo;
 
+    descriptorWrites[10].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrites[10].dstSet = m_FinalPassDescriptorSets[frameIndex];
+    descriptorWrites[10].dstBinding = 10;
+    descriptorWrites[10].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrites[10].descriptorCount = 1;
+    descriptorWrites[10].pBufferInfo = &lightClusterBufferInfo;
+
     vkUpdateDescriptorSets(m_Device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
 }
 
@@ -530,6 +574,8 @@ void DescriptorManager::updateFinalPassDescriptorSet(
 	VkImageView shadowMapImageView,
 	VkImageView skyboxImageView,
 	VkImageView irradianceImageView,
+    VkBuffer lightClusterBuffer,
+    VkDeviceSize lightClusterBufferSize,
     VkSampler sampler)
 {
     // Update the descriptor set with the new G-Buffer images
@@ -583,7 +629,12 @@ void DescriptorManager::updateFinalPassDescriptorSet(
 	sunMatrixBufferInfo.offset = 0;
 	sunMatrixBufferInfo.range = sunMatrixBufferObjectSize;
 
-    std::array<VkWriteDescriptorSet, 10> descriptorWrites{};
+    VkDescriptorBufferInfo lightClusterBufferInfo{};
+    lightClusterBufferInfo.buffer = lightClusterBuffer;
+    lightClusterBufferInfo.offset = 0;
+    lightClusterBufferInfo.range = lightClusterBufferSize;
+
+    std::array<VkWriteDescriptorSet, 11> descriptorWrites{};
 
     descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     descriptorWrites[0].dstSet = m_FinalPassDescriptorSets[frameIndex];
@@ -616,7 +667,7 @@ void DescriptorManager::updateFinalPassDescriptorSet(
 	descriptorWrites[4].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
 	descriptorWrites[4].dstSet = m_FinalPassDescriptorSets[frameIndex];
 	descriptorWrites[4].dstBinding = 4;
-	descriptorWrites[4].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descriptorWrites[4].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 	descriptorWrites[4].descriptorCount = 1;
 	descriptorWrites[4].pBufferInfo = &bufferInfo;
 
@@ -651,10 +702,17 @@ void DescriptorManager::updateFinalPassDescriptorSet(
 	descriptorWrites[9].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
 	descriptorWrites[9].dstSet = m_FinalPassDescriptorSets[frameIndex];
 	descriptorWrites[9].dstBinding = 9;
-	descriptorWrites[9].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descriptorWrites[9].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 	descriptorWrites[9].descriptorCount = 1;
 	descriptorWrites[9].pBufferInfo = &sunMatrixBufferInfo;
 
+    descriptorWrites[10].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrites[10].dstSet = m_FinalPassDescriptorSets[frameIndex];
+    descriptorWrites[10].dstBinding = 10;
+    descriptorWrites[10].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrites[10].descriptorCount = 1;
+    descriptorWrites[10].pBufferInfo = &lightClusterBufferInfo;
+
     vkUpdateDescriptorSets(m_Device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
 }
 
@@ -787,3 +845,796 @@ const std::vector<VkDescriptorSet>& DescriptorManager::getComputeDescriptorSets(
 {
 	return m_ComputeDescriptorSets;
 }
+
+void DescriptorManager::createDepthPyramidDescriptorSetLayout()
+{
+    // Binding for the level being reduced (binding = 0)
+    VkDescriptorSetLayoutBinding sourceBinding{};
+    sourceBinding.binding = 0;
+    sourceBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    sourceBinding.descriptorCount = 1;
+    sourceBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    sourceBinding.pImmutableSamplers = nullptr;
+
+    // Binding for the level being written (binding = 1)
+    VkDescriptorSetLayoutBinding destinationBinding{};
+    destinationBinding.binding = 1;
+    destinationBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    destinationBinding.descriptorCount = 1;
+    destinationBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    destinationBinding.pImmutableSamplers = nullptr;
+
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings = {
+        sourceBinding,
+        destinationBinding
+    };
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(m_Device, &layoutInfo, nullptr, &m_DepthPyramidDescriptorSetLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create depth pyramid descriptor set layout.");
+    }
+}
+
+VkDescriptorSetLayout DescriptorManager::getDepthPyramidDescriptorSetLayout() const
+{
+    return m_DepthPyramidDescriptorSetLayout;
+}
+
+void DescriptorManager::createDepthPyramidDescriptorSets(
+    size_t frameIndex,
+    const std::vector<VkImageView>& sourceImageViews,
+    const std::vector<VkImageView>& destinationImageViews,
+    VkSampler sampler)
+{
+    std::vector<VkDescriptorSetLayout> layouts(MAX_DEPTH_PYRAMID_LEVELS, m_DepthPyramidDescriptorSetLayout);
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_DescriptorPool;
+    allocInfo.descriptorSetCount = MAX_DEPTH_PYRAMID_LEVELS;
+    allocInfo.pSetLayouts = layouts.data();
+
+    m_DepthPyramidDescriptorSets[frameIndex].resize(MAX_DEPTH_PYRAMID_LEVELS);
+    if (vkAllocateDescriptorSets(m_Device, &allocInfo, m_DepthPyramidDescriptorSets[frameIndex].data()) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to allocate depth pyramid descriptor sets.");
+    }
+
+    updateDepthPyramidDescriptorSets(frameIndex, sourceImageViews, destinationImageViews, sampler);
+}
+
+void DescriptorManager::updateDepthPyramidDescriptorSets(
+    size_t frameIndex,
+    const std::vector<VkImageView>& sourceImageViews,
+    const std::vector<VkImageView>& destinationImageViews,
+    VkSampler sampler)
+{
+    if (destinationImageViews.size() > MAX_DEPTH_PYRAMID_LEVELS)
+    {
+        throw std::runtime_error("Depth pyramid has more levels than descriptor sets.");
+    }
+
+    std::vector<VkDescriptorImageInfo> imageInfos(destinationImageViews.size() * 2);
+    std::vector<VkWriteDescriptorSet> descriptorWrites(destinationImageViews.size() * 2);
+
+    for (size_t level = 0; level < destinationImageViews.size(); ++level)
+    {
+        // The depth buffer and every pyramid level stay readable in these layouts while the pyramid is built
+        VkDescriptorImageInfo& sourceInfo = imageInfos[level * 2];
+        sourceInfo.sampler = sampler;
+        sourceInfo.imageView = sourceImageViews[level];
+        sourceInfo.imageLayout = level == 0 ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+
+        VkDescriptorImageInfo& destinationInfo = imageInfos[level * 2 + 1];
+        destinationInfo.imageView = destinationImageViews[level];
+        destinationInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        VkWriteDescriptorSet& sourceWrite = descriptorWrites[level * 2];
+        sourceWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        sourceWrite.dstSet = m_DepthPyramidDescriptorSets[frameIndex][level];
+        sourceWrite.dstBinding = 0;
+        sourceWrite.dstArrayElement = 0;
+        sourceWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        sourceWrite.descriptorCount = 1;
+        sourceWrite.pImageInfo = &sourceInfo;
+
+        VkWriteDescriptorSet& destinationWrite = descriptorWrites[level * 2 + 1];
+        destinationWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        destinationWrite.dstSet = m_DepthPyramidDescriptorSets[frameIndex][level];
+        destinationWrite.dstBinding = 1;
+        destinationWrite.dstArrayElement = 0;
+        destinationWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        destinationWrite.descriptorCount = 1;
+        destinationWrite.pImageInfo = &destinationInfo;
+    }
+
+    vkUpdateDescriptorSets(
+        m_Device,
+        static_cast<uint32_t>(descriptorWrites.size()),
+        descriptorWrites.data(),
+        0,
+        nullptr);
+}
+
+const std::vector<std::vector<VkDescriptorSet>>& DescriptorManager::getDepthPyramidDescriptorSets() const
+{
+    return m_DepthPyramidDescriptorSets;
+}
+
+void DescriptorManager::createCullDescriptorSetLayout()
+{
+    std::array<VkDescriptorSetLayoutBinding, 5> bindings{};
+
+    // Submeshes (binding = 0), the visible draws (binding = 1) and their bounds (binding = 2),
+    // each submesh's level of detail (binding = 3) and the statistics counters (binding = 4)
+    for (uint32_t i = 0; i < bindings.size(); ++i)
+    {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[i].pImmutableSamplers = nullptr;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(m_Device, &layoutInfo, nullptr, &m_CullDescriptorSetLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create cull descriptor set layout.");
+    }
+}
+
+VkDescriptorSetLayout DescriptorManager::getCullDescriptorSetLayout() const
+{
+    return m_CullDescriptorSetLayout;
+}
+
+void DescriptorManager::createCullDescriptorSet(
+    size_t frameIndex,
+    VkBuffer submeshBuffer,
+    VkDeviceSize submeshBufferSize,
+    VkBuffer drawBuffer,
+    VkBuffer drawBoundsBuffer,
+    VkDeviceSize maxDrawCount,
+    VkBuffer lodBuffer,
+    VkDeviceSize lodBufferSize,
+    VkBuffer statisticsBuffer,
+    VkDeviceSize statisticsBufferSize)
+{
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_DescriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &m_CullDescriptorSetLayout;
+
+    if (vkAllocateDescriptorSets(m_Device, &allocInfo, &m_CullDescriptorSets[frameIndex]) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to allocate cull descriptor set.");
+    }
+
+    VkDescriptorBufferInfo submeshBufferInfo{};
+    submeshBufferInfo.buffer = submeshBuffer;
+    submeshBufferInfo.offset = 0;
+    submeshBufferInfo.range = submeshBufferSize;
+
+    VkDescriptorBufferInfo drawBufferInfo{};
+    drawBufferInfo.buffer = drawBuffer;
+    drawBufferInfo.offset = 0;
+    drawBufferInfo.range = sizeof(VkDrawIndexedIndirectCommand) * maxDrawCount;
+
+    // Bounds and meshlet range per draw
+    VkDescriptorBufferInfo drawBoundsBufferInfo{};
+    drawBoundsBufferInfo.buffer = drawBoundsBuffer;
+    drawBoundsBufferInfo.offset = 0;
+    drawBoundsBufferInfo.range = sizeof(float) * 8 * maxDrawCount;
+
+    VkDescriptorBufferInfo lodBufferInfo{};
+    lodBufferInfo.buffer = lodBuffer;
+    lodBufferInfo.offset = 0;
+    lodBufferInfo.range = lodBufferSize;
+
+    VkDescriptorBufferInfo statisticsBufferInfo{};
+    statisticsBufferInfo.buffer = statisticsBuffer;
+    statisticsBufferInfo.offset = 0;
+    statisticsBufferInfo.range = statisticsBufferSize;
+
+    std::array<VkDescriptorBufferInfo*, 5> bufferInfos = {
+        &submeshBufferInfo,
+        &drawBufferInfo,
+        &drawBoundsBufferInfo,
+        &lodBufferInfo,
+        &statisticsBufferInfo
+    };
+
+    std::array<VkWriteDescriptorSet, 5> descriptorWrites{};
+    for (uint32_t i = 0; i < bufferInfos.size(); ++i)
+    {
+        descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[i].dstSet = m_CullDescriptorSets[frameIndex];
+        descriptorWrites[i].dstBinding = i;
+        descriptorWrites[i].dstArrayElement = 0;
+        descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrites[i].descriptorCount = 1;
+        descriptorWrites[i].pBufferInfo = bufferInfos[i];
+    }
+
+    vkUpdateDescriptorSets(
+        m_Device,
+        static_cast<uint32_t>(descriptorWrites.size()),
+        descriptorWrites.data(),
+        0,
+        nullptr);
+}
+
+const std::vector<VkDescriptorSet>& DescriptorManager::getCullDescriptorSets() const
+{
+    return m_CullDescriptorSets;
+}
+
+void DescriptorManager::createOcclusionDescriptorSetLayout()
+{
+    std::array<VkDescriptorSetLayoutBinding, 5> bindings{};
+
+    // Frustum-culled draws (binding = 0), their bounds (binding = 1),
+    // the filtered draws (binding = 2) and the statistics counters (binding = 3)
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[i].pImmutableSamplers = nullptr;
+    }
+
+    // Binding for the whole depth pyramid (binding = 4)
+    bindings[4].binding = 4;
+    bindings[4].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[4].descriptorCount = 1;
+    bindings[4].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    bindings[4].pImmutableSamplers = nullptr;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(m_Device, &layoutInfo, nullptr, &m_OcclusionDescriptorSetLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create occlusion descriptor set layout.");
+    }
+}
+
+VkDescriptorSetLayout DescriptorManager::getOcclusionDescriptorSetLayout() const
+{
+    return m_OcclusionDescriptorSetLayout;
+}
+
+void DescriptorManager::createOcclusionDescriptorSet(
+    size_t frameIndex,
+    VkBuffer inputDrawBuffer,
+    VkBuffer drawBoundsBuffer,
+    VkBuffer outputDrawBuffer,
+    VkDeviceSize maxDrawCount,
+    VkBuffer statisticsBuffer,
+    VkDeviceSize statisticsBufferSize,
+    VkImageView depthPyramidImageView,
+    VkSampler sampler)
+{
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_DescriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &m_OcclusionDescriptorSetLayout;
+
+    if (vkAllocateDescriptorSets(m_Device, &allocInfo, &m_OcclusionDescriptorSets[frameIndex]) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to allocate occlusion descriptor set.");
+    }
+
+    updateOcclusionDescriptorSet(frameIndex, inputDrawBuffer, drawBoundsBuffer, outputDrawBuffer, maxDrawCount,
+        statisticsBuffer, statisticsBufferSize, depthPyramidImageView, sampler);
+}
+
+void DescriptorManager::updateOcclusionDescriptorSet(
+    size_t frameIndex,
+    VkBuffer inputDrawBuffer,
+    VkBuffer drawBoundsBuffer,
+    VkBuffer outputDrawBuffer,
+    VkDeviceSize maxDrawCount,
+    VkBuffer statisticsBuffer,
+    VkDeviceSize statisticsBufferSize,
+    VkImageView depthPyramidImageView,
+    VkSampler sampler)
+{
+    VkDescriptorBufferInfo inputDrawBufferInfo{};
+    inputDrawBufferInfo.buffer = inputDrawBuffer;
+    inputDrawBufferInfo.offset = 0;
+    inputDrawBufferInfo.range = sizeof(VkDrawIndexedIndirectCommand) * maxDrawCount;
+
+    // Bounds and meshlet range per draw
+    VkDescriptorBufferInfo drawBoundsBufferInfo{};
+    drawBoundsBufferInfo.buffer = drawBoundsBuffer;
+    drawBoundsBufferInfo.offset = 0;
+    drawBoundsBufferInfo.range = sizeof(float) * 8 * maxDrawCount;
+
+    VkDescriptorBufferInfo outputDrawBufferInfo{};
+    outputDrawBufferInfo.buffer = outputDrawBuffer;
+    outputDrawBufferInfo.offset = 0;
+    outputDrawBufferInfo.range = sizeof(VkDrawIndexedIndirectCommand) * maxDrawCount;
+
+    VkDescriptorBufferInfo statisticsBufferInfo{};
+    statisticsBufferInfo.buffer = statisticsBuffer;
+    statisticsBufferInfo.offset = 0;
+    statisticsBufferInfo.range = statisticsBufferSize;
+
+    VkDescriptorImageInfo depthPyramidInfo{};
+    depthPyramidInfo.sampler = sampler;
+    depthPyramidInfo.imageView = depthPyramidImageView;
+    depthPyramidInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+    std::array<VkDescriptorBufferInfo*, 4> bufferInfos = {
+        &inputDrawBufferInfo,
+        &drawBoundsBufferInfo,
+        &outputDrawBufferInfo,
+        &statisticsBufferInfo
+    };
+
+    std::array<VkWriteDescriptorSet, 5> descriptorWrites{};
+    for (uint32_t i = 0; i < bufferInfos.size(); ++i)
+    {
+        descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[i].dstSet = m_OcclusionDescriptorSets[frameIndex];
+        descriptorWrites[i].dstBinding = i;
+        descriptorWrites[i].dstArrayElement = 0;
+        descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrites[i].descriptorCount = 1;
+        descriptorWrites[i].pBufferInfo = bufferInfos[i];
+    }
+
+    descriptorWrites[4].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrites[4].dstSet = m_OcclusionDescriptorSets[frameIndex];
+    descriptorWrites[4].dstBinding = 4;
+    descriptorWrites[4].dstArrayElement = 0;
+    descriptorWrites[4].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descriptorWrites[4].descriptorCount = 1;
+    descriptorWrites[4].pImageInfo = &depthPyramidInfo;
+
+    vkUpdateDescriptorSets(
+        m_Device,
+        static_cast<uint32_t>(descriptorWrites.size()),
+        descriptorWrites.data(),
+        0,
+        nullptr);
+}
+
+const std::vector<VkDescriptorSet>& DescriptorManager::getOcclusionDescriptorSets() const
+{
+    return m_OcclusionDescriptorSets;
+}
+
+void DescriptorManager::createMeshletCullDescriptorSetLayout()
+{
+    std::array<VkDescriptorSetLayoutBinding, 6> bindings{};
+
+    // Occlusion-tested draws (binding = 0), their bounds and meshlet ranges (binding = 1), the meshlets (binding = 2),
+    // the meshlet draws (binding = 3) and the statistics counters (binding = 4)
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[i].pImmutableSamplers = nullptr;
+    }
+
+    // Binding for the whole depth pyramid (binding = 5)
+    bindings[5].binding = 5;
+    bindings[5].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[5].descriptorCount = 1;
+    bindings[5].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    bindings[5].pImmutableSamplers = nullptr;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(m_Device, &layoutInfo, nullptr, &m_MeshletCullDescriptorSetLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create meshlet culling descriptor set layout.");
+    }
+}
+
+VkDescriptorSetLayout DescriptorManager::getMeshletCullDescriptorSetLayout() const
+{
+    return m_MeshletCullDescriptorSetLayout;
+}
+
+void DescriptorManager::createMeshletCullDescriptorSet(
+    size_t frameIndex,
+    VkBuffer drawBuffer,
+    VkBuffer drawBoundsBuffer,
+    VkDeviceSize maxDrawCount,
+    VkBuffer meshletBuffer,
+    VkDeviceSize meshletBufferSize,
+    VkBuffer meshletDrawBuffer,
+    VkDeviceSize maxMeshletDrawCount,
+    VkBuffer statisticsBuffer,
+    VkDeviceSize statisticsBufferSize,
+    VkImageView depthPyramidImageView,
+    VkSampler sampler)
+{
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_DescriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &m_MeshletCullDescriptorSetLayout;
+
+    if (vkAllocateDescriptorSets(m_Device, &allocInfo, &m_MeshletCullDescriptorSets[frameIndex]) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to allocate meshlet culling descriptor set.");
+    }
+
+    updateMeshletCullDescriptorSet(frameIndex, drawBuffer, drawBoundsBuffer, maxDrawCount, meshletBuffer, meshletBufferSize,
+        meshletDrawBuffer, maxMeshletDrawCount, statisticsBuffer, statisticsBufferSize, depthPyramidImageView, sampler);
+}
+
+void DescriptorManager::updateMeshletCullDescriptorSet(
+    size_t frameIndex,
+    VkBuffer drawBuffer,
+    VkBuffer drawBoundsBuffer,
+    VkDeviceSize maxDrawCount,
+    VkBuffer meshletBuffer,
+    VkDeviceSize meshletBufferSize,
+    VkBuffer meshletDrawBuffer,
+    VkDeviceSize maxMeshletDrawCount,
+    VkBuffer statisticsBuffer,
+    VkDeviceSize statisticsBufferSize,
+    VkImageView depthPyramidImageView,
+    VkSampler sampler)
+{
+    VkDescriptorBufferInfo drawBufferInfo{};
+    drawBufferInfo.buffer = drawBuffer;
+    drawBufferInfo.offset = 0;
+    drawBufferInfo.range = sizeof(VkDrawIndexedIndirectCommand) * maxDrawCount;
+
+    // Bounds and meshlet range per draw
+    VkDescriptorBufferInfo drawBoundsBufferInfo{};
+    drawBoundsBufferInfo.buffer = drawBoundsBuffer;
+    drawBoundsBufferInfo.offset = 0;
+    drawBoundsBufferInfo.range = sizeof(float) * 8 * maxDrawCount;
+
+    VkDescriptorBufferInfo meshletBufferInfo{};
+    meshletBufferInfo.buffer = meshletBuffer;
+    meshletBufferInfo.offset = 0;
+    meshletBufferInfo.range = meshletBufferSize;
+
+    VkDescriptorBufferInfo meshletDrawBufferInfo{};
+    meshletDrawBufferInfo.buffer = meshletDrawBuffer;
+    meshletDrawBufferInfo.offset = 0;
+    meshletDrawBufferInfo.range = sizeof(VkDrawIndexedIndirectCommand) * maxMeshletDrawCount;
+
+    VkDescriptorBufferInfo statisticsBufferInfo{};
+    statisticsBufferInfo.buffer = statisticsBuffer;
+    statisticsBufferInfo.offset = 0;
+    statisticsBufferInfo.range = statisticsBufferSize;
+
+    VkDescriptorImageInfo depthPyramidInfo{};
+    depthPyramidInfo.sampler = sampler;
+    depthPyramidInfo.imageView = depthPyramidImageView;
+    depthPyramidInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+    std::array<VkDescriptorBufferInfo*, 5> bufferInfos = {
+        &drawBufferInfo,
+        &drawBoundsBufferInfo,
+        &meshletBufferInfo,
+        &meshletDrawBufferInfo,
+        &statisticsBufferInfo
+    };
+
+    std::array<VkWriteDescriptorSet, 6> descriptorWrites{};
+    for (uint32_t i = 0; i < bufferInfos.size(); ++i)
+    {
+        descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[i].dstSet = m_MeshletCullDescriptorSets[frameIndex];
+        descriptorWrites[i].dstBinding = i;
+        descriptorWrites[i].dstArrayElement = 0;
+        descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrites[i].descriptorCount = 1;
+        descriptorWrites[i].pBufferInfo = bufferInfos[i];
+    }
+
+    descriptorWrites[5].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrites[5].dstSet = m_MeshletCullDescriptorSets[frameIndex];
+    descriptorWrites[5].dstBinding = 5;
+    descriptorWrites[5].dstArrayElement = 0;
+    descriptorWrites[5].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descriptorWrites[5].descriptorCount = 1;
+    descriptorWrites[5].pImageInfo = &depthPyramidInfo;
+
+    vkUpdateDescriptorSets(
+        m_Device,
+        static_cast<uint32_t>(descriptorWrites.size()),
+        descriptorWrites.data(),
+        0,
+        nullptr);
+}
+
+const std::vector<VkDescriptorSet>& DescriptorManager::getMeshletCullDescriptorSets() const
+{
+    return m_MeshletCullDescriptorSets;
+}
+
+void DescriptorManager::createLightCullDescriptorSetLayout()
+{
+    std::array<VkDescriptorSetLayoutBinding, 4> bindings{};
+
+    // Scene UBO (binding = 0)
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    // Lights (binding = 1)
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    // Depth buffer (binding = 2)
+    bindings[2].binding = 2;
+    bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    // Per-cluster light lists (binding = 3)
+    bindings[3].binding = 3;
+    bindings[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+
+    for (VkDescriptorSetLayoutBinding& binding : bindings)
+    {
+        binding.descriptorCount = 1;
+        binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        binding.pImmutableSamplers = nullptr;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(m_Device, &layoutInfo, nullptr, &m_LightCullDescriptorSetLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create light culling descriptor set layout.");
+    }
+}
+
+VkDescriptorSetLayout DescriptorManager::getLightCullDescriptorSetLayout() const
+{
+    return m_LightCullDescriptorSetLayout;
+}
+
+void DescriptorManager::createLightCullDescriptorSet(
+    size_t frameIndex,
+    VkBuffer uniformBuffer,
+    size_t uniformBufferObjectSize,
+    VkBuffer lightBuffer,
+    VkDeviceSize lightBufferSize,
+    VkImageView depthImageView,
+    VkBuffer lightClusterBuffer,
+    VkDeviceSize lightClusterBufferSize,
+    VkSampler sampler)
+{
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_DescriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &m_LightCullDescriptorSetLayout;
+
+    if (vkAllocateDescriptorSets(m_Device, &allocInfo, &m_LightCullDescriptorSets[frameIndex]) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to allocate light culling descriptor set.");
+    }
+
+    updateLightCullDescriptorSet(frameIndex, uniformBuffer, uniformBufferObjectSize, lightBuffer, lightBufferSize,
+        depthImageView, lightClusterBuffer, lightClusterBufferSize, sampler);
+}
+
+void DescriptorManager::updateLightCullDescriptorSet(
+    size_t frameIndex,
+    VkBuffer uniformBuffer,
+    size_t uniformBufferObjectSize,
+    VkBuffer lightBuffer,
+    VkDeviceSize lightBufferSize,
+    VkImageView depthImageView,
+    VkBuffer lightClusterBuffer,
+    VkDeviceSize lightClusterBufferSize,
+    VkSampler sampler)
+{
+    VkDescriptorBufferInfo uniformBufferInfo{};
+    uniformBufferInfo.buffer = uniformBuffer;
+    uniformBufferInfo.offset = 0;
+    uniformBufferInfo.range = uniformBufferObjectSize;
+
+    VkDescriptorBufferInfo lightBufferInfo{};
+    lightBufferInfo.buffer = lightBuffer;
+    lightBufferInfo.offset = 0;
+    lightBufferInfo.range = lightBufferSize;
+
+    // Read while the depth buffer is in the read-only layout between the depth pre-pass and the G-buffer pass
+    VkDescriptorImageInfo depthImageInfo{};
+    depthImageInfo.sampler = sampler;
+    depthImageInfo.imageView = depthImageView;
+    depthImageInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+
+    VkDescriptorBufferInfo lightClusterBufferInfo{};
+    lightClusterBufferInfo.buffer = lightClusterBuffer;
+    lightClusterBufferInfo.offset = 0;
+    lightClusterBufferInfo.range = lightClusterBufferSize;
+
+    std::array<VkWriteDescriptorSet, 4> descriptorWrites{};
+    for (uint32_t i = 0; i < descriptorWrites.size(); ++i)
+    {
+        descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[i].dstSet = m_LightCullDescriptorSets[frameIndex];
+        descriptorWrites[i].dstBinding = i;
+        descriptorWrites[i].dstArrayElement = 0;
+        descriptorWrites[i].descriptorCount = 1;
+    }
+
+    descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    descriptorWrites[0].pBufferInfo = &uniformBufferInfo;
+    descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrites[1].pBufferInfo = &lightBufferInfo;
+    descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descriptorWrites[2].pImageInfo = &depthImageInfo;
+    descriptorWrites[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrites[3].pBufferInfo = &lightClusterBufferInfo;
+
+    vkUpdateDescriptorSets(
+        m_Device,
+        static_cast<uint32_t>(descriptorWrites.size()),
+        descriptorWrites.data(),
+        0,
+        nullptr);
+}
+
+const std::vector<VkDescriptorSet>& DescriptorManager::getLightCullDescriptorSets() const
+{
+    return m_LightCullDescriptorSets;
+}
+
+void DescriptorManager::createLightAnimateDescriptorSetLayout()
+{
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+
+    // Light sources (binding = 0) and the animated lights (binding = 1)
+    for (uint32_t i = 0; i < bindings.size(); ++i)
+    {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[i].pImmutableSamplers = nullptr;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(m_Device, &layoutInfo, nullptr, &m_LightAnimateDescriptorSetLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create light animation descriptor set layout.");
+    }
+}
+
+VkDescriptorSetLayout DescriptorManager::getLightAnimateDescriptorSetLayout() const
+{
+    return m_LightAnimateDescriptorSetLayout;
+}
+
+void DescriptorManager::createLightAnimateDescriptorSet(
+    size_t frameIndex,
+    VkBuffer lightSourceBuffer,
+    VkDeviceSize lightSourceBufferSize,
+    VkBuffer lightBuffer,
+    VkDeviceSize lightBufferSize)
+{
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_DescriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &m_LightAnimateDescriptorSetLayout;
+
+    if (vkAllocateDescriptorSets(m_Device, &allocInfo, &m_LightAnimateDescriptorSets[frameIndex]) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to allocate light animation descriptor set.");
+    }
+
+    updateLightAnimateDescriptorSet(frameIndex, lightSourceBuffer, lightSourceBufferSize, lightBuffer, lightBufferSize);
+}
+
+void DescriptorManager::updateLightAnimateDescriptorSet(
+    size_t frameIndex,
+    VkBuffer lightSourceBuffer,
+    VkDeviceSize lightSourceBufferSize,
+    VkBuffer lightBuffer,
+    VkDeviceSize lightBufferSize)
+{
+    VkDescriptorBufferInfo lightSourceBufferInfo{};
+    lightSourceBufferInfo.buffer = lightSourceBuffer;
+    lightSourceBufferInfo.offset = 0;
+    lightSourceBufferInfo.range = lightSourceBufferSize;
+
+    VkDescriptorBufferInfo lightBufferInfo{};
+    lightBufferInfo.buffer = lightBuffer;
+    lightBufferInfo.offset = 0;
+    lightBufferInfo.range = lightBufferSize;
+
+    std::array<VkDescriptorBufferInfo*, 2> bufferInfos = {
+        &lightSourceBufferInfo,
+        &lightBufferInfo
+    };
+
+    std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+    for (uint32_t i = 0; i < descriptorWrites.size(); ++i)
+    {
+        descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[i].dstSet = m_LightAnimateDescriptorSets[frameIndex];
+        descriptorWrites[i].dstBinding = i;
+        descriptorWrites[i].dstArrayElement = 0;
+        descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrites[i].descriptorCount = 1;
+        descriptorWrites[i].pBufferInfo = bufferInfos[i];
+    }
+
+    vkUpdateDescriptorSets(
+        m_Device,
+        static_cast<uint32_t>(descriptorWrites.size()),
+        descriptorWrites.data(),
+        0,
+        nullptr);
+}
+
+const std::vector<VkDescriptorSet>& DescriptorManager::getLightAnimateDescriptorSets() const
+{
+    return m_LightAnimateDescriptorSets;
+}
+
+void DescriptorManager::updateLightBufferDescriptors(
+    size_t frameIndex,
+    VkBuffer lightSourceBuffer,
+    VkDeviceSize lightSourceBufferSize,
+    VkBuffer lightBuffer,
+    VkDeviceSize lightBufferSize)
+{
+    updateLightAnimateDescriptorSet(frameIndex, lightSourceBuffer, lightSourceBufferSize, lightBuffer, lightBufferSize);
+
+    VkDescriptorBufferInfo lightBufferInfo{};
+    lightBufferInfo.buffer = lightBuffer;
+    lightBufferInfo.offset = 0;
+    lightBufferInfo.range = lightBufferSize;
+
+    // LightsBuffer is binding 5 of the final pass and binding 1 of the light culling pass
+    std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+    descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrites[0].dstSet = m_FinalPassDescriptorSets[frameIndex];
+    descriptorWrites[0].dstBinding = 5;
+    descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrites[1].dstSet = m_LightCullDescriptorSets[frameIndex];
+    descriptorWrites[1].dstBinding = 1;
+    for (VkWriteDescriptorSet& descriptorWrite : descriptorWrites)
+    {
+        descriptorWrite.dstArrayElement = 0;
+        descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrite.descriptorCount = 1;
+        descriptorWrite.pBufferInfo = &lightBufferInfo;
+    }
+
+    vkUpdateDescriptorSets(
+        m_Device,
+        static_cast<uint32_t>(descriptorWrites.size()),
+        descriptorWrites.data(),
+        0,
+        nullptr);
+}
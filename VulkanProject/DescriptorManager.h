@@ -7,16 +7,25 @@
 class DescriptorManager
 {
 public:
-    DescriptorManager(VkDevice device, size_t maxFramesInFlight, size_t materialCount);
+    // Upper bound on depth pyramid levels; sets for all of them are allocated up front so resizes only rewrite them
+    static constexpr uint32_t MAX_DEPTH_PYRAMID_LEVELS = 16;
+
+    DescriptorManager(VkDevice device, size_t maxFramesInFlight, size_t textureCount);
     ~DescriptorManager();
 
     void createDescriptorSetLayout();
     void createDescriptorPool();
+    // One set per frame: scene UBO, material storage buffer and the bindless texture array.
+    // Uniform buffers throughout are dynamic, bound with the offset of the frame's data in the uniform ring.
     void createDescriptorSets(
-        const std::vector<VkBuffer>& uniformBuffers,
-        const std::vector<Material*>& materials,
-        size_t uniformBufferObjectSize
+        VkBuffer uniformBuffer,
+        size_t uniformBufferObjectSize,
+        VkBuffer materialBuffer,
+        VkDeviceSize materialBufferSize,
+        const std::vector<Texture*>& textures
     );
+    // Rewrites the texture array of one frame's set; the frame must not be in flight
+    void updateTextureDescriptors(size_t frameIndex, const std::vector<Texture*>& textures);
 
     void createFinalPassDescriptorSetLayout();
     void createFinalPassDescriptorSet(
@@ -34,6 +43,8 @@ public:
 		VkImageView shadowMapImageView,
 		VkImageView skyboxImageView,
 		VkImageView irradianceImageView,
+        VkBuffer lightClusterBuffer,
+        VkDeviceSize lightClusterBufferSize,
         VkSampler sampler
     );
     void updateFinalPassDescriptorSet(
@@ -51,6 +62,8 @@ public:
 		VkImageView shadowMapImageView,
 		VkImageView skyboxImageView,
 		VkImageView irradianceImageView,
+        VkBuffer lightClusterBuffer,
+        VkDeviceSize lightClusterBufferSize,
         VkSampler sampler
     );
 
@@ -66,26 +79,188 @@ public:
 		VkImageView outputImageView
 	);
 
+    // One set per pyramid level: the level above (or the depth buffer) as source, the level itself as storage image
+    void createDepthPyramidDescriptorSetLayout();
+    void createDepthPyramidDescriptorSets(
+        size_t frameIndex,
+        const std::vector<VkImageView>& sourceImageViews,
+        const std::vector<VkImageView>& destinationImageViews,
+        VkSampler sampler
+    );
+    void updateDepthPyramidDescriptorSets(
+        size_t frameIndex,
+        const std::vector<VkImageView>& sourceImageViews,
+        const std::vector<VkImageView>& destinationImageViews,
+        VkSampler sampler
+    );
+
+    // Submesh culling pass: submeshes in, the visibility list, the submeshes' levels of detail and statistics out
+    void createCullDescriptorSetLayout();
+    void createCullDescriptorSet(
+        size_t frameIndex,
+        VkBuffer submeshBuffer,
+        VkDeviceSize submeshBufferSize,
+        VkBuffer drawBuffer,
+        VkBuffer drawBoundsBuffer,
+        VkDeviceSize maxDrawCount,
+        VkBuffer lodBuffer,
+        VkDeviceSize lodBufferSize,
+        VkBuffer statisticsBuffer,
+        VkDeviceSize statisticsBufferSize
+    );
+
+    // Occlusion pass: frustum-culled draws and their bounds in, filtered draws and statistics out
+    void createOcclusionDescriptorSetLayout();
+    void createOcclusionDescriptorSet(
+        size_t frameIndex,
+        VkBuffer inputDrawBuffer,
+        VkBuffer drawBoundsBuffer,
+        VkBuffer outputDrawBuffer,
+        VkDeviceSize maxDrawCount,
+        VkBuffer statisticsBuffer,
+        VkDeviceSize statisticsBufferSize,
+        VkImageView depthPyramidImageView,
+        VkSampler sampler
+    );
+    void updateOcclusionDescriptorSet(
+        size_t frameIndex,
+        VkBuffer inputDrawBuffer,
+        VkBuffer drawBoundsBuffer,
+        VkBuffer outputDrawBuffer,
+        VkDeviceSize maxDrawCount,
+        VkBuffer statisticsBuffer,
+        VkDeviceSize statisticsBufferSize,
+        VkImageView depthPyramidImageView,
+        VkSampler sampler
+    );
+
+    // Meshlet pass: occlusion-tested draws, their bounds and the meshlets in, meshlet draws and statistics out
+    void createMeshletCullDescriptorSetLayout();
+    void createMeshletCullDescriptorSet(
+        size_t frameIndex,
+        VkBuffer drawBuffer,
+        VkBuffer drawBoundsBuffer,
+        VkDeviceSize maxDrawCount,
+        VkBuffer meshletBuffer,
+        VkDeviceSize meshletBufferSize,
+        VkBuffer meshletDrawBuffer,
+        VkDeviceSize maxMeshletDrawCount,
+        VkBuffer statisticsBuffer,
+        VkDeviceSize statisticsBufferSize,
+        VkImageView depthPyramidImageView,
+        VkSampler sampler
+    );
+    void updateMeshletCullDescriptorSet(
+        size_t frameIndex,
+        VkBuffer drawBuffer,
+        VkBuffer drawBoundsBuffer,
+        VkDeviceSize maxDrawCount,
+        VkBuffer meshletBuffer,
+        VkDeviceSize meshletBufferSize,
+        VkBuffer meshletDrawBuffer,
+        VkDeviceSize maxMeshletDrawCount,
+        VkBuffer statisticsBuffer,
+        VkDeviceSize statisticsBufferSize,
+        VkImageView depthPyramidImageView,
+        VkSampler sampler
+    );
+
+    // Light culling pass: scene UBO, lights and depth buffer in, per-cluster light lists out
+    void createLightCullDescriptorSetLayout();
+    void createLightCullDescriptorSet(
+        size_t frameIndex,
+        VkBuffer uniformBuffer,
+        size_t uniformBufferObjectSize,
+        VkBuffer lightBuffer,
+        VkDeviceSize lightBufferSize,
+        VkImageView depthImageView,
+        VkBuffer lightClusterBuffer,
+        VkDeviceSize lightClusterBufferSize,
+        VkSampler sampler
+    );
+    void updateLightCullDescriptorSet(
+        size_t frameIndex,
+        VkBuffer uniformBuffer,
+        size_t uniformBufferObjectSize,
+        VkBuffer lightBuffer,
+        VkDeviceSize lightBufferSize,
+        VkImageView depthImageView,
+        VkBuffer lightClusterBuffer,
+        VkDeviceSize lightClusterBufferSize,
+        VkSampler sampler
+    );
+
+    // Light animation pass: light sources in, animated lights out
+    void createLightAnimateDescriptorSetLayout();
+    void createLightAnimateDescriptorSet(
+        size_t frameIndex,
+        VkBuffer lightSourceBuffer,
+        VkDeviceSize lightSourceBufferSize,
+        VkBuffer lightBuffer,
+        VkDeviceSize lightBufferSize
+    );
+    void updateLightAnimateDescriptorSet(
+        size_t frameIndex,
+        VkBuffer lightSourceBuffer,
+        VkDeviceSize lightSourceBufferSize,
+        VkBuffer lightBuffer,
+        VkDeviceSize lightBufferSize
+    );
+    // Points every set of one frame that reads or writes the lights at reallocated light buffers;
+    // the frame must not be in flight
+    void updateLightBufferDescriptors(
+        size_t frameIndex,
+        VkBuffer lightSourceBuffer,
+        VkDeviceSize lightSourceBufferSize,
+        VkBuffer lightBuffer,
+        VkDeviceSize lightBufferSize
+    );
+
     VkDescriptorSetLayout getDescriptorSetLayout() const;
     VkDescriptorSetLayout getFinalPassDescriptorSetLayout() const;
     VkDescriptorSetLayout getComputeDescriptorSetLayout() const;
+    VkDescriptorSetLayout getDepthPyramidDescriptorSetLayout() const;
+    VkDescriptorSetLayout getCullDescriptorSetLayout() const;
+    VkDescriptorSetLayout getOcclusionDescriptorSetLayout() const;
+    VkDescriptorSetLayout getMeshletCullDescriptorSetLayout() const;
+    VkDescriptorSetLayout getLightCullDescriptorSetLayout() const;
+    VkDescriptorSetLayout getLightAnimateDescriptorSetLayout() const;
 
     const std::vector<VkDescriptorSet>& getDescriptorSets() const;
     const std::vector<VkDescriptorSet>& getFinalPassDescriptorSets() const;
     const std::vector<VkDescriptorSet>& getComputeDescriptorSets() const;
+    // Indexed by frame, then by pyramid level
+    const std::vector<std::vector<VkDescriptorSet>>& getDepthPyramidDescriptorSets() const;
+    const std::vector<VkDescriptorSet>& getCullDescriptorSets() const;
+    const std::vector<VkDescriptorSet>& getOcclusionDescriptorSets() const;
+    const std::vector<VkDescriptorSet>& getMeshletCullDescriptorSets() const;
+    const std::vector<VkDescriptorSet>& getLightCullDescriptorSets() const;
+    const std::vector<VkDescriptorSet>& getLightAnimateDescriptorSets() const;
 
 private:
     VkDevice m_Device;
     size_t m_MaxFramesInFlight;
-    size_t m_MaterialCount;
+    size_t m_TextureCount;
 
     VkDescriptorSetLayout m_DescriptorSetLayout{};
     VkDescriptorSetLayout m_FinalPassDescriptorSetLayout{};
     VkDescriptorSetLayout m_ComputeDescriptorSetLayout{};
+    VkDescriptorSetLayout m_DepthPyramidDescriptorSetLayout{};
+    VkDescriptorSetLayout m_CullDescriptorSetLayout{};
+    VkDescriptorSetLayout m_OcclusionDescriptorSetLayout{};
+    VkDescriptorSetLayout m_MeshletCullDescriptorSetLayout{};
+    VkDescriptorSetLayout m_LightCullDescriptorSetLayout{};
+    VkDescriptorSetLayout m_LightAnimateDescriptorSetLayout{};
 
     VkDescriptorPool m_DescriptorPool{};
     std::vector<VkDescriptorSet> m_DescriptorSets{};
     std::vector<VkDescriptorSet> m_FinalPassDescriptorSets{};
     std::vector<VkDescriptorSet> m_ComputeDescriptorSets{};
+    std::vector<std::vector<VkDescriptorSet>> m_DepthPyramidDescriptorSets{};
+    std::vector<VkDescriptorSet> m_CullDescriptorSets{};
+    std::vector<VkDescriptorSet> m_OcclusionDescriptorSets{};
+    std::vector<VkDescriptorSet> m_MeshletCullDescriptorSets{};
+    std::vector<VkDescriptorSet> m_LightCullDescriptorSets{};
+    std::vector<VkDescriptorSet> m_LightAnimateDescriptorSets{};
 };
 
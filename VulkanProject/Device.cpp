@@ -2,8 +2,8 @@
 #include "PhysicalDevice.h"
 #include <spdlog/spdlog.h>
 
-Device::Device(VkDevice device, VkQueue graphicsQueue, VkQueue presentQueue)
-    : m_Device(device), m_GraphicsQueue(graphicsQueue), m_PresentQueue(presentQueue) 
+Device::Device(VkDevice device, VkQueue graphicsQueue, VkQueue presentQueue, VkQueue transferQueue)
+    : m_Device(device), m_GraphicsQueue(graphicsQueue), m_PresentQueue(presentQueue), m_TransferQueue(transferQueue) 
 {
 	spdlog::debug("Device created successfully.");
 }
@@ -32,11 +32,17 @@ VkQueue Device::getPresentQueue() const
     return m_PresentQueue;
 }
 
+VkQueue Device::getTransferQueue() const
+{
+    return m_TransferQueue;
+}
+
 Device::Device(Device&& other) noexcept 
 {
     m_Device = other.m_Device;
     m_GraphicsQueue = other.m_GraphicsQueue;
     m_PresentQueue = other.m_PresentQueue;
+    m_TransferQueue = other.m_TransferQueue;
 
     other.m_Device = VK_NULL_HANDLE;
 }
@@ -52,6 +58,7 @@ Device& Device::operator=(Device&& other) noexcept
         m_Device = other.m_Device;
         m_GraphicsQueue = other.m_GraphicsQueue;
         m_PresentQueue = other.m_PresentQueue;
+        m_TransferQueue = other.m_TransferQueue;
 
         other.m_Device = VK_NULL_HANDLE;
     }
@@ -54,7 +54,7 @@ class PhysicalDevice;
 class Device 
 {
 public:
-    Device(VkDevice device, VkQueue graphicsQueue, VkQueue presentQueue);
+    Device(VkDevice device, VkQueue graphicsQueue, VkQueue presentQueue, VkQueue transferQueue);
     ~Device();
 
     Device(const Device&) = delete;
@@ -65,8 +65,11 @@ public:
     VkDevice get() const;
     VkQueue getGraphicsQueue() const;
     VkQueue getPresentQueue() const;
+    // Same handle as the graphics queue when the device has no separate transfer family
+    VkQueue getTransferQueue() const;
 private:
     VkDevice m_Device;
     VkQueue m_GraphicsQueue;
     VkQueue m_PresentQueue;
+    VkQueue m_TransferQueue;
 };
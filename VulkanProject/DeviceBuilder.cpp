@@ -61,6 +61,10 @@ Device* DeviceBuilder::build()
         m_QueueFamilyIndices.graphicsFamily.value(),
         m_QueueFamilyIndices.presentFamily.value()
     };
+    if (m_QueueFamilyIndices.transferFamily.has_value())
+    {
+        uniqueQueueFamilies.insert(m_QueueFamilyIndices.transferFamily.value());
+    }
 
     float queuePriority = 1.0f;
     for (uint32_t queueFamily : uniqueQueueFamilies)
@@ -135,6 +139,13 @@ Device* DeviceBuilder::build()
     VkQueue presentQueue;
     vkGetDeviceQueue(device, m_QueueFamilyIndices.presentFamily.value(), 0, &presentQueue);
 
-    return new Device(device, graphicsQueue, presentQueue);
+    VkQueue transferQueue = graphicsQueue;
+    if (m_QueueFamilyIndices.hasDedicatedTransferFamily())
+    {
+        vkGetDeviceQueue(device, m_QueueFamilyIndices.transferFamily.value(), 0, &transferQueue);
+        spdlog::info("Using dedicated transfer queue family {}", m_QueueFamilyIndices.transferFamily.value());
+    }
+
+    return new Device(device, graphicsQueue, presentQueue, transferQueue);
 }
 
@@ -1,5 +1,97 @@
 // Frustum.cpp
 #include "Frustum.h"
+#include <bit>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define FRUSTUM_CULL_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRUSTUM_CULL_SSE2
+#endif
+
+namespace
+{
+    // Transform and planes flattened to scalars, shared by the scalar and SIMD paths so both round the same way
+    struct CullConstants
+    {
+        float rotation[3][3];       // [row][column] of the upper 3x3
+        float absRotation[3][3];
+        float translation[3];
+        float planes[6][4];
+        float absNormals[6][3];
+    };
+
+    CullConstants makeCullConstants(const std::array<glm::vec4, 6>& planes, const glm::mat4& transform)
+    {
+        CullConstants constants{};
+        for (int row = 0; row < 3; ++row)
+        {
+            for (int column = 0; column < 3; ++column)
+            {
+                constants.rotation[row][column] = transform[column][row];
+                constants.absRotation[row][column] = std::fabs(transform[column][row]);
+            }
+            constants.translation[row] = transform[3][row];
+        }
+        for (int plane = 0; plane < 6; ++plane)
+        {
+            for (int component = 0; component < 4; ++component)
+            {
+                constants.planes[plane][component] = planes[plane][component];
+            }
+            for (int component = 0; component < 3; ++component)
+            {
+                constants.absNormals[plane][component] = std::fabs(planes[plane][component]);
+            }
+        }
+        return constants;
+    }
+
+    bool testBox(const CullConstants& c, float cx, float cy, float cz, float ex, float ey, float ez)
+    {
+        const float wx = c.rotation[0][0] * cx + c.rotation[0][1] * cy + c.rotation[0][2] * cz + c.translation[0];
+        const float wy = c.rotation[1][0] * cx + c.rotation[1][1] * cy + c.rotation[1][2] * cz + c.translation[1];
+        const float wz = c.rotation[2][0] * cx + c.rotation[2][1] * cy + c.rotation[2][2] * cz + c.translation[2];
+        const float rx = c.absRotation[0][0] * ex + c.absRotation[0][1] * ey + c.absRotation[0][2] * ez;
+        const float ry = c.absRotation[1][0] * ex + c.absRotation[1][1] * ey + c.absRotation[1][2] * ez;
+        const float rz = c.absRotation[2][0] * ex + c.absRotation[2][1] * ey + c.absRotation[2][2] * ez;
+
+        for (int plane = 0; plane < 6; ++plane)
+        {
+            const float distance = c.planes[plane][0] * wx + c.planes[plane][1] * wy + c.planes[plane][2] * wz + c.planes[plane][3];
+            const float radius = c.absNormals[plane][0] * rx + c.absNormals[plane][1] * ry + c.absNormals[plane][2] * rz;
+            if (distance + radius < 0.0f)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+void BoxBoundsSoA::add(const glm::vec3& min, const glm::vec3& max)
+{
+    const glm::vec3 center = (min + max) * 0.5f;
+    const glm::vec3 extent = (max - min) * 0.5f;
+    centerX.push_back(center.x);
+    centerY.push_back(center.y);
+    centerZ.push_back(center.z);
+    extentX.push_back(extent.x);
+    extentY.push_back(extent.y);
+    extentZ.push_back(extent.z);
+}
+
+void BoxBoundsSoA::clear()
+{
+    centerX.clear();
+    centerY.clear();
+    centerZ.clear();
+    extentX.clear();
+    extentY.clear();
+    extentZ.clear();
+}
 
 Frustum::Frustum(const glm::mat4& projection, const glm::mat4& view) {
     glm::mat4 clip = projection * view;
@@ -73,3 +165,129 @@ bool Frustum::isBoxVisible(const glm::vec3& min, const glm::vec3& max) const {
     }
     return true; // Inside or intersects the frustum
 }
+
+Frustum::Containment Frustum::classifyBox(const glm::vec3& min, const glm::vec3& max, uint32_t& planeMask) const
+{
+    for (uint32_t i = 0; i < planes.size(); ++i)
+    {
+        if ((planeMask & (1u << i)) == 0)
+        {
+            continue;
+        }
+
+        const glm::vec4& plane = planes[i];
+        const glm::vec3 positiveVertex(plane.x >= 0 ? max.x : min.x, plane.y >= 0 ? max.y : min.y, plane.z >= 0 ? max.z : min.z);
+        const glm::vec3 negativeVertex(plane.x >= 0 ? min.x : max.x, plane.y >= 0 ? min.y : max.y, plane.z >= 0 ? min.z : max.z);
+
+        if (glm::dot(glm::vec3(plane), positiveVertex) + plane.w < 0)
+        {
+            return Containment::Outside;
+        }
+        if (glm::dot(glm::vec3(plane), negativeVertex) + plane.w >= 0)
+        {
+            planeMask &= ~(1u << i);
+        }
+    }
+    return planeMask == 0 ? Containment::Inside : Containment::Intersecting;
+}
+
+bool Frustum::isBoxVisible(const glm::vec3& center, const glm::vec3& extent, const glm::mat4& transform) const
+{
+    const CullConstants constants = makeCullConstants(planes, transform);
+    return testBox(constants, center.x, center.y, center.z, extent.x, extent.y, extent.z);
+}
+
+size_t Frustum::cullBatch(const BoxBoundsSoA& bounds, const glm::mat4& transform, std::vector<uint64_t>& visibilityMask) const
+{
+    const CullConstants c = makeCullConstants(planes, transform);
+    const size_t count = bounds.size();
+    visibilityMask.assign((count + 63) / 64, 0);
+
+    size_t visibleCount = 0;
+    size_t i = 0;
+
+#if defined(FRUSTUM_CULL_AVX2)
+    constexpr size_t laneCount = 8;
+    #define SIMD_FLOAT __m256
+    #define SIMD_SET1 _mm256_set1_ps
+    #define SIMD_LOAD _mm256_loadu_ps
+    #define SIMD_ADD _mm256_add_ps
+    #define SIMD_MUL _mm256_mul_ps
+    #define SIMD_AND _mm256_and_ps
+    #define SIMD_CMPGE(a, b) _mm256_cmp_ps(a, b, _CMP_GE_OQ)
+    #define SIMD_MOVEMASK _mm256_movemask_ps
+#elif defined(FRUSTUM_CULL_SSE2)
+    constexpr size_t laneCount = 4;
+    #define SIMD_FLOAT __m128
+    #define SIMD_SET1 _mm_set1_ps
+    #define SIMD_LOAD _mm_loadu_ps
+    #define SIMD_ADD _mm_add_ps
+    #define SIMD_MUL _mm_mul_ps
+    #define SIMD_AND _mm_and_ps
+    #define SIMD_CMPGE _mm_cmpge_ps
+    #define SIMD_MOVEMASK _mm_movemask_ps
+#endif
+
+#if defined(FRUSTUM_CULL_AVX2) || defined(FRUSTUM_CULL_SSE2)
+    // Same operation order as testBox, without the early out
+    auto dot3 = [](SIMD_FLOAT a, SIMD_FLOAT x, SIMD_FLOAT b, SIMD_FLOAT y, SIMD_FLOAT c, SIMD_FLOAT z)
+    {
+        return SIMD_ADD(SIMD_ADD(SIMD_MUL(a, x), SIMD_MUL(b, y)), SIMD_MUL(c, z));
+    };
+
+    const SIMD_FLOAT zero = SIMD_SET1(0.0f);
+    for (; i + laneCount <= count; i += laneCount)
+    {
+        const SIMD_FLOAT cx = SIMD_LOAD(&bounds.centerX[i]);
+        const SIMD_FLOAT cy = SIMD_LOAD(&bounds.centerY[i]);
+        const SIMD_FLOAT cz = SIMD_LOAD(&bounds.centerZ[i]);
+        const SIMD_FLOAT ex = SIMD_LOAD(&bounds.extentX[i]);
+        const SIMD_FLOAT ey = SIMD_LOAD(&bounds.extentY[i]);
+        const SIMD_FLOAT ez = SIMD_LOAD(&bounds.extentZ[i]);
+
+        SIMD_FLOAT world[3];
+        SIMD_FLOAT radius[3];
+        for (int row = 0; row < 3; ++row)
+        {
+            world[row] = SIMD_ADD(dot3(SIMD_SET1(c.rotation[row][0]), cx, SIMD_SET1(c.rotation[row][1]), cy,
+                SIMD_SET1(c.rotation[row][2]), cz), SIMD_SET1(c.translation[row]));
+            radius[row] = dot3(SIMD_SET1(c.absRotation[row][0]), ex, SIMD_SET1(c.absRotation[row][1]), ey,
+                SIMD_SET1(c.absRotation[row][2]), ez);
+        }
+
+        SIMD_FLOAT visible = SIMD_CMPGE(zero, zero);
+        for (int plane = 0; plane < 6; ++plane)
+        {
+            const SIMD_FLOAT distance = SIMD_ADD(dot3(SIMD_SET1(c.planes[plane][0]), world[0], SIMD_SET1(c.planes[plane][1]), world[1],
+                SIMD_SET1(c.planes[plane][2]), world[2]), SIMD_SET1(c.planes[plane][3]));
+            const SIMD_FLOAT extent = dot3(SIMD_SET1(c.absNormals[plane][0]), radius[0], SIMD_SET1(c.absNormals[plane][1]), radius[1],
+                SIMD_SET1(c.absNormals[plane][2]), radius[2]);
+            visible = SIMD_AND(visible, SIMD_CMPGE(SIMD_ADD(distance, extent), zero));
+        }
+
+        // laneCount divides 64, so a group never straddles two mask words
+        const uint32_t bits = static_cast<uint32_t>(SIMD_MOVEMASK(visible));
+        visibilityMask[i / 64] |= static_cast<uint64_t>(bits) << (i % 64);
+        visibleCount += std::popcount(bits);
+    }
+
+    #undef SIMD_FLOAT
+    #undef SIMD_SET1
+    #undef SIMD_LOAD
+    #undef SIMD_ADD
+    #undef SIMD_MUL
+    #undef SIMD_AND
+    #undef SIMD_CMPGE
+    #undef SIMD_MOVEMASK
+#endif
+
+    for (; i < count; ++i)
+    {
+        if (testBox(c, bounds.centerX[i], bounds.centerY[i], bounds.centerZ[i], bounds.extentX[i], bounds.extentY[i], bounds.extentZ[i]))
+        {
+            visibilityMask[i / 64] |= uint64_t(1) << (i % 64);
+            visibleCount++;
+        }
+    }
+    return visibleCount;
+}
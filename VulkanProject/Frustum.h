@@ -1,11 +1,43 @@
 // Frustum.h
+#pragma once
 #include <glm/glm.hpp>
 #include <array>
+#include <cstdint>
+#include <vector>
+
+// Axis-aligned boxes as separate center/extent arrays, so several boxes fill one SIMD register
+struct BoxBoundsSoA
+{
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> extentX, extentY, extentZ;
+
+    void add(const glm::vec3& min, const glm::vec3& max);
+    void clear();
+    size_t size() const { return centerX.size(); }
+};
 
 class Frustum {
 public:
+    enum class Containment
+    {
+        Outside,
+        Intersecting,
+        Inside
+    };
+
     Frustum(const glm::mat4& projection, const glm::mat4& view);
     bool isBoxVisible(const glm::vec3& min, const glm::vec3& max) const;
+    // Only the planes set in planeMask are tested; planes the box lies fully inside of are cleared from it,
+    // so children of a box never repeat those tests. Start hierarchies with ALL_PLANES.
+    Containment classifyBox(const glm::vec3& min, const glm::vec3& max, uint32_t& planeMask) const;
+    static constexpr uint32_t ALL_PLANES = 0x3F;
+    // Box given in the space transform maps from; it is moved as center plus |transform| * extent
+    bool isBoxVisible(const glm::vec3& center, const glm::vec3& extent, const glm::mat4& transform) const;
+    // Same test over a whole array, 8 (AVX2) or 4 (SSE2) boxes at a time. Bit i of visibilityMask
+    // is set when box i is visible; returns the number of visible boxes.
+    size_t cullBatch(const BoxBoundsSoA& bounds, const glm::mat4& transform, std::vector<uint64_t>& visibilityMask) const;
+    // Normalized plane equations (xyz normal pointing inwards, w distance)
+    const std::array<glm::vec4, 6>& getPlanes() const { return planes; }
 private:
     std::array<glm::vec4, 6> planes;
 };
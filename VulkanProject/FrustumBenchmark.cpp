@@ -0,0 +1,107 @@
+// Micro-benchmark for Frustum::cullBatch against the one-box-at-a-time scalar test.
+
+#include "Frustum.h"
+#include "Benchmark.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <bit>
+#include <random>
+#include <string>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+    void report(const std::string& name, const BenchmarkResult& result, size_t boxCount)
+    {
+        spdlog::info("{:<28} {:>12.1f} us {:>10} {:>10.1f} M boxes/s", name, result.secondsPerIteration * 1e6,
+            result.iterations, double(boxCount) / result.secondsPerIteration / 1e6);
+    }
+
+    BoxBoundsSoA makeBoxes(size_t count)
+    {
+        std::mt19937 random(1234);
+        std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+        std::uniform_real_distribution<float> size(0.1f, 2.0f);
+
+        BoxBoundsSoA bounds;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const glm::vec3 center(position(random), position(random), position(random));
+            const glm::vec3 extent(size(random), size(random), size(random));
+            bounds.add(center - extent, center + extent);
+        }
+        return bounds;
+    }
+}
+
+int main()
+{
+    const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 150.0f);
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 10.0f, 60.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    // A rotated model, which the old min/max transform got wrong
+    const glm::mat4 model = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(5.0f, 0.0f, -10.0f)),
+        glm::radians(30.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const Frustum frustum(projection, view);
+    const glm::mat3 absModel(glm::abs(glm::vec3(model[0])), glm::abs(glm::vec3(model[1])), glm::abs(glm::vec3(model[2])));
+
+#if defined(__AVX2__)
+    spdlog::info("cullBatch path: AVX2, 8 boxes per iteration");
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    spdlog::info("cullBatch path: SSE2, 4 boxes per iteration");
+#else
+    spdlog::info("cullBatch path: scalar");
+#endif
+    spdlog::info("{:<28} {:>15} {:>10} {:>21}", "Benchmark", "Time", "Iterations", "Throughput");
+
+    int failures = 0;
+    for (size_t boxCount : { size_t(10000), size_t(100000), size_t(1000000) })
+    {
+        const BoxBoundsSoA bounds = makeBoxes(boxCount);
+
+        std::vector<uint64_t> scalarMask;
+        size_t scalarVisible = 0;
+        BenchmarkResult scalar = runBenchmark([&]()
+        {
+            scalarMask.assign((boxCount + 63) / 64, 0);
+            scalarVisible = 0;
+            for (size_t i = 0; i < boxCount; ++i)
+            {
+                const glm::vec3 center(bounds.centerX[i], bounds.centerY[i], bounds.centerZ[i]);
+                const glm::vec3 extent(bounds.extentX[i], bounds.extentY[i], bounds.extentZ[i]);
+                const glm::vec3 worldCenter = glm::vec3(model * glm::vec4(center, 1.0f));
+                const glm::vec3 worldExtent = absModel * extent;
+                if (frustum.isBoxVisible(worldCenter - worldExtent, worldCenter + worldExtent))
+                {
+                    scalarMask[i / 64] |= uint64_t(1) << (i % 64);
+                    scalarVisible++;
+                }
+            }
+        });
+
+        std::vector<uint64_t> batchMask;
+        size_t batchVisible = 0;
+        BenchmarkResult batch = runBenchmark([&]()
+        {
+            batchVisible = frustum.cullBatch(bounds, model, batchMask);
+        });
+
+        report("BM_IsBoxVisible/" + std::to_string(boxCount), scalar, boxCount);
+        report("BM_CullBatch/" + std::to_string(boxCount), batch, boxCount);
+        spdlog::info("  {} of {} visible, speedup {:.2f}x", batchVisible, boxCount,
+            scalar.secondsPerIteration / batch.secondsPerIteration);
+
+        // Both paths do the same math in a different order, so only boxes touching a plane may differ
+        size_t mismatches = 0;
+        for (size_t word = 0; word < scalarMask.size(); ++word)
+        {
+            mismatches += std::popcount(scalarMask[word] ^ batchMask[word]);
+        }
+        if (mismatches > boxCount / 10000)
+        {
+            spdlog::error("  cullBatch disagrees with the scalar test on {} boxes", mismatches);
+            failures++;
+        }
+    }
+
+    return failures == 0 ? 0 : 1;
+}
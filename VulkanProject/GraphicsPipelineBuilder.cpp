@@ -26,8 +26,8 @@ GraphicsPipelineBuilder& GraphicsPipelineBuilder::setSwapChainExtent(VkExtent2D
     return *this;
 }
 
-GraphicsPipelineBuilder& GraphicsPipelineBuilder::setVertexInputBindingDescription(const VkVertexInputBindingDescription& bindingDescription) {
-    m_BindingDescription = bindingDescription;
+GraphicsPipelineBuilder& GraphicsPipelineBuilder::setVertexInputBindingDescriptions(const std::vector<VkVertexInputBindingDescription>& bindingDescriptions) {
+    m_BindingDescriptions = bindingDescriptions;
     m_HasVertexInput = true;
     return *this;
 }
@@ -142,8 +142,8 @@ GraphicsPipeline* GraphicsPipelineBuilder::build() {
     }
     else {
         // Use provided vertex input descriptions
-        vertexInputInfo.vertexBindingDescriptionCount = 1;
-        vertexInputInfo.pVertexBindingDescriptions = &m_BindingDescription;
+        vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(m_BindingDescriptions.size());
+        vertexInputInfo.pVertexBindingDescriptions = m_BindingDescriptions.data();
         vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(m_AttributeDescriptions.size());
         vertexInputInfo.pVertexAttributeDescriptions = m_AttributeDescriptions.data();
     }
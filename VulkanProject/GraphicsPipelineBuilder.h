@@ -13,7 +13,7 @@ public:
     GraphicsPipelineBuilder& setRenderPass(VkRenderPass renderPass);
     GraphicsPipelineBuilder& setDescriptorSetLayout(VkDescriptorSetLayout descriptorSetLayout);
     GraphicsPipelineBuilder& setSwapChainExtent(VkExtent2D extent);
-    GraphicsPipelineBuilder& setVertexInputBindingDescription(const VkVertexInputBindingDescription& bindingDescription);
+    GraphicsPipelineBuilder& setVertexInputBindingDescriptions(const std::vector<VkVertexInputBindingDescription>& bindingDescriptions);
     GraphicsPipelineBuilder& setVertexInputAttributeDescriptions(const std::vector<VkVertexInputAttributeDescription>& attributeDescriptions);
     GraphicsPipelineBuilder& setShaderPaths(const std::string& vertShaderPath, const std::string& fragShaderPath);
     GraphicsPipelineBuilder& setColorFormats(const std::vector<VkFormat>& colorFormats); // Updated to support multiple formats
@@ -35,7 +35,7 @@ private:
     VkRenderPass m_RenderPass{ VK_NULL_HANDLE };
     VkDescriptorSetLayout m_DescriptorSetLayout{ VK_NULL_HANDLE };
     VkExtent2D m_SwapChainExtent{};
-    VkVertexInputBindingDescription m_BindingDescription{};
+    std::vector<VkVertexInputBindingDescription> m_BindingDescriptions{};
     std::vector<VkVertexInputAttributeDescription> m_AttributeDescriptions{};
     std::string m_VertShaderPath;
     std::string m_FragShaderPath;
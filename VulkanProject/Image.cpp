@@ -34,16 +34,18 @@ void Image::createImage(
     VkImageUsageFlags usage,
     VkImageCreateFlags flags,
 	size_t layerCount,
-    VmaMemoryUsage memoryUsage
+    VmaMemoryUsage memoryUsage,
+    uint32_t mipLevels
     )
 {
 	m_Width = width;
 	m_Height = height;
+	m_MipLevels = mipLevels;
 	VkImageCreateInfo imageInfo{};
 	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
 	imageInfo.imageType = VK_IMAGE_TYPE_2D;
 	imageInfo.extent = { width, height, 1 };
-	imageInfo.mipLevels = 1;
+	imageInfo.mipLevels = mipLevels;
 	imageInfo.arrayLayers = layerCount;
 	imageInfo.format = format;
 	imageInfo.tiling = tiling;
@@ -58,10 +60,15 @@ void Image::createImage(
 	{
 		throw std::runtime_error("Failed to create image!");
 	}
-	spdlog::debug("Image created with width: {}, height: {}", width, height);
+	spdlog::debug("Image created with width: {}, height: {}, mip levels: {}", width, height, mipLevels);
 }
 
 VkImageView Image::createImageView(VkFormat format, VkImageAspectFlags aspectFlags) 
+{
+    return createImageView(format, aspectFlags, 0, m_MipLevels);
+}
+
+VkImageView Image::createImageView(VkFormat format, VkImageAspectFlags aspectFlags, uint32_t baseMipLevel, uint32_t levelCount)
 {
     VkImageViewCreateInfo viewInfo{};
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -69,7 +76,8 @@ VkImageView Image::createImageView(VkFormat format, VkImageAspectFlags aspectFla
     viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
     viewInfo.format = format;
     viewInfo.subresourceRange.aspectMask = aspectFlags;
-    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.baseMipLevel = baseMipLevel;
+    viewInfo.subresourceRange.levelCount = levelCount;
     viewInfo.subresourceRange.layerCount = 1;
 
     VkImageView imageView;
@@ -83,6 +91,28 @@ VkImageView Image::createImageView(VkFormat format, VkImageAspectFlags aspectFla
     return imageView;
 }
 
+VkImageView Image::createLayerImageView(VkFormat format, VkImageAspectFlags aspectFlags, VkImageViewType viewType, uint32_t baseLayer, uint32_t layerCount)
+{
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = m_Image;
+    viewInfo.viewType = viewType;
+    viewInfo.format = format;
+    viewInfo.subresourceRange.aspectMask = aspectFlags;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = m_MipLevels;
+    viewInfo.subresourceRange.baseArrayLayer = baseLayer;
+    viewInfo.subresourceRange.layerCount = layerCount;
+
+    VkImageView imageView;
+    if (vkCreateImageView(m_pDevice->get(), &viewInfo, nullptr, &imageView) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create image layer view!");
+    }
+
+    return imageView;
+}
+
 void Image::transitionImageLayout(CommandPool* commandPool, VkQueue graphicsQueue,
     VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout)
 {
@@ -135,7 +165,7 @@ void Image::transitionImageLayout(CommandPool* commandPool, VkQueue graphicsQueu
     }
 
     barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.levelCount = m_MipLevels;
     barrier.subresourceRange.baseArrayLayer = 0;
     barrier.subresourceRange.layerCount = 1;
 
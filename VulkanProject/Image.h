@@ -26,11 +26,16 @@ public:
         VkImageUsageFlags usage,
         VkImageCreateFlags flags,
 		size_t layerCount,
-        VmaMemoryUsage memoryUsage
+        VmaMemoryUsage memoryUsage,
+        uint32_t mipLevels = 1
         );
 
 
     VkImageView createImageView(VkFormat format, VkImageAspectFlags aspectFlags);
+    // View of a range of mip levels, e.g. a single level to bind as a storage image
+    VkImageView createImageView(VkFormat format, VkImageAspectFlags aspectFlags, uint32_t baseMipLevel, uint32_t levelCount);
+    // View of a range of array layers, e.g. one layer to render into or all of them as a 2D array
+    VkImageView createLayerImageView(VkFormat format, VkImageAspectFlags aspectFlags, VkImageViewType viewType, uint32_t baseLayer, uint32_t layerCount);
 
     void transitionImageLayout(CommandPool* commandPool, VkQueue graphicsQueue,
                                VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
@@ -50,6 +55,7 @@ public:
 
 	uint32_t getWidth() const { return m_Width; }
     uint32_t getHeight() const { return m_Height; }
+    uint32_t getMipLevels() const { return m_MipLevels; }
 
 private:
     Device* m_pDevice;
@@ -59,4 +65,5 @@ private:
 	VkImageLayout m_ImageLayout;
 	uint32_t m_Width;
     uint32_t m_Height;
+    uint32_t m_MipLevels = 1;
 };
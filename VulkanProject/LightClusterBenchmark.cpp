@@ -0,0 +1,182 @@
+// Benchmark and correctness check for LightClusterBinner, the CPU reference of the clustered light culling.
+// The check ray casts a room with pillars into a depth buffer, bins random point lights against it and
+// verifies that every light reaching a pixel's reconstructed position is listed in that pixel's cluster.
+
+#include "LightClusters.h"
+#include "Benchmark.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cfloat>
+#include <random>
+#include <string>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+    constexpr uint32_t WIDTH = 1280;
+    constexpr uint32_t HEIGHT = 720;
+
+    // Open-topped room, so rays that leave above the walls see sky
+    const glm::vec3 ROOM_MIN(-10.0f, 0.0f, -60.0f);
+    const glm::vec3 ROOM_MAX(10.0f, 8.0f, 5.0f);
+
+    // Distance along the ray to the box, or FLT_MAX when it is missed
+    float intersectBox(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& boxMin, const glm::vec3& boxMax)
+    {
+        const glm::vec3 t0 = (boxMin - origin) / direction;
+        const glm::vec3 t1 = (boxMax - origin) / direction;
+        const glm::vec3 tNear = glm::min(t0, t1);
+        const glm::vec3 tFar = glm::max(t0, t1);
+        const float enter = std::max(std::max(tNear.x, tNear.y), tNear.z);
+        const float exit = std::min(std::min(tFar.x, tFar.y), tFar.z);
+        return enter <= exit && enter > 0.0f ? enter : FLT_MAX;
+    }
+
+    // Depth buffer of the room seen through view and projection, with a double row of pillars along the nave
+    std::vector<float> renderDepth(const glm::mat4& view, const glm::mat4& projection)
+    {
+        const glm::mat4 inverseViewProjection = glm::inverse(projection * view);
+        const glm::vec3 origin = glm::vec3(glm::inverse(view)[3]);
+
+        std::vector<float> depth(size_t(WIDTH) * HEIGHT, 1.0f);
+        for (uint32_t y = 0; y < HEIGHT; ++y)
+        {
+            for (uint32_t x = 0; x < WIDTH; ++x)
+            {
+                const glm::vec2 ndc = (glm::vec2(x, y) + 0.5f) / glm::vec2(WIDTH, HEIGHT) * 2.0f - 1.0f;
+                const glm::vec4 farPoint = inverseViewProjection * glm::vec4(ndc, 1.0f, 1.0f);
+                const glm::vec3 direction = glm::normalize(glm::vec3(farPoint) / farPoint.w - origin);
+
+                // Inside the room the ray leaves through the farthest plane it is heading for
+                const glm::vec3 exitPlanes = glm::mix(ROOM_MIN, ROOM_MAX, glm::step(glm::vec3(0.0f), direction));
+                const glm::vec3 exits = (exitPlanes - origin) / direction;
+                float distance = std::min(std::min(exits.x, exits.z), direction.y < 0.0f ? exits.y : FLT_MAX);
+                if (origin.y + direction.y * distance > ROOM_MAX.y - 1e-3f)
+                {
+                    continue;
+                }
+
+                for (float z = -4.0f; z > ROOM_MIN.z; z -= 6.0f)
+                {
+                    for (float side : { -5.0f, 5.0f })
+                    {
+                        distance = std::min(distance, intersectBox(origin, direction,
+                            { side - 0.5f, 0.0f, z - 0.5f }, { side + 0.5f, ROOM_MAX.y, z + 0.5f }));
+                    }
+                }
+
+                const glm::vec4 clip = projection * view * glm::vec4(origin + direction * distance, 1.0f);
+                depth[size_t(y) * WIDTH + x] = clip.z / clip.w;
+            }
+        }
+        return depth;
+    }
+}
+
+int main()
+{
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 1.7f, 0.0f), glm::vec3(1.5f, 1.2f, -10.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    // The renderer's projection: Vulkan depth range and a flipped Y
+    glm::mat4 projection = glm::perspectiveRH_ZO(glm::radians(45.0f), float(WIDTH) / float(HEIGHT), 0.001f, 100.0f);
+    projection[1][1] *= -1.0f;
+    const glm::mat4 inverseViewProjection = glm::inverse(projection * view);
+
+    const std::vector<float> depth = renderDepth(view, projection);
+
+    spdlog::info("{:<32} {:>15} {:>10} {:>21}", "Benchmark", "Time", "Iterations", "Throughput");
+
+    int failures = 0;
+    std::mt19937 random(1);
+    for (uint32_t lightCount : { 256u, 1024u, 4096u })
+    {
+        std::uniform_real_distribution<float> x(ROOM_MIN.x, ROOM_MAX.x);
+        std::uniform_real_distribution<float> y(ROOM_MIN.y, ROOM_MAX.y);
+        std::uniform_real_distribution<float> z(ROOM_MIN.z, ROOM_MAX.z);
+        std::uniform_real_distribution<float> radius(0.5f, 3.0f);
+        std::vector<glm::vec4> lights(lightCount);
+        for (glm::vec4& light : lights)
+        {
+            light = glm::vec4(x(random), y(random), z(random), radius(random));
+        }
+
+        LightClusterBinner unboundedBinner;
+        uint32_t unboundedDropped = 0;
+        BenchmarkResult unboundedResult = runBenchmark([&]()
+        {
+            unboundedDropped = unboundedBinner.bin(view, projection, lights.data(), lightCount);
+        });
+
+        LightClusterBinner binner;
+        uint32_t dropped = 0;
+        BenchmarkResult result = runBenchmark([&]()
+        {
+            binner.reduceDepth(depth.data(), WIDTH, HEIGHT, projection);
+            dropped = binner.bin(view, projection, lights.data(), lightCount);
+        });
+
+        const std::string suffix = "/" + std::to_string(lightCount);
+        spdlog::info("{:<32} {:>12.3f} ms {:>10} {:>10.2f} M lights/s", "BM_BinLights" + suffix,
+            unboundedResult.secondsPerIteration * 1e3, unboundedResult.iterations, double(lightCount) / unboundedResult.secondsPerIteration / 1e6);
+        spdlog::info("{:<32} {:>12.3f} ms {:>10} {:>10.2f} M lights/s", "BM_ReduceDepthAndBinLights" + suffix,
+            result.secondsPerIteration * 1e3, result.iterations, double(lightCount) / result.secondsPerIteration / 1e6);
+
+        // Every light that reaches a shaded position has to be in that pixel's cluster
+        uint64_t pixelCount = 0;
+        uint64_t reachingCount = 0;
+        uint64_t listedCount = 0;
+        uint64_t unboundedListedCount = 0;
+        uint64_t missingCount = 0;
+        for (uint32_t pixelY = 0; pixelY < HEIGHT; pixelY += 3)
+        {
+            for (uint32_t pixelX = 0; pixelX < WIDTH; pixelX += 3)
+            {
+                const float pixelDepth = depth[size_t(pixelY) * WIDTH + pixelX];
+                if (pixelDepth >= 1.0f)
+                {
+                    continue;
+                }
+
+                // The same reconstruction as final.frag
+                const glm::vec2 ndc = (glm::vec2(pixelX, pixelY) + 0.5f) / glm::vec2(WIDTH, HEIGHT) * 2.0f - 1.0f;
+                const glm::vec4 positionH = inverseViewProjection * glm::vec4(ndc, pixelDepth, 1.0f);
+                const glm::vec3 position = glm::vec3(positionH) / positionH.w;
+
+                const uint32_t cluster = getLightClusterIndex(getLightClusterTile({ pixelX, pixelY }, { WIDTH, HEIGHT }),
+                    getLightClusterSlice(getLightClusterDepth(pixelDepth, projection)));
+                const uint32_t* pIndices = binner.getLightIndices(cluster);
+                const uint32_t* pIndicesEnd = pIndices + binner.getLightCount(cluster);
+
+                pixelCount++;
+                listedCount += binner.getLightCount(cluster);
+                unboundedListedCount += unboundedBinner.getLightCount(cluster);
+                for (uint32_t light = 0; light < lightCount; ++light)
+                {
+                    // A hair inside the radius, where the attenuation is still above zero
+                    if (glm::length(position - glm::vec3(lights[light])) >= lights[light].w * 0.999f)
+                    {
+                        continue;
+                    }
+                    reachingCount++;
+                    if (std::find(pIndices, pIndicesEnd, light) == pIndicesEnd)
+                    {
+                        missingCount++;
+                    }
+                }
+            }
+        }
+
+        spdlog::info("  per lit pixel: {:.1f} lights reach it, {:.1f} listed with depth bounds, {:.1f} without; {} and {} references dropped from full clusters",
+            double(reachingCount) / double(pixelCount), double(listedCount) / double(pixelCount),
+            double(unboundedListedCount) / double(pixelCount), dropped, unboundedDropped);
+
+        // Dropped references may legitimately be missing; without any, nothing may be
+        if (missingCount > 0 && dropped == 0)
+        {
+            spdlog::error("  {} of {} lights reaching a pixel are missing from its cluster", missingCount, reachingCount);
+            failures++;
+        }
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+// LightClusters.cpp
+#include "LightClusters.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+    // Side planes of a tile's frustum, through the eye with normals pointing inwards
+    void getTilePlanes(glm::uvec2 tile, const glm::mat4& inverseProjection, glm::vec3* pPlanes)
+    {
+        const glm::vec2 gridSize(LIGHT_CLUSTER_GRID_X, LIGHT_CLUSTER_GRID_Y);
+        const glm::vec2 ndcMin = glm::vec2(tile) / gridSize * 2.0f - 1.0f;
+        const glm::vec2 ndcMax = glm::vec2(tile + 1u) / gridSize * 2.0f - 1.0f;
+        const glm::vec2 ndcCorners[4] = { ndcMin, { ndcMax.x, ndcMin.y }, ndcMax, { ndcMin.x, ndcMax.y } };
+
+        glm::vec3 corners[4];
+        for (int i = 0; i < 4; ++i)
+        {
+            const glm::vec4 corner = inverseProjection * glm::vec4(ndcCorners[i], 1.0f, 1.0f);
+            corners[i] = glm::vec3(corner) / corner.w;
+        }
+
+        // The projection may flip an axis, so the winding is not known; the tile's center ray is inside
+        const glm::vec3 center = corners[0] + corners[1] + corners[2] + corners[3];
+        for (int i = 0; i < 4; ++i)
+        {
+            glm::vec3 normal = glm::normalize(glm::cross(corners[i], corners[(i + 1) % 4]));
+            pPlanes[i] = glm::dot(normal, center) < 0.0f ? -normal : normal;
+        }
+    }
+}
+
+float getLightClusterDepth(float depth, const glm::mat4& projection)
+{
+    // Solves depth = (P[2][2] z + P[3][2]) / (P[2][3] z + P[3][3]) for the view-space z
+    const float z = (projection[3][2] - depth * projection[3][3]) / (depth * projection[2][3] - projection[2][2]);
+    return -z;
+}
+
+uint32_t getLightClusterSlice(float viewDepth)
+{
+    if (viewDepth < LIGHT_CLUSTER_NEAR_DEPTH)
+    {
+        return 0;
+    }
+    const float slice = std::log(viewDepth / LIGHT_CLUSTER_NEAR_DEPTH) /
+        std::log(LIGHT_CLUSTER_FAR_DEPTH / LIGHT_CLUSTER_NEAR_DEPTH) * float(LIGHT_CLUSTER_GRID_Z - 1);
+    return std::min(uint32_t(slice) + 1, LIGHT_CLUSTER_GRID_Z - 1);
+}
+
+glm::uvec2 getLightClusterTile(glm::uvec2 pixel, glm::uvec2 viewportSize)
+{
+    const glm::vec2 tile = (glm::vec2(pixel) + 0.5f) * glm::vec2(LIGHT_CLUSTER_GRID_X, LIGHT_CLUSTER_GRID_Y) / glm::vec2(viewportSize);
+    return glm::min(glm::uvec2(tile), glm::uvec2(LIGHT_CLUSTER_GRID_X - 1, LIGHT_CLUSTER_GRID_Y - 1));
+}
+
+uint32_t getLightClusterIndex(glm::uvec2 tile, uint32_t slice)
+{
+    return (slice * LIGHT_CLUSTER_GRID_Y + tile.y) * LIGHT_CLUSTER_GRID_X + tile.x;
+}
+
+void LightClusterBinner::reduceDepth(const float* pDepth, uint32_t width, uint32_t height, const glm::mat4& projection)
+{
+    m_TileDepthRanges.assign(size_t(LIGHT_CLUSTER_GRID_X) * LIGHT_CLUSTER_GRID_Y, glm::vec2(FLT_MAX, 0.0f));
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            // Sky is lit by no point light
+            const float depth = pDepth[size_t(y) * width + x];
+            if (depth >= 1.0f)
+            {
+                continue;
+            }
+
+            const glm::uvec2 tile = getLightClusterTile({ x, y }, { width, height });
+            glm::vec2& range = m_TileDepthRanges[tile.y * LIGHT_CLUSTER_GRID_X + tile.x];
+            const float viewDepth = getLightClusterDepth(depth, projection);
+            range.x = std::min(range.x, viewDepth);
+            range.y = std::max(range.y, viewDepth);
+        }
+    }
+}
+
+uint32_t LightClusterBinner::bin(const glm::mat4& view, const glm::mat4& projection, const glm::vec4* pLights, uint32_t lightCount)
+{
+    m_LightCounts.assign(LIGHT_CLUSTER_COUNT, 0);
+    m_LightIndices.resize(size_t(LIGHT_CLUSTER_COUNT) * MAX_LIGHTS_PER_CLUSTER);
+
+    m_ViewLights.resize(lightCount);
+    for (uint32_t light = 0; light < lightCount; ++light)
+    {
+        m_ViewLights[light] = glm::vec4(glm::vec3(view * glm::vec4(glm::vec3(pLights[light]), 1.0f)), pLights[light].w);
+    }
+
+    const glm::mat4 inverseProjection = glm::inverse(projection);
+    uint32_t droppedCount = 0;
+    for (uint32_t tileY = 0; tileY < LIGHT_CLUSTER_GRID_Y; ++tileY)
+    {
+        for (uint32_t tileX = 0; tileX < LIGHT_CLUSTER_GRID_X; ++tileX)
+        {
+            glm::vec3 planes[4];
+            getTilePlanes({ tileX, tileY }, inverseProjection, planes);
+            const glm::vec2 depthRange = m_TileDepthRanges.empty() ?
+                glm::vec2(0.0f, FLT_MAX) : m_TileDepthRanges[tileY * LIGHT_CLUSTER_GRID_X + tileX];
+
+            for (uint32_t light = 0; light < lightCount; ++light)
+            {
+                const glm::vec3 center(m_ViewLights[light]);
+                const float radius = m_ViewLights[light].w;
+                if (glm::dot(planes[0], center) < -radius || glm::dot(planes[1], center) < -radius ||
+                    glm::dot(planes[2], center) < -radius || glm::dot(planes[3], center) < -radius)
+                {
+                    continue;
+                }
+
+                // Only the part of the sphere's depth range that holds geometry
+                const float nearDepth = std::max(-center.z - radius, depthRange.x);
+                const float farDepth = std::min(-center.z + radius, depthRange.y);
+                if (nearDepth > farDepth)
+                {
+                    continue;
+                }
+
+                const uint32_t lastSlice = getLightClusterSlice(farDepth);
+                for (uint32_t slice = getLightClusterSlice(nearDepth); slice <= lastSlice; ++slice)
+                {
+                    const uint32_t cluster = getLightClusterIndex({ tileX, tileY }, slice);
+                    uint32_t& count = m_LightCounts[cluster];
+                    if (count < MAX_LIGHTS_PER_CLUSTER)
+                    {
+                        m_LightIndices[size_t(cluster) * MAX_LIGHTS_PER_CLUSTER + count++] = light;
+                    }
+                    else
+                    {
+                        droppedCount++;
+                    }
+                }
+            }
+        }
+    }
+    return droppedCount;
+}
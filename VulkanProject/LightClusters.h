@@ -0,0 +1,54 @@
+// LightClusters.h
+#pragma once
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Froxel grid the lighting pass looks its point lights up in: screen tiles, each split into depth slices.
+// light_clusters.glsl mirrors these constants and the mapping functions below.
+constexpr uint32_t LIGHT_CLUSTER_GRID_X = 16;
+constexpr uint32_t LIGHT_CLUSTER_GRID_Y = 9;
+constexpr uint32_t LIGHT_CLUSTER_GRID_Z = 24;
+constexpr uint32_t LIGHT_CLUSTER_COUNT = LIGHT_CLUSTER_GRID_X * LIGHT_CLUSTER_GRID_Y * LIGHT_CLUSTER_GRID_Z;
+// Lights one cluster can list; light_cull.comp drops the rest
+constexpr uint32_t MAX_LIGHTS_PER_CLUSTER = 256;
+// The first slice covers everything nearer than LIGHT_CLUSTER_NEAR_DEPTH. The others split the view depth up to
+// LIGHT_CLUSTER_FAR_DEPTH exponentially, and the last one also takes everything beyond.
+constexpr float LIGHT_CLUSTER_NEAR_DEPTH = 0.1f;
+constexpr float LIGHT_CLUSTER_FAR_DEPTH = 100.0f;
+// Cluster buffer: one light count per cluster, then MAX_LIGHTS_PER_CLUSTER light indices per cluster
+constexpr size_t LIGHT_CLUSTER_BUFFER_SIZE = sizeof(uint32_t) * LIGHT_CLUSTER_COUNT * (1 + MAX_LIGHTS_PER_CLUSTER);
+
+// View depth (distance along -z) of a depth buffer value
+float getLightClusterDepth(float depth, const glm::mat4& projection);
+uint32_t getLightClusterSlice(float viewDepth);
+// Tile of the pixel; tiles split the viewport evenly, so their edges need not fall between pixels
+glm::uvec2 getLightClusterTile(glm::uvec2 pixel, glm::uvec2 viewportSize);
+uint32_t getLightClusterIndex(glm::uvec2 tile, uint32_t slice);
+
+//
+// Reference for light_cull.comp, so light binning can be checked without a GPU.
+//
+class LightClusterBinner
+{
+public:
+    // Nearest and farthest view depth of the geometry in each tile, from width * height depth values row by row.
+    // Tiles that only see sky get an empty range, so no light is binned into them.
+    void reduceDepth(const float* pDepth, uint32_t width, uint32_t height, const glm::mat4& projection);
+
+    // Lists the lights that may reach geometry in each cluster. Each light is a world-space position and a radius
+    // in w. Without a reduced depth buffer every slice a light overlaps is listed.
+    // Returns the light references dropped because their cluster was full; the lowest light indices are kept,
+    // where the shader keeps whichever arrive first.
+    uint32_t bin(const glm::mat4& view, const glm::mat4& projection, const glm::vec4* pLights, uint32_t lightCount);
+
+    uint32_t getLightCount(uint32_t cluster) const { return m_LightCounts[cluster]; }
+    const uint32_t* getLightIndices(uint32_t cluster) const { return &m_LightIndices[size_t(cluster) * MAX_LIGHTS_PER_CLUSTER]; }
+
+private:
+    std::vector<glm::vec2> m_TileDepthRanges;
+    std::vector<glm::vec4> m_ViewLights;
+    std::vector<uint32_t> m_LightCounts;
+    std::vector<uint32_t> m_LightIndices;
+};
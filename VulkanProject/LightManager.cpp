@@ -0,0 +1,184 @@
+// LightManager.cpp
+#include "LightManager.h"
+#include "Buffer.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    // Capacity the buffers start with, and the least they grow by
+    constexpr uint32_t MIN_LIGHT_CAPACITY = 256;
+}
+
+LightManager::LightManager(VmaAllocator allocator, size_t frameCount)
+    : m_Allocator(allocator)
+    , m_Frames(frameCount)
+{
+    for (FrameBuffers& frame : m_Frames)
+    {
+        allocateBuffers(frame, MIN_LIGHT_CAPACITY);
+    }
+}
+
+LightManager::~LightManager()
+{
+    for (FrameBuffers& frame : m_Frames)
+    {
+        delete frame.pSourceBuffer;
+        delete frame.pLightBuffer;
+    }
+}
+
+LightHandle LightManager::addLight(const LightSource& light)
+{
+    uint32_t slot;
+    if (!m_FreeSlots.empty())
+    {
+        slot = m_FreeSlots.back();
+        m_FreeSlots.pop_back();
+    }
+    else
+    {
+        slot = static_cast<uint32_t>(m_Slots.size());
+        m_Slots.push_back({ 0, 0 });
+    }
+
+    const uint32_t lightIndex = static_cast<uint32_t>(m_Lights.size());
+    m_Slots[slot].lightIndex = lightIndex;
+    m_Lights.push_back(light);
+    m_LightSlots.push_back(slot);
+    markDirty(lightIndex);
+
+    return { slot, m_Slots[slot].generation };
+}
+
+void LightManager::removeLight(LightHandle handle)
+{
+    const uint32_t lightIndex = getLightIndex(handle);
+
+    // The last light fills the hole, so only that one index has to be uploaded again
+    const uint32_t lastIndex = static_cast<uint32_t>(m_Lights.size()) - 1;
+    if (lightIndex != lastIndex)
+    {
+        m_Lights[lightIndex] = m_Lights[lastIndex];
+        m_LightSlots[lightIndex] = m_LightSlots[lastIndex];
+        m_Slots[m_LightSlots[lightIndex]].lightIndex = lightIndex;
+        markDirty(lightIndex);
+    }
+    m_Lights.pop_back();
+    m_LightSlots.pop_back();
+
+    m_Slots[handle.slot].generation++;
+    m_FreeSlots.push_back(handle.slot);
+}
+
+void LightManager::updateLight(LightHandle handle, const LightSource& light)
+{
+    const uint32_t lightIndex = getLightIndex(handle);
+    m_Lights[lightIndex] = light;
+    markDirty(lightIndex);
+}
+
+bool LightManager::isValid(LightHandle handle) const
+{
+    // Removal bumps the slot's generation, so handles to removed lights no longer match
+    return handle.slot < m_Slots.size() && m_Slots[handle.slot].generation == handle.generation;
+}
+
+const LightSource& LightManager::getLight(LightHandle handle) const
+{
+    return m_Lights[getLightIndex(handle)];
+}
+
+void LightManager::upload(size_t frameIndex)
+{
+    FrameBuffers& frame = m_Frames[frameIndex];
+    const uint32_t lightCount = getLightCount();
+    if (lightCount > frame.capacity)
+    {
+        allocateBuffers(frame, std::max(lightCount, frame.capacity * 2));
+        frame.dirtyBegin = 0;
+        frame.dirtyEnd = lightCount;
+    }
+
+    // Lights past the count are never read, so indices freed by removals need no upload
+    const uint32_t dirtyEnd = std::min(frame.dirtyEnd, lightCount);
+    if (frame.dirtyBegin < dirtyEnd)
+    {
+        LightSource* pSources = static_cast<LightSource*>(frame.pSourceBuffer->map());
+        memcpy(pSources + frame.dirtyBegin, m_Lights.data() + frame.dirtyBegin, sizeof(LightSource) * (dirtyEnd - frame.dirtyBegin));
+        frame.pSourceBuffer->flush(sizeof(LightSource) * (dirtyEnd - frame.dirtyBegin), sizeof(LightSource) * frame.dirtyBegin);
+    }
+    frame.dirtyBegin = 0;
+    frame.dirtyEnd = 0;
+}
+
+VkBuffer LightManager::getSourceBuffer(size_t frameIndex) const
+{
+    return m_Frames[frameIndex].pSourceBuffer->get();
+}
+
+VkDeviceSize LightManager::getSourceBufferSize(size_t frameIndex) const
+{
+    return sizeof(LightSource) * m_Frames[frameIndex].capacity;
+}
+
+VkBuffer LightManager::getLightBuffer(size_t frameIndex) const
+{
+    return m_Frames[frameIndex].pLightBuffer->get();
+}
+
+VkDeviceSize LightManager::getLightBufferSize(size_t frameIndex) const
+{
+    return sizeof(LightsBufferHeader) + sizeof(Light) * m_Frames[frameIndex].capacity;
+}
+
+uint32_t LightManager::getLightIndex(LightHandle handle) const
+{
+    if (!isValid(handle))
+    {
+        throw std::runtime_error("Invalid light handle!");
+    }
+    return m_Slots[handle.slot].lightIndex;
+}
+
+void LightManager::markDirty(uint32_t lightIndex)
+{
+    for (FrameBuffers& frame : m_Frames)
+    {
+        if (frame.dirtyBegin >= frame.dirtyEnd)
+        {
+            frame.dirtyBegin = lightIndex;
+            frame.dirtyEnd = lightIndex + 1;
+        }
+        else
+        {
+            frame.dirtyBegin = std::min(frame.dirtyBegin, lightIndex);
+            frame.dirtyEnd = std::max(frame.dirtyEnd, lightIndex + 1);
+        }
+    }
+}
+
+void LightManager::allocateBuffers(FrameBuffers& frame, uint32_t capacity)
+{
+    delete frame.pSourceBuffer;
+    delete frame.pLightBuffer;
+
+    frame.capacity = std::max(capacity, MIN_LIGHT_CAPACITY);
+    frame.pSourceBuffer = new Buffer(
+        m_Allocator,
+        sizeof(LightSource) * frame.capacity,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VMA_MEMORY_USAGE_CPU_TO_GPU,
+        VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+        VMA_ALLOCATION_CREATE_MAPPED_BIT
+    );
+    frame.pLightBuffer = new Buffer(
+        m_Allocator,
+        sizeof(LightsBufferHeader) + sizeof(Light) * frame.capacity,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY
+    );
+    frame.bufferGeneration++;
+}
@@ -0,0 +1,124 @@
+// LightManager.h
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+class Buffer;
+
+// Parametric animations light_animate.comp evaluates each frame; a light may combine them
+enum LightAnimation : uint32_t
+{
+    LIGHT_ANIMATION_NONE = 0,
+    // Moves along an ellipse around its position in the horizontal plane
+    LIGHT_ANIMATION_ORBIT = 1 << 0,
+    // Scales its intensity between 1 and 1 + pulseAmount
+    LIGHT_ANIMATION_PULSE = 1 << 1
+};
+
+// A point light as stored on the GPU; matches LightSource in light_animate.comp
+struct LightSource
+{
+    alignas(16) glm::vec3 position;
+    float intensity = 1.0f;
+    alignas(16) glm::vec3 color;
+    float radius = 1.0f;
+    // Radii of the orbit along x and z, its angular speed in radians per second and the phase of both animations
+    glm::vec2 orbitExtent{ 0.0f };
+    float orbitSpeed = 0.0f;
+    float phase = 0.0f;
+    float pulseAmount = 0.0f;
+    float pulseSpeed = 0.0f;
+    uint32_t animation = LIGHT_ANIMATION_NONE;
+    float padding = 0.0f;
+};
+static_assert(sizeof(LightSource) == 64, "LightSource must match its std430 layout");
+
+// A light as the culling and lighting passes read it, after animation; matches Light in light_cull.comp and final.frag
+struct Light
+{
+    alignas(16) glm::vec3 position;
+    alignas(16) glm::vec3 color;
+    alignas(4) float intensity;
+    alignas(4) float radius;
+};
+
+// Start of LightsBuffer; the light array follows at its 16-byte alignment
+struct LightsBufferHeader
+{
+    alignas(16) uint32_t lightCount;
+};
+
+// Stays valid until its light is removed; a handle of a removed light never matches a later one
+struct LightHandle
+{
+    uint32_t slot = UINT32_MAX;
+    uint32_t generation = 0;
+};
+
+//
+// Owns the scene's point lights. Lights are kept densely packed for the GPU and addressed by handle,
+// so removing one moves the last light into its place. Each frame in flight has its own source buffer,
+// which only receives the lights changed since that frame's last upload, and its own animated light buffer,
+// which light_animate.comp fills from the sources. Both grow when the light count outgrows them.
+//
+class LightManager
+{
+public:
+    LightManager(VmaAllocator allocator, size_t frameCount);
+    ~LightManager();
+
+    LightManager(const LightManager&) = delete;
+    LightManager& operator=(const LightManager&) = delete;
+
+    LightHandle addLight(const LightSource& light);
+    void removeLight(LightHandle handle);
+    void updateLight(LightHandle handle, const LightSource& light);
+    bool isValid(LightHandle handle) const;
+    const LightSource& getLight(LightHandle handle) const;
+    uint32_t getLightCount() const { return static_cast<uint32_t>(m_Lights.size()); }
+
+    // Writes the lights changed since this frame's last upload, reallocating its buffers if they are too small.
+    // The frame must not be in flight.
+    void upload(size_t frameIndex);
+
+    VkBuffer getSourceBuffer(size_t frameIndex) const;
+    VkDeviceSize getSourceBufferSize(size_t frameIndex) const;
+    VkBuffer getLightBuffer(size_t frameIndex) const;
+    VkDeviceSize getLightBufferSize(size_t frameIndex) const;
+    // Incremented whenever the frame's buffers are reallocated, so descriptor sets know when to refresh
+    uint64_t getBufferGeneration(size_t frameIndex) const { return m_Frames[frameIndex].bufferGeneration; }
+
+private:
+    struct Slot
+    {
+        uint32_t lightIndex;
+        uint32_t generation;
+    };
+
+    struct FrameBuffers
+    {
+        Buffer* pSourceBuffer = nullptr;
+        Buffer* pLightBuffer = nullptr;
+        uint32_t capacity = 0;
+        uint64_t bufferGeneration = 0;
+        // Light indices changed since the last upload; empty when dirtyBegin >= dirtyEnd
+        uint32_t dirtyBegin = 0;
+        uint32_t dirtyEnd = 0;
+    };
+
+    uint32_t getLightIndex(LightHandle handle) const;
+    void markDirty(uint32_t lightIndex);
+    void allocateBuffers(FrameBuffers& frame, uint32_t capacity);
+
+    VmaAllocator m_Allocator;
+    std::vector<LightSource> m_Lights;
+    // Slot of each light, in light order
+    std::vector<uint32_t> m_LightSlots;
+    std::vector<Slot> m_Slots;
+    std::vector<uint32_t> m_FreeSlots;
+    std::vector<FrameBuffers> m_Frames;
+};
@@ -0,0 +1,102 @@
+#include "MappedFile.h"
+#include <spdlog/spdlog.h>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path)
+{
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+    m_FileHandle = file;
+
+    LARGE_INTEGER fileSize{};
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        return;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+        return;
+    }
+    m_MappingHandle = mapping;
+
+    m_pData = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_pData)
+    {
+        m_Size = static_cast<size_t>(fileSize.QuadPart);
+        spdlog::debug("Mapped file {} ({} bytes)", path, m_Size);
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_pData)
+    {
+        UnmapViewOfFile(m_pData);
+    }
+    if (m_MappingHandle)
+    {
+        CloseHandle(static_cast<HANDLE>(m_MappingHandle));
+    }
+    if (m_FileHandle)
+    {
+        CloseHandle(static_cast<HANDLE>(m_FileHandle));
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path)
+{
+    m_FileDescriptor = open(path.c_str(), O_RDONLY);
+    if (m_FileDescriptor < 0)
+    {
+        return;
+    }
+
+    struct stat fileStat{};
+    if (fstat(m_FileDescriptor, &fileStat) != 0 || fileStat.st_size == 0)
+    {
+        return;
+    }
+
+    void* data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, m_FileDescriptor, 0);
+    if (data != MAP_FAILED)
+    {
+        m_pData = static_cast<const unsigned char*>(data);
+        m_Size = static_cast<size_t>(fileStat.st_size);
+        spdlog::debug("Mapped file {} ({} bytes)", path, m_Size);
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_pData)
+    {
+        munmap(const_cast<unsigned char*>(m_pData), m_Size);
+    }
+    if (m_FileDescriptor >= 0)
+    {
+        close(m_FileDescriptor);
+    }
+}
+
+#endif
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+//
+// Read-only memory mapping of a whole file.
+// Used to load cooked assets without copying them through an ifstream first.
+//
+class MappedFile
+{
+public:
+    MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isValid() const { return m_pData != nullptr; }
+    const unsigned char* getData() const { return m_pData; }
+    size_t getSize() const { return m_Size; }
+
+private:
+    const unsigned char* m_pData = nullptr;
+    size_t m_Size = 0;
+
+#ifdef _WIN32
+    void* m_FileHandle = nullptr;
+    void* m_MappingHandle = nullptr;
+#else
+    int m_FileDescriptor = -1;
+#endif
+};
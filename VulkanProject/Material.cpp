@@ -9,8 +9,5 @@ Material::Material()
 
 Material::~Material()
 {
-    // Destructor implementation (clean up resources)
-    delete pDiffuseTexture;
-    delete pNormalTexture;
-    delete pMetallicRoughnessTexture;
+    // Textures are owned by the TextureCache
 }
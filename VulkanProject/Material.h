@@ -14,3 +14,12 @@ public:
     Texture* pNormalTexture;
 	Texture* pMetallicRoughnessTexture;
 };
+
+// One entry of the material storage buffer (std430); the fields index the bindless texture array
+struct MaterialData
+{
+    uint32_t diffuseTextureIndex;
+    uint32_t normalTextureIndex;
+    uint32_t metallicRoughnessTextureIndex;
+    uint32_t padding;
+};
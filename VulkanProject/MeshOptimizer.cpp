@@ -0,0 +1,210 @@
+// MeshOptimizer.cpp
+#include "MeshOptimizer.h"
+#include <algorithm>
+
+namespace
+{
+    // Maps the vertices an index list references to 0..count-1, keeping their relative order
+    uint32_t compactIndices(const uint32_t* pIndices, size_t indexCount, std::vector<uint32_t>& localIndices)
+    {
+        std::vector<uint32_t> vertices(pIndices, pIndices + indexCount);
+        std::sort(vertices.begin(), vertices.end());
+        vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+
+        localIndices.resize(indexCount);
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            localIndices[i] = static_cast<uint32_t>(std::lower_bound(vertices.begin(), vertices.end(), pIndices[i]) - vertices.begin());
+        }
+        return static_cast<uint32_t>(vertices.size());
+    }
+}
+
+VertexCacheStatistics& VertexCacheStatistics::operator+=(const VertexCacheStatistics& other)
+{
+    triangleCount += other.triangleCount;
+    vertexCount += other.vertexCount;
+    missCount += other.missCount;
+    return *this;
+}
+
+void buildTriangleAdjacency(const uint32_t* pIndices, size_t indexCount, uint32_t vertexCount, TriangleAdjacency& adjacency)
+{
+    const uint32_t triangleCount = static_cast<uint32_t>(indexCount / 3);
+
+    adjacency.offsets.assign(size_t(vertexCount) + 1, 0);
+    for (size_t i = 0; i < size_t(triangleCount) * 3; ++i)
+    {
+        adjacency.offsets[pIndices[i] + 1]++;
+    }
+    for (uint32_t i = 0; i < vertexCount; ++i)
+    {
+        adjacency.offsets[i + 1] += adjacency.offsets[i];
+    }
+
+    adjacency.triangles.resize(size_t(triangleCount) * 3);
+    std::vector<uint32_t> fill(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+    for (uint32_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        for (uint32_t corner = 0; corner < 3; ++corner)
+        {
+            adjacency.triangles[fill[pIndices[triangle * 3 + corner]]++] = triangle;
+        }
+    }
+}
+
+void optimizeVertexCache(uint32_t* pIndices, size_t indexCount, uint32_t cacheSize)
+{
+    const uint32_t triangleCount = static_cast<uint32_t>(indexCount / 3);
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    std::vector<uint32_t> localIndices;
+    const uint32_t vertexCount = compactIndices(pIndices, size_t(triangleCount) * 3, localIndices);
+
+    TriangleAdjacency adjacency;
+    buildTriangleAdjacency(localIndices.data(), localIndices.size(), vertexCount, adjacency);
+
+    // Triangles still to be emitted around each vertex
+    std::vector<uint32_t> liveTriangles(vertexCount);
+    for (uint32_t i = 0; i < vertexCount; ++i)
+    {
+        liveTriangles[i] = adjacency.offsets[i + 1] - adjacency.offsets[i];
+    }
+
+    // A vertex is in the cache while timestamp - cacheTimes[vertex] <= cacheSize
+    std::vector<uint32_t> cacheTimes(vertexCount, 0);
+    uint32_t timestamp = cacheSize + 1;
+
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> deadEnds;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> output;
+    output.reserve(localIndices.size());
+    uint32_t cursor = 0;
+
+    int64_t fanVertex = localIndices[0];
+    while (fanVertex >= 0)
+    {
+        // Emit every remaining triangle around the fanning vertex
+        candidates.clear();
+        for (uint32_t i = adjacency.offsets[fanVertex]; i < adjacency.offsets[fanVertex + 1]; ++i)
+        {
+            const uint32_t triangle = adjacency.triangles[i];
+            if (emitted[triangle])
+            {
+                continue;
+            }
+
+            for (uint32_t corner = 0; corner < 3; ++corner)
+            {
+                const uint32_t vertex = localIndices[triangle * 3 + corner];
+                output.push_back(triangle * 3 + corner);
+                deadEnds.push_back(vertex);
+                candidates.push_back(vertex);
+                liveTriangles[vertex]--;
+                if (timestamp - cacheTimes[vertex] > cacheSize)
+                {
+                    cacheTimes[vertex] = timestamp++;
+                }
+            }
+            emitted[triangle] = 1;
+        }
+
+        // Next fan around the oldest candidate that stays cached while its own fan is emitted
+        fanVertex = -1;
+        int64_t bestPriority = -1;
+        for (uint32_t vertex : candidates)
+        {
+            if (liveTriangles[vertex] == 0)
+            {
+                continue;
+            }
+
+            int64_t priority = 0;
+            if (timestamp - cacheTimes[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+            {
+                priority = timestamp - cacheTimes[vertex];
+            }
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                fanVertex = vertex;
+            }
+        }
+
+        // Dead end: back up through recently used vertices, then scan for any vertex with triangles left
+        while (fanVertex < 0 && !deadEnds.empty())
+        {
+            const uint32_t vertex = deadEnds.back();
+            deadEnds.pop_back();
+            if (liveTriangles[vertex] > 0)
+            {
+                fanVertex = vertex;
+            }
+        }
+        while (fanVertex < 0 && cursor < vertexCount)
+        {
+            if (liveTriangles[cursor] > 0)
+            {
+                fanVertex = cursor;
+            }
+            cursor++;
+        }
+    }
+
+    // output holds positions in the original list; translate them back to the caller's indices
+    std::vector<uint32_t> reordered(output.size());
+    for (size_t i = 0; i < output.size(); ++i)
+    {
+        reordered[i] = pIndices[output[i]];
+    }
+    std::copy(reordered.begin(), reordered.end(), pIndices);
+}
+
+void optimizeVertexFetch(uint32_t* pIndices, size_t indexCount, size_t vertexCount, std::vector<uint32_t>& remap)
+{
+    remap.assign(vertexCount, UINT32_MAX);
+    uint32_t nextVertex = 0;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        uint32_t& newIndex = remap[pIndices[i]];
+        if (newIndex == UINT32_MAX)
+        {
+            newIndex = nextVertex++;
+        }
+        pIndices[i] = newIndex;
+    }
+
+    for (uint32_t& newIndex : remap)
+    {
+        if (newIndex == UINT32_MAX)
+        {
+            newIndex = nextVertex++;
+        }
+    }
+}
+
+VertexCacheStatistics analyzeVertexCache(const uint32_t* pIndices, size_t indexCount, uint32_t cacheSize)
+{
+    VertexCacheStatistics statistics;
+    statistics.triangleCount = indexCount / 3;
+
+    std::vector<uint32_t> localIndices;
+    statistics.vertexCount = compactIndices(pIndices, indexCount, localIndices);
+
+    std::vector<uint32_t> cache(cacheSize, UINT32_MAX);
+    uint32_t cacheHead = 0;
+    for (uint32_t vertex : localIndices)
+    {
+        if (std::find(cache.begin(), cache.end(), vertex) == cache.end())
+        {
+            statistics.missCount++;
+            cache[cacheHead] = vertex;
+            cacheHead = (cacheHead + 1) % cacheSize;
+        }
+    }
+    return statistics;
+}
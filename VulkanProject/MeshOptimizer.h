@@ -0,0 +1,46 @@
+// MeshOptimizer.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// FIFO entries assumed for the post-transform cache, both when optimizing and when measuring
+constexpr uint32_t VERTEX_CACHE_SIZE = 16;
+
+// Post-transform cache behaviour of an index list, as simulated by analyzeVertexCache
+struct VertexCacheStatistics
+{
+    uint64_t triangleCount = 0;
+    uint64_t vertexCount = 0;    // distinct vertices referenced
+    uint64_t missCount = 0;      // vertex shader invocations
+
+    // Average cache miss ratio: misses per triangle, between 0.5 for a large regular grid and 3
+    float getAcmr() const { return triangleCount ? float(missCount) / float(triangleCount) : 0.0f; }
+    // Average transformed vertex ratio: misses per vertex, 1 at best
+    float getAtvr() const { return vertexCount ? float(missCount) / float(vertexCount) : 0.0f; }
+
+    VertexCacheStatistics& operator+=(const VertexCacheStatistics& other);
+};
+
+// Triangles around each vertex of an index list, as ranges of one flat array:
+// vertex v is used by triangles[offsets[v]] up to triangles[offsets[v + 1]]
+struct TriangleAdjacency
+{
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> triangles;
+};
+
+// Indices must lie in 0..vertexCount-1; a trailing partial triangle is ignored
+void buildTriangleAdjacency(const uint32_t* pIndices, size_t indexCount, uint32_t vertexCount, TriangleAdjacency& adjacency);
+
+// Reorders the triangles of an index list for the post-transform cache with Tipsify
+// (Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw").
+void optimizeVertexCache(uint32_t* pIndices, size_t indexCount, uint32_t cacheSize = VERTEX_CACHE_SIZE);
+
+// Numbers vertices in the order the indices first reference them, so vertex fetches walk memory forwards.
+// Rewrites the indices and fills remap with the new position of every old vertex; unreferenced vertices
+// are moved to the end.
+void optimizeVertexFetch(uint32_t* pIndices, size_t indexCount, size_t vertexCount, std::vector<uint32_t>& remap);
+
+// Counts cache misses with a FIFO cache of cacheSize entries
+VertexCacheStatistics analyzeVertexCache(const uint32_t* pIndices, size_t indexCount, uint32_t cacheSize = VERTEX_CACHE_SIZE);
@@ -0,0 +1,272 @@
+// Meshlet.cpp
+#include "Meshlet.h"
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <unordered_map>
+
+namespace
+{
+    const glm::vec3& getPosition(const glm::vec3* pPositions, size_t positionStride, uint32_t index)
+    {
+        return *reinterpret_cast<const glm::vec3*>(reinterpret_cast<const char*>(pPositions) + size_t(index) * positionStride);
+    }
+
+    // Bounds and normal cone of the triangles in pIndices[0, indexCount)
+    Meshlet computeMeshlet(const glm::vec3* pPositions, size_t positionStride, const uint32_t* pIndices,
+        uint32_t indexStart, uint32_t indexCount)
+    {
+        Meshlet meshlet{};
+        meshlet.indexStart = indexStart;
+        meshlet.indexCount = indexCount;
+        meshlet.boundsMin = glm::vec3(FLT_MAX);
+        meshlet.boundsMax = glm::vec3(-FLT_MAX);
+
+        std::array<glm::vec3, MAX_MESHLET_TRIANGLES> normals;
+        uint32_t normalCount = 0;
+        glm::vec3 normalSum(0.0f);
+        for (uint32_t i = 0; i < indexCount; i += 3)
+        {
+            const glm::vec3& a = getPosition(pPositions, positionStride, pIndices[i]);
+            const glm::vec3& b = getPosition(pPositions, positionStride, pIndices[i + 1]);
+            const glm::vec3& c = getPosition(pPositions, positionStride, pIndices[i + 2]);
+            meshlet.boundsMin = glm::min(meshlet.boundsMin, glm::min(a, glm::min(b, c)));
+            meshlet.boundsMax = glm::max(meshlet.boundsMax, glm::max(a, glm::max(b, c)));
+
+            // Counter-clockwise triangles face along this normal; degenerate ones face nowhere
+            glm::vec3 normal = glm::cross(b - a, c - a);
+            float length = glm::length(normal);
+            if (length > 0.0f)
+            {
+                normals[normalCount++] = normal / length;
+                normalSum += normal / length;
+            }
+        }
+
+        meshlet.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+        meshlet.coneCutoff = 1.0f;
+
+        float axisLength = glm::length(normalSum);
+        if (normalCount == 0 || axisLength < 1e-6f)
+        {
+            return meshlet;
+        }
+
+        glm::vec3 axis = normalSum / axisLength;
+        float minDot = 1.0f;
+        for (uint32_t i = 0; i < normalCount; ++i)
+        {
+            minDot = std::min(minDot, glm::dot(normals[i], axis));
+        }
+
+        // A cone as wide as a hemisphere has some triangle facing every direction. Otherwise the cutoff is the
+        // sine of the cone's half angle: views closer than that to the axis see only back faces.
+        meshlet.coneAxis = axis;
+        if (minDot > 0.0f)
+        {
+            meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+        }
+        return meshlet;
+    }
+}
+
+void buildMeshlets(const glm::vec3* pPositions, size_t positionStride, uint32_t* pIndices, uint32_t indexCount,
+    uint32_t firstIndex, std::vector<Meshlet>& meshlets)
+{
+    const uint32_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    // Number the vertices of this range locally so the adjacency only spans what it uses
+    std::unordered_map<uint32_t, uint32_t> localVertices;
+    localVertices.reserve(indexCount);
+    std::vector<uint32_t> localIndices(size_t(triangleCount) * 3);
+    for (size_t i = 0; i < localIndices.size(); ++i)
+    {
+        auto [it, inserted] = localVertices.try_emplace(pIndices[i], static_cast<uint32_t>(localVertices.size()));
+        localIndices[i] = it->second;
+    }
+    const uint32_t vertexCount = static_cast<uint32_t>(localVertices.size());
+
+    TriangleAdjacency adjacency;
+    buildTriangleAdjacency(localIndices.data(), localIndices.size(), vertexCount, adjacency);
+
+    std::vector<glm::vec3> centroids(triangleCount);
+    for (uint32_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        centroids[triangle] = (getPosition(pPositions, positionStride, pIndices[triangle * 3]) +
+            getPosition(pPositions, positionStride, pIndices[triangle * 3 + 1]) +
+            getPosition(pPositions, positionStride, pIndices[triangle * 3 + 2])) / 3.0f;
+    }
+
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    // Tag of the meshlet each vertex was last added to; bumping the tag empties the meshlet without a clear
+    std::vector<uint32_t> vertexTags(vertexCount, 0);
+    uint32_t meshletTag = 1;
+    std::vector<uint32_t> meshletVertices;
+    meshletVertices.reserve(MAX_MESHLET_VERTICES);
+    uint32_t meshletTriangleCount = 0;
+    glm::vec3 meshletMin(FLT_MAX);
+    glm::vec3 meshletMax(-FLT_MAX);
+
+    std::vector<uint32_t> reordered;
+    reordered.reserve(localIndices.size());
+    uint32_t meshletIndexStart = 0;
+    uint32_t nextSeed = 0;
+
+    auto countNewVertices = [&](uint32_t triangle)
+    {
+        uint32_t count = 0;
+        for (uint32_t corner = 0; corner < 3; ++corner)
+        {
+            count += vertexTags[localIndices[triangle * 3 + corner]] != meshletTag ? 1 : 0;
+        }
+        return count;
+    };
+
+    auto addTriangle = [&](uint32_t triangle)
+    {
+        emitted[triangle] = 1;
+        for (uint32_t corner = 0; corner < 3; ++corner)
+        {
+            uint32_t vertex = localIndices[triangle * 3 + corner];
+            if (vertexTags[vertex] != meshletTag)
+            {
+                vertexTags[vertex] = meshletTag;
+                meshletVertices.push_back(vertex);
+            }
+            reordered.push_back(pIndices[triangle * 3 + corner]);
+        }
+        meshletMin = glm::min(meshletMin, centroids[triangle]);
+        meshletMax = glm::max(meshletMax, centroids[triangle]);
+        meshletTriangleCount++;
+    };
+
+    auto finishCurrent = [&]()
+    {
+        const uint32_t meshletIndexCount = static_cast<uint32_t>(reordered.size()) - meshletIndexStart;
+        meshlets.push_back(computeMeshlet(pPositions, positionStride, reordered.data() + meshletIndexStart,
+            firstIndex + meshletIndexStart, meshletIndexCount));
+
+        meshletIndexStart = static_cast<uint32_t>(reordered.size());
+        meshletTag++;
+        meshletVertices.clear();
+        meshletTriangleCount = 0;
+        meshletMin = glm::vec3(FLT_MAX);
+        meshletMax = glm::vec3(-FLT_MAX);
+    };
+
+    for (uint32_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+    {
+        // Grow across shared vertices: fewest new vertices first, then the triangle nearest the meshlet's center
+        const glm::vec3 center = (meshletMin + meshletMax) * 0.5f;
+        uint32_t bestTriangle = UINT32_MAX;
+        uint32_t bestNewVertices = 4;
+        float bestDistance = FLT_MAX;
+        for (uint32_t vertex : meshletVertices)
+        {
+            for (uint32_t i = adjacency.offsets[vertex]; i < adjacency.offsets[vertex + 1]; ++i)
+            {
+                uint32_t triangle = adjacency.triangles[i];
+                if (emitted[triangle])
+                {
+                    continue;
+                }
+
+                uint32_t newVertices = countNewVertices(triangle);
+                if (meshletVertices.size() + newVertices > MAX_MESHLET_VERTICES)
+                {
+                    continue;
+                }
+
+                glm::vec3 offset = centroids[triangle] - center;
+                float distance = glm::dot(offset, offset);
+                if (newVertices < bestNewVertices || (newVertices == bestNewVertices && distance < bestDistance))
+                {
+                    bestTriangle = triangle;
+                    bestNewVertices = newVertices;
+                    bestDistance = distance;
+                }
+            }
+        }
+
+        // Nothing connected fits, so continue with the next triangle in the source order.
+        // Small disconnected pieces stay together this way instead of each becoming a tiny meshlet.
+        if (bestTriangle == UINT32_MAX)
+        {
+            while (emitted[nextSeed])
+            {
+                nextSeed++;
+            }
+            bestTriangle = nextSeed;
+            if (meshletVertices.size() + countNewVertices(bestTriangle) > MAX_MESHLET_VERTICES)
+            {
+                finishCurrent();
+            }
+        }
+
+        addTriangle(bestTriangle);
+        if (meshletTriangleCount == MAX_MESHLET_TRIANGLES)
+        {
+            finishCurrent();
+        }
+    }
+
+    if (meshletTriangleCount > 0)
+    {
+        finishCurrent();
+    }
+
+    std::copy(reordered.begin(), reordered.end(), pIndices);
+}
+
+void sortMeshletsForOverdraw(uint32_t* pIndices, uint32_t firstIndex, Meshlet* pMeshlets, size_t meshletCount)
+{
+    if (meshletCount < 2)
+    {
+        return;
+    }
+
+    // Center of the whole range, weighting each meshlet by its triangles
+    glm::vec3 meshCenter(0.0f);
+    uint32_t rangeStart = UINT32_MAX;
+    uint32_t rangeIndexCount = 0;
+    for (size_t i = 0; i < meshletCount; ++i)
+    {
+        const Meshlet& meshlet = pMeshlets[i];
+        meshCenter += (meshlet.boundsMin + meshlet.boundsMax) * 0.5f * float(meshlet.indexCount);
+        rangeStart = std::min(rangeStart, meshlet.indexStart);
+        rangeIndexCount += meshlet.indexCount;
+    }
+    meshCenter /= float(rangeIndexCount);
+
+    // How far a meshlet faces away from the center
+    std::vector<float> scores(meshletCount);
+    std::vector<uint32_t> order(meshletCount);
+    for (size_t i = 0; i < meshletCount; ++i)
+    {
+        const Meshlet& meshlet = pMeshlets[i];
+        scores[i] = glm::dot((meshlet.boundsMin + meshlet.boundsMax) * 0.5f - meshCenter, meshlet.coneAxis);
+        order[i] = static_cast<uint32_t>(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return scores[a] > scores[b]; });
+
+    const uint32_t* pRange = pIndices + (rangeStart - firstIndex);
+    std::vector<uint32_t> reordered;
+    reordered.reserve(rangeIndexCount);
+    std::vector<Meshlet> sorted(meshletCount);
+    for (size_t i = 0; i < meshletCount; ++i)
+    {
+        sorted[i] = pMeshlets[order[i]];
+        const uint32_t* pSource = pRange + (sorted[i].indexStart - rangeStart);
+        sorted[i].indexStart = rangeStart + static_cast<uint32_t>(reordered.size());
+        reordered.insert(reordered.end(), pSource, pSource + sorted[i].indexCount);
+    }
+
+    std::copy(reordered.begin(), reordered.end(), pIndices + (rangeStart - firstIndex));
+    std::copy(sorted.begin(), sorted.end(), pMeshlets);
+}
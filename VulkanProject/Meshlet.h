@@ -0,0 +1,37 @@
+// Meshlet.h
+#pragma once
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 64 vertices and 124 triangles keep a meshlet within common mesh shader output limits
+constexpr uint32_t MAX_MESHLET_VERTICES = 64;
+constexpr uint32_t MAX_MESHLET_TRIANGLES = 124;
+
+//
+// A small cluster of triangles that is culled as a unit. Its triangles form one contiguous index range,
+// so a meshlet is drawn as an ordinary indexed draw. Matches the Meshlet struct in meshlet_cull.comp.
+//
+struct Meshlet
+{
+    glm::vec3 boundsMin;
+    uint32_t indexStart;
+    glm::vec3 boundsMax;
+    uint32_t indexCount;
+    // Every triangle normal lies within the cone around coneAxis. A coneCutoff of 1 never culls;
+    // see MeshletCuller::isBackfacing for the test.
+    glm::vec3 coneAxis;
+    float coneCutoff;
+};
+
+// Splits the triangles of one index range into meshlets, growing each one across shared vertices.
+// Triangles are reordered in place so every meshlet is contiguous; firstIndex is the position of
+// pIndices in the model's index buffer. Positions are read with the given stride in bytes.
+void buildMeshlets(const glm::vec3* pPositions, size_t positionStride, uint32_t* pIndices, uint32_t indexCount,
+    uint32_t firstIndex, std::vector<Meshlet>& meshlets);
+
+// Reorders meshlets built from one index range so outward-facing ones come first, following the cluster
+// sort of Sander et al.: drawn from outside, they tend to cover the meshlets behind them, which then fail
+// the depth test before shading. Moves the index ranges to match; pIndices is at firstIndex as above.
+void sortMeshletsForOverdraw(uint32_t* pIndices, uint32_t firstIndex, Meshlet* pMeshlets, size_t meshletCount);
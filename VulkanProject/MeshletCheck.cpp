@@ -0,0 +1,370 @@
+// Correctness check for buildMeshlets and MeshletCuller, the CPU reference of meshlet_cull.comp.
+// Meshlets built from small known meshes are compared with hand-computed bounds and normal cones, and
+// the frustum, cone and Hi-Z tests with hand-placed boxes and cameras. A shuffled sphere then checks
+// the builder's limits and that no meshlet the cone test rejects has a triangle facing the camera.
+
+#include "Meshlet.h"
+#include "MeshletCuller.h"
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <set>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+    int g_Failures = 0;
+
+    void check(bool condition, const char* description)
+    {
+        if (!condition)
+        {
+            spdlog::error("  failed: {}", description);
+            g_Failures++;
+        }
+    }
+
+    bool isNear(float a, float b)
+    {
+        return std::abs(a - b) <= 1e-5f;
+    }
+
+    bool isNear(const glm::vec3& a, const glm::vec3& b)
+    {
+        return isNear(a.x, b.x) && isNear(a.y, b.y) && isNear(a.z, b.z);
+    }
+
+    std::vector<Meshlet> buildAll(const std::vector<glm::vec3>& positions, std::vector<uint32_t>& indices)
+    {
+        std::vector<Meshlet> meshlets;
+        buildMeshlets(positions.data(), sizeof(glm::vec3), indices.data(), static_cast<uint32_t>(indices.size()), 0, meshlets);
+        return meshlets;
+    }
+
+    // n x n quads in the z = 0 plane over [0, n]^2, counter-clockwise seen from +z
+    void makeGrid(uint32_t n, std::vector<glm::vec3>& positions, std::vector<uint32_t>& indices)
+    {
+        for (uint32_t y = 0; y <= n; ++y)
+        {
+            for (uint32_t x = 0; x <= n; ++x)
+            {
+                positions.push_back(glm::vec3(float(x), float(y), 0.0f));
+            }
+        }
+        for (uint32_t y = 0; y < n; ++y)
+        {
+            for (uint32_t x = 0; x < n; ++x)
+            {
+                const uint32_t a = y * (n + 1) + x;
+                const uint32_t b = a + n + 1;
+                indices.insert(indices.end(), { a, a + 1, b + 1, a, b + 1, b });
+            }
+        }
+    }
+
+    void checkKnownMeshes()
+    {
+        spdlog::info("Known meshes");
+
+        // Two triangles folded at a right angle, facing +z and +x: the axis halves them and the
+        // cutoff is the sine of the 45 degree half angle
+        {
+            std::vector<glm::vec3> positions = { { 0, 0, 0 }, { 0, 1, 0 }, { -1, 0, 0 }, { 0, 0, -1 } };
+            std::vector<uint32_t> indices = { 0, 1, 2, 0, 3, 1 };
+            const std::vector<Meshlet> meshlets = buildAll(positions, indices);
+            check(meshlets.size() == 1, "folded pair: one meshlet");
+            if (meshlets.size() == 1)
+            {
+                check(isNear(meshlets[0].boundsMin, { -1, 0, -1 }) && isNear(meshlets[0].boundsMax, { 0, 1, 0 }), "folded pair: bounds");
+                check(isNear(meshlets[0].coneAxis, glm::normalize(glm::vec3(1, 0, 1))), "folded pair: cone axis");
+                check(isNear(meshlets[0].coneCutoff, std::sqrt(0.5f)), "folded pair: cone cutoff");
+            }
+        }
+
+        // A closed cube faces every way, so its cone must never cull
+        {
+            std::vector<glm::vec3> positions;
+            for (int i = 0; i < 8; ++i)
+            {
+                positions.push_back(glm::vec3(float(i & 1), float((i >> 1) & 1), float((i >> 2) & 1)));
+            }
+            std::vector<uint32_t> indices = {
+                0, 2, 3, 0, 3, 1,   4, 5, 7, 4, 7, 6,   // -z, +z
+                0, 4, 6, 0, 6, 2,   1, 3, 7, 1, 7, 5,   // -x, +x
+                0, 1, 5, 0, 5, 4,   2, 6, 7, 2, 7, 3 }; // -y, +y
+            const std::vector<Meshlet> meshlets = buildAll(positions, indices);
+            check(meshlets.size() == 1, "cube: one meshlet");
+            if (meshlets.size() == 1)
+            {
+                check(isNear(meshlets[0].boundsMin, glm::vec3(0.0f)) && isNear(meshlets[0].boundsMax, glm::vec3(1.0f)), "cube: bounds");
+                check(meshlets[0].coneCutoff == 1.0f, "cube: cone cutoff of 1");
+                check(!MeshletCuller::isBackfacing(meshlets[0], { 0.5f, 0.5f, -10.0f }), "cube: never backfacing");
+            }
+        }
+
+        // A flat 16x16 grid needs several meshlets, each with the plane's normal and a zero cutoff
+        {
+            std::vector<glm::vec3> positions;
+            std::vector<uint32_t> indices;
+            makeGrid(16, positions, indices);
+            const std::vector<Meshlet> meshlets = buildAll(positions, indices);
+            check(meshlets.size() >= 512 / MAX_MESHLET_TRIANGLES + 1, "grid: split by the triangle limit");
+            bool flatCones = true;
+            for (const Meshlet& meshlet : meshlets)
+            {
+                flatCones = flatCones && isNear(meshlet.coneAxis, { 0, 0, 1 }) && isNear(meshlet.coneCutoff, 0.0f);
+            }
+            check(flatCones, "grid: every cone is the plane normal with cutoff 0");
+        }
+    }
+
+    void checkConeTest()
+    {
+        spdlog::info("Cone test");
+
+        // The unit square in z = 0 facing +z; its bounding sphere has radius sqrt(2) / 2
+        Meshlet meshlet{};
+        meshlet.boundsMin = glm::vec3(0.0f);
+        meshlet.boundsMax = glm::vec3(1.0f, 1.0f, 0.0f);
+        meshlet.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+        meshlet.coneCutoff = 0.0f;
+
+        check(MeshletCuller::isBackfacing(meshlet, { 0.5f, 0.5f, -1.0f }), "camera 1 below the plane: backfacing");
+        check(MeshletCuller::isBackfacing(meshlet, { 5.0f, 0.5f, -1.0f }), "camera 1 below and off to the side: backfacing");
+        check(!MeshletCuller::isBackfacing(meshlet, { 0.5f, 0.5f, -0.5f }), "camera inside the bounding sphere: kept");
+        check(!MeshletCuller::isBackfacing(meshlet, { 0.5f, 0.5f, 2.0f }), "camera above the plane: kept");
+    }
+
+    // The renderer's projection: Vulkan depth range and a flipped Y. The camera sits at the origin looking down -z,
+    // and a 90 degree field of view puts the side planes at |x| = |y| = -z.
+    glm::mat4 makeProjection()
+    {
+        glm::mat4 projection = glm::perspectiveRH_ZO(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
+        projection[1][1] *= -1.0f;
+        return projection;
+    }
+
+    void checkFrustumTest()
+    {
+        spdlog::info("Frustum test");
+
+        const glm::mat4 projection = makeProjection();
+        check(!MeshletCuller::isOutsideFrustum({ -1, -1, -11 }, { 1, 1, -9 }, projection), "box ahead: inside");
+        check(!MeshletCuller::isOutsideFrustum({ 9, -1, -11 }, { 12, 1, -9 }, projection), "box across the right plane: kept");
+        check(MeshletCuller::isOutsideFrustum({ 12, -1, -11 }, { 14, 1, -9 }, projection), "box right of the right plane: outside");
+        check(MeshletCuller::isOutsideFrustum({ -1, 12, -11 }, { 1, 14, -9 }, projection), "box above the top plane: outside");
+        check(MeshletCuller::isOutsideFrustum({ -1, -1, 1 }, { 1, 1, 3 }, projection), "box behind the camera: outside");
+        check(MeshletCuller::isOutsideFrustum({ -1, -1, -120 }, { 1, 1, -110 }, projection), "box beyond the far plane: outside");
+        check(!MeshletCuller::isOutsideFrustum({ -1, -1, -1 }, { 1, 1, 1 }, projection), "box around the camera: kept");
+    }
+
+    void checkDepthPyramid()
+    {
+        spdlog::info("Depth pyramid");
+
+        // 5x3 with depth (y * 5 + x) / 100: level 0 is 2x1 and its last column and row take the leftover texels
+        std::vector<float> depth(15);
+        for (uint32_t i = 0; i < depth.size(); ++i)
+        {
+            depth[i] = float(i) / 100.0f;
+        }
+        DepthPyramid pyramid;
+        pyramid.build(depth.data(), 5, 3);
+        check(pyramid.getLevelCount() == 2, "5x3: two levels");
+        check(pyramid.getLevelSize(0).x == 2 && pyramid.getLevelSize(0).y == 1, "5x3: level 0 is 2x1");
+        check(isNear(pyramid.getTexel(0, 0, 0), 0.11f), "5x3: texel (0, 0) covers columns 0-1 and rows 0-2");
+        check(isNear(pyramid.getTexel(0, 1, 0), 0.14f), "5x3: texel (1, 0) covers columns 2-4 and rows 0-2");
+        check(isNear(pyramid.getTexel(1, 0, 0), 0.14f), "5x3: level 1 keeps the farthest depth");
+    }
+
+    void checkOcclusionTest()
+    {
+        spdlog::info("Hi-Z test");
+
+        const glm::mat4 projection = makeProjection();
+        const glm::mat4 view(1.0f);
+
+        // A wall across the whole view at distance 10
+        const glm::vec4 wallClip = projection * glm::vec4(0.0f, 0.0f, -10.0f, 1.0f);
+        const float wallDepth = wallClip.z / wallClip.w;
+        constexpr uint32_t WIDTH = 65;
+        constexpr uint32_t HEIGHT = 33;
+        std::vector<float> depth(size_t(WIDTH) * HEIGHT, wallDepth);
+        DepthPyramid pyramid;
+        pyramid.build(depth.data(), WIDTH, HEIGHT);
+
+        const MeshletCuller culler(projection, view, &pyramid);
+        Meshlet behind{};
+        behind.boundsMin = glm::vec3(-1, -1, -21);
+        behind.boundsMax = glm::vec3(1, 1, -19);
+        behind.coneCutoff = 1.0f;
+        Meshlet inFront = behind;
+        inFront.boundsMin = glm::vec3(-1, -1, -6);
+        inFront.boundsMax = glm::vec3(1, 1, -4);
+        Meshlet aroundCamera = behind;
+        aroundCamera.boundsMin = glm::vec3(-1, -1, -21);
+        aroundCamera.boundsMax = glm::vec3(1, 1, 1);
+
+        check(culler.cull(behind) == MeshletCuller::Result::Occluded, "box behind the wall: occluded");
+        check(culler.cull(inFront) == MeshletCuller::Result::Visible, "box in front of the wall: visible");
+        check(culler.cull(aroundCamera) == MeshletCuller::Result::Visible, "box reaching behind the camera: visible");
+
+        // A hole in the middle of the wall, where the box behind it projects
+        for (uint32_t y = HEIGHT / 2 - 2; y <= HEIGHT / 2 + 2; ++y)
+        {
+            for (uint32_t x = WIDTH / 2 - 2; x <= WIDTH / 2 + 2; ++x)
+            {
+                depth[size_t(y) * WIDTH + x] = 1.0f;
+            }
+        }
+        pyramid.build(depth.data(), WIDTH, HEIGHT);
+        check(culler.cull(behind) == MeshletCuller::Result::Visible, "box behind a hole in the wall: visible");
+
+        // Frustum and cone come before Hi-Z, as in the shader
+        Meshlet outside = behind;
+        outside.boundsMin = glm::vec3(30, -1, -21);
+        outside.boundsMax = glm::vec3(32, 1, -19);
+        check(culler.cull(outside) == MeshletCuller::Result::OutsideFrustum, "box outside and behind the wall: outside first");
+        Meshlet facingAway = inFront;
+        facingAway.coneAxis = glm::vec3(0.0f, 0.0f, -1.0f);
+        facingAway.coneCutoff = 0.0f;
+        check(culler.cull(facingAway) == MeshletCuller::Result::Backfacing, "box facing away: backfacing");
+    }
+
+    void checkShuffledSphere()
+    {
+        spdlog::info("Shuffled sphere");
+
+        // UV sphere, counter-clockwise seen from outside, with its triangles shuffled so meshlets
+        // cannot simply follow the input order
+        constexpr uint32_t RINGS = 80;
+        constexpr uint32_t SEGMENTS = 160;
+        std::vector<glm::vec3> positions;
+        for (uint32_t ring = 0; ring <= RINGS; ++ring)
+        {
+            for (uint32_t segment = 0; segment <= SEGMENTS; ++segment)
+            {
+                const float theta = glm::pi<float>() * float(ring) / float(RINGS);
+                const float phi = 2.0f * glm::pi<float>() * float(segment) / float(SEGMENTS);
+                positions.push_back(glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)));
+            }
+        }
+        std::vector<std::array<uint32_t, 3>> triangles;
+        for (uint32_t ring = 0; ring < RINGS; ++ring)
+        {
+            for (uint32_t segment = 0; segment < SEGMENTS; ++segment)
+            {
+                const uint32_t a = ring * (SEGMENTS + 1) + segment;
+                const uint32_t b = a + SEGMENTS + 1;
+                triangles.push_back({ a, a + 1, b });
+                triangles.push_back({ a + 1, b + 1, b });
+            }
+        }
+        std::mt19937 random(1);
+        std::shuffle(triangles.begin(), triangles.end(), random);
+
+        // Built at an offset into a larger index buffer, as the importer does
+        constexpr uint32_t FIRST_INDEX = 3;
+        std::vector<uint32_t> indices(FIRST_INDEX, 0);
+        for (const std::array<uint32_t, 3>& triangle : triangles)
+        {
+            indices.insert(indices.end(), triangle.begin(), triangle.end());
+        }
+        const std::vector<uint32_t> sourceIndices = indices;
+
+        std::vector<Meshlet> meshlets;
+        buildMeshlets(positions.data(), sizeof(glm::vec3), indices.data() + FIRST_INDEX,
+            static_cast<uint32_t>(indices.size()) - FIRST_INDEX, FIRST_INDEX, meshlets);
+
+        std::multiset<std::array<uint32_t, 3>> sourceTriangles;
+        std::multiset<std::array<uint32_t, 3>> builtTriangles;
+        for (size_t i = FIRST_INDEX; i < indices.size(); i += 3)
+        {
+            sourceTriangles.insert({ sourceIndices[i], sourceIndices[i + 1], sourceIndices[i + 2] });
+            builtTriangles.insert({ indices[i], indices[i + 1], indices[i + 2] });
+        }
+        check(sourceTriangles == builtTriangles, "triangles are only reordered, winding kept");
+
+        uint32_t nextIndex = FIRST_INDEX;
+        bool contiguous = true;
+        bool withinLimits = true;
+        bool boundsContain = true;
+        double vertexCount = 0.0;
+        for (const Meshlet& meshlet : meshlets)
+        {
+            contiguous = contiguous && meshlet.indexStart == nextIndex;
+            nextIndex = meshlet.indexStart + meshlet.indexCount;
+
+            const std::set<uint32_t> vertices(indices.begin() + meshlet.indexStart, indices.begin() + meshlet.indexStart + meshlet.indexCount);
+            withinLimits = withinLimits && vertices.size() <= MAX_MESHLET_VERTICES && meshlet.indexCount / 3 <= MAX_MESHLET_TRIANGLES;
+            for (uint32_t vertex : vertices)
+            {
+                boundsContain = boundsContain && glm::all(glm::greaterThanEqual(positions[vertex], meshlet.boundsMin))
+                    && glm::all(glm::lessThanEqual(positions[vertex], meshlet.boundsMax));
+            }
+            vertexCount += double(vertices.size());
+        }
+        check(contiguous && nextIndex == indices.size(), "meshlets cover the range back to back");
+        check(withinLimits, "meshlets stay within the vertex and triangle limits");
+        check(boundsContain, "meshlet bounds contain their vertices");
+
+        // Every triangle of a meshlet the cone test rejects must face away from the camera
+        uint32_t backfacingCount = 0;
+        uint32_t wrongCount = 0;
+        std::uniform_real_distribution<float> coordinate(-4.0f, 4.0f);
+        for (int camera = 0; camera < 200; ++camera)
+        {
+            const glm::vec3 cameraPosition(coordinate(random), coordinate(random), coordinate(random));
+            if (glm::length(cameraPosition) < 1.2f)
+            {
+                continue;
+            }
+            for (const Meshlet& meshlet : meshlets)
+            {
+                if (!MeshletCuller::isBackfacing(meshlet, cameraPosition))
+                {
+                    continue;
+                }
+                backfacingCount++;
+                for (uint32_t i = meshlet.indexStart; i < meshlet.indexStart + meshlet.indexCount; i += 3)
+                {
+                    const glm::vec3& a = positions[indices[i]];
+                    const glm::vec3 normal = glm::cross(positions[indices[i + 1]] - a, positions[indices[i + 2]] - a);
+                    if (glm::dot(normal, a - cameraPosition) < 0.0f)
+                    {
+                        wrongCount++;
+                        break;
+                    }
+                }
+            }
+        }
+        check(backfacingCount > 0, "the cone test rejects some meshlets");
+        check(wrongCount == 0, "rejected meshlets have no triangle facing the camera");
+
+        spdlog::info("  {} triangles in {} meshlets, {:.1f} triangles and {:.1f} vertices each; {} meshlets rejected by the cone over 200 cameras",
+            triangles.size(), meshlets.size(), double(triangles.size()) / double(meshlets.size()),
+            vertexCount / double(meshlets.size()), backfacingCount);
+    }
+}
+
+int main()
+{
+    checkKnownMeshes();
+    checkConeTest();
+    checkFrustumTest();
+    checkDepthPyramid();
+    checkOcclusionTest();
+    checkShuffledSphere();
+
+    if (g_Failures > 0)
+    {
+        spdlog::error("{} checks failed", g_Failures);
+        return 1;
+    }
+    spdlog::info("All checks passed");
+    return 0;
+}
@@ -0,0 +1,167 @@
+// MeshletCuller.cpp
+#include "MeshletCuller.h"
+#include <algorithm>
+#include <bit>
+
+void DepthPyramid::build(const float* pDepth, uint32_t width, uint32_t height)
+{
+    m_DepthSize = glm::vec2(width, height);
+    m_Levels.clear();
+
+    // Same level count as Renderer::createDepthPyramid
+    glm::uvec2 size(std::max(1u, width / 2), std::max(1u, height / 2));
+    uint32_t levelCount = 1;
+    while ((std::max(size.x, size.y) >> levelCount) > 0)
+    {
+        levelCount++;
+    }
+    m_Levels.resize(levelCount);
+
+    glm::uvec2 sourceSize(width, height);
+    const float* pSource = pDepth;
+    for (uint32_t level = 0; level < levelCount; ++level)
+    {
+        Level& destination = m_Levels[level];
+        destination.size = glm::max(glm::uvec2(1u), size >> level);
+        destination.texels.resize(size_t(destination.size.x) * destination.size.y);
+
+        // With an odd source size the last row and column also take the texel the rounded-down size drops
+        for (uint32_t y = 0; y < destination.size.y; ++y)
+        {
+            for (uint32_t x = 0; x < destination.size.x; ++x)
+            {
+                uint32_t lastX = x * 2 + 1 + (x == destination.size.x - 1 ? (sourceSize.x & 1) : 0);
+                uint32_t lastY = y * 2 + 1 + (y == destination.size.y - 1 ? (sourceSize.y & 1) : 0);
+                lastX = std::min(lastX, sourceSize.x - 1);
+                lastY = std::min(lastY, sourceSize.y - 1);
+
+                float farthestDepth = 0.0f;
+                for (uint32_t sourceY = y * 2; sourceY <= lastY; ++sourceY)
+                {
+                    for (uint32_t sourceX = x * 2; sourceX <= lastX; ++sourceX)
+                    {
+                        farthestDepth = std::max(farthestDepth, pSource[size_t(sourceY) * sourceSize.x + sourceX]);
+                    }
+                }
+                destination.texels[size_t(y) * destination.size.x + x] = farthestDepth;
+            }
+        }
+
+        sourceSize = destination.size;
+        pSource = destination.texels.data();
+    }
+}
+
+float DepthPyramid::getTexel(uint32_t level, uint32_t x, uint32_t y) const
+{
+    const Level& source = m_Levels[level];
+    return source.texels[size_t(y) * source.size.x + x];
+}
+
+MeshletCuller::MeshletCuller(const glm::mat4& projection, const glm::mat4& viewModel, const DepthPyramid* pDepthPyramid)
+    : m_ModelViewProjection(projection * viewModel),
+    m_CameraPosition(glm::inverse(viewModel)[3]),
+    m_pDepthPyramid(pDepthPyramid)
+{
+}
+
+MeshletCuller::Result MeshletCuller::cull(const Meshlet& meshlet) const
+{
+    // Cheapest first, in the same order as the shader so the counters match
+    if (isOutsideFrustum(meshlet.boundsMin, meshlet.boundsMax, m_ModelViewProjection))
+    {
+        return Result::OutsideFrustum;
+    }
+    if (isBackfacing(meshlet, m_CameraPosition))
+    {
+        return Result::Backfacing;
+    }
+    if (m_pDepthPyramid && isOccluded(meshlet.boundsMin, meshlet.boundsMax, m_ModelViewProjection, *m_pDepthPyramid))
+    {
+        return Result::Occluded;
+    }
+    return Result::Visible;
+}
+
+bool MeshletCuller::isOutsideFrustum(const glm::vec3& boxMin, const glm::vec3& boxMax, const glm::mat4& modelViewProjection)
+{
+    // One bit per clip plane, cleared as soon as a corner lies inside it; depth runs from 0 to w
+    uint32_t outsideMask = 0x3F;
+    for (int i = 0; i < 8; ++i)
+    {
+        glm::vec3 corner((i & 1) ? boxMax.x : boxMin.x, (i & 2) ? boxMax.y : boxMin.y, (i & 4) ? boxMax.z : boxMin.z);
+        glm::vec4 clip = modelViewProjection * glm::vec4(corner, 1.0f);
+
+        uint32_t cornerMask = 0;
+        cornerMask |= clip.x < -clip.w ? 0x01 : 0;
+        cornerMask |= clip.x > clip.w ? 0x02 : 0;
+        cornerMask |= clip.y < -clip.w ? 0x04 : 0;
+        cornerMask |= clip.y > clip.w ? 0x08 : 0;
+        cornerMask |= clip.z < 0.0f ? 0x10 : 0;
+        cornerMask |= clip.z > clip.w ? 0x20 : 0;
+        outsideMask &= cornerMask;
+    }
+    return outsideMask != 0;
+}
+
+bool MeshletCuller::isBackfacing(const Meshlet& meshlet, const glm::vec3& cameraPosition)
+{
+    const glm::vec3 center = (meshlet.boundsMin + meshlet.boundsMax) * 0.5f;
+    const float radius = glm::length(meshlet.boundsMax - meshlet.boundsMin) * 0.5f;
+    const glm::vec3 offset = center - cameraPosition;
+    return glm::dot(offset, meshlet.coneAxis) >= meshlet.coneCutoff * glm::length(offset) + radius;
+}
+
+bool MeshletCuller::isOccluded(const glm::vec3& boxMin, const glm::vec3& boxMax, const glm::mat4& modelViewProjection,
+    const DepthPyramid& depthPyramid)
+{
+    glm::vec2 screenMin(1.0f);
+    glm::vec2 screenMax(0.0f);
+    float nearestDepth = 1.0f;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        glm::vec3 corner((i & 1) ? boxMax.x : boxMin.x, (i & 2) ? boxMax.y : boxMin.y, (i & 4) ? boxMax.z : boxMin.z);
+        glm::vec4 clip = modelViewProjection * glm::vec4(corner, 1.0f);
+
+        // Boxes reaching behind the camera are too close to test
+        if (clip.w <= 0.0f)
+        {
+            return false;
+        }
+
+        glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        screenMin = glm::min(screenMin, glm::vec2(ndc) * 0.5f + 0.5f);
+        screenMax = glm::max(screenMax, glm::vec2(ndc) * 0.5f + 0.5f);
+        nearestDepth = std::min(nearestDepth, ndc.z);
+    }
+
+    if (nearestDepth <= 0.0f)
+    {
+        return false;
+    }
+
+    const glm::vec2 depthSize = depthPyramid.getDepthSize();
+    const glm::ivec2 pixelMin = glm::ivec2(glm::clamp(screenMin, 0.0f, 1.0f) * depthSize);
+    const glm::ivec2 pixelMax = glm::ivec2(glm::clamp(screenMax, 0.0f, 1.0f) * depthSize);
+
+    // Level L texels cover 2^(L+1) pixels, so this level spans the rectangle with at most 2x2 texels
+    const int pixelExtent = std::max(std::max(pixelMax.x - pixelMin.x, pixelMax.y - pixelMin.y), 1);
+    const int level = std::clamp(int(std::bit_width(uint32_t(pixelExtent))) - 1, 0, int(depthPyramid.getLevelCount()) - 1);
+
+    // The last texel of a level also covers the pixels its rounded-down size leaves over
+    const glm::ivec2 levelSize = glm::ivec2(depthPyramid.getLevelSize(level));
+    const glm::ivec2 texelMin = glm::min(pixelMin >> (level + 1), levelSize - 1);
+    const glm::ivec2 texelMax = glm::min(pixelMax >> (level + 1), levelSize - 1);
+
+    float farthestDepth = 0.0f;
+    for (int y = texelMin.y; y <= texelMax.y; ++y)
+    {
+        for (int x = texelMin.x; x <= texelMax.x; ++x)
+        {
+            farthestDepth = std::max(farthestDepth, depthPyramid.getTexel(level, x, y));
+        }
+    }
+
+    return nearestDepth > farthestDepth;
+}
@@ -0,0 +1,67 @@
+// MeshletCuller.h
+#pragma once
+#include "Meshlet.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+//
+// CPU mirror of depth_pyramid.comp: level 0 is half the depth buffer's resolution and every texel
+// keeps the farthest depth of the texels below it.
+//
+class DepthPyramid
+{
+public:
+    // pDepth holds width * height depth values, row by row
+    void build(const float* pDepth, uint32_t width, uint32_t height);
+
+    uint32_t getLevelCount() const { return static_cast<uint32_t>(m_Levels.size()); }
+    glm::uvec2 getLevelSize(uint32_t level) const { return m_Levels[level].size; }
+    float getTexel(uint32_t level, uint32_t x, uint32_t y) const;
+    // Resolution of the depth buffer the pyramid was built from
+    glm::vec2 getDepthSize() const { return m_DepthSize; }
+
+private:
+    struct Level
+    {
+        glm::uvec2 size;
+        std::vector<float> texels;
+    };
+
+    std::vector<Level> m_Levels;
+    glm::vec2 m_DepthSize{ 0.0f };
+};
+
+//
+// Reference for the meshlet tests in meshlet_cull.comp, so meshlet culling can be checked without a GPU.
+//
+class MeshletCuller
+{
+public:
+    enum class Result
+    {
+        Visible,
+        OutsideFrustum,
+        Backfacing,
+        Occluded
+    };
+
+    // viewModel maps model space to view space. Without a depth pyramid nothing counts as occluded.
+    MeshletCuller(const glm::mat4& projection, const glm::mat4& viewModel, const DepthPyramid* pDepthPyramid = nullptr);
+
+    Result cull(const Meshlet& meshlet) const;
+
+    // True when all eight corners of the box lie beyond the same clip plane
+    static bool isOutsideFrustum(const glm::vec3& boxMin, const glm::vec3& boxMax, const glm::mat4& modelViewProjection);
+    // True when every triangle of the meshlet faces away from a camera at cameraPosition (model space).
+    // Tests the cone against the meshlet's bounding sphere, so it holds for the whole meshlet.
+    static bool isBackfacing(const Meshlet& meshlet, const glm::vec3& cameraPosition);
+    // Same test as the occlusion shaders: the box's nearest depth against the farthest depth under it
+    static bool isOccluded(const glm::vec3& boxMin, const glm::vec3& boxMax, const glm::mat4& modelViewProjection,
+        const DepthPyramid& depthPyramid);
+
+private:
+    glm::mat4 m_ModelViewProjection;
+    glm::vec3 m_CameraPosition;
+    const DepthPyramid* m_pDepthPyramid;
+};
@@ -0,0 +1,116 @@
+#include "MipChain.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace
+{
+    float srgbToLinear(float value)
+    {
+        return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    float linearToSrgb(float value)
+    {
+        return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+    }
+
+    const std::array<float, 256>& getSrgbToLinearTable()
+    {
+        static const std::array<float, 256> table = []()
+            {
+                std::array<float, 256> values{};
+                for (size_t i = 0; i < values.size(); ++i)
+                {
+                    values[i] = srgbToLinear(static_cast<float>(i) / 255.0f);
+                }
+                return values;
+            }();
+        return table;
+    }
+
+    unsigned char quantize(float value)
+    {
+        return static_cast<unsigned char>(std::clamp(value * 255.0f + 0.5f, 0.0f, 255.0f));
+    }
+}
+
+uint32_t MipChain::calculateLevelCount(uint32_t width, uint32_t height)
+{
+    uint32_t levels = 1;
+    for (uint32_t size = std::max(width, height); size > 1; size >>= 1)
+    {
+        ++levels;
+    }
+    return levels;
+}
+
+void MipChain::generate(std::vector<unsigned char>& pixels, std::vector<uint64_t>& mipOffsets,
+    uint32_t width, uint32_t height, bool isSrgb)
+{
+    const uint32_t mipLevels = calculateLevelCount(width, height);
+    const std::array<float, 256>& toLinear = getSrgbToLinearTable();
+
+    mipOffsets.assign(1, 0);
+    pixels.reserve(pixels.size() + pixels.size() / 3 + 4 * mipLevels);
+
+    uint32_t srcWidth = width;
+    uint32_t srcHeight = height;
+    for (uint32_t level = 1; level < mipLevels; ++level)
+    {
+        const uint32_t dstWidth = std::max(srcWidth / 2, 1u);
+        const uint32_t dstHeight = std::max(srcHeight / 2, 1u);
+        const size_t srcOffset = static_cast<size_t>(mipOffsets.back());
+        const size_t dstOffset = pixels.size();
+        mipOffsets.push_back(dstOffset);
+        pixels.resize(dstOffset + size_t(dstWidth) * dstHeight * 4);
+
+        const unsigned char* pSrc = pixels.data() + srcOffset;
+        unsigned char* pDst = pixels.data() + dstOffset;
+
+        // 2x2 box filter; odd edges reuse the last row/column
+        for (uint32_t y = 0; y < dstHeight; ++y)
+        {
+            const uint32_t y0 = std::min(y * 2, srcHeight - 1);
+            const uint32_t y1 = std::min(y * 2 + 1, srcHeight - 1);
+            for (uint32_t x = 0; x < dstWidth; ++x)
+            {
+                const uint32_t x0 = std::min(x * 2, srcWidth - 1);
+                const uint32_t x1 = std::min(x * 2 + 1, srcWidth - 1);
+                const unsigned char* samples[4] = {
+                    pSrc + (size_t(y0) * srcWidth + x0) * 4,
+                    pSrc + (size_t(y0) * srcWidth + x1) * 4,
+                    pSrc + (size_t(y1) * srcWidth + x0) * 4,
+                    pSrc + (size_t(y1) * srcWidth + x1) * 4
+                };
+
+                unsigned char* pTexel = pDst + (size_t(y) * dstWidth + x) * 4;
+                for (int channel = 0; channel < 4; ++channel)
+                {
+                    // Alpha is always linear
+                    if (isSrgb && channel < 3)
+                    {
+                        float sum = 0.0f;
+                        for (const unsigned char* pSample : samples)
+                        {
+                            sum += toLinear[pSample[channel]];
+                        }
+                        pTexel[channel] = quantize(linearToSrgb(sum * 0.25f));
+                    }
+                    else
+                    {
+                        uint32_t sum = 2;
+                        for (const unsigned char* pSample : samples)
+                        {
+                            sum += pSample[channel];
+                        }
+                        pTexel[channel] = static_cast<unsigned char>(sum / 4);
+                    }
+                }
+            }
+        }
+
+        srcWidth = dstWidth;
+        srcHeight = dstHeight;
+    }
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+//
+// CPU mip generation for RGBA8 images, shared by the runtime texture loader and the offline cooker.
+//
+class MipChain
+{
+public:
+    // Number of levels in a full chain down to 1x1
+    static uint32_t calculateLevelCount(uint32_t width, uint32_t height);
+
+    // pixels holds level 0; every further level is appended with a 2x2 box filter.
+    // sRGB data is filtered in linear space. mipOffsets receives the start of each level.
+    static void generate(std::vector<unsigned char>& pixels, std::vector<uint64_t>& mipOffsets,
+        uint32_t width, uint32_t height, bool isSrgb);
+};
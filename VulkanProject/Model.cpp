@@ -1,12 +1,90 @@
 #include "Model.h"
 
 #include <glm/gtx/matrix_decompose.hpp>
+#include <glm/gtc/packing.hpp>
 #include <spdlog/spdlog.h>
+#include <filesystem>
+#include <fstream>
 #include "PhysicalDevice.h"
+#include "MappedFile.h"
+#include "VertexDeduplicator.h"
+#include "ThreadPool.h"
+#include "TextureCache.h"
+#include <chrono>
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+    // On-disk layout of the cooked mesh cache (<model>.meshcache).
+    // Bump MESH_CACHE_VERSION whenever Vertex, Submesh, Meshlet or the layout below changes.
+    constexpr char MESH_CACHE_MAGIC[4] = { 'M', 'S', 'H', 'C' };
+    constexpr uint32_t MESH_CACHE_VERSION = 9;
+    constexpr uint64_t MESH_CACHE_ALIGNMENT = 16;
+
+    // Each simplified level aims for half the triangles of the one before. Levels that keep more than
+    // LOD_MIN_REDUCTION of their parent cost a draw of their own for too little, and no level may stray
+    // further than LOD_MAX_ERROR of the submesh's bounding box diagonal from full detail.
+    constexpr float LOD_MIN_REDUCTION = 0.8f;
+    constexpr float LOD_MAX_ERROR = 0.02f;
+
+    struct MeshCacheHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t vertexStride;
+        uint32_t submeshStride;
+        uint32_t meshletStride;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t submeshCount;
+        uint32_t meshletCount;
+        uint32_t materialCount;
+        glm::vec3 bboxMin;
+        glm::vec3 bboxMax;
+        uint64_t vertexOffset;
+        uint64_t indexOffset;
+        uint64_t submeshOffset;
+        uint64_t meshletOffset;
+        uint64_t materialOffset;
+    };
+
+    // Maps a unit vector onto the octahedron and unfolds it into [-1, 1]^2
+    glm::vec2 encodeOctahedral(const glm::vec3& v)
+    {
+        const float sum = std::abs(v.x) + std::abs(v.y) + std::abs(v.z);
+        if (sum == 0.0f)
+        {
+            return glm::vec2(0.0f);
+        }
+
+        glm::vec2 p = glm::vec2(v) / sum;
+        if (v.z < 0.0f)
+        {
+            const glm::vec2 signs(p.x >= 0.0f ? 1.0f : -1.0f, p.y >= 0.0f ? 1.0f : -1.0f);
+            p = (1.0f - glm::abs(glm::vec2(p.y, p.x))) * signs;
+        }
+        return p;
+    }
 
-Model::Model(VmaAllocator allocator, Device* device, PhysicalDevice* pPhysicalDevice, CommandPool* commandPool, const std::string& modelPath)
-    : m_Allocator(allocator), m_pDevice(device), m_pPhysicalDevice(pPhysicalDevice), m_pCommandPool(commandPool), m_ModelPath(modelPath),
-    m_pVertexBuffer(nullptr), m_pIndexBuffer(nullptr)
+    int16_t packSnorm16(float value)
+    {
+        return static_cast<int16_t>(std::round(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+    }
+
+    uint16_t packUnorm16(float value)
+    {
+        return static_cast<uint16_t>(std::round(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+    }
+}
+
+Model::Model(VmaAllocator allocator, Device* device, PhysicalDevice* pPhysicalDevice, UploadBatch* pUploadBatch, ThreadPool* pThreadPool, TextureCache* pTextureCache, const std::string& modelPath)
+    : m_Allocator(allocator), m_pDevice(device), m_pPhysicalDevice(pPhysicalDevice), m_pUploadBatch(pUploadBatch), m_pThreadPool(pThreadPool), m_pTextureCache(pTextureCache), m_ModelPath(modelPath),
+    m_pVertexBuffer(nullptr), m_VertexStreamOffsets{}, m_PositionScale(1.0f), m_PositionOffset(0.0f),
+    m_pIndexBuffer(nullptr), m_IndexType(VK_INDEX_TYPE_UINT32), m_pMaterialBuffer(nullptr), m_pMeshletBuffer(nullptr), m_pSubmeshBuffer(nullptr)
 {
     spdlog::debug("Model created with path: {}", m_ModelPath);
 }
@@ -15,6 +93,9 @@ Model::~Model()
 {
     delete m_pVertexBuffer;
     delete m_pIndexBuffer;
+    delete m_pMaterialBuffer;
+    delete m_pMeshletBuffer;
+    delete m_pSubmeshBuffer;
 
     for (Material* material : m_Materials)
     {
@@ -24,6 +105,30 @@ Model::~Model()
 }
 
 void Model::loadModel()
+{
+    m_Vertices.clear();
+    m_Indices.clear();
+    m_Submeshes.clear();
+    m_Meshlets.clear();
+    m_MaterialInfos.clear();
+    m_Materials.clear();
+
+    m_Directory = m_ModelPath.substr(0, m_ModelPath.find_last_of('/'));
+
+    const std::string cachePath = getCachePath();
+    if (!loadFromCache(cachePath))
+    {
+        loadFromAssimp();
+        writeCache(cachePath);
+    }
+
+    createMaterials();
+    buildBvh();
+
+    spdlog::debug("Loaded model with {} vertices, {} indices, {} meshlets and {} materials.", m_Vertices.size(), m_Indices.size(), m_Meshlets.size(), m_Materials.size());
+}
+
+void Model::loadFromAssimp()
 {
     m_BoundingBoxMin = glm::vec3(FLT_MAX);
     m_BoundingBoxMax = glm::vec3(-FLT_MAX);
@@ -46,84 +151,601 @@ void Model::loadModel()
         throw std::runtime_error("Failed to load model");
     }
 
-    m_Vertices.clear();
-    m_Indices.clear();
-    m_Submeshes.clear();
-    m_Materials.clear();
+    auto startTime = std::chrono::high_resolution_clock::now();
 
-    std::unordered_map<Vertex, uint32_t> uniqueVertices{};
+    std::vector<MeshInstance> instances;
+    collectMeshInstances(scene->mRootNode, scene, glm::mat4(1.0f), instances);
 
-    m_Directory = m_ModelPath.substr(0, m_ModelPath.find_last_of('/'));
+    // Every mesh instance is processed independently into its own output region
+    std::vector<MeshOutput> outputs(instances.size());
+    m_pThreadPool->parallelFor(instances.size(), [&](size_t i)
+    {
+        outputs[i] = processMesh(instances[i].pMesh, scene, instances[i].transform);
+    });
+
+    auto processedTime = std::chrono::high_resolution_clock::now();
+
+    // Exclusive prefix sum over the region sizes gives each mesh its place in the final buffers
+    std::vector<uint32_t> vertexOffsets(outputs.size());
+    std::vector<uint32_t> indexOffsets(outputs.size());
+    std::vector<uint32_t> meshletOffsets(outputs.size());
+    size_t vertexCount = 0;
+    size_t indexCount = 0;
+    size_t meshletCount = 0;
+    size_t sourceVertexCount = 0;
+    for (size_t i = 0; i < outputs.size(); i++)
+    {
+        vertexOffsets[i] = static_cast<uint32_t>(vertexCount);
+        indexOffsets[i] = static_cast<uint32_t>(indexCount);
+        meshletOffsets[i] = static_cast<uint32_t>(meshletCount);
+        vertexCount += outputs[i].vertices.size();
+        indexCount += outputs[i].indices.size();
+        meshletCount += outputs[i].meshlets.size();
+        sourceVertexCount += instances[i].pMesh->mNumVertices;
+    }
+
+    m_Vertices.resize(vertexCount);
+    m_Indices.resize(indexCount);
+    m_Meshlets.resize(meshletCount);
+    m_Submeshes.resize(outputs.size());
+    m_MaterialInfos.resize(outputs.size());
+
+    m_pThreadPool->parallelFor(outputs.size(), [&](size_t i)
+    {
+        MeshOutput& output = outputs[i];
+        std::copy(output.vertices.begin(), output.vertices.end(), m_Vertices.begin() + vertexOffsets[i]);
+
+        // Indices stay local; the submesh's draws add vertexOffset
+        std::copy(output.indices.begin(), output.indices.end(), m_Indices.begin() + indexOffsets[i]);
+
+        Meshlet* pMeshlets = m_Meshlets.data() + meshletOffsets[i];
+        for (size_t j = 0; j < output.meshlets.size(); j++)
+        {
+            pMeshlets[j] = output.meshlets[j];
+            pMeshlets[j].indexStart += indexOffsets[i];
+        }
 
-    processNode(scene->mRootNode, scene, uniqueVertices, glm::mat4(1.0f));
+        output.submesh.indexStart = indexOffsets[i];
+        output.submesh.vertexOffset = vertexOffsets[i];
+        output.submesh.meshletStart = meshletOffsets[i];
+        for (uint32_t lod = 0; lod < output.submesh.lodCount; lod++)
+        {
+            output.submesh.lods[lod].indexStart += indexOffsets[i];
+            output.submesh.lods[lod].meshletStart += meshletOffsets[i];
+        }
+        m_Submeshes[i] = output.submesh;
+        m_MaterialInfos[i] = std::move(output.material);
+    });
+
+    sortSubmeshesByMaterial();
+
+    VertexCacheStatistics sourceCacheStatistics;
+    VertexCacheStatistics meshletCacheStatistics;
+    VertexCacheStatistics cacheStatistics;
+    size_t lodIndexCount = 0;
+    size_t lodMeshletCount = 0;
+    size_t lodCount = 0;
+    for (const MeshOutput& output : outputs)
+    {
+        sourceCacheStatistics += output.sourceCacheStatistics;
+        meshletCacheStatistics += output.meshletCacheStatistics;
+        cacheStatistics += output.cacheStatistics;
+        lodIndexCount += output.lodIndexCount;
+        lodMeshletCount += output.lodMeshletCount;
+        lodCount += output.submesh.lodCount - 1;
+    }
 
+    for (const Submesh& submesh : m_Submeshes)
+    {
+        m_BoundingBoxMin = glm::min(m_BoundingBoxMin, submesh.bboxMin);
+        m_BoundingBoxMax = glm::max(m_BoundingBoxMax, submesh.bboxMax);
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    float processTime = std::chrono::duration<float, std::milli>(processedTime - startTime).count();
+    float stitchTime = std::chrono::duration<float, std::milli>(endTime - processedTime).count();
+
+    spdlog::info("Processed {} mesh instances on {} threads in {:.2f} ms (+{:.2f} ms stitching): {} vertices -> {} unique vertices (dedup ratio {:.2f}), {} meshlets",
+        instances.size(), m_pThreadPool->getThreadCount(), processTime, stitchTime, sourceVertexCount, m_Vertices.size(),
+        m_Vertices.empty() ? 0.0f : float(sourceVertexCount) / float(m_Vertices.size()), m_Meshlets.size());
+    spdlog::info("Vertex cache ({}-entry FIFO): ACMR {:.3f} in import order, {:.3f} -> {:.3f} per meshlet; ATVR {:.3f}, {:.3f} -> {:.3f}",
+        VERTEX_CACHE_SIZE, sourceCacheStatistics.getAcmr(), meshletCacheStatistics.getAcmr(), cacheStatistics.getAcmr(),
+        sourceCacheStatistics.getAtvr(), meshletCacheStatistics.getAtvr(), cacheStatistics.getAtvr());
+    spdlog::info("LODs: {} simplified levels over {} submeshes, adding {} triangles ({:.1f}% of full detail) in {} meshlets",
+        lodCount, m_Submeshes.size(), lodIndexCount / 3,
+        m_Indices.size() > lodIndexCount ? 100.0f * float(lodIndexCount) / float(m_Indices.size() - lodIndexCount) : 0.0f, lodMeshletCount);
+}
 
-    spdlog::debug("Loaded model with {} vertices, {} indices, and {} materials.", m_Vertices.size(), m_Indices.size(), m_Materials.size());
+void Model::sortSubmeshesByMaterial()
+{
+    // Every submesh owns its material, so materials sharing all textures are the same state to the GPU.
+    // Only the submesh table moves; vertices, indices and meshlets stay where the stitching put them.
+    std::vector<uint32_t> order(m_Submeshes.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+    {
+        const MaterialInfo& materialA = m_MaterialInfos[a];
+        const MaterialInfo& materialB = m_MaterialInfos[b];
+        return std::tie(materialA.diffusePath, materialA.normalPath, materialA.metallicRoughnessPath) <
+            std::tie(materialB.diffusePath, materialB.normalPath, materialB.metallicRoughnessPath);
+    });
+
+    std::vector<Submesh> submeshes(m_Submeshes.size());
+    std::vector<MaterialInfo> materialInfos(m_MaterialInfos.size());
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        submeshes[i] = m_Submeshes[order[i]];
+        submeshes[i].materialIndex = static_cast<uint16_t>(i);
+        materialInfos[i] = std::move(m_MaterialInfos[order[i]]);
+    }
+    m_Submeshes = std::move(submeshes);
+    m_MaterialInfos = std::move(materialInfos);
+}
+
+std::string Model::getCachePath() const
+{
+    return std::filesystem::path(m_ModelPath).replace_extension(".meshcache").string();
+}
+
+bool Model::loadFromCache(const std::string& cachePath)
+{
+    std::error_code ec;
+    if (!std::filesystem::exists(cachePath, ec))
+    {
+        return false;
+    }
+
+    // The cache is stale as soon as the source asset has been touched after cooking
+    auto sourceTime = std::filesystem::last_write_time(m_ModelPath, ec);
+    if (!ec && sourceTime > std::filesystem::last_write_time(cachePath, ec))
+    {
+        spdlog::info("Mesh cache {} is older than {}, re-importing", cachePath, m_ModelPath);
+        return false;
+    }
+
+    MappedFile file(cachePath);
+    if (!file.isValid() || file.getSize() < sizeof(MeshCacheHeader))
+    {
+        spdlog::warn("Mesh cache {} could not be mapped", cachePath);
+        return false;
+    }
+
+    MeshCacheHeader header;
+    memcpy(&header, file.getData(), sizeof(header));
+
+    if (memcmp(header.magic, MESH_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != MESH_CACHE_VERSION ||
+        header.vertexStride != sizeof(Vertex) ||
+        header.submeshStride != sizeof(Submesh) ||
+        header.meshletStride != sizeof(Meshlet))
+    {
+        spdlog::info("Mesh cache {} has an incompatible format, re-importing", cachePath);
+        return false;
+    }
+
+    const size_t vertexBytes = size_t(header.vertexCount) * sizeof(Vertex);
+    const size_t indexBytes = size_t(header.indexCount) * sizeof(uint32_t);
+    const size_t submeshBytes = size_t(header.submeshCount) * sizeof(Submesh);
+    const size_t meshletBytes = size_t(header.meshletCount) * sizeof(Meshlet);
+    if (header.vertexOffset + vertexBytes > file.getSize() ||
+        header.indexOffset + indexBytes > file.getSize() ||
+        header.submeshOffset + submeshBytes > file.getSize() ||
+        header.meshletOffset + meshletBytes > file.getSize() ||
+        header.materialOffset > file.getSize())
+    {
+        spdlog::warn("Mesh cache {} is truncated", cachePath);
+        return false;
+    }
+
+    const unsigned char* pData = file.getData();
+
+    m_Vertices.resize(header.vertexCount);
+    memcpy(m_Vertices.data(), pData + header.vertexOffset, vertexBytes);
+
+    m_Indices.resize(header.indexCount);
+    memcpy(m_Indices.data(), pData + header.indexOffset, indexBytes);
+
+    m_Submeshes.resize(header.submeshCount);
+    memcpy(m_Submeshes.data(), pData + header.submeshOffset, submeshBytes);
+
+    m_Meshlets.resize(header.meshletCount);
+    memcpy(m_Meshlets.data(), pData + header.meshletOffset, meshletBytes);
+
+    // Material paths are stored as length-prefixed strings
+    const unsigned char* pCursor = pData + header.materialOffset;
+    const unsigned char* pEnd = pData + file.getSize();
+    auto readString = [&](std::string& out) -> bool
+    {
+        uint32_t length = 0;
+        if (pCursor + sizeof(length) > pEnd)
+        {
+            return false;
+        }
+        memcpy(&length, pCursor, sizeof(length));
+        pCursor += sizeof(length);
+        if (pCursor + length > pEnd)
+        {
+            return false;
+        }
+        out.assign(reinterpret_cast<const char*>(pCursor), length);
+        pCursor += length;
+        return true;
+    };
+
+    m_MaterialInfos.resize(header.materialCount);
+    for (MaterialInfo& info : m_MaterialInfos)
+    {
+        if (!readString(info.diffusePath) ||
+            !readString(info.normalPath) ||
+            !readString(info.metallicRoughnessPath))
+        {
+            spdlog::warn("Mesh cache {} has corrupt material data", cachePath);
+            m_Vertices.clear();
+            m_Indices.clear();
+            m_Submeshes.clear();
+            m_Meshlets.clear();
+            m_MaterialInfos.clear();
+            return false;
+        }
+    }
+
+    m_BoundingBoxMin = header.bboxMin;
+    m_BoundingBoxMax = header.bboxMax;
+
+    spdlog::info("Loaded mesh cache {}", cachePath);
+    return true;
+}
+
+void Model::writeCache(const std::string& cachePath) const
+{
+    MeshCacheHeader header{};
+    memcpy(header.magic, MESH_CACHE_MAGIC, sizeof(header.magic));
+    header.version = MESH_CACHE_VERSION;
+    header.vertexStride = sizeof(Vertex);
+    header.submeshStride = sizeof(Submesh);
+    header.meshletStride = sizeof(Meshlet);
+    header.vertexCount = static_cast<uint32_t>(m_Vertices.size());
+    header.indexCount = static_cast<uint32_t>(m_Indices.size());
+    header.submeshCount = static_cast<uint32_t>(m_Submeshes.size());
+    header.meshletCount = static_cast<uint32_t>(m_Meshlets.size());
+    header.materialCount = static_cast<uint32_t>(m_MaterialInfos.size());
+    header.bboxMin = m_BoundingBoxMin;
+    header.bboxMax = m_BoundingBoxMax;
+
+    auto alignOffset = [](uint64_t offset) { return (offset + MESH_CACHE_ALIGNMENT - 1) & ~(MESH_CACHE_ALIGNMENT - 1); };
+    header.vertexOffset = alignOffset(sizeof(MeshCacheHeader));
+    header.indexOffset = alignOffset(header.vertexOffset + m_Vertices.size() * sizeof(Vertex));
+    header.submeshOffset = alignOffset(header.indexOffset + m_Indices.size() * sizeof(uint32_t));
+    header.meshletOffset = alignOffset(header.submeshOffset + m_Submeshes.size() * sizeof(Submesh));
+    header.materialOffset = alignOffset(header.meshletOffset + m_Meshlets.size() * sizeof(Meshlet));
+
+    // Write to a temporary file first so a crash mid-write never leaves a half-written cache behind
+    const std::string tempPath = cachePath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            spdlog::warn("Could not write mesh cache {}", cachePath);
+            return;
+        }
+
+        auto writeAt = [&file](uint64_t offset, const void* pData, size_t size)
+        {
+            static const char padding[MESH_CACHE_ALIGNMENT]{};
+            uint64_t position = static_cast<uint64_t>(file.tellp());
+            file.write(padding, static_cast<std::streamsize>(offset - position));
+            file.write(static_cast<const char*>(pData), static_cast<std::streamsize>(size));
+        };
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        writeAt(header.vertexOffset, m_Vertices.data(), m_Vertices.size() * sizeof(Vertex));
+        writeAt(header.indexOffset, m_Indices.data(), m_Indices.size() * sizeof(uint32_t));
+        writeAt(header.submeshOffset, m_Submeshes.data(), m_Submeshes.size() * sizeof(Submesh));
+        writeAt(header.meshletOffset, m_Meshlets.data(), m_Meshlets.size() * sizeof(Meshlet));
+        writeAt(header.materialOffset, nullptr, 0);
+
+        auto writeString = [&file](const std::string& value)
+        {
+            uint32_t length = static_cast<uint32_t>(value.size());
+            file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            file.write(value.data(), length);
+        };
+
+        for (const MaterialInfo& info : m_MaterialInfos)
+        {
+            writeString(info.diffusePath);
+            writeString(info.normalPath);
+            writeString(info.metallicRoughnessPath);
+        }
+
+        if (!file.good())
+        {
+            spdlog::warn("Failed while writing mesh cache {}", cachePath);
+            return;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, cachePath, ec);
+    if (ec)
+    {
+        spdlog::warn("Could not move mesh cache into place: {}", ec.message());
+        std::filesystem::remove(tempPath, ec);
+        return;
+    }
+
+    spdlog::info("Wrote mesh cache {}", cachePath);
+}
+
+void Model::createMaterials()
+{
+    const std::string defaultTexturePath = "default/default_black.png";
+    auto resolve = [&](const std::string& relativePath)
+    {
+        return relativePath.empty() ? defaultTexturePath : m_Directory + "/" + relativePath;
+    };
+
+    m_Materials.reserve(m_MaterialInfos.size());
+    for (const MaterialInfo& info : m_MaterialInfos)
+    {
+        Material* material = new Material();
+        material->pDiffuseTexture = m_pTextureCache->getTexture(resolve(info.diffusePath));
+        material->pNormalTexture = m_pTextureCache->getTexture(resolve(info.normalPath), Texture::Format::UNORM);
+        material->pMetallicRoughnessTexture = m_pTextureCache->getTexture(resolve(info.metallicRoughnessPath));
+        m_Materials.push_back(material);
+    }
+}
+
+void Model::buildBvh()
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<glm::vec3> boxMins(m_Submeshes.size());
+    std::vector<glm::vec3> boxMaxs(m_Submeshes.size());
+    for (size_t i = 0; i < m_Submeshes.size(); ++i)
+    {
+        boxMins[i] = m_Submeshes[i].bboxMin;
+        boxMaxs[i] = m_Submeshes[i].bboxMax;
+    }
+    m_Bvh.build(boxMins, boxMaxs, m_pThreadPool);
+
+    auto end = std::chrono::high_resolution_clock::now();
+    spdlog::info("Built BVH over {} submeshes: {} nodes in {:.2f} ms", m_Submeshes.size(), m_Bvh.getNodes().size(),
+        std::chrono::duration<double, std::milli>(end - start).count());
+}
+
+bool Model::pick(const glm::vec3& origin, const glm::vec3& direction, PickResult& result) const
+{
+    bool hit = false;
+    m_Bvh.traverseRay(origin, direction, FLT_MAX, [&](uint32_t submeshIndex, float maxDistance)
+    {
+        const Submesh& submesh = m_Submeshes[submeshIndex];
+        for (uint32_t triangle = 0; triangle < submesh.indexCount / 3; ++triangle)
+        {
+            const uint32_t* pIndices = &m_Indices[submesh.indexStart + triangle * 3];
+            const Vertex* pVertices = &m_Vertices[submesh.vertexOffset];
+            const glm::vec3& p0 = pVertices[pIndices[0]].pos;
+            const glm::vec3 edge1 = pVertices[pIndices[1]].pos - p0;
+            const glm::vec3 edge2 = pVertices[pIndices[2]].pos - p0;
+
+            // Moller-Trumbore, double sided
+            const glm::vec3 p = glm::cross(direction, edge2);
+            const float determinant = glm::dot(edge1, p);
+            if (std::abs(determinant) < 1e-12f)
+            {
+                continue;
+            }
+            const float inverseDeterminant = 1.0f / determinant;
+            const glm::vec3 toOrigin = origin - p0;
+            const float u = glm::dot(toOrigin, p) * inverseDeterminant;
+            if (u < 0.0f || u > 1.0f)
+            {
+                continue;
+            }
+            const glm::vec3 q = glm::cross(toOrigin, edge1);
+            const float v = glm::dot(direction, q) * inverseDeterminant;
+            if (v < 0.0f || u + v > 1.0f)
+            {
+                continue;
+            }
+            const float distance = glm::dot(edge2, q) * inverseDeterminant;
+            if (distance > 0.0f && distance < maxDistance)
+            {
+                maxDistance = distance;
+                result = { submeshIndex, triangle, distance };
+                hit = true;
+            }
+        }
+        return maxDistance;
+    });
+    return hit;
 }
 
 void Model::createVertexBuffer()
 {
     spdlog::debug("Creating vertex buffer");
-    VkDeviceSize bufferSize = sizeof(m_Vertices[0]) * m_Vertices.size();
 
-    Buffer stagingBuffer(
-        m_Allocator,
-        bufferSize,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VMA_MEMORY_USAGE_CPU_ONLY,
-        VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT
-    );
+    // Positions are quantized over the model bounds, so every submesh snaps to the same grid
+    m_PositionOffset = m_BoundingBoxMin;
+    m_PositionScale = glm::max(m_BoundingBoxMax - m_BoundingBoxMin, glm::vec3(FLT_MIN));
+
+    const size_t vertexCount = m_Vertices.size();
+    m_VertexStreamOffsets[VERTEX_STREAM_POSITION] = 0;
+    m_VertexStreamOffsets[VERTEX_STREAM_TEXCOORD] = vertexCount * sizeof(PackedPosition);
+    m_VertexStreamOffsets[VERTEX_STREAM_TANGENT_FRAME] = m_VertexStreamOffsets[VERTEX_STREAM_TEXCOORD] + vertexCount * sizeof(PackedTexCoord);
+    VkDeviceSize bufferSize = m_VertexStreamOffsets[VERTEX_STREAM_TANGENT_FRAME] + vertexCount * sizeof(PackedTangentFrame);
 
-    void* data = stagingBuffer.map();
-    memcpy(data, m_Vertices.data(), static_cast<size_t>(bufferSize));
-    stagingBuffer.unmap();
-    stagingBuffer.flush();
+    std::vector<uint8_t> streams(bufferSize);
+    PackedPosition* pPositions = reinterpret_cast<PackedPosition*>(streams.data() + m_VertexStreamOffsets[VERTEX_STREAM_POSITION]);
+    PackedTexCoord* pTexCoords = reinterpret_cast<PackedTexCoord*>(streams.data() + m_VertexStreamOffsets[VERTEX_STREAM_TEXCOORD]);
+    PackedTangentFrame* pTangentFrames = reinterpret_cast<PackedTangentFrame*>(streams.data() + m_VertexStreamOffsets[VERTEX_STREAM_TANGENT_FRAME]);
+
+    for (size_t i = 0; i < vertexCount; i++)
+    {
+        const Vertex& vertex = m_Vertices[i];
+
+        const glm::vec3 position = (vertex.pos - m_PositionOffset) / m_PositionScale;
+        pPositions[i] = { packUnorm16(position.x), packUnorm16(position.y), packUnorm16(position.z), 0 };
+
+        pTexCoords[i] = { glm::packHalf1x16(vertex.texCoord.x), glm::packHalf1x16(vertex.texCoord.y) };
+
+        const glm::vec2 normal = encodeOctahedral(vertex.normal);
+        const glm::vec2 tangent = encodeOctahedral(glm::vec3(vertex.tangent));
+        PackedTangentFrame& tangentFrame = pTangentFrames[i];
+        tangentFrame.normal[0] = packSnorm16(normal.x);
+        tangentFrame.normal[1] = packSnorm16(normal.y);
+        tangentFrame.tangent[0] = packSnorm16(tangent.x);
+        tangentFrame.tangent[1] = packSnorm16(tangent.y);
+        tangentFrame.bitangentSign = packSnorm16(vertex.tangent.w);
+        tangentFrame.padding = 0;
+    }
 
     m_pVertexBuffer = new Buffer(
         m_Allocator,
-        bufferSize,
+        std::max<VkDeviceSize>(bufferSize, 1),
         VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
         VMA_MEMORY_USAGE_GPU_ONLY
     );
 
-    stagingBuffer.copyTo(m_pCommandPool, m_pDevice->getGraphicsQueue(), m_pVertexBuffer);
+    m_pUploadBatch->uploadBuffer(m_pVertexBuffer, streams.data(), bufferSize, 0,
+        VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT, VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT);
 
-    spdlog::debug("Vertex buffer created with size: {}", bufferSize);
+    spdlog::debug("Vertex buffer created with size: {} ({} bytes per vertex instead of {})", bufferSize,
+        sizeof(PackedPosition) + sizeof(PackedTexCoord) + sizeof(PackedTangentFrame), sizeof(Vertex));
 }
 
 void Model::createIndexBuffer()
 {
     spdlog::debug("Creating index buffer");
-    VkDeviceSize bufferSize = sizeof(m_Indices[0]) * m_Indices.size();
 
-    Buffer stagingBuffer(
+    // With submesh-local indices most models fit in 16 bits. One index type for the whole model keeps
+    // every pass at a single index buffer binding and a single indirect draw call.
+    const uint32_t maxIndex = m_Indices.empty() ? 0 : *std::max_element(m_Indices.begin(), m_Indices.end());
+    m_IndexType = maxIndex <= UINT16_MAX ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+
+    std::vector<uint16_t> narrowIndices;
+    const void* pIndexData = m_Indices.data();
+    VkDeviceSize bufferSize = sizeof(uint32_t) * m_Indices.size();
+    if (m_IndexType == VK_INDEX_TYPE_UINT16)
+    {
+        narrowIndices.assign(m_Indices.begin(), m_Indices.end());
+        pIndexData = narrowIndices.data();
+        bufferSize = sizeof(uint16_t) * narrowIndices.size();
+    }
+
+    m_pIndexBuffer = new Buffer(
+        m_Allocator,
+        std::max<VkDeviceSize>(bufferSize, 1),
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY
+    );
+
+    m_pUploadBatch->uploadBuffer(m_pIndexBuffer, pIndexData, bufferSize, 0,
+        VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT, VK_ACCESS_2_INDEX_READ_BIT);
+
+    spdlog::info("Index buffer created with {}-bit indices ({} bytes, largest local index {})",
+        m_IndexType == VK_INDEX_TYPE_UINT16 ? 16 : 32, bufferSize, maxIndex);
+}
+
+void Model::createMeshletBuffer()
+{
+    // Read by the meshlet culling pass only
+    VkDeviceSize bufferSize = sizeof(Meshlet) * std::max<size_t>(m_Meshlets.size(), 1);
+
+    m_pMeshletBuffer = new Buffer(
         m_Allocator,
         bufferSize,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VMA_MEMORY_USAGE_CPU_ONLY,
-        VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY
     );
 
-    void* data = stagingBuffer.map();
-    memcpy(data, m_Indices.data(), static_cast<size_t>(bufferSize));
-    stagingBuffer.unmap();
-    stagingBuffer.flush();
+    if (!m_Meshlets.empty())
+    {
+        m_pUploadBatch->uploadBuffer(m_pMeshletBuffer, m_Meshlets.data(), sizeof(Meshlet) * m_Meshlets.size(), 0,
+            VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+    }
 
-    m_pIndexBuffer = new Buffer(
+    spdlog::debug("Meshlet buffer created with {} meshlets", m_Meshlets.size());
+}
+
+void Model::createSubmeshBuffer()
+{
+    std::vector<SubmeshData> submeshData(std::max<size_t>(m_Submeshes.size(), 1));
+    for (size_t i = 0; i < m_Submeshes.size(); i++)
+    {
+        const Submesh& submesh = m_Submeshes[i];
+        SubmeshData& data = submeshData[i];
+        data.bboxMin = submesh.bboxMin;
+        data.vertexOffset = submesh.vertexOffset;
+        data.bboxMax = submesh.bboxMax;
+        data.materialIndex = submesh.materialIndex;
+        data.lodCount = submesh.lodCount;
+        for (uint32_t lod = 0; lod < submesh.lodCount; lod++)
+        {
+            const SubmeshLod& level = submesh.lods[lod];
+            data.lodErrors[lod] = level.error;
+            data.lods[lod] = glm::uvec4(level.indexStart, level.indexCount, level.meshletStart, level.meshletCount);
+        }
+    }
+
+    // Read by the submesh culling pass only
+    VkDeviceSize bufferSize = sizeof(SubmeshData) * submeshData.size();
+    m_pSubmeshBuffer = new Buffer(
         m_Allocator,
         bufferSize,
-        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
         VMA_MEMORY_USAGE_GPU_ONLY
     );
 
-    stagingBuffer.copyTo(m_pCommandPool, m_pDevice->getGraphicsQueue(), m_pIndexBuffer);
+    m_pUploadBatch->uploadBuffer(m_pSubmeshBuffer, submeshData.data(), bufferSize, 0,
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
 
-    spdlog::debug("Index buffer created with size: {}", bufferSize);
-    spdlog::debug("Index buffer created successfully");
+    spdlog::debug("Submesh buffer created with {} submeshes", m_Submeshes.size());
 }
 
+void Model::createMaterialBuffer()
+{
+    spdlog::debug("Creating material buffer");
+
+    // The texture cache shares textures between materials, so each one gets a single slot
+    std::unordered_map<Texture*, uint32_t> textureSlots;
+    auto getSlot = [&](Texture* pTexture)
+    {
+        auto [it, inserted] = textureSlots.try_emplace(pTexture, static_cast<uint32_t>(m_Textures.size()));
+        if (inserted)
+        {
+            m_Textures.push_back(pTexture);
+        }
+        return it->second;
+    };
+
+    std::vector<MaterialData> materialData;
+    materialData.reserve(m_Materials.size());
+    for (const Material* material : m_Materials)
+    {
+        MaterialData data{};
+        data.diffuseTextureIndex = getSlot(material->pDiffuseTexture);
+        data.normalTextureIndex = getSlot(material->pNormalTexture);
+        data.metallicRoughnessTextureIndex = getSlot(material->pMetallicRoughnessTexture);
+        materialData.push_back(data);
+    }
+
+    VkDeviceSize bufferSize = sizeof(MaterialData) * materialData.size();
 
-void Model::processNode(aiNode* node, const aiScene* scene, std::unordered_map<Vertex, uint32_t>& uniqueVertices, glm::mat4 parentTransform)
+    m_pMaterialBuffer = new Buffer(
+        m_Allocator,
+        bufferSize,
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY
+    );
+
+    m_pUploadBatch->uploadBuffer(m_pMaterialBuffer, materialData.data(), bufferSize, 0,
+        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+
+    spdlog::debug("Material buffer created with {} materials and {} unique textures", materialData.size(), m_Textures.size());
+}
+
+void Model::collectMeshInstances(aiNode* node, const aiScene* scene, glm::mat4 parentTransform, std::vector<MeshInstance>& instances) const
 {
     // Convert Assimp's aiMatrix4x4 to glm::mat4
     aiMatrix4x4 nodeTransformation = node->mTransformation;
@@ -132,181 +754,161 @@ void Model::processNode(aiNode* node, const aiScene* scene, std::unordered_map<V
     // Compute the current transformation by combining with the parent
     glm::mat4 currentTransform = parentTransform * nodeTransform;
 
-    // Process all the node's meshes
+    // Gather all the node's meshes
     for (unsigned int i = 0; i < node->mNumMeshes; i++)
     {
-        aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-        processMesh(mesh, scene, uniqueVertices, currentTransform);
+        instances.push_back({ scene->mMeshes[node->mMeshes[i]], currentTransform });
     }
 
-    // Recursively process each of the children nodes
+    // Recursively visit each of the children nodes
     for (unsigned int i = 0; i < node->mNumChildren; i++)
     {
-        processNode(node->mChildren[i], scene, uniqueVertices, currentTransform);
+        collectMeshInstances(node->mChildren[i], scene, currentTransform, instances);
     }
 }
 
-void Model::processMesh(aiMesh* mesh, const aiScene* scene, std::unordered_map<Vertex, uint32_t>& uniqueVertices, glm::mat4 transform)
+Model::MeshOutput Model::processMesh(aiMesh* mesh, const aiScene* scene, const glm::mat4& transform) const
 {
-    Submesh submesh{};
+    MeshOutput output{};
+    Submesh& submesh = output.submesh;
     glm::vec3 bboxMin(FLT_MAX);
     glm::vec3 bboxMax(-FLT_MAX);
 
-    submesh.indexStart = static_cast<uint32_t>(m_Indices.size());
+    // Maps Assimp vertex indices to deduplicated indices in output.vertices
+    VertexDeduplicator deduplicator(mesh->mNumVertices);
+    std::vector<uint32_t> remap(mesh->mNumVertices);
+    output.vertices.reserve(mesh->mNumVertices);
+    output.indices.reserve(size_t(mesh->mNumFaces) * 3);
 
     // Process vertices
     for (unsigned int i = 0; i < mesh->mNumVertices; i++)
     {
-        Vertex vertex{};
-
-        // Apply the transformation to the vertex position
-        glm::vec4 pos(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z, 1.0f);
-        pos = transform * pos;
-        vertex.pos = glm::vec3(pos);
+        const Vertex vertex = readAssimpVertex(*mesh, i, transform);
 
         bboxMin = glm::min(bboxMin, vertex.pos);
         bboxMax = glm::max(bboxMax, vertex.pos);
 
-        if (mesh->HasNormals())
+        remap[i] = deduplicator.insert(vertex, output.vertices);
+    }
+
+    // Process indices
+    for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+    {
+        const aiFace& face = mesh->mFaces[i];
+        for (unsigned int j = 0; j < face.mNumIndices; j++)
         {
-            // Transform the normal
-            glm::vec4 normal(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z, 0.0f);
-            normal = transform * normal;
-            vertex.normal = glm::normalize(glm::vec3(normal));
+            output.indices.push_back(remap[face.mIndices[j]]);
         }
+    }
 
-        if (mesh->mTextureCoords[0])
+    // UVs are stored as half floats, which lose precision away from zero. Textures repeat, so moving the
+    // submesh's UVs by whole units towards the origin changes nothing but the precision.
+    if (!output.vertices.empty())
+    {
+        glm::vec2 texCoordMin(FLT_MAX);
+        for (const Vertex& vertex : output.vertices)
         {
-            vertex.texCoord = glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y);
+            texCoordMin = glm::min(texCoordMin, vertex.texCoord);
         }
+        const glm::vec2 texCoordShift = glm::floor(texCoordMin);
+        for (Vertex& vertex : output.vertices)
+        {
+            vertex.texCoord -= texCoordShift;
+        }
+    }
+
+    output.sourceCacheStatistics = analyzeVertexCache(output.indices.data(), output.indices.size());
 
-        if (mesh->HasTangentsAndBitangents())
+    // Simplify each level from the one before and append it to the index list. The levels index the same
+    // vertices, so they share the submesh's vertexOffset. Errors add up along the chain, which keeps each
+    // level's error a bound on its distance from full detail.
+    submesh.lodCount = 1;
+    submesh.lods[0] = { 0, static_cast<uint32_t>(output.indices.size()), 0, 0, 0.0f };
+    if (!output.vertices.empty())
+    {
+        const float maxError = glm::length(bboxMax - bboxMin) * LOD_MAX_ERROR;
+        std::vector<uint32_t> lodIndices(output.indices.size());
+        while (submesh.lodCount < MAX_LOD_COUNT)
         {
-            // Transform tangent
-            glm::vec4 tangent_h(mesh->mTangents[i].x, mesh->mTangents[i].y, mesh->mTangents[i].z, 0.0f);
-            tangent_h = transform * tangent_h;
-            vertex.tangent = glm::normalize(glm::vec3(tangent_h));
-
-            // Transform bitangent (initial)
-            glm::vec4 bitangent_h(mesh->mBitangents[i].x, mesh->mBitangents[i].y, mesh->mBitangents[i].z, 0.0f);
-            bitangent_h = transform * bitangent_h;
-            // vertex.bitangent will be recomputed from normal and tangent later.
-
-            // Re-orthogonalize tangent with respect to the transformed normal (vertex.normal)
-            if (mesh->HasNormals()) // Should be true if tangents are present
+            const SubmeshLod& parent = submesh.lods[submesh.lodCount - 1];
+            float error = 0.0f;
+            const size_t indexCount = simplifyMesh(lodIndices.data(), output.indices.data() + parent.indexStart, parent.indexCount,
+                &output.vertices[0].pos, sizeof(Vertex), output.vertices.size(), parent.indexCount / 6 * 3, maxError - parent.error, &error);
+            if (indexCount == 0 || float(indexCount) > float(parent.indexCount) * LOD_MIN_REDUCTION)
             {
-                vertex.tangent = glm::normalize(vertex.tangent - vertex.normal * glm::dot(vertex.normal, vertex.tangent));
-                // Recompute bitangent to ensure consistency and correct handedness
-                vertex.bitangent = glm::normalize(glm::cross(vertex.normal, vertex.tangent));
+                break;
             }
-            // If somehow no normals but tangents exist, the above might need adjustment or indicates an issue.
-            // aiProcess_CalcTangentSpace usually ensures normals are present with tangents.
+
+            submesh.lods[submesh.lodCount] = { static_cast<uint32_t>(output.indices.size()), static_cast<uint32_t>(indexCount), 0, 0, parent.error + error };
+            output.indices.insert(output.indices.end(), lodIndices.begin(), lodIndices.begin() + indexCount);
+            output.lodIndexCount += indexCount;
+            submesh.lodCount++;
         }
-        // Ensure tangent/bitangent are initialized otherwise, if Vertex struct doesn't default them. Assuming it does.
+    }
 
-        // Check if vertex is already in uniqueVertices
-        if (uniqueVertices.count(vertex) == 0)
+    // Cluster each level's triangles while the indices are still local; meshlet and level starts are offset when stitching
+    if (!output.vertices.empty())
+    {
+        for (uint32_t lod = 0; lod < submesh.lodCount; ++lod)
         {
-            uniqueVertices[vertex] = static_cast<uint32_t>(m_Vertices.size());
-            m_Vertices.push_back(vertex);
+            SubmeshLod& level = submesh.lods[lod];
+            level.meshletStart = static_cast<uint32_t>(output.meshlets.size());
+            buildMeshlets(&output.vertices[0].pos, sizeof(Vertex), output.indices.data() + level.indexStart,
+                level.indexCount, level.indexStart, output.meshlets);
+            level.meshletCount = static_cast<uint32_t>(output.meshlets.size()) - level.meshletStart;
+            sortMeshletsForOverdraw(output.indices.data() + level.indexStart, level.indexStart,
+                output.meshlets.data() + level.meshletStart, level.meshletCount);
         }
+        output.lodMeshletCount = output.meshlets.size() - submesh.lods[0].meshletCount;
     }
 
-    // Process indices
-    for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+    // Every meshlet is its own draw, so the triangle order only needs to be cache friendly within one.
+    // The statistics cover full detail only, to stay comparable with the import order.
+    for (size_t i = 0; i < output.meshlets.size(); i++)
     {
-        aiFace face = mesh->mFaces[i];
-        for (unsigned int j = 0; j < face.mNumIndices; j++)
+        const Meshlet& meshlet = output.meshlets[i];
+        if (i < submesh.lods[0].meshletCount)
         {
-            uint32_t meshIndex = face.mIndices[j];
-
-            // Construct the vertex from the mesh data directly, applying the same transformations as the first loop
-            Vertex vertex{};
-
-            // Position
-            glm::vec4 pos_val(mesh->mVertices[meshIndex].x, mesh->mVertices[meshIndex].y, mesh->mVertices[meshIndex].z, 1.0f);
-            pos_val = transform * pos_val;
-            vertex.pos = glm::vec3(pos_val);
-
-            // Normal
-            if (mesh->HasNormals())
-            {
-                glm::vec4 normal_val(mesh->mNormals[meshIndex].x, mesh->mNormals[meshIndex].y, mesh->mNormals[meshIndex].z, 0.0f);
-                normal_val = transform * normal_val;
-                vertex.normal = glm::normalize(glm::vec3(normal_val));
-            }
-
-            // TexCoord
-            if (mesh->mTextureCoords[0])
-            {
-                vertex.texCoord = glm::vec2(mesh->mTextureCoords[0][meshIndex].x, mesh->mTextureCoords[0][meshIndex].y);
-            }
-            // Ensure texCoord is initialized otherwise
-
-            // Tangent and Bitangent
-            if (mesh->HasTangentsAndBitangents())
-            {
-                // Transform tangent
-                glm::vec4 tangent_h(mesh->mTangents[meshIndex].x, mesh->mTangents[meshIndex].y, mesh->mTangents[meshIndex].z, 0.0f);
-                tangent_h = transform * tangent_h;
-                vertex.tangent = glm::normalize(glm::vec3(tangent_h));
-                
-                // Transform bitangent (initial)
-                // glm::vec4 bitangent_h(mesh->mBitangents[meshIndex].x, mesh->mBitangents[meshIndex].y, mesh->mBitangents[meshIndex].z, 0.0f);
-                // bitangent_h = transform * bitangent_h;
-                // vertex.bitangent will be recomputed.
-
-                // Re-orthogonalize tangent and recompute bitangent using the transformed normal
-                if (mesh->HasNormals()) // vertex.normal should be correctly transformed by now
-                {
-                    vertex.tangent = glm::normalize(vertex.tangent - vertex.normal * glm::dot(vertex.normal, vertex.tangent));
-                    vertex.bitangent = glm::normalize(glm::cross(vertex.normal, vertex.tangent));
-                }
-            }
-            // Ensure tangent/bitangent are initialized otherwise
+            output.meshletCacheStatistics += analyzeVertexCache(output.indices.data() + meshlet.indexStart, meshlet.indexCount);
+        }
+        optimizeVertexCache(output.indices.data() + meshlet.indexStart, meshlet.indexCount);
+    }
 
-            // Get or create the optimized index for this vertex
-            uint32_t optimizedIndex;
-            if (uniqueVertices.count(vertex) == 0)
-            {
-                optimizedIndex = static_cast<uint32_t>(m_Vertices.size());
-                uniqueVertices[vertex] = optimizedIndex;
-                m_Vertices.push_back(vertex);
-            }
-            else
-            {
-                optimizedIndex = uniqueVertices[vertex];
-            }
+    // Store the vertices in the order the optimized indices first use them
+    std::vector<uint32_t> fetchRemap;
+    optimizeVertexFetch(output.indices.data(), output.indices.size(), output.vertices.size(), fetchRemap);
+    std::vector<Vertex> fetchOrderedVertices(output.vertices.size());
+    for (size_t i = 0; i < output.vertices.size(); i++)
+    {
+        fetchOrderedVertices[fetchRemap[i]] = output.vertices[i];
+    }
+    output.vertices = std::move(fetchOrderedVertices);
 
-            m_Indices.push_back(optimizedIndex);
-        }
+    // Measured per meshlet, the way the G-buffer pass draws them
+    for (uint32_t i = 0; i < submesh.lods[0].meshletCount; i++)
+    {
+        const Meshlet& meshlet = output.meshlets[i];
+        output.cacheStatistics += analyzeVertexCache(output.indices.data() + meshlet.indexStart, meshlet.indexCount);
     }
 
-    submesh.indexCount = static_cast<uint32_t>(m_Indices.size()) - submesh.indexStart;
+    // indexStart and meshletStart are assigned when the outputs are stitched together, materialIndex once they are sorted
+    submesh.indexCount = submesh.lods[0].indexCount;
+    submesh.meshletCount = submesh.lods[0].meshletCount;
     submesh.bboxMin = bboxMin;
     submesh.bboxMax = bboxMax;
 
-    // Update model AABB
-    m_BoundingBoxMin = glm::min(m_BoundingBoxMin, bboxMin);
-    m_BoundingBoxMax = glm::max(m_BoundingBoxMax, bboxMax);
-
-    // Process material (existing code)
+    // Record the material's texture paths; the textures themselves are created in createMaterials()
     if (mesh->mMaterialIndex >= 0)
     {
         aiMaterial* aiMat = scene->mMaterials[mesh->mMaterialIndex];
-        Material* material = new Material();
+        MaterialInfo& info = output.material;
 
         // Albedo texture
         aiString albedoPath;
         if (aiMat->GetTexture(aiTextureType_BASE_COLOR, 0, &albedoPath) == AI_SUCCESS ||
             aiMat->GetTexture(aiTextureType_DIFFUSE, 0, &albedoPath) == AI_SUCCESS)
         {
-            std::string fullPath = m_Directory + "/" + albedoPath.C_Str();
-            material->pDiffuseTexture = new Texture(m_pDevice, m_Allocator, m_pCommandPool, fullPath, m_pPhysicalDevice->get());
-        }
-        else
-        {
-            material->pDiffuseTexture = new Texture(m_pDevice, m_Allocator, m_pCommandPool, "default/default_black.png", m_pPhysicalDevice->get());
+            info.diffusePath = albedoPath.C_Str();
         }
 
         // Normal texture
@@ -315,37 +917,25 @@ void Model::processMesh(aiMesh* mesh, const aiScene* scene, std::unordered_map<V
             aiMat->GetTexture(aiTextureType_NORMALS, 0, &normalPath) == AI_SUCCESS ||
             aiMat->GetTexture(aiTextureType_HEIGHT, 0, &normalPath) == AI_SUCCESS)
         {
-            std::string fullPath = m_Directory + "/" + normalPath.C_Str();
-            material->pNormalTexture = new Texture(m_pDevice, m_Allocator, m_pCommandPool, fullPath, m_pPhysicalDevice->get(), Texture::Format::UNORM);
-        }
-        else
-        {
-            material->pNormalTexture = new Texture(m_pDevice, m_Allocator, m_pCommandPool, "default/default_black.png", m_pPhysicalDevice->get(), Texture::Format::UNORM);
+            info.normalPath = normalPath.C_Str();
         }
 
         // Metallic-Roughness texture
         aiString mrPath;
         if (aiMat->GetTexture(aiTextureType_UNKNOWN, 0, &mrPath) == AI_SUCCESS)
         {
-            std::string fullPath = m_Directory + "/" + mrPath.C_Str();
-            material->pMetallicRoughnessTexture = new Texture(m_pDevice, m_Allocator, m_pCommandPool, fullPath, m_pPhysicalDevice->get());
-        }
-        else
-        {
-            material->pMetallicRoughnessTexture = new Texture(m_pDevice, m_Allocator, m_pCommandPool, "default/default_black.png", m_pPhysicalDevice->get());
+            info.metallicRoughnessPath = mrPath.C_Str();
         }
-
-        m_Materials.push_back(material);
-        submesh.materialIndex = static_cast<uint32_t>(m_Materials.size() - 1);
     }
 
-    m_Submeshes.push_back(submesh);
+    return output;
 }
 
 
-VkBuffer Model::getVertexBuffer() const
+void Model::bindVertexBuffers(VkCommandBuffer commandBuffer, VertexStream lastStream) const
 {
-    return m_pVertexBuffer->get();
+    const VkBuffer buffers[VERTEX_STREAM_COUNT] = { m_pVertexBuffer->get(), m_pVertexBuffer->get(), m_pVertexBuffer->get() };
+    vkCmdBindVertexBuffers(commandBuffer, 0, lastStream + 1, buffers, m_VertexStreamOffsets);
 }
 
 VkBuffer Model::getIndexBuffer() const
@@ -353,75 +943,87 @@ VkBuffer Model::getIndexBuffer() const
     return m_pIndexBuffer->get();
 }
 
-size_t Model::getIndexCount() const
+void Model::bindIndexBuffer(VkCommandBuffer commandBuffer) const
 {
-    return m_Indices.size();
+    vkCmdBindIndexBuffer(commandBuffer, m_pIndexBuffer->get(), 0, m_IndexType);
 }
 
-bool Vertex::operator==(const Vertex& other) const
+VkBuffer Model::getMaterialBuffer() const
 {
-    return pos == other.pos &&
-        texCoord == other.texCoord &&
-        normal == other.normal &&
-        tangent == other.tangent &&
-        bitangent == other.bitangent;
+    return m_pMaterialBuffer->get();
 }
 
-VkVertexInputBindingDescription Vertex::getBindingDescription()
+VkDeviceSize Model::getMaterialBufferSize() const
 {
-    VkVertexInputBindingDescription bindingDescription{};
-    bindingDescription.binding = 0;
-    bindingDescription.stride = sizeof(Vertex);
-    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-    return bindingDescription;
+    return sizeof(MaterialData) * m_Materials.size();
 }
 
-std::vector<VkVertexInputAttributeDescription> Vertex::getAttributeDescriptions()
+VkBuffer Model::getMeshletBuffer() const
 {
-    std::vector<VkVertexInputAttributeDescription> attributeDescriptions(5);
+    return m_pMeshletBuffer->get();
+}
 
-    attributeDescriptions[0].binding = 0;
-    attributeDescriptions[0].location = 0;
-    attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-    attributeDescriptions[0].offset = offsetof(Vertex, pos);
+VkDeviceSize Model::getMeshletBufferSize() const
+{
+    return sizeof(Meshlet) * std::max<size_t>(m_Meshlets.size(), 1);
+}
 
-    attributeDescriptions[1].binding = 0;
-    attributeDescriptions[1].location = 1;
-    attributeDescriptions[1].format = VK_FORMAT_R32G32_SFLOAT;
-    attributeDescriptions[1].offset = offsetof(Vertex, texCoord);
+VkBuffer Model::getSubmeshBuffer() const
+{
+    return m_pSubmeshBuffer->get();
+}
 
-    attributeDescriptions[2].binding = 0;
-    attributeDescriptions[2].location = 2;
-    attributeDescriptions[2].format = VK_FORMAT_R32G32B32_SFLOAT;
-    attributeDescriptions[2].offset = offsetof(Vertex, normal);
+VkDeviceSize Model::getSubmeshBufferSize() const
+{
+    return sizeof(SubmeshData) * std::max<size_t>(m_Submeshes.size(), 1);
+}
 
-    attributeDescriptions[3].binding = 0;
-    attributeDescriptions[3].location = 3;
-    attributeDescriptions[3].format = VK_FORMAT_R32G32B32_SFLOAT;
-    attributeDescriptions[3].offset = offsetof(Vertex, tangent);
+size_t Model::getIndexCount() const
+{
+    return m_Indices.size();
+}
 
-    attributeDescriptions[4].binding = 0;
-    attributeDescriptions[4].location = 4;
-    attributeDescriptions[4].format = VK_FORMAT_R32G32B32_SFLOAT;
-    attributeDescriptions[4].offset = offsetof(Vertex, bitangent);
+bool Vertex::operator==(const Vertex& other) const
+{
+    return pos == other.pos &&
+        texCoord == other.texCoord &&
+        normal == other.normal &&
+        tangent == other.tangent;
+}
 
-    return attributeDescriptions;
+std::vector<VkVertexInputBindingDescription> Vertex::getBindingDescriptions(VertexStream lastStream)
+{
+    const uint32_t strides[VERTEX_STREAM_COUNT] = { sizeof(PackedPosition), sizeof(PackedTexCoord), sizeof(PackedTangentFrame) };
+
+    std::vector<VkVertexInputBindingDescription> bindingDescriptions(lastStream + 1);
+    for (uint32_t i = 0; i <= lastStream; i++)
+    {
+        bindingDescriptions[i].binding = i;
+        bindingDescriptions[i].stride = strides[i];
+        bindingDescriptions[i].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    }
+    return bindingDescriptions;
 }
 
-std::vector<VkVertexInputAttributeDescription> Vertex::getDepthAttributeDescriptions()
+std::vector<VkVertexInputAttributeDescription> Vertex::getAttributeDescriptions(VertexStream lastStream)
 {
-    std::vector<VkVertexInputAttributeDescription> attributeDescriptions(2);
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
 
-    attributeDescriptions[0].binding = 0;
-    attributeDescriptions[0].location = 0;
-    attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-    attributeDescriptions[0].offset = offsetof(Vertex, pos);
+    // Location 0: position, dequantized in the vertex shader
+    attributeDescriptions.push_back({ 0, VERTEX_STREAM_POSITION, VK_FORMAT_R16G16B16A16_UNORM, offsetof(PackedPosition, x) });
 
-    attributeDescriptions[1].binding = 0;
-    attributeDescriptions[1].location = 1;
-    attributeDescriptions[1].format = VK_FORMAT_R32G32_SFLOAT;
-    attributeDescriptions[1].offset = offsetof(Vertex, texCoord);
+    if (lastStream >= VERTEX_STREAM_TEXCOORD)
+    {
+        // Location 1: texCoord
+        attributeDescriptions.push_back({ 1, VERTEX_STREAM_TEXCOORD, VK_FORMAT_R16G16_SFLOAT, offsetof(PackedTexCoord, u) });
+    }
 
+    if (lastStream >= VERTEX_STREAM_TANGENT_FRAME)
+    {
+        // Location 2: octahedral normal; location 3: octahedral tangent with the bitangent sign in z
+        attributeDescriptions.push_back({ 2, VERTEX_STREAM_TANGENT_FRAME, VK_FORMAT_R16G16_SNORM, offsetof(PackedTangentFrame, normal) });
+        attributeDescriptions.push_back({ 3, VERTEX_STREAM_TANGENT_FRAME, VK_FORMAT_R16G16B16A16_SNORM, offsetof(PackedTangentFrame, tangent) });
+    }
 
     return attributeDescriptions;
 }
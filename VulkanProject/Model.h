@@ -16,22 +16,61 @@
 #include <assimp/postprocess.h>
 
 #include "Buffer.h"
-#include "CommandPool.h"
+#include "UploadBatch.h"
 #include "Device.h"
 #include "Texture.h"
 #include "Material.h"
+#include "Bvh.h"
+#include "Meshlet.h"
+#include "MeshOptimizer.h"
+#include "Simplifier.h"
 
+class ThreadPool;
+class TextureCache;
+
+// Vertex streams on the GPU. Passes bind the streams up to the last one they read: shadow maps fetch
+// positions only, the depth pre-pass adds UVs for the alpha test and the G-buffer pass reads all three.
+enum VertexStream : uint32_t
+{
+    VERTEX_STREAM_POSITION,         // PackedPosition
+    VERTEX_STREAM_TEXCOORD,         // PackedTexCoord
+    VERTEX_STREAM_TANGENT_FRAME,    // PackedTangentFrame
+    VERTEX_STREAM_COUNT
+};
+
+// 16-bit UNORM within the model's bounds; see Model::getPositionScale and getPositionOffset
+struct PackedPosition
+{
+    uint16_t x, y, z, w;
+};
+
+// Half-float UVs
+struct PackedTexCoord
+{
+    uint16_t u, v;
+};
+
+// Octahedral normal and tangent as 16-bit SNORM. The tangent attribute reads four components,
+// so the bitangent sign arrives in its z.
+struct PackedTangentFrame
+{
+    int16_t normal[2];
+    int16_t tangent[2];
+    int16_t bitangentSign;
+    int16_t padding;
+};
+
+// Full-precision vertex as imported and cached; Model::createVertexBuffer packs it into the streams above
 struct Vertex
 {
     glm::vec3 pos;
     glm::vec2 texCoord;
     glm::vec3 normal;
-    glm::vec3 tangent;    // Added tangent
-    glm::vec3 bitangent;  // Added bitangent
+    glm::vec4 tangent;    // w is the bitangent sign: bitangent = cross(normal, tangent.xyz) * tangent.w
 
-    static VkVertexInputBindingDescription getBindingDescription();
-    static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions();
-    static std::vector<VkVertexInputAttributeDescription> getDepthAttributeDescriptions();
+    // Vertex input for the streams up to and including lastStream
+    static std::vector<VkVertexInputBindingDescription> getBindingDescriptions(VertexStream lastStream = VERTEX_STREAM_TANGENT_FRAME);
+    static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions(VertexStream lastStream = VERTEX_STREAM_TANGENT_FRAME);
 
     bool operator==(const Vertex& other) const;
 };
@@ -45,68 +84,200 @@ namespace std
             size_t seed = 0;
             hash<glm::vec3> vec3Hasher;
             hash<glm::vec2> vec2Hasher;
+            hash<glm::vec4> vec4Hasher;
 
             seed ^= vec3Hasher(vertex.pos) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
             seed ^= vec2Hasher(vertex.texCoord) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
             seed ^= vec3Hasher(vertex.normal) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-            seed ^= vec3Hasher(vertex.tangent) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-            seed ^= vec3Hasher(vertex.bitangent) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            seed ^= vec4Hasher(vertex.tangent) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
 
             return seed;
         }
     };
 }
 
+// Full detail plus up to three simplified levels per submesh
+constexpr uint32_t MAX_LOD_COUNT = 4;
+
+// One level of detail: an index range over the submesh's vertices and the meshlets covering it
+struct SubmeshLod
+{
+    uint32_t indexStart;
+    uint32_t indexCount;
+    uint32_t meshletStart;
+    uint32_t meshletCount;
+    // Largest distance, in model units, the level's surface may lie from the full-detail one
+    float error;
+};
+
 struct Submesh
 {
     uint32_t indexStart;
     uint32_t indexCount;
+    // Indices are local to the submesh; this is added to them as the vertexOffset of its draws
+    uint32_t vertexOffset;
     uint16_t materialIndex;
 
     glm::vec3 bboxMin;
     glm::vec3 bboxMax;
+
+    // Meshlets covering exactly this submesh's index range
+    uint32_t meshletStart;
+    uint32_t meshletCount;
+
+    // lods[0] repeats the full-detail ranges above; coarser levels follow their parent in the index buffer
+    uint32_t lodCount;
+    SubmeshLod lods[MAX_LOD_COUNT];
+};
+
+// One entry of the submesh storage buffer read by cull.comp (std430)
+struct SubmeshData
+{
+    glm::vec3 bboxMin;
+    uint32_t vertexOffset;
+    glm::vec3 bboxMax;
+    uint32_t materialIndex;
+    glm::vec4 lodErrors;
+    // indexStart, indexCount, meshletStart and meshletCount of each level
+    glm::uvec4 lods[MAX_LOD_COUNT];
+    uint32_t lodCount;
+    uint32_t padding[3];
+};
+static_assert(sizeof(SubmeshData) == 128, "SubmeshData must match its std430 layout");
+
+// Closest triangle hit by Model::pick
+struct PickResult
+{
+    uint32_t submeshIndex;
+    uint32_t triangleIndex;    // within the submesh
+    float distance;            // in units of the ray direction's length
+};
+
+// Texture paths of a material, relative to the model directory.
+// An empty path means the material slot falls back to the default texture.
+struct MaterialInfo
+{
+    std::string diffusePath;
+    std::string normalPath;
+    std::string metallicRoughnessPath;
 };
 
 class PhysicalDevice;
 class Model
 {
 public:
-    Model(VmaAllocator allocator, Device* pDevice, PhysicalDevice* pPhysicalDevice, CommandPool* pCommandPool, const std::string& modelPath);
+    Model(VmaAllocator allocator, Device* pDevice, PhysicalDevice* pPhysicalDevice, UploadBatch* pUploadBatch, ThreadPool* pThreadPool, TextureCache* pTextureCache, const std::string& modelPath);
     ~Model();
 
     void loadModel();
     void createVertexBuffer();
     void createIndexBuffer();
+    void createMeshletBuffer();
+    // Uploads the bounds and draw ranges of every submesh for GPU culling
+    void createSubmeshBuffer();
+    // Builds the bindless texture table and uploads one MaterialData per material
+    void createMaterialBuffer();
 
-    VkBuffer getVertexBuffer() const;
+    // Binds the vertex streams up to and including lastStream to bindings 0..lastStream
+    void bindVertexBuffers(VkCommandBuffer commandBuffer, VertexStream lastStream) const;
+    // Packed positions decode to model space as position * scale + offset
+    glm::vec3 getPositionScale() const { return m_PositionScale; }
+    glm::vec3 getPositionOffset() const { return m_PositionOffset; }
     VkBuffer getIndexBuffer() const;
+    // 16-bit when every submesh has few enough vertices, 32-bit otherwise
+    VkIndexType getIndexType() const { return m_IndexType; }
+    void bindIndexBuffer(VkCommandBuffer commandBuffer) const;
     size_t getIndexCount() const;
+    VkBuffer getMaterialBuffer() const;
+    VkDeviceSize getMaterialBufferSize() const;
+    VkBuffer getMeshletBuffer() const;
+    VkDeviceSize getMeshletBufferSize() const;
+    VkBuffer getSubmeshBuffer() const;
+    VkDeviceSize getSubmeshBufferSize() const;
 
-    std::vector<Submesh> getSubmeshes() const { return m_Submeshes; }
+    // Grouped by material, so draws compacted in submesh order share material state with their neighbours
+    const std::vector<Submesh>& getSubmeshes() const { return m_Submeshes; }
+    uint32_t getSubmeshCount() const { return static_cast<uint32_t>(m_Submeshes.size()); }
+    const std::vector<Meshlet>& getMeshlets() const { return m_Meshlets; }
+    uint32_t getMeshletCount() const { return static_cast<uint32_t>(m_Meshlets.size()); }
     std::vector<Material*> getMaterials() const { return m_Materials; }
+    // Unique textures referenced by the materials, in bindless array order
+    const std::vector<Texture*>& getTextures() const { return m_Textures; }
+    // Hierarchy over the submesh bounds, in model space
+    const Bvh& getBvh() const { return m_Bvh; }
+    // Closest triangle along a model-space ray; returns false when nothing is hit
+    bool pick(const glm::vec3& origin, const glm::vec3& direction, PickResult& result) const;
     std::pair<glm::vec3, glm::vec3> getAABB() const 
     {
         return { m_BoundingBoxMin, m_BoundingBoxMax };
     }
 
 private:
-    void processNode(aiNode* node, const aiScene* scene, std::unordered_map<Vertex, uint32_t>& uniqueVertices, glm::mat4 parentTransform);
-    void processMesh(aiMesh* mesh, const aiScene* scene, std::unordered_map<Vertex, uint32_t>& uniqueVertices, glm::mat4 transform);
+    void loadFromAssimp();
+    bool loadFromCache(const std::string& cachePath);
+    void writeCache(const std::string& cachePath) const;
+    std::string getCachePath() const;
+    // Stable-sorts the submeshes and their materials by texture set and renumbers the materials to match
+    void sortSubmeshesByMaterial();
+    void createMaterials();
+    void buildBvh();
+
+    // A mesh referenced by a node, with the node's accumulated transform
+    struct MeshInstance
+    {
+        aiMesh* pMesh;
+        glm::mat4 transform;
+    };
+
+    // Result of processing one mesh instance; indices are local to its own vertices
+    struct MeshOutput
+    {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        std::vector<Meshlet> meshlets;
+        // Post-transform cache behaviour in import order, per meshlet before and after optimization
+        VertexCacheStatistics sourceCacheStatistics;
+        VertexCacheStatistics meshletCacheStatistics;
+        VertexCacheStatistics cacheStatistics;
+        // Indices and meshlets of the simplified levels, out of indices.size() and meshlets.size()
+        size_t lodIndexCount;
+        size_t lodMeshletCount;
+        Submesh submesh;
+        MaterialInfo material;
+    };
+
+    void collectMeshInstances(aiNode* node, const aiScene* scene, glm::mat4 parentTransform, std::vector<MeshInstance>& instances) const;
+    MeshOutput processMesh(aiMesh* mesh, const aiScene* scene, const glm::mat4& transform) const;
     VmaAllocator m_Allocator;
     Device* m_pDevice;
     PhysicalDevice* m_pPhysicalDevice;
-    CommandPool* m_pCommandPool;
+    UploadBatch* m_pUploadBatch;
+    ThreadPool* m_pThreadPool;
+    TextureCache* m_pTextureCache;
     std::string m_ModelPath;
     std::string m_Directory;
 
     std::vector<Vertex> m_Vertices;
+    // Local to each submesh, see Submesh::vertexOffset
     std::vector<uint32_t> m_Indices;
 
+    // All vertex streams share one buffer
     Buffer* m_pVertexBuffer;
+    VkDeviceSize m_VertexStreamOffsets[VERTEX_STREAM_COUNT];
+    glm::vec3 m_PositionScale;
+    glm::vec3 m_PositionOffset;
     Buffer* m_pIndexBuffer;
+    VkIndexType m_IndexType;
+    Buffer* m_pMaterialBuffer;
+    Buffer* m_pMeshletBuffer;
+    Buffer* m_pSubmeshBuffer;
 
     std::vector<Submesh> m_Submeshes;
+    std::vector<Meshlet> m_Meshlets;
+    Bvh m_Bvh;
+    std::vector<MaterialInfo> m_MaterialInfos;
     std::vector<Material*> m_Materials;
+    std::vector<Texture*> m_Textures;
 	glm::vec3 m_BoundingBoxMin;
 	glm::vec3 m_BoundingBoxMax;
 };
@@ -148,6 +148,18 @@ bool PhysicalDevice::checkFeatureSupport(VkPhysicalDevice device)
     {
         return false;
     }
+    if (m_RequiredFeatures.textureCompressionBC && !supportedFeatures2.features.textureCompressionBC)
+    {
+        return false;
+    }
+    if (m_RequiredFeatures.multiDrawIndirect && !supportedFeatures2.features.multiDrawIndirect)
+    {
+        return false;
+    }
+    if (m_RequiredFeatures.drawIndirectFirstInstance && !supportedFeatures2.features.drawIndirectFirstInstance)
+    {
+        return false;
+    }
  
     // Check Vulkan 1.1 features
     if (m_UseVulkan11Features)
@@ -162,6 +174,18 @@ bool PhysicalDevice::checkFeatureSupport(VkPhysicalDevice device)
         {
             return false;
         }
+        if (m_Vulkan12Features.timelineSemaphore && !supportedVulkan12Features.timelineSemaphore)
+        {
+            return false;
+        }
+        if (m_Vulkan12Features.shaderSampledImageArrayNonUniformIndexing && !supportedVulkan12Features.shaderSampledImageArrayNonUniformIndexing)
+        {
+            return false;
+        }
+        if (m_Vulkan12Features.drawIndirectCount && !supportedVulkan12Features.drawIndirectCount)
+        {
+            return false;
+        }
         // ... check other Vulkan 1.2 features
     }
 
@@ -254,6 +278,39 @@ PhysicalDevice::QueueFamilyIndices PhysicalDevice::findQueueFamilies(VkPhysicalD
         i++;
     }
 
+    // Prefer a family without graphics/compute (the copy engine), then any family without graphics
+    std::optional<uint32_t> transferOnlyFamily;
+    std::optional<uint32_t> nonGraphicsTransferFamily;
+    for (uint32_t familyIndex = 0; familyIndex < queueFamilyCount; ++familyIndex)
+    {
+        const VkQueueFlags flags = queueFamilies[familyIndex].queueFlags;
+        if (!(flags & VK_QUEUE_TRANSFER_BIT) || (flags & VK_QUEUE_GRAPHICS_BIT))
+        {
+            continue;
+        }
+        if (!(flags & VK_QUEUE_COMPUTE_BIT) && !transferOnlyFamily.has_value())
+        {
+            transferOnlyFamily = familyIndex;
+        }
+        else if (!nonGraphicsTransferFamily.has_value())
+        {
+            nonGraphicsTransferFamily = familyIndex;
+        }
+    }
+
+    if (transferOnlyFamily.has_value())
+    {
+        indices.transferFamily = transferOnlyFamily;
+    }
+    else if (nonGraphicsTransferFamily.has_value())
+    {
+        indices.transferFamily = nonGraphicsTransferFamily;
+    }
+    else
+    {
+        indices.transferFamily = indices.graphicsFamily;
+    }
+
     return indices;
 }
 
@@ -304,6 +361,11 @@ bool PhysicalDevice::QueueFamilyIndices::isComplete() const
     return graphicsFamily.has_value() && presentFamily.has_value();
 }
 
+bool PhysicalDevice::QueueFamilyIndices::hasDedicatedTransferFamily() const
+{
+    return transferFamily.has_value() && transferFamily != graphicsFamily;
+}
+
 const PhysicalDevice::QueueFamilyIndices& PhysicalDevice::getQueueFamilyIndices() const
 {
     return m_QueueFamilyIndices;
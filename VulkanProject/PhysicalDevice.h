@@ -25,8 +25,11 @@ public:
     {
         std::optional<uint32_t> graphicsFamily;
         std::optional<uint32_t> presentFamily;
+        // Transfer-only family when the device exposes one, otherwise the graphics family
+        std::optional<uint32_t> transferFamily;
 
         bool isComplete() const;
+        bool hasDedicatedTransferFamily() const;
     };
 
     const QueueFamilyIndices& getQueueFamilyIndices() const;
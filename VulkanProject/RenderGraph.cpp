@@ -0,0 +1,617 @@
+// RenderGraph.cpp
+#include "RenderGraph.h"
+#include "Device.h"
+#include <algorithm>
+#include <stdexcept>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+    struct AccessInfo
+    {
+        VkImageLayout layout;
+        VkPipelineStageFlags2 stageMask;
+        VkAccessFlags2 accessMask;
+        VkImageUsageFlags usage;
+        bool write;
+    };
+
+    AccessInfo getAccessInfo(RenderGraphAccess access, VkImageAspectFlags aspectMask)
+    {
+        // Sampled depth and depth tests without writes share the read-only depth layout
+        const VkImageLayout readOnlyLayout = (aspectMask & VK_IMAGE_ASPECT_DEPTH_BIT) != 0 ?
+            VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        const VkPipelineStageFlags2 fragmentTestStages = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+
+        switch (access)
+        {
+        case RenderGraphAccess::ColorAttachmentWrite:
+            return { VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, true };
+        case RenderGraphAccess::DepthAttachmentWrite:
+            return { VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, fragmentTestStages,
+                VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, true };
+        case RenderGraphAccess::DepthAttachmentRead:
+            return { readOnlyLayout, fragmentTestStages,
+                VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, false };
+        case RenderGraphAccess::FragmentSampledRead:
+            return { readOnlyLayout, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+                VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_USAGE_SAMPLED_BIT, false };
+        case RenderGraphAccess::ComputeSampledRead:
+            return { readOnlyLayout, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_USAGE_SAMPLED_BIT, false };
+        case RenderGraphAccess::ComputeStorageRead:
+            return { VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_IMAGE_USAGE_STORAGE_BIT, false };
+        case RenderGraphAccess::ComputeStorageWrite:
+            return { VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_USAGE_STORAGE_BIT, true };
+        case RenderGraphAccess::TransferRead:
+            return { VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_USAGE_TRANSFER_SRC_BIT, false };
+        case RenderGraphAccess::TransferWrite:
+            return { VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_USAGE_TRANSFER_DST_BIT, true };
+        }
+        throw std::runtime_error("Unknown render graph access!");
+    }
+
+    VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::use(RenderGraphImage image, RenderGraphAccess access)
+{
+    if (image.index >= m_pGraph->m_Images.size())
+    {
+        throw std::runtime_error("Invalid render graph image!");
+    }
+
+    Pass& pass = m_pGraph->m_Passes[m_PassIndex];
+    for (const ImageUse& use : pass.uses)
+    {
+        if (use.image == image.index)
+        {
+            throw std::runtime_error("Render graph pass '" + pass.name + "' uses image '" + m_pGraph->m_Images[image.index].name + "' twice!");
+        }
+    }
+    pass.uses.push_back({ image.index, access });
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::setSideEffects()
+{
+    m_pGraph->m_Passes[m_PassIndex].sideEffects = true;
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::setExecute(std::function<void(VkCommandBuffer)> execute)
+{
+    m_pGraph->m_Passes[m_PassIndex].execute = std::move(execute);
+    return *this;
+}
+
+RenderGraph::RenderGraph(Device* pDevice, VmaAllocator allocator)
+    : m_pDevice(pDevice)
+    , m_Allocator(allocator)
+{
+}
+
+RenderGraph::~RenderGraph()
+{
+    for (ImageResource& resource : m_Images)
+    {
+        if (resource.imported)
+        {
+            continue;
+        }
+        if (resource.view != VK_NULL_HANDLE)
+        {
+            vkDestroyImageView(m_pDevice->get(), resource.view, nullptr);
+        }
+        if (resource.image != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(m_pDevice->get(), resource.image, nullptr);
+        }
+    }
+    for (MemoryBlock& block : m_MemoryBlocks)
+    {
+        if (block.allocation != VK_NULL_HANDLE)
+        {
+            vmaFreeMemory(m_Allocator, block.allocation);
+        }
+    }
+}
+
+RenderGraphImage RenderGraph::createImage(const std::string& name, uint32_t width, uint32_t height, VkFormat format, VkImageAspectFlags aspectMask)
+{
+    ImageResource resource{};
+    resource.name = name;
+    resource.width = width;
+    resource.height = height;
+    resource.format = format;
+    resource.aspectMask = aspectMask;
+    m_Images.push_back(resource);
+    return { static_cast<uint32_t>(m_Images.size() - 1) };
+}
+
+RenderGraphImage RenderGraph::importImage(const std::string& name, VkImageAspectFlags aspectMask, VkImageLayout finalLayout)
+{
+    ImageResource resource{};
+    resource.name = name;
+    resource.imported = true;
+    resource.aspectMask = aspectMask;
+    resource.finalLayout = finalLayout;
+    m_Images.push_back(resource);
+    return { static_cast<uint32_t>(m_Images.size() - 1) };
+}
+
+RenderGraph::PassBuilder RenderGraph::addPass(const std::string& name)
+{
+    if (m_Compiled)
+    {
+        throw std::runtime_error("Render graph is already compiled!");
+    }
+
+    Pass pass{};
+    pass.name = name;
+    m_Passes.push_back(pass);
+    return PassBuilder(this, static_cast<uint32_t>(m_Passes.size() - 1));
+}
+
+void RenderGraph::compile()
+{
+    if (m_Compiled)
+    {
+        throw std::runtime_error("Render graph is already compiled!");
+    }
+
+    cullPasses();
+    computeLifetimes();
+    mergeReads();
+    createTransientImages();
+    allocateTransientMemory();
+    m_Compiled = true;
+
+    const size_t livePassCount = std::count_if(m_Passes.begin(), m_Passes.end(), [](const Pass& pass) { return pass.live; });
+    spdlog::info("Render graph: {} of {} passes live, transient images in {:.1f} MiB ({:.1f} MiB without aliasing)",
+        livePassCount, m_Passes.size(), m_TransientMemorySize / (1024.0 * 1024.0), m_UnaliasedMemorySize / (1024.0 * 1024.0));
+}
+
+void RenderGraph::setImportedImage(RenderGraphImage image, VkImage vkImage, VkImageLayout layout,
+    VkPipelineStageFlags2 stageMask, VkAccessFlags2 accessMask)
+{
+    ImageResource& resource = m_Images[image.index];
+    if (!resource.imported)
+    {
+        throw std::runtime_error("Render graph image '" + resource.name + "' is not imported!");
+    }
+
+    resource.image = vkImage;
+    resource.state = ImageState{};
+    resource.state.layout = layout;
+    resource.state.writeStageMask = stageMask;
+    resource.state.writeAccessMask = accessMask;
+}
+
+void RenderGraph::execute(VkCommandBuffer commandBuffer)
+{
+    if (!m_Compiled)
+    {
+        throw std::runtime_error("Render graph is not compiled!");
+    }
+
+    std::vector<VkImageMemoryBarrier2> barriers;
+    VkDependencyInfo dependencyInfo{};
+    dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+
+    for (uint32_t passIndex = 0; passIndex < m_Passes.size(); ++passIndex)
+    {
+        const Pass& pass = m_Passes[passIndex];
+        if (!pass.live)
+        {
+            continue;
+        }
+
+        barriers.clear();
+        for (const ImageUse& use : pass.uses)
+        {
+            ImageResource& resource = m_Images[use.image];
+            if (resource.image == VK_NULL_HANDLE)
+            {
+                throw std::runtime_error("Render graph image '" + resource.name + "' is not bound!");
+            }
+            addBarrier(barriers, resource, use, !resource.imported && resource.firstPass == passIndex);
+        }
+
+        if (!barriers.empty())
+        {
+            dependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(barriers.size());
+            dependencyInfo.pImageMemoryBarriers = barriers.data();
+            vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+        }
+
+        if (pass.execute)
+        {
+            pass.execute(commandBuffer);
+        }
+    }
+
+    // Hand imported images back in the layout their owner expects, e.g. for presentation
+    barriers.clear();
+    for (ImageResource& resource : m_Images)
+    {
+        if (!resource.imported || resource.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED || resource.firstPass == UINT32_MAX ||
+            resource.state.layout == resource.finalLayout)
+        {
+            continue;
+        }
+
+        VkImageMemoryBarrier2 barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+        barrier.srcStageMask = resource.state.writeStageMask | resource.state.readStageMask;
+        barrier.srcAccessMask = resource.state.writeAccessMask;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_NONE;
+        barrier.oldLayout = resource.state.layout;
+        barrier.newLayout = resource.finalLayout;
+        barrier.image = resource.image;
+        barrier.subresourceRange = { resource.aspectMask, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS };
+        barriers.push_back(barrier);
+
+        resource.state = ImageState{};
+        resource.state.layout = resource.finalLayout;
+    }
+    if (!barriers.empty())
+    {
+        dependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(barriers.size());
+        dependencyInfo.pImageMemoryBarriers = barriers.data();
+        vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+    }
+}
+
+VkImage RenderGraph::getImage(RenderGraphImage image) const
+{
+    return m_Images[image.index].image;
+}
+
+VkImageView RenderGraph::getImageView(RenderGraphImage image) const
+{
+    const ImageResource& resource = m_Images[image.index];
+    if (resource.view == VK_NULL_HANDLE)
+    {
+        throw std::runtime_error("Render graph image '" + resource.name + "' has no view!");
+    }
+    return resource.view;
+}
+
+void RenderGraph::cullPasses()
+{
+    // Walking backwards, a pass is needed if it has side effects, writes an imported image
+    // or writes an image that a later live pass reads
+    std::vector<bool> read(m_Images.size(), false);
+    for (size_t passIndex = m_Passes.size(); passIndex-- > 0;)
+    {
+        Pass& pass = m_Passes[passIndex];
+        pass.live = pass.sideEffects;
+        for (const ImageUse& use : pass.uses)
+        {
+            if (getAccessInfo(use.access, 0).write && (m_Images[use.image].imported || read[use.image]))
+            {
+                pass.live = true;
+            }
+        }
+
+        if (!pass.live)
+        {
+            spdlog::debug("Render graph: culled pass '{}'", pass.name);
+            continue;
+        }
+        for (const ImageUse& use : pass.uses)
+        {
+            if (!getAccessInfo(use.access, 0).write)
+            {
+                read[use.image] = true;
+            }
+        }
+    }
+}
+
+void RenderGraph::computeLifetimes()
+{
+    for (uint32_t passIndex = 0; passIndex < m_Passes.size(); ++passIndex)
+    {
+        const Pass& pass = m_Passes[passIndex];
+        if (!pass.live)
+        {
+            continue;
+        }
+
+        for (const ImageUse& use : pass.uses)
+        {
+            ImageResource& resource = m_Images[use.image];
+            const AccessInfo info = getAccessInfo(use.access, resource.aspectMask);
+            if (resource.firstPass == UINT32_MAX)
+            {
+                if (!resource.imported && !info.write)
+                {
+                    throw std::runtime_error("Render graph image '" + resource.name + "' is read before it is written!");
+                }
+                resource.firstPass = passIndex;
+            }
+            resource.lastPass = passIndex;
+            resource.usage |= info.usage;
+        }
+    }
+}
+
+void RenderGraph::mergeReads()
+{
+    for (uint32_t passIndex = 0; passIndex < m_Passes.size(); ++passIndex)
+    {
+        if (!m_Passes[passIndex].live)
+        {
+            continue;
+        }
+
+        for (ImageUse& use : m_Passes[passIndex].uses)
+        {
+            const ImageResource& resource = m_Images[use.image];
+            const AccessInfo info = getAccessInfo(use.access, resource.aspectMask);
+            use.mergedStageMask = info.stageMask;
+            use.mergedAccessMask = info.accessMask;
+            if (info.write)
+            {
+                continue;
+            }
+
+            // Extend over the following reads until the image is written or changes layout
+            bool merging = true;
+            for (uint32_t laterPass = passIndex + 1; merging && laterPass <= resource.lastPass; ++laterPass)
+            {
+                if (!m_Passes[laterPass].live)
+                {
+                    continue;
+                }
+                for (const ImageUse& laterUse : m_Passes[laterPass].uses)
+                {
+                    if (laterUse.image != use.image)
+                    {
+                        continue;
+                    }
+                    const AccessInfo laterInfo = getAccessInfo(laterUse.access, resource.aspectMask);
+                    if (laterInfo.write || laterInfo.layout != info.layout)
+                    {
+                        merging = false;
+                        break;
+                    }
+                    use.mergedStageMask |= laterInfo.stageMask;
+                    use.mergedAccessMask |= laterInfo.accessMask;
+                }
+            }
+        }
+    }
+}
+
+void RenderGraph::createTransientImages()
+{
+    for (ImageResource& resource : m_Images)
+    {
+        // Unused images are never created
+        if (resource.imported || resource.firstPass == UINT32_MAX)
+        {
+            continue;
+        }
+
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.extent = { resource.width, resource.height, 1 };
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.format = resource.format;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage = resource.usage;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateImage(m_pDevice->get(), &imageInfo, nullptr, &resource.image) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create render graph image '" + resource.name + "'!");
+        }
+        vkGetImageMemoryRequirements(m_pDevice->get(), resource.image, &resource.memoryRequirements);
+        m_UnaliasedMemorySize += resource.memoryRequirements.size;
+    }
+}
+
+void RenderGraph::allocateTransientMemory()
+{
+    std::vector<uint32_t> order;
+    for (uint32_t imageIndex = 0; imageIndex < m_Images.size(); ++imageIndex)
+    {
+        if (m_Images[imageIndex].image != VK_NULL_HANDLE && !m_Images[imageIndex].imported)
+        {
+            order.push_back(imageIndex);
+        }
+    }
+    // Largest first, so smaller images fill the gaps they leave
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        return m_Images[a].memoryRequirements.size > m_Images[b].memoryRequirements.size;
+    });
+
+    std::vector<uint32_t> placed;
+    for (uint32_t imageIndex : order)
+    {
+        ImageResource& resource = m_Images[imageIndex];
+        const VkMemoryRequirements& requirements = resource.memoryRequirements;
+
+        uint32_t blockIndex = 0;
+        while (blockIndex < m_MemoryBlocks.size() && (m_MemoryBlocks[blockIndex].memoryTypeBits & requirements.memoryTypeBits) == 0)
+        {
+            blockIndex++;
+        }
+        if (blockIndex == m_MemoryBlocks.size())
+        {
+            m_MemoryBlocks.push_back({});
+        }
+        MemoryBlock& block = m_MemoryBlocks[blockIndex];
+
+        // Memory of images that are alive at the same time is off limits
+        std::vector<std::pair<VkDeviceSize, VkDeviceSize>> occupied;
+        for (uint32_t other : placed)
+        {
+            const ImageResource& otherResource = m_Images[other];
+            if (otherResource.block == blockIndex &&
+                otherResource.firstPass <= resource.lastPass && resource.firstPass <= otherResource.lastPass)
+            {
+                occupied.push_back({ otherResource.offset, otherResource.offset + otherResource.memoryRequirements.size });
+            }
+        }
+        std::sort(occupied.begin(), occupied.end());
+
+        VkDeviceSize offset = 0;
+        for (const auto& [begin, end] : occupied)
+        {
+            offset = alignUp(offset, requirements.alignment);
+            if (offset + requirements.size <= begin)
+            {
+                break;
+            }
+            offset = std::max(offset, end);
+        }
+        offset = alignUp(offset, requirements.alignment);
+
+        resource.block = blockIndex;
+        resource.offset = offset;
+        block.memoryTypeBits &= requirements.memoryTypeBits;
+        block.size = std::max(block.size, offset + requirements.size);
+        block.alignment = std::max(block.alignment, requirements.alignment);
+        placed.push_back(imageIndex);
+    }
+
+    for (MemoryBlock& block : m_MemoryBlocks)
+    {
+        VkMemoryRequirements requirements{};
+        requirements.size = block.size;
+        requirements.alignment = block.alignment;
+        requirements.memoryTypeBits = block.memoryTypeBits;
+
+        VmaAllocationCreateInfo allocInfo{};
+        allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+        if (vmaAllocateMemory(m_Allocator, &requirements, &allocInfo, &block.allocation, nullptr) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to allocate render graph memory!");
+        }
+        m_TransientMemorySize += block.size;
+    }
+
+    for (uint32_t imageIndex : placed)
+    {
+        ImageResource& resource = m_Images[imageIndex];
+        if (vmaBindImageMemory2(m_Allocator, m_MemoryBlocks[resource.block].allocation, resource.offset, resource.image, nullptr) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to bind render graph image '" + resource.name + "'!");
+        }
+
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = resource.image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = resource.format;
+        viewInfo.subresourceRange = { resource.aspectMask, 0, 1, 0, 1 };
+        if (vkCreateImageView(m_pDevice->get(), &viewInfo, nullptr, &resource.view) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create render graph image view '" + resource.name + "'!");
+        }
+
+        // Images whose memory overlaps, whatever their lifetimes; their earlier uses are waited for on first use
+        for (uint32_t other : placed)
+        {
+            const ImageResource& otherResource = m_Images[other];
+            if (other != imageIndex && otherResource.block == resource.block &&
+                otherResource.offset < resource.offset + resource.memoryRequirements.size &&
+                resource.offset < otherResource.offset + otherResource.memoryRequirements.size)
+            {
+                resource.aliases.push_back(other);
+            }
+        }
+    }
+}
+
+void RenderGraph::addBarrier(std::vector<VkImageMemoryBarrier2>& barriers, ImageResource& resource, const ImageUse& use, bool firstUse)
+{
+    const AccessInfo info = getAccessInfo(use.access, resource.aspectMask);
+    ImageState& state = resource.state;
+
+    VkImageMemoryBarrier2 barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+    barrier.newLayout = info.layout;
+    barrier.dstStageMask = info.write ? info.stageMask : use.mergedStageMask;
+    barrier.dstAccessMask = info.write ? info.accessMask : use.mergedAccessMask;
+    barrier.image = resource.image;
+    barrier.subresourceRange = { resource.aspectMask, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS };
+
+    if (firstUse)
+    {
+        // The contents are discarded, but every earlier use of the memory has to be done with it:
+        // this image's own uses in the previous frame and those of the images it aliases
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.srcStageMask = state.writeStageMask | state.readStageMask;
+        barrier.srcAccessMask = state.writeAccessMask;
+        for (uint32_t alias : resource.aliases)
+        {
+            const ImageState& aliasState = m_Images[alias].state;
+            barrier.srcStageMask |= aliasState.writeStageMask | aliasState.readStageMask;
+            barrier.srcAccessMask |= aliasState.writeAccessMask;
+        }
+    }
+    else if (!info.write && state.layout == info.layout)
+    {
+        // Reads after reads need nothing, unless the last write is not yet visible to these stages
+        if ((state.readStageMask & info.stageMask) == info.stageMask && (state.readAccessMask & info.accessMask) == info.accessMask)
+        {
+            return;
+        }
+        if (state.writeStageMask != VK_PIPELINE_STAGE_2_NONE)
+        {
+            barrier.oldLayout = state.layout;
+            barrier.srcStageMask = state.writeStageMask;
+            barrier.srcAccessMask = state.writeAccessMask;
+            barriers.push_back(barrier);
+        }
+        state.readStageMask |= barrier.dstStageMask;
+        state.readAccessMask |= barrier.dstAccessMask;
+        return;
+    }
+    else
+    {
+        // Writes and layout transitions wait for the last write and every read since
+        barrier.oldLayout = state.layout;
+        barrier.srcStageMask = state.writeStageMask | state.readStageMask;
+        barrier.srcAccessMask = state.writeAccessMask;
+    }
+
+    if (barrier.oldLayout != barrier.newLayout || barrier.srcStageMask != VK_PIPELINE_STAGE_2_NONE)
+    {
+        barriers.push_back(barrier);
+    }
+
+    state = ImageState{};
+    state.layout = info.layout;
+    if (info.write)
+    {
+        state.writeStageMask = info.stageMask;
+        state.writeAccessMask = info.accessMask;
+    }
+    else
+    {
+        // Later passes order themselves after the reads that followed the transition
+        state.writeStageMask = barrier.dstStageMask;
+        state.readStageMask = barrier.dstStageMask;
+        state.readAccessMask = barrier.dstAccessMask;
+    }
+}
@@ -0,0 +1,168 @@
+// RenderGraph.h
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include "vk_mem_alloc.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+class Device;
+
+// Stays valid until the graph is destroyed
+struct RenderGraphImage
+{
+    uint32_t index = UINT32_MAX;
+};
+
+// How a pass uses an image; each maps to the layout, stages and accesses its barriers are built from
+enum class RenderGraphAccess
+{
+    ColorAttachmentWrite,
+    DepthAttachmentWrite,
+    // Depth test without depth writes; the image stays in its read-only layout
+    DepthAttachmentRead,
+    FragmentSampledRead,
+    ComputeSampledRead,
+    ComputeStorageRead,
+    ComputeStorageWrite,
+    TransferRead,
+    TransferWrite
+};
+
+//
+// Records a frame as passes that declare which images they read and write, in submission order.
+// compile() drops the passes nothing depends on, gives each transient image the usage its passes need,
+// and places transient images whose lifetimes do not overlap at the same offsets of shared memory.
+// execute() records the passes with one batched image barrier in front of each, derived from the
+// previous use of every image it touches. The graph keeps that state across frames, so a transient image
+// is shared by all frames in flight: its first barrier in a frame waits for its last use in the one before.
+// Buffers are not tracked; passes synchronise their own buffer accesses.
+//
+class RenderGraph
+{
+public:
+    class PassBuilder
+    {
+    public:
+        PassBuilder& use(RenderGraphImage image, RenderGraphAccess access);
+        // Keeps the pass even if no live pass reads its images, e.g. because its results are buffers
+        PassBuilder& setSideEffects();
+        PassBuilder& setExecute(std::function<void(VkCommandBuffer)> execute);
+
+    private:
+        friend class RenderGraph;
+        PassBuilder(RenderGraph* pGraph, uint32_t passIndex) : m_pGraph(pGraph), m_PassIndex(passIndex) {}
+
+        RenderGraph* m_pGraph;
+        uint32_t m_PassIndex;
+    };
+
+    RenderGraph(Device* pDevice, VmaAllocator allocator);
+    ~RenderGraph();
+
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+
+    // An image allocated by compile(); its contents do not outlive the frame, so its first use in a frame must write it
+    RenderGraphImage createImage(const std::string& name, uint32_t width, uint32_t height, VkFormat format, VkImageAspectFlags aspectMask);
+    // An image owned elsewhere, bound with setImportedImage() before each execute().
+    // It is left in finalLayout after the last pass, unless that is VK_IMAGE_LAYOUT_UNDEFINED.
+    RenderGraphImage importImage(const std::string& name, VkImageAspectFlags aspectMask, VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED);
+    // Passes run in the order they are added
+    PassBuilder addPass(const std::string& name);
+
+    void compile();
+
+    // layout is the image's current layout; stageMask and accessMask the work it must wait for
+    void setImportedImage(RenderGraphImage image, VkImage vkImage, VkImageLayout layout,
+        VkPipelineStageFlags2 stageMask, VkAccessFlags2 accessMask = VK_ACCESS_2_NONE);
+    void execute(VkCommandBuffer commandBuffer);
+
+    VkImage getImage(RenderGraphImage image) const;
+    // Views of transient images, covering their whole aspect
+    VkImageView getImageView(RenderGraphImage image) const;
+
+    // Bytes of memory backing the transient images, and what they would take without aliasing
+    VkDeviceSize getTransientMemorySize() const { return m_TransientMemorySize; }
+    VkDeviceSize getUnaliasedMemorySize() const { return m_UnaliasedMemorySize; }
+
+private:
+    struct ImageState
+    {
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        // Last write, or the layout transition before the reads that followed it
+        VkPipelineStageFlags2 writeStageMask = VK_PIPELINE_STAGE_2_NONE;
+        VkAccessFlags2 writeAccessMask = VK_ACCESS_2_NONE;
+        // Reads since then that the write is already visible to
+        VkPipelineStageFlags2 readStageMask = VK_PIPELINE_STAGE_2_NONE;
+        VkAccessFlags2 readAccessMask = VK_ACCESS_2_NONE;
+    };
+
+    struct ImageResource
+    {
+        std::string name;
+        bool imported = false;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        VkImageAspectFlags aspectMask = 0;
+        VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkImageUsageFlags usage = 0;
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        // First and last live pass that uses the image
+        uint32_t firstPass = UINT32_MAX;
+        uint32_t lastPass = 0;
+        // Where the image lives in the transient memory
+        uint32_t block = UINT32_MAX;
+        VkDeviceSize offset = 0;
+        VkMemoryRequirements memoryRequirements{};
+        // Transient images sharing some of its memory
+        std::vector<uint32_t> aliases;
+        ImageState state;
+    };
+
+    struct ImageUse
+    {
+        uint32_t image;
+        RenderGraphAccess access;
+        // This read and the reads right after it in the same layout, made visible by a single barrier
+        VkPipelineStageFlags2 mergedStageMask = VK_PIPELINE_STAGE_2_NONE;
+        VkAccessFlags2 mergedAccessMask = VK_ACCESS_2_NONE;
+    };
+
+    struct Pass
+    {
+        std::string name;
+        std::vector<ImageUse> uses;
+        std::function<void(VkCommandBuffer)> execute;
+        bool sideEffects = false;
+        bool live = false;
+    };
+
+    struct MemoryBlock
+    {
+        uint32_t memoryTypeBits = ~0u;
+        VkDeviceSize size = 0;
+        VkDeviceSize alignment = 1;
+        VmaAllocation allocation = VK_NULL_HANDLE;
+    };
+
+    void cullPasses();
+    void computeLifetimes();
+    void mergeReads();
+    void createTransientImages();
+    void allocateTransientMemory();
+    void addBarrier(std::vector<VkImageMemoryBarrier2>& barriers, ImageResource& resource, const ImageUse& use, bool firstUse);
+
+    Device* m_pDevice;
+    VmaAllocator m_Allocator;
+    std::vector<ImageResource> m_Images;
+    std::vector<Pass> m_Passes;
+    std::vector<MemoryBlock> m_MemoryBlocks;
+    VkDeviceSize m_TransientMemorySize = 0;
+    VkDeviceSize m_UnaliasedMemorySize = 0;
+    bool m_Compiled = false;
+};
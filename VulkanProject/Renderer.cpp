@@ -1,7 +1,10 @@
 #include "Renderer.h"
+#include <algorithm>
 #include <stdexcept>
 #include <array>
 #include <chrono>
+#include <random>
+#include <cmath>
 
 #define VMA_IMPLEMENTATION
 #include "vk_mem_alloc.h"
@@ -14,11 +17,43 @@
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/constants.hpp>
 
 #include <spdlog/spdlog.h>
 
 #include "Frustum.h"
 
+namespace
+{
+    // Level 0 reduces the depth buffer, every later level the one before it
+    std::vector<VkImageView> getDepthPyramidSourceViews(VkImageView depthImageView, const std::vector<VkImageView>& levelViews)
+    {
+        std::vector<VkImageView> sourceViews{ depthImageView };
+        sourceViews.insert(sourceViews.end(), levelViews.begin(), levelViews.end() - 1);
+        return sourceViews;
+    }
+
+    VkViewport getViewport(VkExtent2D extent)
+    {
+        VkViewport viewport{};
+        viewport.x = 0.0f;
+        viewport.y = 0.0f;
+        viewport.width = static_cast<float>(extent.width);
+        viewport.height = static_cast<float>(extent.height);
+        viewport.minDepth = 0.0f;
+        viewport.maxDepth = 1.0f;
+        return viewport;
+    }
+
+    VkRect2D getScissor(VkExtent2D extent)
+    {
+        VkRect2D scissor{};
+        scissor.offset = { 0, 0 };
+        scissor.extent = extent;
+        return scissor;
+    }
+}
+
 Renderer::Renderer(Window* window)
     : m_pWindow(window),
       m_pCamera(nullptr)  // Initialize to nullptr
@@ -56,6 +91,11 @@ void Renderer::initVulkan()
 
     VkPhysicalDeviceFeatures deviceFeatures{};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
+    // Cooked textures are BC1/BC3/BC5/BC7
+    deviceFeatures.textureCompressionBC = VK_TRUE;
+    // Culled draws are issued indirectly, with the material index in firstInstance
+    deviceFeatures.multiDrawIndirect = VK_TRUE;
+    deviceFeatures.drawIndirectFirstInstance = VK_TRUE;
 
 	//Vulkan 1.1 features
 	VkPhysicalDeviceVulkan11Features vulkan11Features{};
@@ -66,6 +106,10 @@ void Renderer::initVulkan()
     vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
     vulkan12Features.runtimeDescriptorArray = VK_TRUE;
 	vulkan12Features.descriptorIndexing = VK_TRUE;
+    vulkan12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+    // The G-buffer pass draws as many meshlets as the culling pass counted
+    vulkan12Features.drawIndirectCount = VK_TRUE;
+    vulkan12Features.timelineSemaphore = VK_TRUE;
 
 	//Vulkan 1.3 features
 	VkPhysicalDeviceVulkan13Features vulkan13Features{};
@@ -129,30 +173,34 @@ void Renderer::initVulkan()
     //m_pRenderPass = new RenderPass(m_pDevice->get(), m_pSwapChain->getImageFormat(), findDepthFormat());
     createVmaAllocator();
     m_pCommandPool = new CommandPool(m_pDevice->get(), m_pPhysicalDevice->getQueueFamilyIndices().graphicsFamily.value());
+    m_pUploadBatch = new UploadBatch(m_pDevice, m_VmaAllocator,
+        m_pPhysicalDevice->getQueueFamilyIndices().transferFamily.value(), m_pDevice->getTransferQueue(),
+        m_pPhysicalDevice->getQueueFamilyIndices().graphicsFamily.value(), m_pDevice->getGraphicsQueue());
 
 	createGBuffer();
+    createRenderGraph();
 
-	createHDRImage();
+    createLightClusterBuffers();
+    m_pLightManager = new LightManager(m_VmaAllocator, MAX_FRAMES_IN_FLIGHT);
 
-	createLDRImage();
+    createUniformRing();
 
-    createLightBuffer();
+    m_pThreadPool = new ThreadPool();
+    m_pTextureCache = new TextureCache(m_pDevice, m_VmaAllocator, m_pUploadBatch, m_pPhysicalDevice->get(), m_pThreadPool);
 
-	m_Lights.push_back(Light{ glm::vec3(6.0f, 1.f, -0.2f), glm::vec3(1.f, 0.5f, 1.0f), 3.0f, 100.0f });
-
-    createSunMatricesBuffers();
+    m_pModel = new Model(m_VmaAllocator, m_pDevice, m_pPhysicalDevice, m_pUploadBatch, m_pThreadPool, m_pTextureCache, MODEL_PATH_);
+    m_pModel->loadModel();
 
+    createPointLights();
     for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
     {
-		updateLightBuffer(i);
-        updateSunMatricesBuffer(i);
+        m_pLightManager->upload(i);
+        m_LightBufferGenerations[i] = m_pLightManager->getBufferGeneration(i);
     }
+    m_LightAnimationStart = std::chrono::high_resolution_clock::now();
 
-    m_pModel = new Model(m_VmaAllocator, m_pDevice, m_pPhysicalDevice, m_pCommandPool, MODEL_PATH_);
-    m_pModel->loadModel();
-
-    size_t materialCount = m_pModel->getMaterials().size();
-    m_pDescriptorManager = new DescriptorManager(m_pDevice->get(), MAX_FRAMES_IN_FLIGHT, materialCount);
+    m_pModel->createMaterialBuffer();
+    m_pDescriptorManager = new DescriptorManager(m_pDevice->get(), MAX_FRAMES_IN_FLIGHT, m_pModel->getTextures().size());
 
     createSkyboxCubeMap();
 	createIrradianceMap();
@@ -161,48 +209,52 @@ void Renderer::initVulkan()
     m_pDescriptorManager->createDescriptorSetLayout();
     m_pDescriptorManager->createFinalPassDescriptorSetLayout();
 	m_pDescriptorManager->createComputeDescriptorSetLayout();
+    m_pDescriptorManager->createDepthPyramidDescriptorSetLayout();
+    m_pDescriptorManager->createCullDescriptorSetLayout();
+    m_pDescriptorManager->createOcclusionDescriptorSetLayout();
+    m_pDescriptorManager->createMeshletCullDescriptorSetLayout();
+    m_pDescriptorManager->createLightCullDescriptorSetLayout();
+    m_pDescriptorManager->createLightAnimateDescriptorSetLayout();
 
     m_pDescriptorManager->createDescriptorPool();
 
     m_pModel->createVertexBuffer();
     m_pModel->createIndexBuffer();
-
-    createUniformBuffers();
-
-    // Gather uniform buffer handles
-    std::vector<VkBuffer> uniformBufferHandles;
-    for (const auto& buffer : m_pUniformBuffers) {
-        uniformBufferHandles.push_back(buffer->get());
-    }
-
-    // Get materials from the Model
-    const std::vector<Material*>& materials = m_pModel->getMaterials();
+    m_pModel->createMeshletBuffer();
+    m_pModel->createSubmeshBuffer();
+    m_pVisibilityList = new VisibilityList(m_VmaAllocator, m_pUploadBatch, MAX_FRAMES_IN_FLIGHT, m_pModel->getSubmeshCount());
+    createDrawCommandBuffers();
 
     // Create descriptor sets for the main pass
     m_pDescriptorManager->createDescriptorSets(
-        uniformBufferHandles,
-        materials,
-        sizeof(UniformBufferObject)
+        m_pUniformRing->get(),
+        sizeof(UniformBufferObject),
+        m_pModel->getMaterialBuffer(),
+        m_pModel->getMaterialBufferSize(),
+        m_pModel->getTextures()
     );
+    m_TextureDescriptorGenerations.fill(m_pTextureCache->getGeneration());
 
     // Create descriptor set for the final pass
     for (size_t frameIndex = 0; frameIndex < MAX_FRAMES_IN_FLIGHT; ++frameIndex)
     {
         m_pDescriptorManager->createFinalPassDescriptorSet(
             frameIndex,
-            m_GBuffers[frameIndex].diffuseImageView,
-            m_GBuffers[frameIndex].normalImageView,
-            m_GBuffers[frameIndex].metallicRoughnessImageView,
-            m_GBuffers[frameIndex].depthImageView,
-            m_pUniformBuffers[frameIndex]->get(),
+            m_pRenderGraph->getImageView(m_DiffuseImage),
+            m_pRenderGraph->getImageView(m_NormalImage),
+            m_pRenderGraph->getImageView(m_MetallicRoughnessImage),
+            m_pRenderGraph->getImageView(m_DepthImage),
+            m_pUniformRing->get(),
             sizeof(UniformBufferObject),
-			m_pLightBuffers[frameIndex]->get(),
-			sizeof(Light) * MAX_LIGHT_COUNT + sizeof(uint32_t),
-			m_pSunMatricesBuffers[frameIndex]->get(),
+			m_pLightManager->getLightBuffer(frameIndex),
+			m_pLightManager->getLightBufferSize(frameIndex),
+			m_pUniformRing->get(),
 			sizeof(SunMatricesUBO),
 			m_GBuffers[frameIndex].shadowMapImageView, // Shadow map image view
 			m_SkyboxCubeMapImageView, // Skybox cube map image view
 			m_IrradianceMapImageView, // Irradiance map image view
+            m_pLightClusterBuffers[frameIndex]->get(),
+            LIGHT_CLUSTER_BUFFER_SIZE,
             Texture::getTextureSampler() // Ensure this sampler is created
         );
     }
@@ -212,11 +264,78 @@ void Renderer::initVulkan()
     {
         m_pDescriptorManager->createComputeDescriptorSet(
 			i,
-			m_HDRImageView[i],
-			m_LDRImageView[i]
+			m_pRenderGraph->getImageView(m_HDRImage),
+			m_pRenderGraph->getImageView(m_LDRImage)
 		);
     }
 
+    // Create descriptor sets for submesh culling, the depth pyramid, the occlusion test, meshlet culling and light culling
+    for (size_t frameIndex = 0; frameIndex < MAX_FRAMES_IN_FLIGHT; ++frameIndex)
+    {
+        const GBuffer& gBuffer = m_GBuffers[frameIndex];
+        m_pDescriptorManager->createCullDescriptorSet(
+            frameIndex,
+            m_pModel->getSubmeshBuffer(),
+            m_pModel->getSubmeshBufferSize(),
+            m_pVisibilityList->getDrawBuffer(frameIndex),
+            m_pVisibilityList->getDrawBoundsBuffer(frameIndex),
+            m_pVisibilityList->getMaxDrawCount(),
+            m_pVisibilityList->getLodBuffer(),
+            m_pVisibilityList->getLodBufferSize(),
+            m_pCullCounterBuffers[frameIndex]->get(),
+            sizeof(CullCounters)
+        );
+        m_pDescriptorManager->createDepthPyramidDescriptorSets(
+            frameIndex,
+            getDepthPyramidSourceViews(m_pRenderGraph->getImageView(m_DepthImage), gBuffer.depthPyramidLevelViews),
+            gBuffer.depthPyramidLevelViews,
+            Texture::getTextureSampler()
+        );
+        m_pDescriptorManager->createOcclusionDescriptorSet(
+            frameIndex,
+            m_pVisibilityList->getDrawBuffer(frameIndex),
+            m_pVisibilityList->getDrawBoundsBuffer(frameIndex),
+            m_pOccludedDrawCommandBuffers[frameIndex]->get(),
+            m_pVisibilityList->getMaxDrawCount(),
+            m_pCullCounterBuffers[frameIndex]->get(),
+            sizeof(CullCounters),
+            gBuffer.depthPyramidImageView,
+            Texture::getTextureSampler()
+        );
+        m_pDescriptorManager->createMeshletCullDescriptorSet(
+            frameIndex,
+            m_pOccludedDrawCommandBuffers[frameIndex]->get(),
+            m_pVisibilityList->getDrawBoundsBuffer(frameIndex),
+            m_pVisibilityList->getMaxDrawCount(),
+            m_pModel->getMeshletBuffer(),
+            m_pModel->getMeshletBufferSize(),
+            m_pMeshletDrawCommandBuffers[frameIndex]->get(),
+            std::max(m_pModel->getMeshletCount(), 1u),
+            m_pCullCounterBuffers[frameIndex]->get(),
+            sizeof(CullCounters),
+            gBuffer.depthPyramidImageView,
+            Texture::getTextureSampler()
+        );
+        m_pDescriptorManager->createLightCullDescriptorSet(
+            frameIndex,
+            m_pUniformRing->get(),
+            sizeof(UniformBufferObject),
+            m_pLightManager->getLightBuffer(frameIndex),
+            m_pLightManager->getLightBufferSize(frameIndex),
+            m_pRenderGraph->getImageView(m_DepthImage),
+            m_pLightClusterBuffers[frameIndex]->get(),
+            LIGHT_CLUSTER_BUFFER_SIZE,
+            Texture::getTextureSampler()
+        );
+        m_pDescriptorManager->createLightAnimateDescriptorSet(
+            frameIndex,
+            m_pLightManager->getSourceBuffer(frameIndex),
+            m_pLightManager->getSourceBufferSize(frameIndex),
+            m_pLightManager->getLightBuffer(frameIndex),
+            m_pLightManager->getLightBufferSize(frameIndex)
+        );
+    }
+
     createCommandBuffers();
 
     m_pGraphicsPipeline = GraphicsPipelineBuilder()
@@ -225,7 +344,7 @@ void Renderer::initVulkan()
         .setSwapChainExtent(m_pSwapChain->getExtent())
         .setColorFormats({ VK_FORMAT_R8G8B8A8_SRGB, VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_R8G8B8A8_UNORM}) // Multiple color formats
         .setDepthFormat(findDepthFormat())
-        .setVertexInputBindingDescription(Vertex::getBindingDescription())
+        .setVertexInputBindingDescriptions(Vertex::getBindingDescriptions())
         .setVertexInputAttributeDescriptions(Vertex::getAttributeDescriptions())
         .setShaderPaths("shaders/shader.vert.spv", "shaders/shader.frag.spv")
 		.setAttachmentCount(3)
@@ -239,8 +358,8 @@ void Renderer::initVulkan()
 		.setDescriptorSetLayout(m_pDescriptorManager->getDescriptorSetLayout())
         .setSwapChainExtent(m_pSwapChain->getExtent())
         .setDepthFormat(findDepthFormat())
-        .setVertexInputBindingDescription(Vertex::getBindingDescription())
-        .setVertexInputAttributeDescriptions(Vertex::getDepthAttributeDescriptions())
+        .setVertexInputBindingDescriptions(Vertex::getBindingDescriptions(VERTEX_STREAM_TEXCOORD))
+        .setVertexInputAttributeDescriptions(Vertex::getAttributeDescriptions(VERTEX_STREAM_TEXCOORD))
         .setShaderPaths("shaders/depth.vert.spv", "shaders/depth.frag.spv")
         .setAttachmentCount(1)
         .enableDepthTest(true)
@@ -254,8 +373,8 @@ void Renderer::initVulkan()
 		.setDescriptorSetLayout(m_pDescriptorManager->getDescriptorSetLayout())
 		.setSwapChainExtent(m_pSwapChain->getExtent())
 		.setDepthFormat(findDepthFormat())
-		.setVertexInputBindingDescription(Vertex::getBindingDescription())
-		.setVertexInputAttributeDescriptions(Vertex::getDepthAttributeDescriptions())
+		.setVertexInputBindingDescriptions(Vertex::getBindingDescriptions(VERTEX_STREAM_POSITION))
+		.setVertexInputAttributeDescriptions(Vertex::getAttributeDescriptions(VERTEX_STREAM_POSITION))
 		.setShaderPaths("shaders/shadow_map.vert.spv", "shaders/shadow_map.frag.spv")
 		.setAttachmentCount(1)
 		.enableDepthTest(true)
@@ -267,8 +386,6 @@ void Renderer::initVulkan()
 		.setPushConstantRange(sizeof(glm::mat4) * 2) // View and projection matrices
 		.build();
 
-	renderShadowMap();
-
     // Create the final pass graphics pipeline
     m_pFinalPipeline = GraphicsPipelineBuilder()
         .setDevice(m_pDevice->get())
@@ -293,9 +410,49 @@ void Renderer::initVulkan()
 		.setPushConstantRange(sizeof(ToneMappingPushConstants))
 		.build();
 
+    m_pDepthPyramidPipeline = ComputePipelineBuilder()
+        .setDevice(m_pDevice)
+        .setShaderPath("shaders/depth_pyramid.comp.spv")
+        .setDescriptorSetLayout(m_pDescriptorManager->getDepthPyramidDescriptorSetLayout())
+        .build();
+
+    m_pCullPipeline = ComputePipelineBuilder()
+        .setDevice(m_pDevice)
+        .setShaderPath("shaders/cull.comp.spv")
+        .setDescriptorSetLayout(m_pDescriptorManager->getCullDescriptorSetLayout())
+        .setPushConstantRange(sizeof(CullPushConstants))
+        .build();
+
+    m_pOcclusionPipeline = ComputePipelineBuilder()
+        .setDevice(m_pDevice)
+        .setShaderPath("shaders/occlusion.comp.spv")
+        .setDescriptorSetLayout(m_pDescriptorManager->getOcclusionDescriptorSetLayout())
+        .setPushConstantRange(sizeof(OcclusionPushConstants))
+        .build();
+
+    m_pMeshletCullPipeline = ComputePipelineBuilder()
+        .setDevice(m_pDevice)
+        .setShaderPath("shaders/meshlet_cull.comp.spv")
+        .setDescriptorSetLayout(m_pDescriptorManager->getMeshletCullDescriptorSetLayout())
+        .setPushConstantRange(sizeof(MeshletCullPushConstants))
+        .build();
+
+    m_pLightCullPipeline = ComputePipelineBuilder()
+        .setDevice(m_pDevice)
+        .setShaderPath("shaders/light_cull.comp.spv")
+        .setDescriptorSetLayout(m_pDescriptorManager->getLightCullDescriptorSetLayout())
+        .build();
+
+    m_pLightAnimatePipeline = ComputePipelineBuilder()
+        .setDevice(m_pDevice)
+        .setShaderPath("shaders/light_animate.comp.spv")
+        .setDescriptorSetLayout(m_pDescriptorManager->getLightAnimateDescriptorSetLayout())
+        .setPushConstantRange(sizeof(LightAnimatePushConstants))
+        .build();
+
     m_pSyncObjects = new SynchronizationObjects(m_pDevice->get(), MAX_FRAMES_IN_FLIGHT);
 
-    transitionSwapchainImagesToPresentLayout();
+    m_pUploadBatch->submit();
 }
 
 void Renderer::createVmaAllocator() 
@@ -430,6 +587,9 @@ void Renderer::renderToCubeMap(
 
     vkUpdateDescriptorSets(m_pDevice->get(), 1, &descriptorWrite, 0, nullptr);
 
+    // The input image upload and queued transitions have to reach the queue before this submission
+    m_pUploadBatch->submit();
+
     // Begin command buffer
     VkCommandBuffer commandBuffer = m_pCommandPool->beginSingleTimeCommands();
 
@@ -569,54 +729,66 @@ void Renderer::renderToCubeMap(
 }
 
 
-void Renderer::createUniformBuffers() 
+void Renderer::createUniformRing()
 {
-    VkDeviceSize bufferSize = sizeof(UniformBufferObject);
-    m_pUniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    // Dynamic offsets must be multiples of the device's uniform offset alignment
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(m_pPhysicalDevice->get(), &properties);
 
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        m_pUniformBuffers[i] = new Buffer(
-            m_VmaAllocator,
-            bufferSize,
-            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-            VMA_MEMORY_USAGE_CPU_TO_GPU,
-            VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
-            VMA_ALLOCATION_CREATE_MAPPED_BIT
-        );
-    }
+    m_pUniformRing = new UniformRing(
+        m_VmaAllocator,
+        UNIFORM_RING_FRAME_SIZE,
+        MAX_FRAMES_IN_FLIGHT,
+        properties.limits.minUniformBufferOffsetAlignment
+    );
 }
 
-void Renderer::createLightBuffer()
+void Renderer::createLightClusterBuffers()
 {
-    VkDeviceSize bufferSize = sizeof(uint32_t) + sizeof(Light) * MAX_LIGHT_COUNT;
-	m_pLightBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    m_pLightClusterBuffers.resize(MAX_FRAMES_IN_FLIGHT);
 
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        m_pLightBuffers[i] = new Buffer(
+        m_pLightClusterBuffers[i] = new Buffer(
             m_VmaAllocator,
-            bufferSize,
+            LIGHT_CLUSTER_BUFFER_SIZE,
             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-            VMA_MEMORY_USAGE_CPU_TO_GPU,
-            VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
-            VMA_ALLOCATION_CREATE_MAPPED_BIT
+            VMA_MEMORY_USAGE_GPU_ONLY
         );
     }
 }
 
-void Renderer::createSunMatricesBuffers()
+void Renderer::createDrawCommandBuffers()
 {
-    VkDeviceSize bufferSize = sizeof(SunMatricesUBO);
-    m_pSunMatricesBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    VkDeviceSize bufferSize = sizeof(VkDrawIndexedIndirectCommand) * m_pVisibilityList->getMaxDrawCount();
+    VkDeviceSize meshletBufferSize = sizeof(VkDrawIndexedIndirectCommand) * std::max(m_pModel->getMeshletCount(), 1u);
+    m_pOccludedDrawCommandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    m_pMeshletDrawCommandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    m_pCullCounterBuffers.resize(MAX_FRAMES_IN_FLIGHT);
 
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        m_pSunMatricesBuffers[i] = new Buffer(
+        m_pOccludedDrawCommandBuffers[i] = new Buffer(
             m_VmaAllocator,
             bufferSize,
-            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-            VMA_MEMORY_USAGE_CPU_TO_GPU,
-            VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY
+        );
+        m_pMeshletDrawCommandBuffers[i] = new Buffer(
+            m_VmaAllocator,
+            meshletBufferSize,
+            VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY
+        );
+        // Read back on the CPU once the frame's fence is signalled; also holds the submesh and meshlet draw counts
+        m_pCullCounterBuffers[i] = new Buffer(
+            m_VmaAllocator,
+            sizeof(CullCounters),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+            VMA_MEMORY_USAGE_GPU_TO_CPU,
+            VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT |
             VMA_ALLOCATION_CREATE_MAPPED_BIT
         );
+        memset(m_pCullCounterBuffers[i]->map(), 0, sizeof(CullCounters));
+        m_pCullCounterBuffers[i]->flush();
     }
 }
 
@@ -645,21 +817,7 @@ void Renderer::createSkyboxCubeMap()
     }
     VkDeviceSize imageSize = texWidth * texHeight * 4 * sizeof(float);
 
-    // **2. Create Staging Buffer and Copy Data**
-    Buffer stagingBuffer(
-        m_VmaAllocator,
-        imageSize,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VMA_MEMORY_USAGE_CPU_ONLY
-    );
-
-    void* data = stagingBuffer.map();
-    memcpy(data, pixels, static_cast<size_t>(imageSize));
-    stagingBuffer.unmap();
-
-    stbi_image_free(pixels);
-
-    // **3. Create HDRI Image**
+    // **2. Create HDRI Image**
     Image* pHDRIImage = new Image(m_pDevice, m_VmaAllocator);
     pHDRIImage->createImage(
         texWidth,
@@ -670,45 +828,10 @@ void Renderer::createSkyboxCubeMap()
         VMA_MEMORY_USAGE_GPU_ONLY
     );
 
-    // **4. Copy Data from Staging Buffer to HDRI Image**
-    {
-        VkCommandBuffer commandBuffer = m_pCommandPool->beginSingleTimeCommands();
-        transitionImageLayout(
-            commandBuffer,
-            pHDRIImage,
-            VK_IMAGE_LAYOUT_UNDEFINED,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
-            VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-            0,
-            VK_ACCESS_2_TRANSFER_WRITE_BIT,
-            VK_IMAGE_ASPECT_COLOR_BIT
-        );
-        m_pCommandPool->endSingleTimeCommands(commandBuffer, m_pDevice->getGraphicsQueue());
-    }
-
-    pHDRIImage->copyBufferToImage(
-        m_pCommandPool,
-        stagingBuffer.get(),
-        static_cast<uint32_t>(texWidth),
-        static_cast<uint32_t>(texHeight)
-    );
+    // **3-4. Stage the pixels and copy them into the HDRI Image**
+    m_pUploadBatch->uploadImage(pHDRIImage, pixels, imageSize);
 
-    {
-        VkCommandBuffer commandBuffer = m_pCommandPool->beginSingleTimeCommands();
-        transitionImageLayout(
-            commandBuffer,
-            pHDRIImage,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-            VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-            VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
-            VK_ACCESS_2_TRANSFER_WRITE_BIT,
-            VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
-            VK_IMAGE_ASPECT_COLOR_BIT
-        );
-        m_pCommandPool->endSingleTimeCommands(commandBuffer, m_pDevice->getGraphicsQueue());
-    }
+    stbi_image_free(pixels);
 
     // **5. Create Image View for HDRI Image**
     VkImageView pHDRIImageView = pHDRIImage->createImageView(
@@ -762,21 +885,16 @@ void Renderer::createSkyboxCubeMap()
         }
     }
 
-    {
-        VkCommandBuffer commandBuffer = m_pCommandPool->beginSingleTimeCommands();
-        transitionImageLayout(
-            commandBuffer,
-            m_pSkyboxCubeMapImage,
-            VK_IMAGE_LAYOUT_UNDEFINED,
-            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-            VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
-            VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-            0,
-            VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
-            VK_IMAGE_ASPECT_COLOR_BIT
-        );
-        m_pCommandPool->endSingleTimeCommands(commandBuffer, m_pDevice->getGraphicsQueue());
-    }
+    m_pUploadBatch->transitionImage(
+        m_pSkyboxCubeMapImage,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+        VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
+        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+        0,
+        VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+        VK_IMAGE_ASPECT_COLOR_BIT
+    );
 
     // **8. Render to Cube Map**
     renderToCubeMap(
@@ -813,22 +931,8 @@ void Renderer::createSkyboxCubeMap()
 		throw std::runtime_error("Failed to create image view for cube map!");
 	}
 
-    // Transition Skybox Cube Map to SHADER_READ_ONLY_OPTIMAL
-    {
-        VkCommandBuffer commandBuffer = m_pCommandPool->beginSingleTimeCommands();
-        transitionImageLayout(
-            commandBuffer,
-            m_pSkyboxCubeMapImage,
-            VK_IMAGE_LAYOUT_UNDEFINED,
-            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-            VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
-            VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
-            0,
-            VK_ACCESS_2_SHADER_READ_BIT,
-            VK_IMAGE_ASPECT_COLOR_BIT
-        );
-        m_pCommandPool->endSingleTimeCommands(commandBuffer, m_pDevice->getGraphicsQueue());
-    }
+    // renderToCubeMap already left every face in SHADER_READ_ONLY_OPTIMAL
+    m_pSkyboxCubeMapImage->setImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 }
 
 void Renderer::createIrradianceMap()
@@ -847,21 +951,16 @@ void Renderer::createIrradianceMap()
     );
 
     // Transition Irradiance Map to COLOR_ATTACHMENT_OPTIMAL for rendering
-    {
-        VkCommandBuffer commandBuffer = m_pCommandPool->beginSingleTimeCommands();
-        transitionImageLayout(
-            commandBuffer,
-            m_pIrradianceMapImage,
-            VK_IMAGE_LAYOUT_UNDEFINED,
-            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-            VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
-            VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-            0,
-            VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
-            VK_IMAGE_ASPECT_COLOR_BIT
-        );
-        m_pCommandPool->endSingleTimeCommands(commandBuffer, m_pDevice->getGraphicsQueue());
-    }
+    m_pUploadBatch->transitionImage(
+        m_pIrradianceMapImage,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+        VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
+        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+        0,
+        VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+        VK_IMAGE_ASPECT_COLOR_BIT
+    );
 
 	for (int face = 0; face < 6; ++face)
 	{
@@ -914,83 +1013,94 @@ void Renderer::createIrradianceMap()
     }
 }
 
-void Renderer::renderShadowMap()
+void Renderer::updateShadowCascades(uint32_t currentImage)
 {
     auto [aabbMin, aabbMax] = m_pModel->getAABB();
-    glm::vec3 sceneCenter = (aabbMin + aabbMax) * 0.5f;
     glm::vec3 lightDirection = glm::normalize(glm::vec3(-0.2f, -1.0f, -0.4f));
 
-    std::vector<glm::vec3> corners = {
-        {aabbMin.x, aabbMin.y, aabbMin.z},
-        {aabbMax.x, aabbMin.y, aabbMin.z},
-        {aabbMin.x, aabbMax.y, aabbMin.z},
-        {aabbMax.x, aabbMax.y, aabbMin.z},
-        {aabbMin.x, aabbMin.y, aabbMax.z},
-        {aabbMax.x, aabbMin.y, aabbMax.z},
-        {aabbMin.x, aabbMax.y, aabbMax.z},
-        {aabbMax.x, aabbMax.y, aabbMax.z},
-    };
+    // Nothing beyond the far side of the model can receive a shadow
+    std::array<ShadowCascade, SHADOW_CASCADE_COUNT> cascades;
+    const float shadowDistance = std::min(CAMERA_FAR_PLANE, CAMERA_NEAR_PLANE + glm::length(aabbMax - aabbMin));
+    computeShadowCascades(m_UniformBufferObject.view, m_UniformBufferObject.proj, CAMERA_NEAR_PLANE, shadowDistance,
+        SHADOW_SPLIT_LAMBDA, lightDirection, aabbMin, aabbMax, SHADOW_MAP_SIZE, cascades.data());
 
-    float minProj = std::numeric_limits<float>::max();
-    float maxProj = std::numeric_limits<float>::lowest();
-    for (const glm::vec3& corner : corners) {
-        float proj = glm::dot(corner, lightDirection);
-        minProj = std::min(minProj, proj);
-        maxProj = std::max(maxProj, proj);
-    }
+    m_CullStatistics.shadowCascadeRenderCount = 0;
+    m_CullStatistics.shadowCasterDrawCount = 0;
 
-    float distance = maxProj - glm::dot(sceneCenter, lightDirection);
-    glm::vec3 lightPos = sceneCenter - lightDirection * distance * 2.f;
-    glm::vec3 up = glm::abs(glm::dot(lightDirection, glm::vec3(0.f, 1.f, 0.f))) > 0.99f
-        ? glm::vec3(0.f, 0.f, 1.f)
-        : glm::vec3(0.f, 1.f, 0.f);
+    const std::vector<Submesh>& submeshes = m_pModel->getSubmeshes();
+    for (uint32_t cascade = 0; cascade < SHADOW_CASCADE_COUNT; ++cascade)
+    {
+        // Casters lie in the cascade's slice extruded towards the light. The shadow shader has no model
+        // matrix, so the hierarchy's model-space bounds are tested directly.
+        m_ShadowCasters.clear();
+        m_pModel->getBvh().cullFrustum(Frustum(cascades[cascade].casterProjection, cascades[cascade].view), m_ShadowCasters);
 
-    glm::mat4 lightView = glm::lookAt(lightPos, sceneCenter, up);
+        // Each submesh indexes its own vertices, so every caster is its own draw; buffer order keeps fetches sequential
+        std::sort(m_ShadowCasters.begin(), m_ShadowCasters.end(), [&](uint32_t a, uint32_t b)
+        {
+            return submeshes[a].indexStart < submeshes[b].indexStart;
+        });
+
+        // The frame's layer is kept, along with the matrices it was rendered with, until the light maps the
+        // world to other texels or the casters change
+        CachedShadowCascade& cached = m_CachedShadowCascades[currentImage][cascade];
+        const bool dirty = !cached.valid || !hasSameShadowMapping(cached.cascade, cascades[cascade]) || cached.casters != m_ShadowCasters;
+        m_DirtyShadowCascades[cascade] = dirty;
+        if (dirty)
+        {
+            cached.valid = true;
+            cached.cascade = cascades[cascade];
+            cached.casters.swap(m_ShadowCasters);
 
-    glm::vec3 minLS(std::numeric_limits<float>::max());
-    glm::vec3 maxLS(-std::numeric_limits<float>::max());
-    for (const glm::vec3& corner : corners) {
-        glm::vec3 tr = glm::vec3(lightView * glm::vec4(corner, 1.0f));
-        minLS = glm::min(minLS, tr);
-        maxLS = glm::max(maxLS, tr);
+            m_CullStatistics.shadowCascadeRenderCount++;
+            m_CullStatistics.shadowCasterDrawCount += static_cast<uint32_t>(cached.casters.size());
+        }
     }
+}
 
-    float nearZ = 0.000f;
-    float farZ = (maxLS.z - minLS.z) * 1.5f;
-    glm::mat4 lightProj = glm::ortho(
-        minLS.x, maxLS.x,
-        minLS.y, maxLS.y,
-        nearZ, farZ
-    );
-    lightProj[1][1] *= -1.0f;
+void Renderer::recordShadowPass(VkCommandBuffer commandBuffer)
+{
+    GBuffer& currentGBuffer = m_GBuffers[m_currentFrame];
+
+    VkViewport viewport{};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = static_cast<float>(SHADOW_MAP_SIZE);
+    viewport.height = static_cast<float>(SHADOW_MAP_SIZE);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
 
-    // Store the matrices in the Renderer class
-    m_LightProj = lightProj;
-    m_LightView = lightView;
+    VkRect2D scissor{};
+    scissor.offset = { 0, 0 };
+    scissor.extent = { SHADOW_MAP_SIZE, SHADOW_MAP_SIZE };
 
-    // 2. For each frame in flight, render the shadow map
-    for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+    const std::vector<Submesh>& submeshes = m_pModel->getSubmeshes();
+    for (uint32_t cascade = 0; cascade < SHADOW_CASCADE_COUNT; ++cascade)
     {
-        // Begin single time command buffer (or use your frame's command buffer if you want to batch)
-        VkCommandBuffer commandBuffer = m_pCommandPool->beginSingleTimeCommands();
+        // Clean layers keep their contents and stay readable
+        if (!m_DirtyShadowCascades[cascade])
+        {
+            continue;
+        }
+        const CachedShadowCascade& cached = m_CachedShadowCascades[m_currentFrame][cascade];
 
-        // Transition shadow map image to depth attachment optimal
+        // The last lighting pass that used this frame's shadow map is done reading it
         transitionImageLayout(
             commandBuffer,
-            m_GBuffers[i].pShadowMapImage,
+            currentGBuffer.pShadowMapImage,
             VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
             VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
             VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
             VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
             VK_ACCESS_2_SHADER_READ_BIT,
             VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
-            VK_IMAGE_ASPECT_DEPTH_BIT
+            VK_IMAGE_ASPECT_DEPTH_BIT,
+            cascade
         );
 
-        // Set up rendering info
         VkRenderingAttachmentInfo depthAttachment{};
         depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
-        depthAttachment.imageView = m_GBuffers[i].shadowMapImageView;
+        depthAttachment.imageView = currentGBuffer.shadowCascadeImageViews[cascade];
         depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
         depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
         depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
@@ -999,44 +1109,27 @@ void Renderer::renderShadowMap()
         VkRenderingInfo renderingInfo{};
         renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
         renderingInfo.renderArea.offset = { 0, 0 };
-        renderingInfo.renderArea.extent = { m_GBuffers[i].pShadowMapImage->getWidth(), m_GBuffers[i].pShadowMapImage->getHeight() };
+        renderingInfo.renderArea.extent = { SHADOW_MAP_SIZE, SHADOW_MAP_SIZE };
         renderingInfo.layerCount = 1;
         renderingInfo.colorAttachmentCount = 0;
         renderingInfo.pDepthAttachment = &depthAttachment;
 
         vkCmdBeginRendering(commandBuffer, &renderingInfo);
 
-        // Bind shadow map pipeline
         vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pShadowMapPipeline->get());
-
-        // Bind vertex and index buffers
-        VkBuffer vertexBuffers[] = { m_pModel->getVertexBuffer() };
-        VkDeviceSize offsets[] = { 0 };
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-        vkCmdBindIndexBuffer(commandBuffer, m_pModel->getIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
-
-        // Set viewport and scissor
-        VkViewport viewport{};
-        viewport.x = 0.0f;
-        viewport.y = 0.0f;
-        viewport.width = static_cast<float>(m_GBuffers[i].pShadowMapImage->getWidth());
-        viewport.height = static_cast<float>(m_GBuffers[i].pShadowMapImage->getHeight());
-        viewport.minDepth = 0.0f;
-        viewport.maxDepth = 1.0f;
+        m_pModel->bindVertexBuffers(commandBuffer, VERTEX_STREAM_POSITION);
+        m_pModel->bindIndexBuffer(commandBuffer);
         vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
-
-        VkRect2D scissor{};
-        scissor.offset = { 0, 0 };
-        scissor.extent = { m_GBuffers[i].pShadowMapImage->getWidth(), m_GBuffers[i].pShadowMapImage->getHeight() };
         vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-        // Push constants or bind UBO for lightView and lightProj as needed by your shadow map shaders
         struct ShadowPushConstants {
             glm::mat4 lightView;
             glm::mat4 lightProj;
         } shadowPC;
-        shadowPC.lightView = lightView;
-        shadowPC.lightProj = lightProj;
+        // The shadow shader has no uniforms, so the position dequantization is folded into the light view
+        shadowPC.lightView = cached.cascade.view * glm::translate(glm::mat4(1.0f), m_pModel->getPositionOffset()) *
+            glm::scale(glm::mat4(1.0f), m_pModel->getPositionScale());
+        shadowPC.lightProj = cached.cascade.projection;
 
         vkCmdPushConstants(
             commandBuffer,
@@ -1047,454 +1140,517 @@ void Renderer::renderShadowMap()
             &shadowPC
         );
 
-        // Draw all submeshes
-        vkCmdDrawIndexed(
-            commandBuffer,
-            m_pModel->getIndexCount(),
-            1,
-            0,
-            0,
-            0
-        );
-      
+        for (uint32_t caster : cached.casters)
+        {
+            const Submesh& submesh = submeshes[caster];
+            vkCmdDrawIndexed(
+                commandBuffer,
+                submesh.indexCount,
+                1,
+                submesh.indexStart,
+                static_cast<int32_t>(submesh.vertexOffset),
+                0
+            );
+        }
+
         vkCmdEndRendering(commandBuffer);
 
-        // Transition shadow map image to shader read optimal for later use
         transitionImageLayout(
             commandBuffer,
-            m_GBuffers[i].pShadowMapImage,
+            currentGBuffer.pShadowMapImage,
             VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
             VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
             VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
             VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
             VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
             VK_ACCESS_2_SHADER_READ_BIT,
-            VK_IMAGE_ASPECT_DEPTH_BIT
+            VK_IMAGE_ASPECT_DEPTH_BIT,
+            cascade
         );
-        // End and submit
-        m_pCommandPool->endSingleTimeCommands(commandBuffer, m_pDevice->getGraphicsQueue());
-    }    
+    }
 }
 
-void Renderer::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+void Renderer::readCullStatistics(uint32_t currentImage)
 {
-    // Get the G-buffer for the current frame
-    GBuffer& currentGBuffer = m_GBuffers[m_currentFrame];
-
-    // Begin command buffer recording
-    VkCommandBufferBeginInfo beginInfo{};
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-
-    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
-        throw std::runtime_error("Failed to begin recording command buffer!");
-    }
+    // The frame that last used these buffers has completed
+    Buffer* pStatisticsBuffer = m_pCullCounterBuffers[currentImage];
+    pStatisticsBuffer->invalidate();
+    const CullCounters* pStatistics = static_cast<const CullCounters*>(pStatisticsBuffer->map());
+
+    m_CullStatistics.submeshCount = m_pModel->getSubmeshCount();
+    m_CullStatistics.frustumVisibleCount = pStatistics->visibleDrawCount;
+    std::copy(std::begin(pStatistics->lodDrawCounts), std::end(pStatistics->lodDrawCounts), m_CullStatistics.lodDrawCounts.begin());
+    m_CullStatistics.occludedCount = pStatistics->occludedCount;
+    m_CullStatistics.drawnCount = pStatistics->drawnCount;
+    m_CullStatistics.meshletFrustumCulledCount = pStatistics->meshletFrustumCulledCount;
+    m_CullStatistics.meshletBackfaceCulledCount = pStatistics->meshletBackfaceCulledCount;
+    m_CullStatistics.meshletOccludedCount = pStatistics->meshletOccludedCount;
+    m_CullStatistics.meshletDrawnCount = pStatistics->meshletDrawCount;
+}
 
-    // Transition depth image to DEPTH_STENCIL_ATTACHMENT_OPTIMAL for depth pre-pass
-    transitionImageLayout(
+void Renderer::cullSubmeshes(VkCommandBuffer commandBuffer)
+{
+    VkDescriptorSet cullDescriptorSet = m_pDescriptorManager->getCullDescriptorSets()[m_currentFrame];
+
+    // Reset the counters; the previous use of this frame's buffer finished before the fence was signalled
+    vkCmdFillBuffer(commandBuffer, m_pCullCounterBuffers[m_currentFrame]->get(), 0, sizeof(CullCounters), 0);
+
+    // The levels of detail were last written by the previous frame's dispatch, which precedes this one on the queue
+    VkMemoryBarrier2 clearBarrier{};
+    clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    clearBarrier.srcStageMask = VK_PIPELINE_STAGE_2_CLEAR_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    clearBarrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+    clearBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    clearBarrier.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+
+    VkDependencyInfo clearDependency{};
+    clearDependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    clearDependency.memoryBarrierCount = 1;
+    clearDependency.pMemoryBarriers = &clearBarrier;
+    vkCmdPipelineBarrier2(commandBuffer, &clearDependency);
+
+    // Submesh bounds are in model space, so the frustum and the camera are moved there
+    const glm::mat4 viewModel = m_UniformBufferObject.view * m_UniformBufferObject.model;
+    CullPushConstants pushConstants{};
+    pushConstants.planes = Frustum(m_UniformBufferObject.proj, viewModel).getPlanes();
+    pushConstants.cameraPosition = glm::vec3(glm::inverse(viewModel)[3]);
+    pushConstants.pixelsPerUnitAtUnitDistance = 0.5f * static_cast<float>(m_pSwapChain->getExtent().height) * std::abs(m_UniformBufferObject.proj[1][1]);
+    pushConstants.submeshCount = m_pModel->getSubmeshCount();
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pCullPipeline->getPipeline());
+    vkCmdBindDescriptorSets(
         commandBuffer,
-        currentGBuffer.pDepthImage,
-        VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
-        VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
-        VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
-        VK_ACCESS_2_SHADER_READ_BIT,
-        VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
-        VK_IMAGE_ASPECT_DEPTH_BIT
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        m_pCullPipeline->getPipelineLayout(),
+        0,
+        1,
+        &cullDescriptorSet,
+        0,
+        nullptr
     );
+    vkCmdPushConstants(commandBuffer, m_pCullPipeline->getPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstants), &pushConstants);
+    // A single workgroup, so the compaction keeps submesh order
+    vkCmdDispatch(commandBuffer, 1, 1, 1);
+
+    // The depth pre-pass draws the list with its count; the occlusion test reads it and keeps counting
+    VkMemoryBarrier2 cullBarrier{};
+    cullBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    cullBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    cullBarrier.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+    cullBarrier.dstStageMask = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    cullBarrier.dstAccessMask = VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+
+    VkDependencyInfo cullDependency{};
+    cullDependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    cullDependency.memoryBarrierCount = 1;
+    cullDependency.pMemoryBarriers = &cullBarrier;
+    vkCmdPipelineBarrier2(commandBuffer, &cullDependency);
+}
 
-    // Prepare common variables
-    VkBuffer vertexBuffers[] = { m_pModel->getVertexBuffer() };
-    VkDeviceSize offsets[] = { 0 };
-
-    VkViewport viewport{};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = static_cast<float>(m_pSwapChain->getExtent().width);
-    viewport.height = static_cast<float>(m_pSwapChain->getExtent().height);
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
+void Renderer::cullOccludedDraws(VkCommandBuffer commandBuffer)
+{
+    GBuffer& currentGBuffer = m_GBuffers[m_currentFrame];
+    VkDescriptorSet occlusionDescriptorSet = m_pDescriptorManager->getOcclusionDescriptorSets()[m_currentFrame];
+    const std::vector<VkDescriptorSet>& pyramidDescriptorSets = m_pDescriptorManager->getDepthPyramidDescriptorSets()[m_currentFrame];
+    const uint32_t levelCount = currentGBuffer.pDepthPyramidImage->getMipLevels();
+
+    // Each level reads what the previous dispatch wrote
+    VkMemoryBarrier2 computeBarrier{};
+    computeBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    computeBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    computeBarrier.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+    computeBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    computeBarrier.dstAccessMask = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+
+    VkDependencyInfo computeDependency{};
+    computeDependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    computeDependency.memoryBarrierCount = 1;
+    computeDependency.pMemoryBarriers = &computeBarrier;
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pDepthPyramidPipeline->getPipeline());
+    for (uint32_t level = 0; level < levelCount; ++level)
+    {
+        vkCmdBindDescriptorSets(
+            commandBuffer,
+            VK_PIPELINE_BIND_POINT_COMPUTE,
+            m_pDepthPyramidPipeline->getPipelineLayout(),
+            0,
+            1,
+            &pyramidDescriptorSets[level],
+            0,
+            nullptr
+        );
 
-    VkRect2D scissor{};
-    scissor.offset = { 0, 0 };
-    scissor.extent = m_pSwapChain->getExtent();
+        uint32_t levelWidth = std::max(1u, currentGBuffer.pDepthPyramidImage->getWidth() >> level);
+        uint32_t levelHeight = std::max(1u, currentGBuffer.pDepthPyramidImage->getHeight() >> level);
+        vkCmdDispatch(commandBuffer, (levelWidth + 7) / 8, (levelHeight + 7) / 8, 1);
+        vkCmdPipelineBarrier2(commandBuffer, &computeDependency);
+    }
 
-    Frustum frustum{ m_UniformBufferObject.proj, m_UniformBufferObject.view };
-    const auto& submeshes = m_pModel->getSubmeshes();
+    // The draw bounds are in model space, so the test projects them with the full model-view-projection
+    OcclusionPushConstants pushConstants{};
+    pushConstants.viewProjection = m_UniformBufferObject.proj * m_UniformBufferObject.view * m_UniformBufferObject.model;
+    pushConstants.depthSize = glm::vec2(m_pSwapChain->getExtent().width, m_pSwapChain->getExtent().height);
+    pushConstants.pyramidLevelCount = levelCount;
 
-    // **Depth Pre-Pass**
-    {
-        // Begin depth-only rendering
-        VkRenderingAttachmentInfo depthAttachment{};
-        depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
-        depthAttachment.imageView = currentGBuffer.depthImageView;
-        depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-        depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR; // Clear depth buffer
-        depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-        depthAttachment.clearValue.depthStencil = { 1.0f, 0 };
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pOcclusionPipeline->getPipeline());
+    vkCmdBindDescriptorSets(
+        commandBuffer,
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        m_pOcclusionPipeline->getPipelineLayout(),
+        0,
+        1,
+        &occlusionDescriptorSet,
+        0,
+        nullptr
+    );
+    vkCmdPushConstants(commandBuffer, m_pOcclusionPipeline->getPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(OcclusionPushConstants), &pushConstants);
+    // The list's length is only known on the GPU; threads past it return early
+    vkCmdDispatch(commandBuffer, (m_pVisibilityList->getMaxDrawCount() + 63) / 64, 1, 1);
+
+    // The meshlet pass reads the filtered commands and keeps counting into the same statistics
+    VkMemoryBarrier2 occlusionBarrier{};
+    occlusionBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    occlusionBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    occlusionBarrier.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+    occlusionBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    occlusionBarrier.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+
+    VkDependencyInfo occlusionDependency{};
+    occlusionDependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    occlusionDependency.memoryBarrierCount = 1;
+    occlusionDependency.pMemoryBarriers = &occlusionBarrier;
+    vkCmdPipelineBarrier2(commandBuffer, &occlusionDependency);
+}
 
-        VkRenderingInfo depthRenderingInfo{};
-        depthRenderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
-        depthRenderingInfo.renderArea.offset = { 0, 0 };
-        depthRenderingInfo.renderArea.extent = m_pSwapChain->getExtent();
-        depthRenderingInfo.layerCount = 1;
-        depthRenderingInfo.colorAttachmentCount = 0; // No color attachments
-        depthRenderingInfo.pDepthAttachment = &depthAttachment;
+void Renderer::cullMeshlets(VkCommandBuffer commandBuffer)
+{
+    GBuffer& currentGBuffer = m_GBuffers[m_currentFrame];
+    VkDescriptorSet meshletCullDescriptorSet = m_pDescriptorManager->getMeshletCullDescriptorSets()[m_currentFrame];
 
-        vkCmdBeginRendering(commandBuffer, &depthRenderingInfo);
+    // Meshlet bounds and cones are in model space, so the camera is moved there too
+    const glm::mat4 viewModel = m_UniformBufferObject.view * m_UniformBufferObject.model;
+    MeshletCullPushConstants pushConstants{};
+    pushConstants.viewProjection = m_UniformBufferObject.proj * viewModel;
+    pushConstants.cameraPosition = glm::inverse(viewModel)[3];
+    pushConstants.depthSize = glm::vec2(m_pSwapChain->getExtent().width, m_pSwapChain->getExtent().height);
+    pushConstants.pyramidLevelCount = currentGBuffer.pDepthPyramidImage->getMipLevels();
 
-        // Bind the depth pre-pass pipeline
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pDepthPipeline->get());
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pMeshletCullPipeline->getPipeline());
+    vkCmdBindDescriptorSets(
+        commandBuffer,
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        m_pMeshletCullPipeline->getPipelineLayout(),
+        0,
+        1,
+        &meshletCullDescriptorSet,
+        0,
+        nullptr
+    );
+    vkCmdPushConstants(commandBuffer, m_pMeshletCullPipeline->getPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(MeshletCullPushConstants), &pushConstants);
+    // One workgroup per slot of the visibility list; those past its length return early
+    vkCmdDispatch(commandBuffer, m_pVisibilityList->getMaxDrawCount(), 1, 1);
+
+    // The G-buffer pass draws the meshlet commands and their count; the counters are read on the host after the fence
+    VkMemoryBarrier2 meshletBarrier{};
+    meshletBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    meshletBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    meshletBarrier.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+    meshletBarrier.dstStageMask = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_HOST_BIT;
+    meshletBarrier.dstAccessMask = VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_HOST_READ_BIT;
+
+    VkDependencyInfo meshletDependency{};
+    meshletDependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    meshletDependency.memoryBarrierCount = 1;
+    meshletDependency.pMemoryBarriers = &meshletBarrier;
+    vkCmdPipelineBarrier2(commandBuffer, &meshletDependency);
+}
 
-        // Bind vertex and index buffers
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-        vkCmdBindIndexBuffer(commandBuffer, m_pModel->getIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
+void Renderer::animateLights(VkCommandBuffer commandBuffer)
+{
+    VkDescriptorSet lightAnimateDescriptorSet = m_pDescriptorManager->getLightAnimateDescriptorSets()[m_currentFrame];
 
-        // Set viewport and scissor
-        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
-        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+    LightAnimatePushConstants pushConstants{};
+    pushConstants.time = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - m_LightAnimationStart).count();
+    pushConstants.lightCount = m_pLightManager->getLightCount();
 
-        // Render the scene
-        for (const auto& submesh : submeshes)
-        {
-            // Transform the bounding box by the model matrix
-            glm::vec3 transformedMin = glm::vec3(m_UniformBufferObject.model * glm::vec4(submesh.bboxMin, 1.0f));
-            glm::vec3 transformedMax = glm::vec3(m_UniformBufferObject.model * glm::vec4(submesh.bboxMax, 1.0f));
-
-            // Perform frustum culling
-            if (!frustum.isBoxVisible(transformedMin, transformedMax)) {
-                continue;
-            }
-
-            // Calculate descriptor set index
-            uint32_t descriptorSetIndex = m_currentFrame * m_pModel->getMaterials().size() + submesh.materialIndex;
-
-            // Bind descriptor set for the current material and frame
-            vkCmdBindDescriptorSets(
-                commandBuffer,
-                VK_PIPELINE_BIND_POINT_GRAPHICS,
-                m_pGraphicsPipeline->getPipelineLayout(),
-                0,
-                1,
-                &m_pDescriptorManager->getDescriptorSets()[descriptorSetIndex],
-                0,
-                nullptr
-            );
-
-            // Draw submesh
-            vkCmdDrawIndexed(
-                commandBuffer,
-                submesh.indexCount,
-                1,
-                submesh.indexStart,
-                0,
-                0
-            );
-        }
-
-        vkCmdEndRendering(commandBuffer);
-    }
-           // Ensure depth data is available for the main pass
-    transitionImageLayout(
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pLightAnimatePipeline->getPipeline());
+    vkCmdBindDescriptorSets(
         commandBuffer,
-        currentGBuffer.pDepthImage,
-        VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-        VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-        VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
-        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT,
-        VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
-        VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
-        VK_IMAGE_ASPECT_DEPTH_BIT
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        m_pLightAnimatePipeline->getPipelineLayout(),
+        0,
+        1,
+        &lightAnimateDescriptorSet,
+        0,
+        nullptr
     );
+    vkCmdPushConstants(commandBuffer, m_pLightAnimatePipeline->getPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(LightAnimatePushConstants), &pushConstants);
+    // One thread per light; the first also writes the count, so at least one workgroup runs
+    vkCmdDispatch(commandBuffer, std::max((pushConstants.lightCount + 63) / 64, 1u), 1, 1);
+
+    // Light culling and the lighting pass read the animated lights
+    VkMemoryBarrier2 lightAnimateBarrier{};
+    lightAnimateBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    lightAnimateBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    lightAnimateBarrier.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+    lightAnimateBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+    lightAnimateBarrier.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT;
+
+    VkDependencyInfo lightAnimateDependency{};
+    lightAnimateDependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    lightAnimateDependency.memoryBarrierCount = 1;
+    lightAnimateDependency.pMemoryBarriers = &lightAnimateBarrier;
+    vkCmdPipelineBarrier2(commandBuffer, &lightAnimateDependency);
+}
+
+void Renderer::cullLights(VkCommandBuffer commandBuffer)
+{
+    VkDescriptorSet lightCullDescriptorSet = m_pDescriptorManager->getLightCullDescriptorSets()[m_currentFrame];
 
-    // Transition G-buffer images for the current frame
-    transitionImageLayout(
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pLightCullPipeline->getPipeline());
+    vkCmdBindDescriptorSets(
         commandBuffer,
-        currentGBuffer.pDiffuseImage,
-        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
-        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-        VK_ACCESS_2_SHADER_READ_BIT,
-        VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
-        VK_IMAGE_ASPECT_COLOR_BIT
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        m_pLightCullPipeline->getPipelineLayout(),
+        0,
+        1,
+        &lightCullDescriptorSet,
+        1,
+        &m_UniformBufferOffset
     );
+    // One workgroup per screen tile, covering all of its depth slices
+    vkCmdDispatch(commandBuffer, LIGHT_CLUSTER_GRID_X, LIGHT_CLUSTER_GRID_Y, 1);
+
+    // The lighting pass reads the cluster lists
+    VkMemoryBarrier2 lightCullBarrier{};
+    lightCullBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+    lightCullBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    lightCullBarrier.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+    lightCullBarrier.dstStageMask = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+    lightCullBarrier.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT;
+
+    VkDependencyInfo lightCullDependency{};
+    lightCullDependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    lightCullDependency.memoryBarrierCount = 1;
+    lightCullDependency.pMemoryBarriers = &lightCullBarrier;
+    vkCmdPipelineBarrier2(commandBuffer, &lightCullDependency);
+}
 
-    transitionImageLayout(
+void Renderer::recordDepthPrePass(VkCommandBuffer commandBuffer)
+{
+    const VkViewport viewport = getViewport(m_pSwapChain->getExtent());
+    const VkRect2D scissor = getScissor(m_pSwapChain->getExtent());
+
+    VkRenderingAttachmentInfo depthAttachment{};
+    depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    depthAttachment.imageView = m_pRenderGraph->getImageView(m_DepthImage);
+    depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR; // Clear depth buffer
+    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    depthAttachment.clearValue.depthStencil = { 1.0f, 0 };
+
+    VkRenderingInfo depthRenderingInfo{};
+    depthRenderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+    depthRenderingInfo.renderArea.offset = { 0, 0 };
+    depthRenderingInfo.renderArea.extent = m_pSwapChain->getExtent();
+    depthRenderingInfo.layerCount = 1;
+    depthRenderingInfo.colorAttachmentCount = 0; // No color attachments
+    depthRenderingInfo.pDepthAttachment = &depthAttachment;
+
+    vkCmdBeginRendering(commandBuffer, &depthRenderingInfo);
+
+    // Bind the depth pre-pass pipeline
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pDepthPipeline->get());
+
+    // Bind vertex and index buffers
+    m_pModel->bindVertexBuffers(commandBuffer, VERTEX_STREAM_TEXCOORD);
+    m_pModel->bindIndexBuffer(commandBuffer);
+
+    // Set viewport and scissor
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    // Bind the frame's descriptor set once; materials are looked up in the shaders
+    vkCmdBindDescriptorSets(
         commandBuffer,
-        currentGBuffer.pNormalImage,
-        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
-        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-        VK_ACCESS_2_SHADER_READ_BIT,
-        VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
-        VK_IMAGE_ASPECT_COLOR_BIT
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        m_pGraphicsPipeline->getPipelineLayout(),
+        0,
+        1,
+        &m_pDescriptorManager->getDescriptorSets()[m_currentFrame],
+        1,
+        &m_UniformBufferOffset
     );
 
-    transitionImageLayout(
+    // Draw the visible submeshes in material order; cull.comp wrote their count
+    vkCmdDrawIndexedIndirectCount(
         commandBuffer,
-        currentGBuffer.pMetallicRougnessImage,
-        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
-        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-        VK_ACCESS_2_SHADER_READ_BIT,
-        VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
-        VK_IMAGE_ASPECT_COLOR_BIT
+        m_pVisibilityList->getDrawBuffer(m_currentFrame),
+        0,
+        m_pCullCounterBuffers[m_currentFrame]->get(),
+        offsetof(CullCounters, visibleDrawCount),
+        m_pVisibilityList->getMaxDrawCount(),
+        sizeof(VkDrawIndexedIndirectCommand)
     );
 
-    // **Main Rendering Pass**
-    {
-        // Set up color attachments
-        VkRenderingAttachmentInfo colorAttachments[3]{};
-
-        // Diffuse attachment
-        colorAttachments[0].sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
-        colorAttachments[0].imageView = currentGBuffer.diffuseImageView;
-        colorAttachments[0].imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-        colorAttachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-        colorAttachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-        colorAttachments[0].clearValue = { { 0.0f, 0.0f, 0.0f, 1.0f } };
-
-        // Normal attachment
-        colorAttachments[1].sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
-        colorAttachments[1].imageView = currentGBuffer.normalImageView;
-        colorAttachments[1].imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-        colorAttachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-        colorAttachments[1].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-        colorAttachments[1].clearValue = { { 0.0f, 0.0f, 0.0f, 1.0f } };
-
-        // Metallic-Roughness attachment
-        colorAttachments[2].sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
-        colorAttachments[2].imageView = currentGBuffer.metallicRoughnessImageView;
-        colorAttachments[2].imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-        colorAttachments[2].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-        colorAttachments[2].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-        colorAttachments[2].clearValue = { { 0.0f, 0.0f, 0.0f, 1.0f } };
-
-        // Depth attachment (load existing depth buffer from pre-pass)
-        VkRenderingAttachmentInfo depthAttachment{};
-        depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
-        depthAttachment.imageView = currentGBuffer.depthImageView;
-        depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-        depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD; // Load depth from pre-pass
-        depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-
-        VkRenderingInfo renderingInfo{};
-        renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
-        renderingInfo.renderArea.offset = { 0, 0 };
-        renderingInfo.renderArea.extent = m_pSwapChain->getExtent();
-        renderingInfo.layerCount = 1;
-        renderingInfo.viewMask = 0;
-        renderingInfo.colorAttachmentCount = 3;
-        renderingInfo.pColorAttachments = colorAttachments;
-        renderingInfo.pDepthAttachment = &depthAttachment;
-
-        vkCmdBeginRendering(commandBuffer, &renderingInfo);
-
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pGraphicsPipeline->get());
-
-        // Bind vertex and index buffers
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-        vkCmdBindIndexBuffer(commandBuffer, m_pModel->getIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
-
-        // Set viewport and scissor
-        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
-        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
-
-        // Render the scene with material bindings
-        for (const auto& submesh : submeshes)
-        {
-            // Transform the bounding box by the model matrix
-            glm::vec3 transformedMin = glm::vec3(m_UniformBufferObject.model * glm::vec4(submesh.bboxMin, 1.0f));
-            glm::vec3 transformedMax = glm::vec3(m_UniformBufferObject.model * glm::vec4(submesh.bboxMax, 1.0f));
-
-            // Perform frustum culling
-            if (!frustum.isBoxVisible(transformedMin, transformedMax)) {
-                continue;
-            }
-
-            // Calculate descriptor set index
-            uint32_t descriptorSetIndex = m_currentFrame * m_pModel->getMaterials().size() + submesh.materialIndex;
-
-            // Bind descriptor set for the current material and frame
-            vkCmdBindDescriptorSets(
-                commandBuffer,
-                VK_PIPELINE_BIND_POINT_GRAPHICS,
-                m_pGraphicsPipeline->getPipelineLayout(),
-                0,
-                1,
-                &m_pDescriptorManager->getDescriptorSets()[descriptorSetIndex],
-                0,
-                nullptr
-            );
-
-            // Draw submesh
-            vkCmdDrawIndexed(
-                commandBuffer,
-                submesh.indexCount,
-                1,
-                submesh.indexStart,
-                0,
-                0
-            );
-        }
-
-        vkCmdEndRendering(commandBuffer);
-    }
-
-    // Define target layouts for post-rendering
-    VkImageLayout targetColorLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    VkImageLayout targetDepthLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+    vkCmdEndRendering(commandBuffer);
+}
 
-    // Transition G-buffer images to SHADER_READ_ONLY_OPTIMAL for final pass
-    transitionImageLayout(
+void Renderer::recordGBufferPass(VkCommandBuffer commandBuffer)
+{
+    const VkViewport viewport = getViewport(m_pSwapChain->getExtent());
+    const VkRect2D scissor = getScissor(m_pSwapChain->getExtent());
+
+    // Set up color attachments
+    VkRenderingAttachmentInfo colorAttachments[3]{};
+
+    // Diffuse attachment
+    colorAttachments[0].sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    colorAttachments[0].imageView = m_pRenderGraph->getImageView(m_DiffuseImage);
+    colorAttachments[0].imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colorAttachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachments[0].clearValue = { { 0.0f, 0.0f, 0.0f, 1.0f } };
+
+    // Normal attachment
+    colorAttachments[1].sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    colorAttachments[1].imageView = m_pRenderGraph->getImageView(m_NormalImage);
+    colorAttachments[1].imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colorAttachments[1].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachments[1].clearValue = { { 0.0f, 0.0f, 0.0f, 1.0f } };
+
+    // Metallic-Roughness attachment
+    colorAttachments[2].sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    colorAttachments[2].imageView = m_pRenderGraph->getImageView(m_MetallicRoughnessImage);
+    colorAttachments[2].imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachments[2].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colorAttachments[2].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachments[2].clearValue = { { 0.0f, 0.0f, 0.0f, 1.0f } };
+
+    // Depth attachment: the pre-pass depth, tested but not written, so it stays in the layout the lighting pass samples it in
+    VkRenderingAttachmentInfo depthAttachment{};
+    depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    depthAttachment.imageView = m_pRenderGraph->getImageView(m_DepthImage);
+    depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD; // Load depth from pre-pass
+    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_NONE;
+
+    VkRenderingInfo renderingInfo{};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+    renderingInfo.renderArea.offset = { 0, 0 };
+    renderingInfo.renderArea.extent = m_pSwapChain->getExtent();
+    renderingInfo.layerCount = 1;
+    renderingInfo.viewMask = 0;
+    renderingInfo.colorAttachmentCount = 3;
+    renderingInfo.pColorAttachments = colorAttachments;
+    renderingInfo.pDepthAttachment = &depthAttachment;
+
+    vkCmdBeginRendering(commandBuffer, &renderingInfo);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pGraphicsPipeline->get());
+
+    // Bind vertex and index buffers
+    m_pModel->bindVertexBuffers(commandBuffer, VERTEX_STREAM_TANGENT_FRAME);
+    m_pModel->bindIndexBuffer(commandBuffer);
+
+    // Set viewport and scissor
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+    // Bind the frame's descriptor set once; materials are looked up in the shaders
+    vkCmdBindDescriptorSets(
         commandBuffer,
-        currentGBuffer.pDiffuseImage,
-        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-        targetColorLayout,
-        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
-        VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
-        VK_ACCESS_2_SHADER_READ_BIT,
-        VK_IMAGE_ASPECT_COLOR_BIT
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        m_pGraphicsPipeline->getPipelineLayout(),
+        0,
+        1,
+        &m_pDescriptorManager->getDescriptorSets()[m_currentFrame],
+        1,
+        &m_UniformBufferOffset
     );
 
-    transitionImageLayout(
+    // Only the meshlets of the pre-pass draws that survived frustum, cone and Hi-Z tests.
+    // They arrive in no particular order; the depth test is EQUAL, so there is no overdraw to sort against.
+    vkCmdDrawIndexedIndirectCount(
         commandBuffer,
-        currentGBuffer.pNormalImage,
-        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-        targetColorLayout,
-        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
-        VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
-        VK_ACCESS_2_SHADER_READ_BIT,
-        VK_IMAGE_ASPECT_COLOR_BIT
+        m_pMeshletDrawCommandBuffers[m_currentFrame]->get(),
+        0,
+        m_pCullCounterBuffers[m_currentFrame]->get(),
+        offsetof(CullCounters, meshletDrawCount),
+        m_pModel->getMeshletCount(),
+        sizeof(VkDrawIndexedIndirectCommand)
     );
 
-    transitionImageLayout(
+    vkCmdEndRendering(commandBuffer);
+}
+
+void Renderer::recordLightingPass(VkCommandBuffer commandBuffer)
+{
+    const VkViewport viewport = getViewport(m_pSwapChain->getExtent());
+    const VkRect2D scissor = getScissor(m_pSwapChain->getExtent());
+
+    // Shade the G-buffer into the HDR image
+    VkRenderingAttachmentInfo colorAttachment{};
+    colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+    colorAttachment.imageView = m_pRenderGraph->getImageView(m_HDRImage);
+    colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    colorAttachment.clearValue = { { 0.0f, 0.0f, 0.0f, 1.0f } };
+
+    VkRenderingInfo finalRenderingInfo{};
+    finalRenderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+    finalRenderingInfo.renderArea.offset = { 0, 0 };
+    finalRenderingInfo.renderArea.extent = m_pSwapChain->getExtent();
+    finalRenderingInfo.layerCount = 1;
+    finalRenderingInfo.colorAttachmentCount = 1;
+    finalRenderingInfo.pColorAttachments = &colorAttachment;
+
+    vkCmdBeginRendering(commandBuffer, &finalRenderingInfo);
+
+    // Bind the final pass pipeline
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pFinalPipeline->get());
+
+    // Bind the descriptor set with G-buffer images; dynamic offsets go in binding order
+    const std::array<uint32_t, 2> finalPassOffsets = { m_UniformBufferOffset, m_SunMatricesOffset };
+    vkCmdBindDescriptorSets(
         commandBuffer,
-        currentGBuffer.pMetallicRougnessImage,
-        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-        targetColorLayout,
-        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
-        VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
-        VK_ACCESS_2_SHADER_READ_BIT,
-        VK_IMAGE_ASPECT_COLOR_BIT
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        m_pFinalPipeline->getPipelineLayout(),
+        0,
+        1,
+        &m_pDescriptorManager->getFinalPassDescriptorSets()[m_currentFrame],
+        static_cast<uint32_t>(finalPassOffsets.size()),
+        finalPassOffsets.data()
     );
+    // Update debug push constants with camera's debug settings and intensity values
+    m_DebugPushConstants.debugMode = m_pCamera->getDebugMode();
+    m_DebugPushConstants.iblIntensity = m_pCamera->getIblIntensity();
+    m_DebugPushConstants.sunIntensity = m_pCamera->getSunIntensity();
 
-    // Transition depth image to DEPTH_STENCIL_READ_ONLY_OPTIMAL for final pass
-    transitionImageLayout(
+    vkCmdPushConstants(
         commandBuffer,
-        currentGBuffer.pDepthImage,
-        VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-        targetDepthLayout,
-        VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
-        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
-        VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
-        VK_ACCESS_2_SHADER_READ_BIT,
-        VK_IMAGE_ASPECT_DEPTH_BIT
+        m_pFinalPipeline->getPipelineLayout(),
+        VK_SHADER_STAGE_FRAGMENT_BIT,
+        0,
+        sizeof(DebugPushConstants),
+        &m_DebugPushConstants
     );
 
-	// Transition HDR image to write layout for tone mapping
-	transitionImageLayout(
-		commandBuffer,
-		m_pHDRImage[m_currentFrame],
-		m_pHDRImage[m_currentFrame]->getImageLayout(),
-		VK_IMAGE_LAYOUT_GENERAL,
-		VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
-		VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
-		VK_ACCESS_2_SHADER_READ_BIT,
-		VK_ACCESS_2_SHADER_WRITE_BIT,
-		VK_IMAGE_ASPECT_COLOR_BIT
-	);   
-
-    // **Final Rendering Pass**
-    {
-        // Begin final rendering pass to the swapchain image
-        VkRenderingAttachmentInfo colorAttachment{};
-        colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
-        colorAttachment.imageView = m_HDRImageView[m_currentFrame];
-        colorAttachment.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-        colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-        colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-        colorAttachment.clearValue = { { 0.0f, 0.0f, 0.0f, 1.0f } };
-
-        VkRenderingInfo finalRenderingInfo{};
-        finalRenderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
-        finalRenderingInfo.renderArea.offset = { 0, 0 };
-        finalRenderingInfo.renderArea.extent = m_pSwapChain->getExtent();
-        finalRenderingInfo.layerCount = 1;
-        finalRenderingInfo.colorAttachmentCount = 1;
-        finalRenderingInfo.pColorAttachments = &colorAttachment;
-
-        vkCmdBeginRendering(commandBuffer, &finalRenderingInfo);
-
-        // Bind the final pass pipeline
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pFinalPipeline->get());
-
-        // Bind the descriptor set with G-buffer images
-        vkCmdBindDescriptorSets(
-            commandBuffer,
-            VK_PIPELINE_BIND_POINT_GRAPHICS,
-            m_pFinalPipeline->getPipelineLayout(),
-            0,
-            1,
-            &m_pDescriptorManager->getFinalPassDescriptorSets()[m_currentFrame],
-            0,
-            nullptr
-        );
-        // Update debug push constants with camera's debug settings and intensity values
-        m_DebugPushConstants.debugMode = m_pCamera->getDebugMode();
-        m_DebugPushConstants.iblIntensity = m_pCamera->getIblIntensity();
-        m_DebugPushConstants.sunIntensity = m_pCamera->getSunIntensity();
-
-        vkCmdPushConstants(
-            commandBuffer,
-            m_pFinalPipeline->getPipelineLayout(),
-            VK_SHADER_STAGE_FRAGMENT_BIT,
-            0,
-            sizeof(DebugPushConstants),
-            &m_DebugPushConstants
-        );
-
-        // Set viewport and scissor
-        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
-        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
-
-        // Draw fullscreen triangle (or quad)
-        vkCmdDraw(commandBuffer, 3, 1, 0, 0);
-
-        vkCmdEndRendering(commandBuffer);
-    }
+    // Set viewport and scissor
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-    // Transition HDR image to GENERAL layout for compute shader read
-    transitionImageLayout(
-        commandBuffer,
-        m_pHDRImage[m_currentFrame],
-        m_pHDRImage[m_currentFrame]->getImageLayout(),
-        VK_IMAGE_LAYOUT_GENERAL,
-        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
-        VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
-        VK_ACCESS_2_SHADER_READ_BIT,
-        VK_IMAGE_ASPECT_COLOR_BIT
-    );
+    // Draw fullscreen triangle (or quad)
+    vkCmdDraw(commandBuffer, 3, 1, 0, 0);
 
-    // Transition swapchain image to GENERAL layout for compute shader write
-    transitionImageLayout(
-        commandBuffer,
-        m_pLDRImage[m_currentFrame],
-        m_pLDRImage[m_currentFrame]->getImageLayout(),
-        VK_IMAGE_LAYOUT_GENERAL,
-        VK_PIPELINE_STAGE_2_NONE,
-        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
-        VK_ACCESS_2_NONE,
-        VK_ACCESS_2_SHADER_WRITE_BIT,
-        VK_IMAGE_ASPECT_COLOR_BIT
-    );
+    vkCmdEndRendering(commandBuffer);
+}
 
+void Renderer::recordToneMapping(VkCommandBuffer commandBuffer)
+{
     // Bind the compute pipeline
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pToneMappingPipeline->getPipeline());
 
@@ -1534,8 +1690,27 @@ void Renderer::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t image
     uint32_t dispatchY = (m_pSwapChain->getExtent().height + workgroupSizeY - 1) / workgroupSizeY;
 
     vkCmdDispatch(commandBuffer, dispatchX, dispatchY, 1);
+}
+
+void Renderer::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+{
+    // Begin command buffer recording
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("Failed to begin recording command buffer!");
+    }
 
-	blitLDRToSwapchain(m_currentFrame, commandBuffer);
+    // The blit overwrites all of the swapchain image, so its contents are dropped.
+    // The acquire semaphore is waited on at this stage, which the graph's first barrier on the image chains to.
+    m_pRenderGraph->setImportedImage(
+        m_SwapchainImage,
+        m_pSwapChain->getImages()[imageIndex],
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT
+    );
+    m_pRenderGraph->execute(commandBuffer);
 
     // End command buffer recording
     if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
@@ -1566,14 +1741,30 @@ void Renderer::drawFrame()
 
     vkResetFences(m_pDevice->get(), 1, m_pSyncObjects->getInFlightFence(m_currentFrame));
 
-    vkResetCommandBuffer(m_CommandBuffers[m_currentFrame], 0);
-    recordCommandBuffer(m_CommandBuffers[m_currentFrame], imageIndex);
+    readCullStatistics(m_currentFrame);
+    pickUnderCursor();
+
+    // Point this frame's texture array at textures that finished streaming in since it was last recorded
+    // Streamed copies run on the transfer queue; this frame never waits for them
+    m_pTextureCache->processPendingUploads();
+    m_pUploadBatch->submitStreaming();
+    if (m_TextureDescriptorGenerations[m_currentFrame] != m_pTextureCache->getGeneration())
+    {
+        m_pDescriptorManager->updateTextureDescriptors(m_currentFrame, m_pModel->getTextures());
+        m_TextureDescriptorGenerations[m_currentFrame] = m_pTextureCache->getGeneration();
+    }
 
+    // Per-frame data first: the shadow cascades decide what gets recorded.
+    // This frame's fence has signalled, so its slice of the uniform ring is free to overwrite.
+    m_pUniformRing->beginFrame(m_currentFrame);
     updateUniformBuffer(m_currentFrame);
-    updateLights();
     updateLightBuffer(m_currentFrame);
+    updateShadowCascades(m_currentFrame);
     updateSunMatricesBuffer(m_currentFrame);
 
+    vkResetCommandBuffer(m_CommandBuffers[m_currentFrame], 0);
+    recordCommandBuffer(m_CommandBuffers[m_currentFrame], imageIndex);
+
     // Prepare VkCommandBufferSubmitInfo
     VkCommandBufferSubmitInfo commandBufferInfo{};
     commandBufferInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
@@ -1660,62 +1851,130 @@ void Renderer::updateUniformBuffer(uint32_t currentImage)
     m_UniformBufferObject.proj = glm::perspective(
         glm::radians(45.0f),
         m_pSwapChain->getExtent().width / (float)m_pSwapChain->getExtent().height,
-        0.001f,
-        100.0f);
+        CAMERA_NEAR_PLANE,
+        CAMERA_FAR_PLANE);
     m_UniformBufferObject.proj[1][1] *= -1;
 
     // Set the camera position
     m_UniformBufferObject.cameraPosition = m_pCamera->getPosition();
     m_UniformBufferObject.viewportSize = glm::vec2(m_pSwapChain->getExtent().width, m_pSwapChain->getExtent().height);
+    m_UniformBufferObject.positionScale = glm::vec4(m_pModel->getPositionScale(), 0.0f);
+    m_UniformBufferObject.positionOffset = glm::vec4(m_pModel->getPositionOffset(), 0.0f);
 
-    // Map the uniform buffer and copy the data
-    void* data = m_pUniformBuffers[currentImage]->map();
-    memcpy(data, &m_UniformBufferObject, sizeof(m_UniformBufferObject));
+    m_UniformBufferOffset = m_pUniformRing->push(m_UniformBufferObject);
 }
 
-void Renderer::updateLights() {
-    static float time = 0.0f;
-    time += 0.01f; // Adjust speed as needed
-    
-    // Make sure we have 3 lights
-    if (m_Lights.size() < 1) {
-        m_Lights.resize(1);
+void Renderer::pickUnderCursor()
+{
+    // Picks on the press, not while the button is held
+    bool pickPressed = glfwGetMouseButton(m_pWindow->getGLFWwindow(), GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+    bool justPressed = pickPressed && !m_PickPressedLast;
+    m_PickPressedLast = pickPressed;
+    if (!justPressed)
+    {
+        return;
+    }
+
+    double cursorX, cursorY;
+    int windowWidth, windowHeight;
+    glfwGetCursorPos(m_pWindow->getGLFWwindow(), &cursorX, &cursorY);
+    glfwGetWindowSize(m_pWindow->getGLFWwindow(), &windowWidth, &windowHeight);
+    if (windowWidth == 0 || windowHeight == 0)
+    {
+        return;
+    }
+
+    // The projection already flips Y, so window and NDC Y both point down
+    glm::vec4 ndc(2.0f * float(cursorX) / windowWidth - 1.0f, 2.0f * float(cursorY) / windowHeight - 1.0f, 1.0f, 1.0f);
+    glm::mat4 inverseModel = glm::inverse(m_UniformBufferObject.model);
+    glm::vec4 farPoint = glm::inverse(m_UniformBufferObject.proj * m_UniformBufferObject.view) * ndc;
+    glm::vec3 origin = glm::vec3(inverseModel * glm::vec4(m_pCamera->getPosition(), 1.0f));
+    glm::vec3 target = glm::vec3(inverseModel * (farPoint / farPoint.w));
+
+    PickResult pick{};
+    if (m_pModel->pick(origin, glm::normalize(target - origin), pick))
+    {
+        spdlog::info("Picked submesh {} (material {}), triangle {} at distance {:.2f}",
+            pick.submeshIndex, m_pModel->getSubmeshes()[pick.submeshIndex].materialIndex, pick.triangleIndex, pick.distance);
+    }
+    else
+    {
+        spdlog::info("Picked nothing");
     }
-    
-    // Fixed Y and Z positions for all lights
-    const float y = 1.0f;
-    const float z = -0.2f;
-
-    // Blue light - pulsating intensity
-	m_Lights[0].color = glm::vec3(1.f, 0.694f, 0.431f); // 4000K light color
-    m_Lights[0].position = glm::vec3(7.0f * sin(time ), y, z);
-    m_Lights[0].intensity = 5.0f + 10.0f * (sin(5*time) * 0.5f + 0.5f); // Pulsate between 5 and 15
-    m_Lights[0].radius = 5.0f;
 }
 
 void Renderer::updateLightBuffer(uint32_t currentImage)
 {
-    struct LightsBuffer {
-        uint32_t lightCount;
-        Light lights[MAX_LIGHT_COUNT];
-    } lightsBufferData;
-
-    lightsBufferData.lightCount = static_cast<uint32_t>(m_Lights.size());
-    memcpy(lightsBufferData.lights, m_Lights.data(), sizeof(Light) * m_Lights.size());
+    m_pLightManager->upload(currentImage);
+    if (m_LightBufferGenerations[currentImage] != m_pLightManager->getBufferGeneration(currentImage))
+    {
+        m_pDescriptorManager->updateLightBufferDescriptors(
+            currentImage,
+            m_pLightManager->getSourceBuffer(currentImage),
+            m_pLightManager->getSourceBufferSize(currentImage),
+            m_pLightManager->getLightBuffer(currentImage),
+            m_pLightManager->getLightBufferSize(currentImage)
+        );
+        m_LightBufferGenerations[currentImage] = m_pLightManager->getBufferGeneration(currentImage);
+    }
+}
 
-    void* data = m_pLightBuffers[currentImage]->map();
-    memcpy(data, &lightsBufferData, sizeof(lightsBufferData));
-    m_pLightBuffers[currentImage]->unmap();
+void Renderer::createPointLights()
+{
+    // 4000K key light swinging along the nave and pulsing between 5 and 15
+    LightSource keyLight{};
+    keyLight.position = glm::vec3(0.0f, 1.0f, -0.2f);
+    keyLight.color = glm::vec3(1.0f, 0.694f, 0.431f);
+    keyLight.intensity = 5.0f;
+    keyLight.radius = 5.0f;
+    keyLight.orbitExtent = glm::vec2(7.0f, 0.0f);
+    keyLight.orbitSpeed = 0.6f;
+    keyLight.phase = -glm::half_pi<float>();
+    keyLight.pulseAmount = 2.0f;
+    keyLight.pulseSpeed = 3.0f;
+    keyLight.animation = LIGHT_ANIMATION_ORBIT | LIGHT_ANIMATION_PULSE;
+    m_pLightManager->addLight(keyLight);
+
+    // A fixed seed keeps the scene the same between runs
+    std::mt19937 random(7);
+    auto [aabbMin, aabbMax] = m_pModel->getAABB();
+    std::uniform_real_distribution<float> x(aabbMin.x, aabbMax.x);
+    std::uniform_real_distribution<float> y(aabbMin.y, aabbMax.y);
+    std::uniform_real_distribution<float> z(aabbMin.z, aabbMax.z);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    // Small lights relative to the scene, so each pixel is reached by a handful
+    const float diagonal = glm::length(aabbMax - aabbMin);
+    for (uint32_t i = 0; i < POINT_LIGHT_COUNT; ++i)
+    {
+        LightSource light{};
+        light.position = glm::vec3(x(random), y(random), z(random));
+        light.color = glm::mix(glm::vec3(0.2f), glm::vec3(1.0f), glm::vec3(unit(random), unit(random), unit(random)));
+        light.intensity = 2.0f;
+        light.radius = diagonal * (0.01f + 0.02f * unit(random));
+        // Each drifts around a small circle and flickers, evaluated on the GPU
+        light.orbitExtent = glm::vec2(light.radius * 0.5f);
+        light.orbitSpeed = 0.2f + unit(random);
+        light.phase = glm::two_pi<float>() * unit(random);
+        light.pulseAmount = 0.5f;
+        light.pulseSpeed = 1.0f + 4.0f * unit(random);
+        light.animation = LIGHT_ANIMATION_ORBIT | LIGHT_ANIMATION_PULSE;
+        m_pLightManager->addLight(light);
+    }
 }
 
 void Renderer::updateSunMatricesBuffer(uint32_t currentImage)
 {
-    SunMatricesUBO sunMatrices;
-    sunMatrices.lightProj = m_LightProj;
-    sunMatrices.lightView = m_LightView;
-    void* data = m_pSunMatricesBuffers[currentImage]->map();
-    memcpy(data, &sunMatrices, sizeof(sunMatrices));
-    m_pSunMatricesBuffers[currentImage]->unmap();
+    // The matrices each layer was rendered with, which may be from an earlier frame
+    SunMatricesUBO sunMatrices{};
+    for (uint32_t cascade = 0; cascade < SHADOW_CASCADE_COUNT; ++cascade)
+    {
+        const ShadowCascade& shadowCascade = m_CachedShadowCascades[currentImage][cascade].cascade;
+        sunMatrices.lightProj[cascade] = shadowCascade.projection;
+        sunMatrices.lightView[cascade] = shadowCascade.view;
+        sunMatrices.cascadeSplits[cascade] = shadowCascade.splitDistance;
+    }
+    m_SunMatricesOffset = m_pUniformRing->push(sunMatrices);
 }
 
 void Renderer::recreateSwapChain()
@@ -1742,11 +2001,8 @@ void Renderer::recreateSwapChain()
         .setImageUsage(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT)
         .build();
 
-    transitionSwapchainImagesToPresentLayout();
-
     createGBuffer();
-	createHDRImage();
-	createLDRImage();
+    createRenderGraph();
 
     m_pSwapChain->getImages();
 
@@ -1756,31 +2012,76 @@ void Renderer::recreateSwapChain()
     {
         m_pDescriptorManager->updateFinalPassDescriptorSet(
             i,
-            m_GBuffers[i].diffuseImageView,
-            m_GBuffers[i].normalImageView,
-            m_GBuffers[i].metallicRoughnessImageView,
-            m_GBuffers[i].depthImageView,
-            m_pUniformBuffers[i]->get(),
+            m_pRenderGraph->getImageView(m_DiffuseImage),
+            m_pRenderGraph->getImageView(m_NormalImage),
+            m_pRenderGraph->getImageView(m_MetallicRoughnessImage),
+            m_pRenderGraph->getImageView(m_DepthImage),
+            m_pUniformRing->get(),
             sizeof(UniformBufferObject),
-            m_pLightBuffers[i]->get(),
-            (sizeof(Light) * MAX_LIGHT_COUNT + sizeof(uint32_t)),
-			m_pSunMatricesBuffers[i]->get(),
+            m_pLightManager->getLightBuffer(i),
+            m_pLightManager->getLightBufferSize(i),
+			m_pUniformRing->get(),
 			sizeof(SunMatricesUBO),
 			m_GBuffers[i].shadowMapImageView,
 			m_SkyboxCubeMapImageView,
             m_IrradianceMapImageView,
+            m_pLightClusterBuffers[i]->get(),
+            LIGHT_CLUSTER_BUFFER_SIZE,
             Texture::getTextureSampler()
         );
 
 		m_pDescriptorManager->updateComputeDescriptorSet(
 			i,
-			m_HDRImageView[i],
-			m_LDRImageView[i]
+			m_pRenderGraph->getImageView(m_HDRImage),
+			m_pRenderGraph->getImageView(m_LDRImage)
 		);
+
+        m_pDescriptorManager->updateDepthPyramidDescriptorSets(
+            i,
+            getDepthPyramidSourceViews(m_pRenderGraph->getImageView(m_DepthImage), m_GBuffers[i].depthPyramidLevelViews),
+            m_GBuffers[i].depthPyramidLevelViews,
+            Texture::getTextureSampler()
+        );
+        m_pDescriptorManager->updateOcclusionDescriptorSet(
+            i,
+            m_pVisibilityList->getDrawBuffer(i),
+            m_pVisibilityList->getDrawBoundsBuffer(i),
+            m_pOccludedDrawCommandBuffers[i]->get(),
+            m_pVisibilityList->getMaxDrawCount(),
+            m_pCullCounterBuffers[i]->get(),
+            sizeof(CullCounters),
+            m_GBuffers[i].depthPyramidImageView,
+            Texture::getTextureSampler()
+        );
+        m_pDescriptorManager->updateMeshletCullDescriptorSet(
+            i,
+            m_pOccludedDrawCommandBuffers[i]->get(),
+            m_pVisibilityList->getDrawBoundsBuffer(i),
+            m_pVisibilityList->getMaxDrawCount(),
+            m_pModel->getMeshletBuffer(),
+            m_pModel->getMeshletBufferSize(),
+            m_pMeshletDrawCommandBuffers[i]->get(),
+            std::max(m_pModel->getMeshletCount(), 1u),
+            m_pCullCounterBuffers[i]->get(),
+            sizeof(CullCounters),
+            m_GBuffers[i].depthPyramidImageView,
+            Texture::getTextureSampler()
+        );
+        m_pDescriptorManager->updateLightCullDescriptorSet(
+            i,
+            m_pUniformRing->get(),
+            sizeof(UniformBufferObject),
+            m_pLightManager->getLightBuffer(i),
+            m_pLightManager->getLightBufferSize(i),
+            m_pRenderGraph->getImageView(m_DepthImage),
+            m_pLightClusterBuffers[i]->get(),
+            LIGHT_CLUSTER_BUFFER_SIZE,
+            Texture::getTextureSampler()
+        );
     }
 
-    // Re-render the shadow map to match the new swapchain resolution
-    renderShadowMap();
+    // Layout transitions of the new attachments
+    m_pUploadBatch->submit();
 }
 
 void Renderer::transitionImageLayout(
@@ -1792,7 +2093,9 @@ void Renderer::transitionImageLayout(
     VkPipelineStageFlags2 dstStageMask,
     VkAccessFlags2 srcAccessMask,
     VkAccessFlags2 dstAccessMask,
-    VkImageAspectFlags aspectMask)
+    VkImageAspectFlags aspectMask,
+    uint32_t baseArrayLayer,
+    uint32_t layerCount)
 {
     VkImageMemoryBarrier2 barrier{};
     barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
@@ -1806,8 +2109,8 @@ void Renderer::transitionImageLayout(
     barrier.subresourceRange.aspectMask = aspectMask;
     barrier.subresourceRange.baseMipLevel = 0;
     barrier.subresourceRange.levelCount = 1;
-    barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = 1;
+    barrier.subresourceRange.baseArrayLayer = baseArrayLayer;
+    barrier.subresourceRange.layerCount = layerCount;
 
     VkDependencyInfo dependencyInfo{};
     dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
@@ -1825,7 +2128,9 @@ void Renderer::transitionImageLayout(VkCommandBuffer commandBuffer,
     VkPipelineStageFlags2 dstStageMask,
     VkAccessFlags2 srcAccessMask,
     VkAccessFlags2 dstAccessMask,
-    VkImageAspectFlags aspectMask)
+    VkImageAspectFlags aspectMask,
+    uint32_t baseArrayLayer,
+    uint32_t layerCount)
 {
 	transitionImageLayout(
 		commandBuffer,
@@ -1836,308 +2141,200 @@ void Renderer::transitionImageLayout(VkCommandBuffer commandBuffer,
 		dstStageMask,
 		srcAccessMask,
 		dstAccessMask,
-		aspectMask
+		aspectMask,
+		baseArrayLayer,
+		layerCount
 	);
 	pImage->setImageLayout(newLayout);
 }
 
-void Renderer::transitionSwapchainImagesToPresentLayout()
-{
-    VkCommandBuffer commandBuffer = m_pCommandPool->beginSingleTimeCommands();
-
-	for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
-	{
-		transitionImageLayout(
-			commandBuffer,
-			m_pSwapChain->getImages()[i],
-			VK_IMAGE_LAYOUT_UNDEFINED,
-			VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-			VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-			VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT,
-			VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
-			VK_ACCESS_2_NONE,
-			VK_IMAGE_ASPECT_COLOR_BIT
-		);
-	}
-
-    m_pCommandPool->endSingleTimeCommands(commandBuffer, m_pDevice->getGraphicsQueue());
-}
-
 void Renderer::createGBuffer()
 {
     m_GBuffers.resize(MAX_FRAMES_IN_FLIGHT);
 
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
     {
-        // Create diffuse image
-        m_GBuffers[i].pDiffuseImage = new Image(m_pDevice, m_VmaAllocator);
-        m_GBuffers[i].pDiffuseImage->createImage(m_pSwapChain->getExtent().width,
-            m_pSwapChain->getExtent().height,
-            VK_FORMAT_R8G8B8A8_SRGB,
-            VK_IMAGE_TILING_OPTIMAL,
-            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-            VMA_MEMORY_USAGE_GPU_ONLY);
-        m_GBuffers[i].diffuseImageView = m_GBuffers[i].pDiffuseImage->createImageView(
-            VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT);
-
-        {
-            VkCommandBuffer commandBuffer = m_pCommandPool->beginSingleTimeCommands();
-            transitionImageLayout(
-                commandBuffer,
-                m_GBuffers[i].pDiffuseImage,
-                VK_IMAGE_LAYOUT_UNDEFINED,
-                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
-                VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
-                0,
-                VK_ACCESS_2_SHADER_READ_BIT,
-                VK_IMAGE_ASPECT_COLOR_BIT
-            );
-            m_pCommandPool->endSingleTimeCommands(commandBuffer, m_pDevice->getGraphicsQueue());
-        }
-          
-        // Create normal image
-        m_GBuffers[i].pNormalImage = new Image(m_pDevice, m_VmaAllocator);
-        m_GBuffers[i].pNormalImage->createImage(m_pSwapChain->getExtent().width,
-            m_pSwapChain->getExtent().height,
-            VK_FORMAT_R16G16B16A16_SFLOAT,
-            VK_IMAGE_TILING_OPTIMAL,
-            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-            VMA_MEMORY_USAGE_GPU_ONLY);
-        m_GBuffers[i].normalImageView = m_GBuffers[i].pNormalImage->createImageView(
-            VK_FORMAT_R16G16B16A16_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT);
-
-        {
-            VkCommandBuffer commandBuffer = m_pCommandPool->beginSingleTimeCommands();
-            transitionImageLayout(
-                commandBuffer,
-                m_GBuffers[i].pNormalImage,
-                VK_IMAGE_LAYOUT_UNDEFINED,
-                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
-                VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
-                0,
-                VK_ACCESS_2_SHADER_READ_BIT,
-                VK_IMAGE_ASPECT_COLOR_BIT
-            );
-            m_pCommandPool->endSingleTimeCommands(commandBuffer, m_pDevice->getGraphicsQueue());
-        }
-
-        // Create metallic-roughness image
-        m_GBuffers[i].pMetallicRougnessImage = new Image(m_pDevice, m_VmaAllocator);
-        m_GBuffers[i].pMetallicRougnessImage->createImage(m_pSwapChain->getExtent().width,
-            m_pSwapChain->getExtent().height,
-            VK_FORMAT_R8G8B8A8_UNORM,
-            VK_IMAGE_TILING_OPTIMAL,
-            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-            VMA_MEMORY_USAGE_GPU_ONLY);
-        m_GBuffers[i].metallicRoughnessImageView = m_GBuffers[i].pMetallicRougnessImage->createImageView(
-            VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT);
-
-        {
-            VkCommandBuffer commandBuffer = m_pCommandPool->beginSingleTimeCommands();
-            transitionImageLayout(
-                commandBuffer,
-                m_GBuffers[i].pMetallicRougnessImage,
-                VK_IMAGE_LAYOUT_UNDEFINED,
-                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
-                VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
-                0,
-                VK_ACCESS_2_SHADER_READ_BIT,
-                VK_IMAGE_ASPECT_COLOR_BIT
-            );
-            m_pCommandPool->endSingleTimeCommands(commandBuffer, m_pDevice->getGraphicsQueue());
-        }
-
-        // Create depth image
         VkFormat depthFormat = findDepthFormat();
-        m_GBuffers[i].pDepthImage = new Image(m_pDevice, m_VmaAllocator);
-        m_GBuffers[i].pDepthImage->createImage(m_pSwapChain->getExtent().width,
-            m_pSwapChain->getExtent().height,
-            depthFormat,
-            VK_IMAGE_TILING_OPTIMAL,
-            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-            VMA_MEMORY_USAGE_GPU_ONLY);
-        m_GBuffers[i].depthImageView = m_GBuffers[i].pDepthImage->createImageView(
-            depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
-
-        {
-            VkCommandBuffer commandBuffer = m_pCommandPool->beginSingleTimeCommands();
-            transitionImageLayout(
-                commandBuffer,
-                m_GBuffers[i].pDepthImage,
-                VK_IMAGE_LAYOUT_UNDEFINED,
-                VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
-                VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
-                VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
-                0,
-                VK_ACCESS_2_SHADER_READ_BIT,
-                VK_IMAGE_ASPECT_DEPTH_BIT
-            );
-            m_pCommandPool->endSingleTimeCommands(commandBuffer, m_pDevice->getGraphicsQueue());
-        }
 
 		// Create Shadow map image
 		m_GBuffers[i].pShadowMapImage = new Image(m_pDevice, m_VmaAllocator);
 		m_GBuffers[i].pShadowMapImage->createImage(
-            2048,
-			2048,
+            SHADOW_MAP_SIZE,
+			SHADOW_MAP_SIZE,
             depthFormat,
 			VK_IMAGE_TILING_OPTIMAL,
 			VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+			0,
+			SHADOW_CASCADE_COUNT,
 			VMA_MEMORY_USAGE_GPU_ONLY);
-		m_GBuffers[i].shadowMapImageView = m_GBuffers[i].pShadowMapImage->createImageView(
-			depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
+		m_GBuffers[i].shadowMapImageView = m_GBuffers[i].pShadowMapImage->createLayerImageView(
+			depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, VK_IMAGE_VIEW_TYPE_2D_ARRAY, 0, SHADOW_CASCADE_COUNT);
+		for (uint32_t cascade = 0; cascade < SHADOW_CASCADE_COUNT; ++cascade)
+		{
+			m_GBuffers[i].shadowCascadeImageViews[cascade] = m_GBuffers[i].pShadowMapImage->createLayerImageView(
+				depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, VK_IMAGE_VIEW_TYPE_2D, cascade, 1);
+			m_CachedShadowCascades[i][cascade].valid = false;
+		}
+
+        m_pUploadBatch->transitionImage(
+            m_GBuffers[i].pShadowMapImage,
+            VK_IMAGE_LAYOUT_UNDEFINED,
+            VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+            VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
+            VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+            0,
+            VK_ACCESS_2_SHADER_READ_BIT,
+            VK_IMAGE_ASPECT_DEPTH_BIT,
+            SHADOW_CASCADE_COUNT
+        );
 
-        {
-            VkCommandBuffer commandBuffer = m_pCommandPool->beginSingleTimeCommands();
-            transitionImageLayout(
-                commandBuffer,
-                m_GBuffers[i].pShadowMapImage,
-                VK_IMAGE_LAYOUT_UNDEFINED,
-                VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
-                VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
-                VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
-                0,
-                VK_ACCESS_2_SHADER_READ_BIT,
-                VK_IMAGE_ASPECT_DEPTH_BIT
-            );
-            m_pCommandPool->endSingleTimeCommands(commandBuffer, m_pDevice->getGraphicsQueue());
-        }
+        createDepthPyramid(i);
     }
 }
 
-void Renderer::createHDRImage()
+void Renderer::createRenderGraph()
 {
-    m_pHDRImage.resize(MAX_FRAMES_IN_FLIGHT);
-    m_HDRImageView.resize(MAX_FRAMES_IN_FLIGHT);
-    for (int i{}; i < MAX_FRAMES_IN_FLIGHT; ++i)
-    {
-        m_pHDRImage[i] = new Image(m_pDevice, m_VmaAllocator);
-        m_pHDRImage[i]->createImage(
-            m_pSwapChain->getExtent().width,
-            m_pSwapChain->getExtent().height,
-            VK_FORMAT_R32G32B32A32_SFLOAT,
-            VK_IMAGE_TILING_OPTIMAL,
-            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT |
-            VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-            VMA_MEMORY_USAGE_GPU_ONLY);
-        m_HDRImageView[i] = m_pHDRImage[i]->createImageView(
-            VK_FORMAT_R32G32B32A32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT);
-        {
-            VkCommandBuffer commandBuffer = m_pCommandPool->beginSingleTimeCommands();
-            transitionImageLayout(
-                commandBuffer,
-                m_pHDRImage[i],
-                VK_IMAGE_LAYOUT_UNDEFINED,
-                VK_IMAGE_LAYOUT_GENERAL,
-                VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
-                VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
-                0,
-                VK_ACCESS_2_SHADER_WRITE_BIT,
-                VK_IMAGE_ASPECT_COLOR_BIT
-            );
-            m_pCommandPool->endSingleTimeCommands(commandBuffer, m_pDevice->getGraphicsQueue());
-        }
-    }
+    const uint32_t width = m_pSwapChain->getExtent().width;
+    const uint32_t height = m_pSwapChain->getExtent().height;
+    m_pRenderGraph = new RenderGraph(m_pDevice, m_VmaAllocator);
+
+    // These only live within a frame, so every frame in flight shares them and the graph overlaps their memory
+    m_DepthImage = m_pRenderGraph->createImage("Depth", width, height, findDepthFormat(), VK_IMAGE_ASPECT_DEPTH_BIT);
+    m_DiffuseImage = m_pRenderGraph->createImage("Diffuse", width, height, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT);
+    m_NormalImage = m_pRenderGraph->createImage("Normal", width, height, VK_FORMAT_R16G16B16A16_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT);
+    m_MetallicRoughnessImage = m_pRenderGraph->createImage("Metallic-roughness", width, height, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT);
+    m_HDRImage = m_pRenderGraph->createImage("HDR", width, height, VK_FORMAT_R32G32B32A32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT);
+    m_LDRImage = m_pRenderGraph->createImage("LDR", width, height, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT);
+    m_SwapchainImage = m_pRenderGraph->importImage("Swapchain", VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+    // Passes whose results are buffers, or the shadow map that keeps its layers between frames,
+    // synchronise those themselves and are kept for their side effects
+    m_pRenderGraph->addPass("Light animation")
+        .setSideEffects()
+        .setExecute([this](VkCommandBuffer commandBuffer) { animateLights(commandBuffer); });
+    m_pRenderGraph->addPass("Shadow cascades")
+        .setSideEffects()
+        .setExecute([this](VkCommandBuffer commandBuffer) { recordShadowPass(commandBuffer); });
+    m_pRenderGraph->addPass("Submesh culling")
+        .setSideEffects()
+        .setExecute([this](VkCommandBuffer commandBuffer) { cullSubmeshes(commandBuffer); });
+    m_pRenderGraph->addPass("Depth pre-pass")
+        .use(m_DepthImage, RenderGraphAccess::DepthAttachmentWrite)
+        .setExecute([this](VkCommandBuffer commandBuffer) { recordDepthPrePass(commandBuffer); });
+    m_pRenderGraph->addPass("Occlusion culling")
+        .use(m_DepthImage, RenderGraphAccess::ComputeSampledRead)
+        .setSideEffects()
+        .setExecute([this](VkCommandBuffer commandBuffer) { cullOccludedDraws(commandBuffer); });
+    m_pRenderGraph->addPass("Meshlet culling")
+        .setSideEffects()
+        .setExecute([this](VkCommandBuffer commandBuffer) { cullMeshlets(commandBuffer); });
+    m_pRenderGraph->addPass("Light culling")
+        .use(m_DepthImage, RenderGraphAccess::ComputeSampledRead)
+        .setSideEffects()
+        .setExecute([this](VkCommandBuffer commandBuffer) { cullLights(commandBuffer); });
+    m_pRenderGraph->addPass("G-buffer")
+        .use(m_DiffuseImage, RenderGraphAccess::ColorAttachmentWrite)
+        .use(m_NormalImage, RenderGraphAccess::ColorAttachmentWrite)
+        .use(m_MetallicRoughnessImage, RenderGraphAccess::ColorAttachmentWrite)
+        .use(m_DepthImage, RenderGraphAccess::DepthAttachmentRead)
+        .setExecute([this](VkCommandBuffer commandBuffer) { recordGBufferPass(commandBuffer); });
+    m_pRenderGraph->addPass("Lighting")
+        .use(m_DiffuseImage, RenderGraphAccess::FragmentSampledRead)
+        .use(m_NormalImage, RenderGraphAccess::FragmentSampledRead)
+        .use(m_MetallicRoughnessImage, RenderGraphAccess::FragmentSampledRead)
+        .use(m_DepthImage, RenderGraphAccess::FragmentSampledRead)
+        .use(m_HDRImage, RenderGraphAccess::ColorAttachmentWrite)
+        .setExecute([this](VkCommandBuffer commandBuffer) { recordLightingPass(commandBuffer); });
+    m_pRenderGraph->addPass("Tone mapping")
+        .use(m_HDRImage, RenderGraphAccess::ComputeStorageRead)
+        .use(m_LDRImage, RenderGraphAccess::ComputeStorageWrite)
+        .setExecute([this](VkCommandBuffer commandBuffer) { recordToneMapping(commandBuffer); });
+    m_pRenderGraph->addPass("Present blit")
+        .use(m_LDRImage, RenderGraphAccess::TransferRead)
+        .use(m_SwapchainImage, RenderGraphAccess::TransferWrite)
+        .setExecute([this](VkCommandBuffer commandBuffer) { blitLDRToSwapchain(commandBuffer); });
+
+    m_pRenderGraph->compile();
 }
 
-void Renderer::createLDRImage()
+void Renderer::createDepthPyramid(size_t frameIndex)
 {
-	m_pLDRImage.resize(MAX_FRAMES_IN_FLIGHT);
-	m_LDRImageView.resize(MAX_FRAMES_IN_FLIGHT);
-	for (int i{}; i < MAX_FRAMES_IN_FLIGHT; ++i)
-	{
-		m_pLDRImage[i] = new Image(m_pDevice, m_VmaAllocator);
-		m_pLDRImage[i]->createImage(
-			m_pSwapChain->getExtent().width,
-			m_pSwapChain->getExtent().height,
-			VK_FORMAT_R8G8B8A8_UNORM,
-			VK_IMAGE_TILING_OPTIMAL,
-			VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT |
-			VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-			VMA_MEMORY_USAGE_GPU_ONLY);
-		m_LDRImageView[i] = m_pLDRImage[i]->createImageView(
-			VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT);
-        {
-            VkCommandBuffer commandBuffer = m_pCommandPool->beginSingleTimeCommands();
-            transitionImageLayout(
-                commandBuffer,
-                m_pLDRImage[i],
-                VK_IMAGE_LAYOUT_UNDEFINED,
-                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
-                VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-                0,
-                VK_ACCESS_2_TRANSFER_WRITE_BIT,
-                VK_IMAGE_ASPECT_COLOR_BIT
-            );
-            m_pCommandPool->endSingleTimeCommands(commandBuffer, m_pDevice->getGraphicsQueue());
-        }
-	}
-}
+    GBuffer& gBuffer = m_GBuffers[frameIndex];
 
-void Renderer::cleanupSwapChain()
-{
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+    // Level 0 is half the depth buffer; sizes round down and the reduction covers the leftover texels
+    uint32_t width = std::max(1u, m_pSwapChain->getExtent().width / 2);
+    uint32_t height = std::max(1u, m_pSwapChain->getExtent().height / 2);
+    uint32_t levelCount = 1;
+    while ((std::max(width, height) >> levelCount) > 0)
     {
-        vkDestroyImageView(m_pDevice->get(), m_GBuffers[i].depthImageView, nullptr);
-        delete m_GBuffers[i].pDepthImage;
+        levelCount++;
+    }
+    levelCount = std::min(levelCount, DescriptorManager::MAX_DEPTH_PYRAMID_LEVELS);
 
-        vkDestroyImageView(m_pDevice->get(), m_GBuffers[i].diffuseImageView, nullptr);
-        delete m_GBuffers[i].pDiffuseImage;
+    gBuffer.pDepthPyramidImage = new Image(m_pDevice, m_VmaAllocator);
+    gBuffer.pDepthPyramidImage->createImage(
+        width,
+        height,
+        VK_FORMAT_R32_SFLOAT,
+        VK_IMAGE_TILING_OPTIMAL,
+        VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        0,
+        1,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        levelCount);
+    gBuffer.depthPyramidImageView = gBuffer.pDepthPyramidImage->createImageView(
+        VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT);
 
-        vkDestroyImageView(m_pDevice->get(), m_GBuffers[i].normalImageView, nullptr);
-        delete m_GBuffers[i].pNormalImage;
+    gBuffer.depthPyramidLevelViews.resize(levelCount);
+    for (uint32_t level = 0; level < levelCount; ++level)
+    {
+        gBuffer.depthPyramidLevelViews[level] = gBuffer.pDepthPyramidImage->createImageView(
+            VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT, level, 1);
+    }
 
-        vkDestroyImageView(m_pDevice->get(), m_GBuffers[i].metallicRoughnessImageView, nullptr);
-        delete m_GBuffers[i].pMetallicRougnessImage;
+    // Written and read only by compute shaders, so it stays in GENERAL
+    m_pUploadBatch->transitionImage(
+        gBuffer.pDepthPyramidImage,
+        VK_IMAGE_LAYOUT_UNDEFINED,
+        VK_IMAGE_LAYOUT_GENERAL,
+        VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+        0,
+        VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT | VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+        VK_IMAGE_ASPECT_COLOR_BIT
+    );
+}
 
+void Renderer::cleanupSwapChain()
+{
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+    {
 		vkDestroyImageView(m_pDevice->get(), m_GBuffers[i].shadowMapImageView, nullptr);
+		for (VkImageView cascadeView : m_GBuffers[i].shadowCascadeImageViews)
+		{
+			vkDestroyImageView(m_pDevice->get(), cascadeView, nullptr);
+		}
 		delete m_GBuffers[i].pShadowMapImage;
 
-		vkDestroyImageView(m_pDevice->get(), m_HDRImageView[i], nullptr);
-		delete m_pHDRImage[i];
-
-		vkDestroyImageView(m_pDevice->get(), m_LDRImageView[i], nullptr);
-		delete m_pLDRImage[i];
+        for (VkImageView levelView : m_GBuffers[i].depthPyramidLevelViews)
+        {
+            vkDestroyImageView(m_pDevice->get(), levelView, nullptr);
+        }
+        vkDestroyImageView(m_pDevice->get(), m_GBuffers[i].depthPyramidImageView, nullptr);
+        delete m_GBuffers[i].pDepthPyramidImage;
     }
 
     // Clear the vector
     m_GBuffers.clear();
 
+    delete m_pRenderGraph;
+    m_pRenderGraph = nullptr;
+
     delete m_pSwapChain;
 }
 
-void Renderer::blitLDRToSwapchain(uint32_t imageIndex, VkCommandBuffer commandBuffer)
+void Renderer::blitLDRToSwapchain(VkCommandBuffer commandBuffer)
 {
-    // Transition LDR image layout to transfer source
-        // Transition LDR image layout to transfer source
-    transitionImageLayout(
-        commandBuffer,
-        m_pLDRImage[imageIndex],
-        m_pLDRImage[imageIndex]->getImageLayout(),                       // From compute shader
-        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,          // To transfer source
-        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,        // After compute shader
-        VK_PIPELINE_STAGE_2_TRANSFER_BIT,              // Before transfer operations
-        VK_ACCESS_2_SHADER_WRITE_BIT,                  // After compute writes
-        VK_ACCESS_2_TRANSFER_READ_BIT,                 // For transfer read
-        VK_IMAGE_ASPECT_COLOR_BIT);
-
-    // **Modified: Transition swapchain image layout to transfer destination**
-    transitionImageLayout(
-        commandBuffer,
-        m_pSwapChain->getImages()[imageIndex],
-        VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,               // **From present source**
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,          // To transfer destination
-        VK_PIPELINE_STAGE_2_TRANSFER_BIT,              // Using transfer stages
-        VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-        VK_ACCESS_2_NONE,                              // No prior access
-        VK_ACCESS_2_TRANSFER_WRITE_BIT,                // For transfer write
-        VK_IMAGE_ASPECT_COLOR_BIT);
-
-
     // Blit the image
     VkImageBlit blitRegion{};
     blitRegion.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
@@ -2163,22 +2360,10 @@ void Renderer::blitLDRToSwapchain(uint32_t imageIndex, VkCommandBuffer commandBu
 
     vkCmdBlitImage(
         commandBuffer,
-        m_pLDRImage[imageIndex]->getImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-        m_pSwapChain->getImages()[imageIndex], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        m_pRenderGraph->getImage(m_LDRImage), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        m_pRenderGraph->getImage(m_SwapchainImage), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
         1, &blitRegion,
         VK_FILTER_NEAREST); // Use VK_FILTER_LINEAR for smoother scaling if needed
-
-    // Transition swapchain image to present mode
-    transitionImageLayout(
-        commandBuffer,
-        m_pSwapChain->getImages()[imageIndex],
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,          // From transfer destination
-        VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,               // To present source
-        VK_PIPELINE_STAGE_2_TRANSFER_BIT,              // After transfer operations
-        VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT,        // Before presentation
-        VK_ACCESS_2_TRANSFER_WRITE_BIT,                // After transfer writes
-        0,                                             // No access needed for presentation
-        VK_IMAGE_ASPECT_COLOR_BIT);
 }
 
 void Renderer::cleanup() 
@@ -2189,17 +2374,18 @@ void Renderer::cleanup()
     delete m_pCamera;
     m_pCamera = nullptr;
 
-    for (auto& uniformBuffer : m_pUniformBuffers) 
+    delete m_pUniformRing;
+    delete m_pLightManager;
+    for (auto& lightClusterBuffer : m_pLightClusterBuffers)
     {
-        delete uniformBuffer;
+        delete lightClusterBuffer;
     }
-	for (auto& lightBuffer : m_pLightBuffers) 
-    {
-		delete lightBuffer;
-	}
-    for (auto& sunMatricesBuffer : m_pSunMatricesBuffers) 
+    delete m_pVisibilityList;
+    for (size_t i = 0; i < m_pOccludedDrawCommandBuffers.size(); i++)
     {
-        delete sunMatricesBuffer;
+        delete m_pOccludedDrawCommandBuffers[i];
+        delete m_pMeshletDrawCommandBuffers[i];
+        delete m_pCullCounterBuffers[i];
     }
 
     vkDestroyImageView(m_pDevice->get(), m_IrradianceMapImageView, nullptr);
@@ -2211,6 +2397,9 @@ void Renderer::cleanup()
 
     delete m_pDescriptorManager;
     delete m_pModel;
+    delete m_pTextureCache;
+    delete m_pThreadPool;
+    delete m_pUploadBatch;
   
     vmaDestroyAllocator(m_VmaAllocator);
 
@@ -2219,6 +2408,12 @@ void Renderer::cleanup()
 	delete m_pShadowMapPipeline;
 	delete m_pFinalPipeline;
 	delete m_pToneMappingPipeline;
+    delete m_pDepthPyramidPipeline;
+    delete m_pCullPipeline;
+    delete m_pOcclusionPipeline;
+    delete m_pMeshletCullPipeline;
+    delete m_pLightCullPipeline;
+    delete m_pLightAnimatePipeline;
     delete m_pSyncObjects;
     delete m_pCommandPool;
     delete m_pDevice;
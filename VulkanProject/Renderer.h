@@ -21,11 +21,21 @@
 #include "Buffer.h"
 #include "Image.h"
 #include "Camera.h"
+#include "ThreadPool.h"
+#include "TextureCache.h"
+#include "UploadBatch.h"
+#include "VisibilityList.h"
+#include "ShadowCascades.h"
+#include "LightClusters.h"
+#include "LightManager.h"
+#include "UniformRing.h"
+#include "RenderGraph.h"
 #include "vk_mem_alloc.h"
 
 #include <vector>
 #include <string>
 #include <array>
+#include <chrono>
 
 class Renderer 
 {
@@ -39,27 +49,71 @@ public:
 
 	VkDevice getDevice() const { return m_pDevice->get(); }
 
+    // Submesh and meshlet counts of the most recently completed frame
+    struct CullStatistics
+    {
+        uint32_t submeshCount = 0;
+        uint32_t frustumVisibleCount = 0;
+        // Submeshes in the frustum by the level of detail they draw, full detail first
+        std::array<uint32_t, MAX_LOD_COUNT> lodDrawCounts{};
+        uint32_t occludedCount = 0;
+        uint32_t drawnCount = 0;
+        // Meshlets of the drawn submeshes, by the test that rejected them
+        uint32_t meshletFrustumCulledCount = 0;
+        uint32_t meshletBackfaceCulledCount = 0;
+        uint32_t meshletOccludedCount = 0;
+        uint32_t meshletDrawnCount = 0;
+        // Shadow cascades re-rendered in the last frame and the caster draws they took
+        uint32_t shadowCascadeRenderCount = 0;
+        uint32_t shadowCasterDrawCount = 0;
+    };
+    const CullStatistics& getCullStatistics() const { return m_CullStatistics; }
+
 private:
     void initVulkan();
     void createVmaAllocator();
     void createGBuffer();
-	void createHDRImage();
-	void createLDRImage();
-    void createUniformBuffers();
-	void createLightBuffer();
+    // Declares the frame's passes and the images they share, and allocates the transient ones
+    void createRenderGraph();
+    void createUniformRing();
+    void createLightClusterBuffers();
+    void createDrawCommandBuffers();
+    void createDepthPyramid(size_t frameIndex);
     void createCommandBuffers();
     void createSkyboxCubeMap();
 	void createIrradianceMap();
-    void renderShadowMap();
+    // Fits the sun's shadow cascades to the camera, culls each cascade's casters and marks the cascades
+    // whose layer in this frame's shadow map is out of date
+    void updateShadowCascades(uint32_t currentImage);
+    // Re-renders the out-of-date cascades into their layers of the frame's shadow map
+    void recordShadowPass(VkCommandBuffer commandBuffer);
+    // Culls the submeshes against the camera and compacts the survivors into the frame's visibility list
+    void cullSubmeshes(VkCommandBuffer commandBuffer);
+    // Reduces the pre-pass depth into the farthest-depth pyramid and tests the frame's draws against it
+    void cullOccludedDraws(VkCommandBuffer commandBuffer);
+    // Expands the draws that survived the occlusion test into the meshlets that pass frustum, cone and Hi-Z tests
+    void cullMeshlets(VkCommandBuffer commandBuffer);
+    // Evaluates the lights' animations into the frame's light buffer
+    void animateLights(VkCommandBuffer commandBuffer);
+    // Bins the frame's point lights into the froxel clusters that hold pre-pass geometry
+    void cullLights(VkCommandBuffer commandBuffer);
+    void readCullStatistics(uint32_t currentImage);
+    void recordDepthPrePass(VkCommandBuffer commandBuffer);
+    void recordGBufferPass(VkCommandBuffer commandBuffer);
+    void recordLightingPass(VkCommandBuffer commandBuffer);
+    void recordToneMapping(VkCommandBuffer commandBuffer);
     void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
     void updateUniformBuffer(uint32_t currentImage);
+    // Logs the submesh under the cursor when the left mouse button is clicked
+    void pickUnderCursor();
+    // Uploads light changes and repoints the frame's descriptor sets if its light buffers were reallocated
 	void updateLightBuffer(uint32_t currentImage);
     void recreateSwapChain();
     void cleanupSwapChain();
-	void blitLDRToSwapchain(uint32_t imageIndex, VkCommandBuffer commandBuffer);
-	void createSunMatricesBuffers();
+	void blitLDRToSwapchain(VkCommandBuffer commandBuffer);
 	void updateSunMatricesBuffer(uint32_t currentImage);
-    void updateLights();
+    // Adds the animated key light and scatters point lights through the model's bounds
+    void createPointLights();
 
     // Helper functions
     VkFormat findDepthFormat();
@@ -85,7 +139,9 @@ private:
         VkPipelineStageFlags2 dstStageMask,
         VkAccessFlags2 srcAccessMask,
         VkAccessFlags2 dstAccessMask,
-		VkImageAspectFlags aspectMask);
+		VkImageAspectFlags aspectMask,
+        uint32_t baseArrayLayer = 0,
+        uint32_t layerCount = 1);
 
 	// Uses Image class
     void transitionImageLayout(
@@ -97,9 +153,9 @@ private:
         VkPipelineStageFlags2 dstStageMask,
         VkAccessFlags2 srcAccessMask,
         VkAccessFlags2 dstAccessMask,
-        VkImageAspectFlags aspectMask);
-
-    void transitionSwapchainImagesToPresentLayout();
+        VkImageAspectFlags aspectMask,
+        uint32_t baseArrayLayer = 0,
+        uint32_t layerCount = 1);
 
     struct UniformBufferObject
     {
@@ -108,39 +164,34 @@ private:
         alignas(16) glm::mat4 proj;
 		alignas(16) glm::vec3 cameraPosition;
 		alignas(16) glm::vec2 viewportSize;
+        // Dequantizes the packed vertex positions: position * scale + offset
+        alignas(16) glm::vec4 positionScale;
+        alignas(16) glm::vec4 positionOffset;
     };
 
+    // Images a frame in flight keeps between its frames; the attachments that only live within a frame belong to the render graph
     struct GBuffer
     {
-        Image* pDiffuseImage;
-		VkImageView diffuseImageView;
-
-		Image* pNormalImage;
-        VkImageView normalImageView;
-
-        Image* pMetallicRougnessImage;
-        VkImageView metallicRoughnessImageView;
-
-        Image* pDepthImage;
-		VkImageView depthImageView;
-
+		// One layer per cascade: sampled as a 2D array, rendered one layer at a time
 		Image* pShadowMapImage;
 		VkImageView shadowMapImageView;
-    };
+		std::array<VkImageView, SHADOW_CASCADE_COUNT> shadowCascadeImageViews;
 
-	struct Light
-	{
-		alignas(16) glm::vec3 position;
-        alignas(16) glm::vec3 color;
-		alignas(4) float intensity;
-        alignas(4) float radius;
-	};
+        // Farthest depth per 2x2 texels of the level below, starting at half resolution
+        Image* pDepthPyramidImage;
+        VkImageView depthPyramidImageView;
+        std::vector<VkImageView> depthPyramidLevelViews;
+    };
 
+    // Matches SunMatrices in final.frag
     struct SunMatricesUBO
     {
-        alignas(16) glm::mat4 lightProj;
-        alignas(16) glm::mat4 lightView;
+        alignas(16) glm::mat4 lightProj[SHADOW_CASCADE_COUNT];
+        alignas(16) glm::mat4 lightView[SHADOW_CASCADE_COUNT];
+        // View-space distance at which each cascade ends
+        alignas(16) glm::vec4 cascadeSplits;
     };
+    static_assert(SHADOW_CASCADE_COUNT <= 4, "Cascade splits are packed into one vec4");
 
     struct DebugPushConstants {
         int debugMode;
@@ -157,8 +208,53 @@ private:
         float padding;  // For alignment
     };
 
-    glm::mat4 m_LightProj;
-    glm::mat4 m_LightView;
+    // Frustum planes and camera in model space
+    struct CullPushConstants {
+        std::array<glm::vec4, 6> planes;
+        glm::vec3 cameraPosition;
+        float pixelsPerUnitAtUnitDistance;
+        uint32_t submeshCount;
+    };
+
+    struct OcclusionPushConstants {
+        glm::mat4 viewProjection;
+        glm::vec2 depthSize;
+        uint32_t pyramidLevelCount;
+    };
+
+    struct LightAnimatePushConstants {
+        float time;
+        uint32_t lightCount;
+    };
+
+    struct MeshletCullPushConstants {
+        glm::mat4 viewProjection;
+        glm::vec4 cameraPosition;
+        glm::vec2 depthSize;
+        uint32_t pyramidLevelCount;
+    };
+
+    // Written by cull.comp (frustum), occlusion.comp (submeshes) and meshlet_cull.comp (meshlets).
+    // visibleDrawCount doubles as the indirect draw count of the depth pre-pass, meshletDrawCount as the G-buffer pass's.
+    struct CullCounters {
+        uint32_t visibleDrawCount;
+        uint32_t lodDrawCounts[MAX_LOD_COUNT];
+        uint32_t drawnCount;
+        uint32_t occludedCount;
+        uint32_t meshletDrawCount;
+        uint32_t meshletFrustumCulledCount;
+        uint32_t meshletBackfaceCulledCount;
+        uint32_t meshletOccludedCount;
+    };
+
+    // What a layer of a frame's shadow map was last rendered with
+    struct CachedShadowCascade
+    {
+        bool valid = false;
+        ShadowCascade cascade{};
+        // In index buffer order
+        std::vector<uint32_t> casters;
+    };
 
     Window* m_pWindow;
     Camera* m_pCamera;  // New camera member variable
@@ -175,33 +271,76 @@ private:
 	GraphicsPipeline* m_pFinalPipeline;
 	GraphicsPipeline* m_pShadowMapPipeline;
 	ComputePipeline* m_pToneMappingPipeline;
+    ComputePipeline* m_pDepthPyramidPipeline;
+    ComputePipeline* m_pCullPipeline;
+    ComputePipeline* m_pOcclusionPipeline;
+    ComputePipeline* m_pMeshletCullPipeline;
+    ComputePipeline* m_pLightCullPipeline;
+    ComputePipeline* m_pLightAnimatePipeline;
     CommandPool* m_pCommandPool;
+    UploadBatch* m_pUploadBatch;
     SynchronizationObjects* m_pSyncObjects;
 
     // Resources
     Model* m_pModel;
-    std::vector<Buffer*> m_pUniformBuffers;
+    ThreadPool* m_pThreadPool;
+    TextureCache* m_pTextureCache;
+    // Per-frame constants; the offsets are where this frame's copies were written
+    UniformRing* m_pUniformRing;
+    uint32_t m_UniformBufferOffset = 0;
+    uint32_t m_SunMatricesOffset = 0;
+    // Per-frame draws of the camera, consumed by the depth pre-pass and the occlusion test
+    VisibilityList* m_pVisibilityList;
+    // The same draws after the occlusion test, consumed by the meshlet pass
+    std::vector<Buffer*> m_pOccludedDrawCommandBuffers;
+    // One draw per surviving meshlet, consumed by the G-buffer pass
+    std::vector<Buffer*> m_pMeshletDrawCommandBuffers;
+    std::vector<Buffer*> m_pCullCounterBuffers;
+    CullStatistics m_CullStatistics;
     std::vector<VkCommandBuffer> m_CommandBuffers;
     VmaAllocator m_VmaAllocator = nullptr;
 
     uint32_t m_currentFrame = 0;
 
     static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
-    static constexpr int MAX_LIGHT_COUNT = 10;
+    // Room each frame has in the uniform ring for its constants
+    static constexpr VkDeviceSize UNIFORM_RING_FRAME_SIZE = 64 * 1024;
+    // Texture cache generation each frame's texture array was last written with
+    std::array<uint64_t, MAX_FRAMES_IN_FLIGHT> m_TextureDescriptorGenerations{};
+    std::array<std::array<CachedShadowCascade, SHADOW_CASCADE_COUNT>, MAX_FRAMES_IN_FLIGHT> m_CachedShadowCascades;
+    // Cascades the current frame re-renders
+    std::array<bool, SHADOW_CASCADE_COUNT> m_DirtyShadowCascades{};
+    // Scratch for the casters culled against one cascade; swapped into its cache entry when the layer is re-rendered
+    std::vector<uint32_t> m_ShadowCasters;
+    // Point lights createPointLights scatters through the scene
+    static constexpr uint32_t POINT_LIGHT_COUNT = 1024;
+    static constexpr float CAMERA_NEAR_PLANE = 0.001f;
+    static constexpr float CAMERA_FAR_PLANE = 100.0f;
+    // Resolution of each shadow cascade
+    static constexpr uint32_t SHADOW_MAP_SIZE = 2048;
+    // Practical split scheme weight: 0 splits the shadow distance uniformly, 1 logarithmically
+    static constexpr float SHADOW_SPLIT_LAMBDA = 0.75f;
 
 	// modelprojview matrix + camera position + viewport size
     UniformBufferObject m_UniformBufferObject{};
 	//Light pass buffer
     std::vector<GBuffer> m_GBuffers;
-	std::vector<Light> m_Lights;
-	std::vector<Buffer*> m_pLightBuffers;
-
-	// HDR and LDR images
-	std::vector<Image*> m_pHDRImage;
-	std::vector<VkImageView> m_HDRImageView;
-
-	std::vector<Image*> m_pLDRImage;
-	std::vector<VkImageView> m_LDRImageView;
+    LightManager* m_pLightManager;
+    // Light buffer generation each frame's descriptor sets were last written with
+    std::array<uint64_t, MAX_FRAMES_IN_FLIGHT> m_LightBufferGenerations{};
+    // Light animations are evaluated at the time since this point
+    std::chrono::high_resolution_clock::time_point m_LightAnimationStart;
+    // Per-cluster light lists, written by light_cull.comp and read by final.frag
+    std::vector<Buffer*> m_pLightClusterBuffers;
+
+    RenderGraph* m_pRenderGraph;
+    RenderGraphImage m_DepthImage;
+    RenderGraphImage m_DiffuseImage;
+    RenderGraphImage m_NormalImage;
+    RenderGraphImage m_MetallicRoughnessImage;
+    RenderGraphImage m_HDRImage;
+    RenderGraphImage m_LDRImage;
+    RenderGraphImage m_SwapchainImage;
 
 	//HDRI -> Cube map -> Irradiance map
     Image* m_pSkyboxCubeMapImage;
@@ -212,9 +351,8 @@ private:
 	std::array<VkImageView, 6> m_IrradianceMapImageViews;
 	VkImageView m_IrradianceMapImageView;
 
-    std::vector<Buffer*> m_pSunMatricesBuffers;
-
     DebugPushConstants m_DebugPushConstants;
+    bool m_PickPressedLast = false;
 
     // Paths
     const std::string MODEL_PATH_ = "models/glTF/Sponza.gltf";
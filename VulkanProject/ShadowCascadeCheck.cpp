@@ -0,0 +1,277 @@
+// Correctness check for the shadow cascade fitting in ShadowCascades. The split distances are compared with
+// hand-computed uniform, logarithmic and blended splits; cascades fitted to a camera that moves by fractions of a
+// shadow map texel must map the world to the same texel grid and depth; and each cascade's projection must keep
+// its slice and the scene within the shadow map, including light directions that are not normalized and scenes
+// that lie entirely beyond a slice.
+
+#include "ShadowCascades.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+    constexpr float NEAR_PLANE = 0.1f;
+    constexpr float FAR_PLANE = 100.0f;
+    constexpr float LAMBDA = 0.75f;
+    constexpr uint32_t SHADOW_MAP_SIZE = 2048;
+
+    int g_Failures = 0;
+
+    void check(bool condition, const char* description)
+    {
+        if (!condition)
+        {
+            spdlog::error("  failed: {}", description);
+            g_Failures++;
+        }
+    }
+
+    bool isNear(float a, float b, float tolerance)
+    {
+        return std::abs(a - b) <= tolerance;
+    }
+
+    // The renderer's camera projection: Vulkan depth range and a flipped Y
+    glm::mat4 makeProjection()
+    {
+        glm::mat4 projection = glm::perspectiveRH_ZO(glm::radians(60.0f), 16.0f / 9.0f, NEAR_PLANE, FAR_PLANE);
+        projection[1][1] *= -1.0f;
+        return projection;
+    }
+
+    void fitCascades(const glm::vec3& cameraPosition, const glm::vec3& cameraTarget, const glm::vec3& lightDirection,
+        const glm::vec3& sceneMin, const glm::vec3& sceneMax, ShadowCascade* pCascades)
+    {
+        const glm::mat4 view = glm::lookAt(cameraPosition, cameraTarget, glm::vec3(0.0f, 1.0f, 0.0f));
+        computeShadowCascades(view, makeProjection(), NEAR_PLANE, FAR_PLANE, LAMBDA, lightDirection, sceneMin, sceneMax,
+            SHADOW_MAP_SIZE, pCascades);
+    }
+
+    // Shadow map texel coordinates in x and y, depth in z
+    glm::vec3 toShadowMap(const ShadowCascade& cascade, const glm::mat4& projection, const glm::vec3& position)
+    {
+        const glm::vec4 clip = projection * cascade.view * glm::vec4(position, 1.0f);
+        return glm::vec3((clip.x * 0.5f + 0.5f) * float(SHADOW_MAP_SIZE), (clip.y * 0.5f + 0.5f) * float(SHADOW_MAP_SIZE), clip.z);
+    }
+
+    bool isFinite(const glm::mat4& matrix)
+    {
+        for (int column = 0; column < 4; ++column)
+        {
+            for (int row = 0; row < 4; ++row)
+            {
+                if (!std::isfinite(matrix[column][row]))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void checkSplits()
+    {
+        spdlog::info("Split distances");
+
+        // Uniform: near + (far - near) * i / 4; logarithmic: near * (far / near)^(i / 4), here 1, 10, 100 over 1 to 10000
+        float splits[4];
+        computeCascadeSplits(1.0f, 10000.0f, 0.0f, 4, splits);
+        check(isNear(splits[0], 2500.75f, 1e-2f) && isNear(splits[1], 5000.5f, 1e-2f) && isNear(splits[2], 7500.25f, 1e-2f),
+            "lambda 0: uniform splits");
+        check(splits[3] == 10000.0f, "lambda 0: last split is the far plane");
+
+        computeCascadeSplits(1.0f, 10000.0f, 1.0f, 4, splits);
+        check(isNear(splits[0], 10.0f, 1e-4f) && isNear(splits[1], 100.0f, 1e-3f) && isNear(splits[2], 1000.0f, 1e-2f),
+            "lambda 1: logarithmic splits");
+        check(splits[3] == 10000.0f, "lambda 1: last split is the far plane");
+
+        computeCascadeSplits(1.0f, 10000.0f, 0.5f, 4, splits);
+        check(isNear(splits[0], 1255.375f, 1e-2f) && isNear(splits[1], 2550.25f, 1e-2f) && isNear(splits[2], 4250.125f, 1e-2f),
+            "lambda 0.5: halfway between the two");
+
+        computeCascadeSplits(1.0f, 10000.0f, 0.5f, 1, splits);
+        check(splits[0] == 10000.0f, "one cascade: ends at the far plane");
+
+        float renderer[SHADOW_CASCADE_COUNT];
+        computeCascadeSplits(NEAR_PLANE, FAR_PLANE, LAMBDA, SHADOW_CASCADE_COUNT, renderer);
+        bool increasing = renderer[0] > NEAR_PLANE;
+        for (uint32_t i = 1; i < SHADOW_CASCADE_COUNT; ++i)
+        {
+            increasing = increasing && renderer[i] > renderer[i - 1];
+        }
+        check(increasing, "renderer settings: splits increase from the near plane");
+
+        ShadowCascade cascades[SHADOW_CASCADE_COUNT];
+        fitCascades(glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(0.0f, 2.0f, -1.0f), glm::vec3(-0.2f, -1.0f, -0.4f),
+            glm::vec3(-200.0f), glm::vec3(200.0f), cascades);
+        bool splitDistances = true;
+        for (uint32_t i = 0; i < SHADOW_CASCADE_COUNT; ++i)
+        {
+            splitDistances = splitDistances && cascades[i].splitDistance == renderer[i];
+        }
+        check(splitDistances, "cascades end at the split distances");
+    }
+
+    void checkSnapping()
+    {
+        spdlog::info("Texel snapping");
+
+        const glm::vec3 lightDirection = glm::normalize(glm::vec3(-0.2f, -1.0f, -0.4f));
+        const glm::vec3 sceneMin(-200.0f);
+        const glm::vec3 sceneMax(200.0f);
+        const glm::vec3 cameraPosition(3.0f, 2.0f, 5.0f);
+        const glm::vec3 viewDirection(0.3f, -0.1f, -1.0f);
+
+        ShadowCascade reference[SHADOW_CASCADE_COUNT];
+        fitCascades(cameraPosition, cameraPosition + viewDirection, lightDirection, sceneMin, sceneMax, reference);
+
+        // World positions spread over the first cascades
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> coordinate(-8.0f, 8.0f);
+        std::vector<glm::vec3> positions;
+        for (int i = 0; i < 64; ++i)
+        {
+            positions.push_back(cameraPosition + glm::vec3(coordinate(random), coordinate(random), coordinate(random) - 8.0f));
+        }
+
+        // Moves of a fraction of the smallest cascade's texel, accumulating along a random walk
+        const float texelSize = 2.0f / (reference[0].projection[0][0] * float(SHADOW_MAP_SIZE));
+        std::uniform_real_distribution<float> step(-0.9f * texelSize, 0.9f * texelSize);
+        glm::vec3 movedPosition = cameraPosition;
+        bool sameScale = true;
+        bool wholeTexels = true;
+        bool sameDepth = true;
+        for (int move = 0; move < 100; ++move)
+        {
+            movedPosition += glm::vec3(step(random), step(random), step(random));
+            ShadowCascade moved[SHADOW_CASCADE_COUNT];
+            fitCascades(movedPosition, movedPosition + viewDirection, lightDirection, sceneMin, sceneMax, moved);
+
+            for (uint32_t cascade = 0; cascade < SHADOW_CASCADE_COUNT; ++cascade)
+            {
+                sameScale = sameScale && moved[cascade].projection[0][0] == reference[cascade].projection[0][0];
+                for (const glm::vec3& position : positions)
+                {
+                    const glm::vec3 before = toShadowMap(reference[cascade], reference[cascade].projection, position);
+                    const glm::vec3 after = toShadowMap(moved[cascade], moved[cascade].projection, position);
+                    const glm::vec2 shift(after.x - before.x, after.y - before.y);
+                    wholeTexels = wholeTexels && isNear(shift.x, std::round(shift.x), 1e-2f) && isNear(shift.y, std::round(shift.y), 1e-2f);
+                    sameDepth = sameDepth && isNear(after.z, before.z, 1e-5f);
+                }
+            }
+        }
+        check(sameScale, "sub-texel moves keep each cascade's size");
+        check(wholeTexels, "sub-texel moves shift the world by whole texels");
+        check(sameDepth, "sub-texel moves keep every position's depth");
+
+        // Turning in place keeps the slices' bounding spheres, and so the texel size
+        ShadowCascade turned[SHADOW_CASCADE_COUNT];
+        fitCascades(cameraPosition, cameraPosition + glm::vec3(-1.0f, 0.2f, -0.4f), lightDirection, sceneMin, sceneMax, turned);
+        bool turnedScale = true;
+        for (uint32_t cascade = 0; cascade < SHADOW_CASCADE_COUNT; ++cascade)
+        {
+            turnedScale = turnedScale && turned[cascade].projection[0][0] == reference[cascade].projection[0][0];
+        }
+        check(turnedScale, "turning keeps each cascade's size");
+
+        // Returning to where it started gives back the same cascades, so their layers stay valid
+        ShadowCascade returned[SHADOW_CASCADE_COUNT];
+        fitCascades(cameraPosition, cameraPosition + viewDirection, lightDirection, sceneMin, sceneMax, returned);
+        bool sameMapping = true;
+        for (uint32_t cascade = 0; cascade < SHADOW_CASCADE_COUNT; ++cascade)
+        {
+            sameMapping = sameMapping && hasSameShadowMapping(returned[cascade], reference[cascade]);
+        }
+        check(sameMapping, "returning to the start gives the same mapping");
+    }
+
+    void checkProjectionRange()
+    {
+        spdlog::info("Projection range");
+
+        const glm::vec3 cameraPosition(3.0f, 2.0f, 5.0f);
+        const glm::vec3 cameraTarget = cameraPosition + glm::vec3(0.3f, -0.1f, -1.0f);
+        const glm::mat4 view = glm::lookAt(cameraPosition, cameraTarget, glm::vec3(0.0f, 1.0f, 0.0f));
+        const glm::mat4 inverseView = glm::inverse(view);
+        const glm::mat4 projection = makeProjection();
+        const glm::vec3 sceneMin(-200.0f);
+        const glm::vec3 sceneMax(200.0f);
+
+        // Scaling the light direction must not change the cascades
+        ShadowCascade cascades[SHADOW_CASCADE_COUNT];
+        ShadowCascade scaled[SHADOW_CASCADE_COUNT];
+        fitCascades(cameraPosition, cameraTarget, glm::normalize(glm::vec3(-0.2f, -1.0f, -0.4f)), sceneMin, sceneMax, cascades);
+        fitCascades(cameraPosition, cameraTarget, glm::vec3(-2.0f, -10.0f, -4.0f), sceneMin, sceneMax, scaled);
+        bool sameCascades = true;
+        for (uint32_t cascade = 0; cascade < SHADOW_CASCADE_COUNT; ++cascade)
+        {
+            sameCascades = sameCascades && hasSameShadowMapping(cascades[cascade], scaled[cascade]);
+        }
+        check(sameCascades, "a scaled light direction gives the same cascades");
+
+        // Every corner of a slice lands in the shadow map, between both depth ranges' ends
+        bool slicesInside = true;
+        bool sceneInside = true;
+        float sliceNear = NEAR_PLANE;
+        const float tanHalfWidth = 1.0f / projection[0][0];
+        const float tanHalfHeight = 1.0f / std::abs(projection[1][1]);
+        for (uint32_t cascade = 0; cascade < SHADOW_CASCADE_COUNT; ++cascade)
+        {
+            for (uint32_t corner = 0; corner < 8; ++corner)
+            {
+                const float depth = (corner & 4) ? cascades[cascade].splitDistance : sliceNear;
+                const glm::vec3 position(inverseView * glm::vec4(
+                    (corner & 1 ? depth : -depth) * tanHalfWidth, (corner & 2 ? depth : -depth) * tanHalfHeight, -depth, 1.0f));
+                for (const glm::mat4* pProjection : { &cascades[cascade].projection, &cascades[cascade].casterProjection })
+                {
+                    const glm::vec4 clip = *pProjection * cascades[cascade].view * glm::vec4(position, 1.0f);
+                    slicesInside = slicesInside && std::abs(clip.x) <= 1.0f && std::abs(clip.y) <= 1.0f
+                        && clip.z >= -1e-5f && clip.z <= 1.0f + 1e-5f;
+                }
+
+                // The depth range of projection spans the scene bounds exactly
+                const glm::vec3 sceneCorner(corner & 1 ? sceneMax.x : sceneMin.x, corner & 2 ? sceneMax.y : sceneMin.y,
+                    corner & 4 ? sceneMax.z : sceneMin.z);
+                const float sceneDepth = (cascades[cascade].projection * cascades[cascade].view * glm::vec4(sceneCorner, 1.0f)).z;
+                sceneInside = sceneInside && sceneDepth >= -1e-5f && sceneDepth <= 1.0f + 1e-5f;
+            }
+            sliceNear = cascades[cascade].splitDistance;
+        }
+        check(slicesInside, "slices lie within both projections");
+        check(sceneInside, "scene bounds lie within the depth range");
+
+        // A floor far below a camera looking up: it lies entirely beyond the near slices as seen from the light,
+        // which used to give casterProjection a near plane past its far plane
+        ShadowCascade beyond[SHADOW_CASCADE_COUNT];
+        fitCascades(glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+            glm::vec3(-50.0f, -1001.0f, -50.0f), glm::vec3(50.0f, -1000.0f, 50.0f), beyond);
+        bool finite = true;
+        bool ordered = true;
+        for (const ShadowCascade& cascade : beyond)
+        {
+            finite = finite && isFinite(cascade.projection) && isFinite(cascade.casterProjection);
+            // orthoRH_ZO's depth scale is -1 / (far - near)
+            ordered = ordered && cascade.projection[2][2] < 0.0f && cascade.casterProjection[2][2] < 0.0f;
+        }
+        check(finite, "scene beyond the slice: finite projections");
+        check(ordered, "scene beyond the slice: near plane before the far plane");
+    }
+}
+
+int main()
+{
+    checkSplits();
+    checkSnapping();
+    checkProjectionRange();
+
+    if (g_Failures > 0)
+    {
+        spdlog::error("{} checks failed", g_Failures);
+        return 1;
+    }
+    spdlog::info("All checks passed");
+    return 0;
+}
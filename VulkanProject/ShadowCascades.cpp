@@ -0,0 +1,135 @@
+// ShadowCascades.cpp
+#include "ShadowCascades.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+    // Orthographic light projection, Y-flipped like the camera's, over the light-space depth range nearZ to farZ.
+    // A range that is empty or inverted, as for a flat scene or a slice entirely in front of the scene, is
+    // widened to a sliver beyond nearZ so the projection stays finite and keeps depth increasing away from the light.
+    glm::mat4 makeLightProjection(float radius, float nearZ, float farZ)
+    {
+        constexpr float MIN_DEPTH_RANGE = 1e-3f;
+        glm::mat4 lightProjection = glm::orthoRH_ZO(-radius, radius, -radius, radius, nearZ, std::max(farZ, nearZ + MIN_DEPTH_RANGE));
+        lightProjection[1][1] *= -1.0f;
+        return lightProjection;
+    }
+}
+
+void computeCascadeSplits(float nearPlane, float farPlane, float lambda, uint32_t cascadeCount, float* pSplits)
+{
+    for (uint32_t i = 0; i < cascadeCount; ++i)
+    {
+        const float fraction = float(i + 1) / float(cascadeCount);
+        const float logarithmic = nearPlane * std::pow(farPlane / nearPlane, fraction);
+        const float uniform = nearPlane + (farPlane - nearPlane) * fraction;
+        pSplits[i] = lambda * logarithmic + (1.0f - lambda) * uniform;
+    }
+    pSplits[cascadeCount - 1] = farPlane;
+}
+
+void computeShadowCascades(const glm::mat4& view, const glm::mat4& projection, float nearPlane, float farPlane,
+    float lambda, const glm::vec3& lightDirection, const glm::vec3& sceneMin, const glm::vec3& sceneMax,
+    uint32_t shadowMapSize, ShadowCascade* pCascades)
+{
+    float splits[SHADOW_CASCADE_COUNT];
+    computeCascadeSplits(nearPlane, farPlane, lambda, SHADOW_CASCADE_COUNT, splits);
+
+    // Half extents of the view frustum at unit distance
+    const glm::mat4 inverseView = glm::inverse(view);
+    const float tanHalfWidth = 1.0f / projection[0][0];
+    const float tanHalfHeight = 1.0f / std::abs(projection[1][1]);
+
+    // The light's eye is placed at unit distance from each slice's center
+    const glm::vec3 direction = glm::normalize(lightDirection);
+    const glm::vec3 up = std::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+
+    float sliceNear = nearPlane;
+    for (uint32_t cascade = 0; cascade < SHADOW_CASCADE_COUNT; ++cascade)
+    {
+        const float sliceFar = splits[cascade];
+
+        glm::vec3 corners[8];
+        glm::vec3 center(0.0f);
+        for (uint32_t corner = 0; corner < 8; ++corner)
+        {
+            const float depth = (corner & 4) ? sliceFar : sliceNear;
+            const glm::vec4 viewCorner(
+                (corner & 1 ? depth : -depth) * tanHalfWidth,
+                (corner & 2 ? depth : -depth) * tanHalfHeight,
+                -depth, 1.0f);
+            corners[corner] = glm::vec3(inverseView * viewCorner);
+            center += corners[corner];
+        }
+        center /= 8.0f;
+
+        // The corners keep their distances to the center under rotation; rounding the radius up keeps
+        // float noise from changing the cascade's size, and with it the texel size, from frame to frame
+        float radius = 0.0f;
+        for (const glm::vec3& corner : corners)
+        {
+            radius = std::max(radius, glm::length(corner - center));
+        }
+        radius = std::ceil(radius * 16.0f) / 16.0f;
+
+        const glm::mat4 lightView = glm::lookAt(center - direction, center, up);
+
+        // The light looks down -z in its view space
+        float minZ = FLT_MAX;
+        float maxZ = -FLT_MAX;
+        for (uint32_t corner = 0; corner < 8; ++corner)
+        {
+            const glm::vec3 sceneCorner(
+                corner & 1 ? sceneMax.x : sceneMin.x,
+                corner & 2 ? sceneMax.y : sceneMin.y,
+                corner & 4 ? sceneMax.z : sceneMin.z);
+            const float z = (lightView * glm::vec4(sceneCorner, 1.0f)).z;
+            minZ = std::min(minZ, z);
+            maxZ = std::max(maxZ, z);
+        }
+
+        // The slice's center lies at unit distance from the light's eye, so nothing in the slice is farther than 1 + radius
+        glm::mat4 lightProjection = makeLightProjection(radius, -maxZ, -minZ);
+        glm::mat4 casterProjection = makeLightProjection(radius, -maxZ, std::min(-minZ, 1.0f + radius));
+
+        // Move the projection so the world origin lands on a texel corner. The light's orientation and the
+        // cascade's size are fixed, so every world position then maps to the same texel in every frame.
+        const glm::vec4 origin = lightProjection * lightView * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        const float texelsPerUnit = float(shadowMapSize) * 0.5f;
+        const glm::vec2 originTexels = glm::vec2(origin.x, origin.y) * texelsPerUnit;
+        const glm::vec2 offset = (glm::round(originTexels) - originTexels) / texelsPerUnit;
+        lightProjection[3][0] += offset.x;
+        lightProjection[3][1] += offset.y;
+        casterProjection[3][0] += offset.x;
+        casterProjection[3][1] += offset.y;
+
+        pCascades[cascade].view = lightView;
+        pCascades[cascade].projection = lightProjection;
+        pCascades[cascade].casterProjection = casterProjection;
+        pCascades[cascade].splitDistance = sliceFar;
+        sliceNear = sliceFar;
+    }
+}
+
+bool hasSameShadowMapping(const ShadowCascade& a, const ShadowCascade& b)
+{
+    // A texel spans 2 / shadowMapSize in clip space; this is far below that for any practical size
+    constexpr float TOLERANCE = 1e-5f;
+
+    const glm::mat4 mappingA = a.projection * a.view;
+    const glm::mat4 mappingB = b.projection * b.view;
+    for (int column = 0; column < 4; ++column)
+    {
+        for (int row = 0; row < 4; ++row)
+        {
+            if (std::abs(mappingA[column][row] - mappingB[column][row]) > TOLERANCE)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,37 @@
+// ShadowCascades.h
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+
+// Cascades of the sun's shadow map, one layer of the shadow map image each
+constexpr uint32_t SHADOW_CASCADE_COUNT = 4;
+
+// Orthographic light camera of one cascade. The projection flips Y like the camera's and maps depth to [0, 1].
+struct ShadowCascade
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+    // projection with the far plane pulled in to the far side of the slice. Casters beyond it cannot
+    // shade anything this cascade is sampled for, so casters are culled against this and view.
+    glm::mat4 casterProjection;
+    // View-space distance from the camera at which this cascade ends
+    float splitDistance;
+};
+
+// Far distances of cascadeCount slices between nearPlane and farPlane, after the practical split scheme of
+// Zhang et al.: lambda blends uniform (0) and logarithmic (1) splits. The last split is farPlane.
+void computeCascadeSplits(float nearPlane, float farPlane, float lambda, uint32_t cascadeCount, float* pSplits);
+
+// Fits one light camera to each slice of the camera frustum between nearPlane and farPlane. Each cascade
+// covers the bounding sphere of its slice, so its size does not change as the camera turns, and its origin
+// is snapped to whole shadow map texels, so shadow edges do not shimmer as the camera moves. Depth spans
+// the scene bounds along the light direction, keeping casters outside the slice in the map.
+// projection supplies the field of view and may be Y-flipped. lightDirection need not be normalized.
+void computeShadowCascades(const glm::mat4& view, const glm::mat4& projection, float nearPlane, float farPlane,
+    float lambda, const glm::vec3& lightDirection, const glm::vec3& sceneMin, const glm::vec3& sceneMax,
+    uint32_t shadowMapSize, ShadowCascade* pCascades);
+
+// True when both cascades map every world position to the same shadow map texel and depth, up to float
+// noise. A cascade fitted to a moving camera keeps its mapping until its snapped origin crosses a texel,
+// so a layer rendered with one stays valid for the other as long as its casters are the same.
+bool hasSameShadowMapping(const ShadowCascade& a, const ShadowCascade& b);
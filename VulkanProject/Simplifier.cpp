@@ -0,0 +1,306 @@
+// Simplifier.cpp
+#include "Simplifier.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    const glm::vec3& getPosition(const glm::vec3* pPositions, size_t positionStride, uint32_t index)
+    {
+        return *reinterpret_cast<const glm::vec3*>(reinterpret_cast<const uint8_t*>(pPositions) + size_t(index) * positionStride);
+    }
+
+    // Sum of area-weighted squared distances to planes, as the symmetric 4x4 matrix's upper triangle
+    struct Quadric
+    {
+        double xx = 0, xy = 0, xz = 0, xw = 0;
+        double yy = 0, yz = 0, yw = 0;
+        double zz = 0, zw = 0;
+        double ww = 0;
+        double weight = 0;
+
+        void addPlane(const glm::dvec3& normal, double distance, double planeWeight)
+        {
+            xx += planeWeight * normal.x * normal.x;
+            xy += planeWeight * normal.x * normal.y;
+            xz += planeWeight * normal.x * normal.z;
+            xw += planeWeight * normal.x * distance;
+            yy += planeWeight * normal.y * normal.y;
+            yz += planeWeight * normal.y * normal.z;
+            yw += planeWeight * normal.y * distance;
+            zz += planeWeight * normal.z * normal.z;
+            zw += planeWeight * normal.z * distance;
+            ww += planeWeight * distance * distance;
+            weight += planeWeight;
+        }
+
+        Quadric& operator+=(const Quadric& other)
+        {
+            xx += other.xx; xy += other.xy; xz += other.xz; xw += other.xw;
+            yy += other.yy; yz += other.yz; yw += other.yw;
+            zz += other.zz; zw += other.zw;
+            ww += other.ww;
+            weight += other.weight;
+            return *this;
+        }
+
+        // RMS distance of p to the accumulated planes
+        float getError(const glm::vec3& p) const
+        {
+            const double x = p.x, y = p.y, z = p.z;
+            const double squared =
+                xx * x * x + 2.0 * xy * x * y + 2.0 * xz * x * z + 2.0 * xw * x +
+                yy * y * y + 2.0 * yz * y * z + 2.0 * yw * y +
+                zz * z * z + 2.0 * zw * z +
+                ww;
+            return weight > 0.0 ? static_cast<float>(std::sqrt(std::max(squared, 0.0) / weight)) : 0.0f;
+        }
+    };
+
+    struct Collapse
+    {
+        uint32_t from;
+        uint32_t to;
+        float error;
+    };
+
+    struct PositionHash
+    {
+        size_t operator()(const std::array<uint32_t, 3>& key) const
+        {
+            return (size_t(key[0]) * 73856093u) ^ (size_t(key[1]) * 19349663u) ^ (size_t(key[2]) * 83492791u);
+        }
+    };
+
+    uint64_t makeEdgeKey(uint32_t a, uint32_t b)
+    {
+        return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+    }
+}
+
+size_t simplifyMesh(uint32_t* pDestination, const uint32_t* pIndices, size_t indexCount,
+    const glm::vec3* pPositions, size_t positionStride, size_t vertexCount,
+    size_t targetIndexCount, float maxError, float* pResultError)
+{
+    std::vector<uint32_t> indices(pIndices, pIndices + indexCount - indexCount % 3);
+    float resultError = 0.0f;
+
+    auto position = [&](uint32_t vertex) -> const glm::vec3& { return getPosition(pPositions, positionStride, vertex); };
+
+    // Vertices that share a position are one point of the surface split along an attribute seam
+    std::vector<uint32_t> positionIds(vertexCount);
+    std::vector<uint32_t> wedgeCounts(vertexCount, 0);
+    {
+        std::vector<uint8_t> referenced(vertexCount, 0);
+        for (uint32_t index : indices)
+        {
+            referenced[index] = 1;
+        }
+
+        std::unordered_map<std::array<uint32_t, 3>, uint32_t, PositionHash> firstAtPosition;
+        firstAtPosition.reserve(vertexCount);
+        for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+        {
+            std::array<uint32_t, 3> key;
+            memcpy(key.data(), &position(vertex), sizeof(key));
+            positionIds[vertex] = firstAtPosition.try_emplace(key, vertex).first->second;
+            wedgeCounts[positionIds[vertex]] += referenced[vertex];
+        }
+    }
+
+    // Seams, borders and non-manifold edges stay where they are
+    std::vector<uint8_t> locked(vertexCount, 0);
+    {
+        std::unordered_map<uint64_t, uint32_t> edgeTriangleCounts;
+        edgeTriangleCounts.reserve(indices.size());
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            for (size_t corner = 0; corner < 3; ++corner)
+            {
+                const uint32_t a = positionIds[indices[i + corner]];
+                const uint32_t b = positionIds[indices[i + (corner + 1) % 3]];
+                edgeTriangleCounts[makeEdgeKey(a, b)]++;
+            }
+        }
+
+        std::vector<uint8_t> lockedPositions(vertexCount, 0);
+        for (const auto& [edge, count] : edgeTriangleCounts)
+        {
+            if (count != 2)
+            {
+                lockedPositions[uint32_t(edge >> 32)] = 1;
+                lockedPositions[uint32_t(edge)] = 1;
+            }
+        }
+        for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+        {
+            locked[vertex] = lockedPositions[positionIds[vertex]] || wedgeCounts[positionIds[vertex]] > 1;
+        }
+    }
+
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        const glm::dvec3 p0 = position(indices[i]);
+        const glm::dvec3 p1 = position(indices[i + 1]);
+        const glm::dvec3 p2 = position(indices[i + 2]);
+        glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+        const double doubleArea = glm::length(normal);
+        if (doubleArea == 0.0)
+        {
+            continue;
+        }
+        normal /= doubleArea;
+
+        Quadric quadric;
+        quadric.addPlane(normal, -glm::dot(normal, p0), doubleArea * 0.5);
+        quadrics[indices[i]] += quadric;
+        quadrics[indices[i + 1]] += quadric;
+        quadrics[indices[i + 2]] += quadric;
+    }
+
+    // Collapses run in passes. Each pass takes the cheapest collapses whose neighbourhoods do not overlap,
+    // so the flip test of one is never invalidated by another in the same pass.
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> collapseTargets(vertexCount);
+    std::vector<uint8_t> touched(vertexCount);
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+    std::vector<uint32_t> adjacency;
+    while (indices.size() > targetIndexCount)
+    {
+        const size_t triangleCount = indices.size() / 3;
+
+        collapses.clear();
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            for (size_t corner = 0; corner < 3; ++corner)
+            {
+                const uint32_t a = indices[i + corner];
+                const uint32_t b = indices[i + (corner + 1) % 3];
+                if (!locked[a])
+                {
+                    collapses.push_back({ a, b, quadrics[a].getError(position(b)) });
+                }
+                if (!locked[b])
+                {
+                    collapses.push_back({ b, a, quadrics[b].getError(position(a)) });
+                }
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+        // Triangles around each vertex
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+        for (uint32_t index : indices)
+        {
+            adjacencyOffsets[index + 1]++;
+        }
+        for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+        {
+            adjacencyOffsets[vertex + 1] += adjacencyOffsets[vertex];
+        }
+        adjacency.resize(indices.size());
+        {
+            std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); ++i)
+            {
+                adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+        {
+            collapseTargets[vertex] = vertex;
+        }
+        std::fill(touched.begin(), touched.end(), 0);
+
+        const size_t trianglesToRemove = triangleCount - targetIndexCount / 3;
+        size_t removedTriangles = 0;
+        size_t collapseCount = 0;
+        for (const Collapse& collapse : collapses)
+        {
+            if (collapse.error > maxError || removedTriangles >= trianglesToRemove)
+            {
+                break;
+            }
+            if (touched[collapse.from] || touched[collapse.to])
+            {
+                continue;
+            }
+
+            // Reject collapses that flip a remaining triangle around the moved vertex
+            const glm::vec3& target = position(collapse.to);
+            bool flips = false;
+            size_t collapsedTriangles = 0;
+            for (uint32_t i = adjacencyOffsets[collapse.from]; i < adjacencyOffsets[collapse.from + 1] && !flips; ++i)
+            {
+                const uint32_t* pTriangle = &indices[size_t(adjacency[i]) * 3];
+                if (pTriangle[0] == collapse.to || pTriangle[1] == collapse.to || pTriangle[2] == collapse.to)
+                {
+                    collapsedTriangles++;
+                    continue;
+                }
+
+                glm::vec3 corners[3] = { position(pTriangle[0]), position(pTriangle[1]), position(pTriangle[2]) };
+                const glm::vec3 before = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+                for (int corner = 0; corner < 3; ++corner)
+                {
+                    if (pTriangle[corner] == collapse.from)
+                    {
+                        corners[corner] = target;
+                    }
+                }
+                const glm::vec3 after = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+                flips = glm::dot(before, after) <= 0.0f;
+            }
+            if (flips)
+            {
+                continue;
+            }
+
+            collapseTargets[collapse.from] = collapse.to;
+            quadrics[collapse.to] += quadrics[collapse.from];
+            resultError = std::max(resultError, collapse.error);
+            removedTriangles += collapsedTriangles;
+            collapseCount++;
+
+            for (uint32_t i = adjacencyOffsets[collapse.from]; i < adjacencyOffsets[collapse.from + 1]; ++i)
+            {
+                const uint32_t* pTriangle = &indices[size_t(adjacency[i]) * 3];
+                touched[pTriangle[0]] = touched[pTriangle[1]] = touched[pTriangle[2]] = 1;
+            }
+        }
+
+        if (collapseCount == 0)
+        {
+            break;
+        }
+
+        // Apply the pass and drop the triangles that collapsed to an edge
+        size_t writeIndex = 0;
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            const uint32_t a = collapseTargets[indices[i]];
+            const uint32_t b = collapseTargets[indices[i + 1]];
+            const uint32_t c = collapseTargets[indices[i + 2]];
+            if (a != b && b != c && c != a)
+            {
+                indices[writeIndex++] = a;
+                indices[writeIndex++] = b;
+                indices[writeIndex++] = c;
+            }
+        }
+        indices.resize(writeIndex);
+    }
+
+    std::copy(indices.begin(), indices.end(), pDestination);
+    if (pResultError)
+    {
+        *pResultError = resultError;
+    }
+    return indices.size();
+}
@@ -0,0 +1,17 @@
+// Simplifier.h
+#pragma once
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+
+// Simplifies an indexed triangle list with quadric error metric edge collapses (Garland and Heckbert).
+// Collapses move a vertex onto a neighbour, so the result indexes a subset of the original vertices and
+// shares their vertex buffer. Vertices on borders and attribute seams (several vertices at one position)
+// never move, which keeps the result free of cracks.
+//
+// Stops once the result has at most targetIndexCount indices or the next collapse would exceed maxError,
+// an RMS distance in model units. pDestination needs room for indexCount indices; the return value is the
+// number written. pResultError receives the largest error of the collapses made.
+size_t simplifyMesh(uint32_t* pDestination, const uint32_t* pIndices, size_t indexCount,
+    const glm::vec3* pPositions, size_t positionStride, size_t vertexCount,
+    size_t targetIndexCount, float maxError, float* pResultError = nullptr);
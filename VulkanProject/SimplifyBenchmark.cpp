@@ -0,0 +1,182 @@
+// Benchmark and error report for simplifyMesh, the simplifier behind the mesh LOD chain.
+// Every result is also measured: the distance from the original vertices to the simplified surface shows
+// how well the simplifier's own error estimate tracks the geometry it removed.
+
+#include "Simplifier.h"
+#include "Benchmark.h"
+#include <glm/gtc/constants.hpp>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+    struct TestMesh
+    {
+        std::string name;
+        std::vector<glm::vec3> positions;
+        std::vector<uint32_t> indices;
+    };
+
+    // UV sphere; the first and last column share positions the way a texture seam splits vertices
+    TestMesh makeSphere(uint32_t rings, uint32_t segments)
+    {
+        TestMesh mesh{ "Sphere" };
+        for (uint32_t ring = 0; ring <= rings; ++ring)
+        {
+            const float theta = glm::pi<float>() * float(ring) / float(rings);
+            for (uint32_t segment = 0; segment <= segments; ++segment)
+            {
+                const float phi = glm::two_pi<float>() * float(segment % segments) / float(segments);
+                mesh.positions.push_back({ std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) });
+            }
+        }
+        for (uint32_t ring = 0; ring < rings; ++ring)
+        {
+            for (uint32_t segment = 0; segment < segments; ++segment)
+            {
+                const uint32_t a = ring * (segments + 1) + segment;
+                const uint32_t b = a + segments + 1;
+                if (ring != 0)
+                {
+                    mesh.indices.insert(mesh.indices.end(), { a, a + 1, b });
+                }
+                if (ring != rings - 1)
+                {
+                    mesh.indices.insert(mesh.indices.end(), { a + 1, b + 1, b });
+                }
+            }
+        }
+        return mesh;
+    }
+
+    // Height field with detail at several scales and an open border
+    TestMesh makeTerrain(uint32_t size)
+    {
+        TestMesh mesh{ "Terrain" };
+        for (uint32_t y = 0; y <= size; ++y)
+        {
+            for (uint32_t x = 0; x <= size; ++x)
+            {
+                const float u = float(x) / float(size);
+                const float v = float(y) / float(size);
+                const float height = 0.1f * std::sin(u * 6.0f) * std::cos(v * 5.0f) +
+                    0.02f * std::sin(u * 40.0f + v * 13.0f) + 0.005f * std::cos(u * 97.0f - v * 151.0f);
+                mesh.positions.push_back({ u, height, v });
+            }
+        }
+        for (uint32_t y = 0; y < size; ++y)
+        {
+            for (uint32_t x = 0; x < size; ++x)
+            {
+                const uint32_t a = y * (size + 1) + x;
+                const uint32_t b = a + size + 1;
+                mesh.indices.insert(mesh.indices.end(), { a, b, a + 1, a + 1, b, b + 1 });
+            }
+        }
+        return mesh;
+    }
+
+    float distanceToTriangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+    {
+        // Closest point by Voronoi region, after Ericson's "Real-Time Collision Detection"
+        const glm::vec3 ab = b - a, ac = c - a, ap = p - a;
+        const float d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+        if (d1 <= 0.0f && d2 <= 0.0f) return glm::length(p - a);
+
+        const glm::vec3 bp = p - b;
+        const float d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+        if (d3 >= 0.0f && d4 <= d3) return glm::length(p - b);
+
+        const float vc = d1 * d4 - d3 * d2;
+        if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) return glm::length(p - (a + ab * (d1 / (d1 - d3))));
+
+        const glm::vec3 cp = p - c;
+        const float d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+        if (d6 >= 0.0f && d5 <= d6) return glm::length(p - c);
+
+        const float vb = d5 * d2 - d1 * d6;
+        if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) return glm::length(p - (a + ac * (d2 / (d2 - d6))));
+
+        const float va = d3 * d6 - d5 * d4;
+        if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+        {
+            return glm::length(p - (b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)))));
+        }
+
+        const float denominator = 1.0f / (va + vb + vc);
+        return glm::length(p - (a + ab * (vb * denominator) + ac * (vc * denominator)));
+    }
+
+    // Distance from a sample of the original vertices to the simplified surface
+    void measureError(const TestMesh& mesh, const std::vector<uint32_t>& simplified, float& maxDistance, float& meanDistance)
+    {
+        constexpr size_t SAMPLE_COUNT = 1000;
+        const size_t step = std::max<size_t>(1, mesh.positions.size() / SAMPLE_COUNT);
+
+        maxDistance = 0.0f;
+        double sum = 0.0;
+        size_t samples = 0;
+        for (size_t vertex = 0; vertex < mesh.positions.size(); vertex += step)
+        {
+            const glm::vec3& p = mesh.positions[vertex];
+            float distance = FLT_MAX;
+            for (size_t i = 0; i < simplified.size(); i += 3)
+            {
+                distance = std::min(distance, distanceToTriangle(p, mesh.positions[simplified[i]],
+                    mesh.positions[simplified[i + 1]], mesh.positions[simplified[i + 2]]));
+            }
+            maxDistance = std::max(maxDistance, distance);
+            sum += distance;
+            samples++;
+        }
+        meanDistance = static_cast<float>(sum / double(samples));
+    }
+}
+
+int main()
+{
+    spdlog::info("{:<28} {:>15} {:>10} {:>21}", "Benchmark", "Time", "Iterations", "Throughput");
+
+    int failures = 0;
+    for (const TestMesh& mesh : { makeSphere(128, 256), makeTerrain(256) })
+    {
+        const size_t triangleCount = mesh.indices.size() / 3;
+        std::vector<uint32_t> simplified(mesh.indices.size());
+
+        for (float ratio : { 0.5f, 0.25f, 0.1f })
+        {
+            const size_t targetIndexCount = size_t(float(triangleCount) * ratio) * 3;
+            size_t indexCount = 0;
+            float estimatedError = 0.0f;
+            BenchmarkResult result = runBenchmark([&]()
+            {
+                indexCount = simplifyMesh(simplified.data(), mesh.indices.data(), mesh.indices.size(),
+                    mesh.positions.data(), sizeof(glm::vec3), mesh.positions.size(), targetIndexCount, FLT_MAX, &estimatedError);
+            });
+            simplified.resize(indexCount);
+
+            float maxDistance = 0.0f;
+            float meanDistance = 0.0f;
+            measureError(mesh, simplified, maxDistance, meanDistance);
+
+            spdlog::info("{:<28} {:>12.1f} ms {:>10} {:>10.2f} M tris/s", "BM_Simplify/" + mesh.name + "/" + std::to_string(int(ratio * 100)),
+                result.secondsPerIteration * 1e3, result.iterations, double(triangleCount) / result.secondsPerIteration / 1e6);
+            spdlog::info("  {} -> {} triangles, estimated error {:.5f}, measured distance max {:.5f} mean {:.6f}",
+                triangleCount, indexCount / 3, estimatedError, maxDistance, meanDistance);
+
+            // Without an error limit only locked borders and seams can stop the simplifier short of its target
+            if (indexCount > targetIndexCount * 2)
+            {
+                spdlog::error("  simplifyMesh stopped at {} of the {} target indices", indexCount, targetIndexCount);
+                failures++;
+            }
+            simplified.resize(mesh.indices.size());
+        }
+    }
+
+    return failures == 0 ? 0 : 1;
+}
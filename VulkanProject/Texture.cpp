@@ -1,22 +1,76 @@
 #include "Texture.h"
-#include "Buffer.h"
 #include "Device.h"
+#include "DdsFile.h"
+#include "MappedFile.h"
+#include "MipChain.h"
 #include <stb_image.h>
+#include <filesystem>
 #include <stdexcept>
 #include <spdlog/spdlog.h>
 
+namespace
+{
+    // Block formats the cooker writes; anything else in a .dds falls back to the source image
+    VkFormat toVkFormat(uint32_t dxgiFormat)
+    {
+        switch (dxgiFormat)
+        {
+        case DdsFile::DXGI_FORMAT_R8G8B8A8_UNORM: return VK_FORMAT_R8G8B8A8_UNORM;
+        case DdsFile::DXGI_FORMAT_R8G8B8A8_UNORM_SRGB: return VK_FORMAT_R8G8B8A8_SRGB;
+        case DdsFile::DXGI_FORMAT_BC1_UNORM: return VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+        case DdsFile::DXGI_FORMAT_BC1_UNORM_SRGB: return VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+        case DdsFile::DXGI_FORMAT_BC3_UNORM: return VK_FORMAT_BC3_UNORM_BLOCK;
+        case DdsFile::DXGI_FORMAT_BC3_UNORM_SRGB: return VK_FORMAT_BC3_SRGB_BLOCK;
+        case DdsFile::DXGI_FORMAT_BC5_UNORM: return VK_FORMAT_BC5_UNORM_BLOCK;
+        case DdsFile::DXGI_FORMAT_BC7_UNORM: return VK_FORMAT_BC7_UNORM_BLOCK;
+        case DdsFile::DXGI_FORMAT_BC7_UNORM_SRGB: return VK_FORMAT_BC7_SRGB_BLOCK;
+        default: return VK_FORMAT_UNDEFINED;
+        }
+    }
+
+    bool loadCooked(const std::string& cookedPath, Texture::TextureData& outData)
+    {
+        MappedFile file(cookedPath);
+        if (!file.isValid())
+        {
+            return false;
+        }
+
+        DdsFile::Description description;
+        if (!DdsFile::read(file.getData(), file.getSize(), description))
+        {
+            spdlog::warn("Ignoring unreadable cooked texture {}", cookedPath);
+            return false;
+        }
+
+        const VkFormat format = toVkFormat(description.dxgiFormat);
+        if (format == VK_FORMAT_UNDEFINED)
+        {
+            spdlog::warn("Ignoring cooked texture {} with unsupported DXGI format {}", cookedPath, description.dxgiFormat);
+            return false;
+        }
+
+        outData.format = format;
+        outData.width = description.width;
+        outData.height = description.height;
+        outData.channels = 4;
+        outData.mipOffsets.assign(description.mipOffsets.begin(), description.mipOffsets.end());
+        outData.pixels.assign(description.pPayload, description.pPayload + description.payloadSize);
+        return true;
+    }
+}
+
 VkSampler Texture::s_textureSampler = VK_NULL_HANDLE;
 size_t Texture::s_samplerUsers = 0;
 
-Texture::Texture(Device* pDevice, VmaAllocator allocator, CommandPool* pCommandPool,
+Texture::Texture(Device* pDevice, VmaAllocator allocator, UploadBatch* pUploadBatch,
     const std::string& texturePath, VkPhysicalDevice physicalDevice, Format format)
-    : m_pDevice(pDevice), m_Allocator(allocator), m_pCommandPool(pCommandPool),
+    : m_pDevice(pDevice), m_Allocator(allocator), m_pUploadBatch(pUploadBatch),
     m_TexturePath(texturePath), m_PhysicalDevice(physicalDevice),
-    m_pTextureImage(nullptr), m_TextureImageView(VK_NULL_HANDLE), m_Format(format)
+    m_pTextureImage(nullptr), m_TextureImageView(VK_NULL_HANDLE), m_Format(format), m_pPlaceholder(nullptr)
 {
     spdlog::info("Creating Texture: {} with format {}", m_TexturePath, (m_Format == Format::SRGB ? "SRGB" : "UNORM"));
     createTextureImage();
-    createTextureImageView();
 
     // Increase sampler user count
     if (s_textureSampler == VK_NULL_HANDLE) {
@@ -27,10 +81,27 @@ Texture::Texture(Device* pDevice, VmaAllocator allocator, CommandPool* pCommandP
     spdlog::debug("Texture created: {}", m_TexturePath);
 }
 
+Texture::Texture(Device* pDevice, VmaAllocator allocator, UploadBatch* pUploadBatch,
+    const std::string& texturePath, VkPhysicalDevice physicalDevice, Format format, const Texture* pPlaceholder)
+    : m_pDevice(pDevice), m_Allocator(allocator), m_pUploadBatch(pUploadBatch),
+    m_TexturePath(texturePath), m_PhysicalDevice(physicalDevice),
+    m_pTextureImage(nullptr), m_TextureImageView(VK_NULL_HANDLE), m_Format(format), m_pPlaceholder(pPlaceholder)
+{
+    if (s_textureSampler == VK_NULL_HANDLE) {
+        createTextureSampler(m_pDevice->get(), m_PhysicalDevice);
+    }
+    s_samplerUsers++;
+
+    spdlog::debug("Texture created without image: {}", m_TexturePath);
+}
+
 
 Texture::~Texture() 
 {
-    vkDestroyImageView(m_pDevice->get(), m_TextureImageView, nullptr);
+    if (m_TextureImageView != VK_NULL_HANDLE)
+    {
+        vkDestroyImageView(m_pDevice->get(), m_TextureImageView, nullptr);
+    }
     delete m_pTextureImage;
     s_samplerUsers--;
 
@@ -43,83 +114,92 @@ Texture::~Texture()
 	spdlog::debug("Texture destroyed: {}", m_TexturePath);
 }
 
-void Texture::createTextureImage()
+Texture::TextureData Texture::decode(const std::string& texturePath, Format format)
 {
+    TextureData data{};
+
+    // Cooked block-compressed data already carries its mips. An edited source image is decoded
+    // instead until it is cooked again.
+    const std::string cookedPath = DdsFile::getCookedPath(texturePath);
+    if (format != Format::HDR)
+    {
+        if (DdsFile::isCookedUpToDate(cookedPath, texturePath))
+        {
+            if (loadCooked(cookedPath, data))
+            {
+                return data;
+            }
+        }
+        else if (std::error_code error; std::filesystem::exists(cookedPath, error))
+        {
+            spdlog::info("Cooked texture {} is older than {}, decoding the source", cookedPath, texturePath);
+        }
+    }
+
     int texWidth, texHeight, texChannels;
-    stbi_uc* pixels = stbi_load(m_TexturePath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-    VkDeviceSize imageSize = texWidth * texHeight * 4;
+    stbi_uc* pixels = stbi_load(texturePath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
 
     if (!pixels)
     {
-        throw std::runtime_error("Failed to load texture image!");
+        throw std::runtime_error("Failed to load texture image: " + texturePath);
     }
 
-    // Create staging buffer
-    Buffer stagingBuffer(
-        m_Allocator,
-        imageSize,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VMA_MEMORY_USAGE_CPU_ONLY,
-        VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
-        VMA_ALLOCATION_CREATE_MAPPED_BIT
-    );
-
-    // Copy image data to staging buffer
-    void* data = stagingBuffer.map();
-    memcpy(data, pixels, static_cast<size_t>(imageSize));
-    stagingBuffer.unmap();
+    data.width = static_cast<uint32_t>(texWidth);
+    data.height = static_cast<uint32_t>(texHeight);
+    data.channels = texChannels;
+    data.pixels.assign(pixels, pixels + size_t(texWidth) * texHeight * 4);
 
     stbi_image_free(pixels);
 
-    // Determine the Vulkan format based on the texture format
-    VkFormat vkFormat = (m_Format == Format::SRGB) ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+    MipChain::generate(data.pixels, data.mipOffsets, data.width, data.height, format == Format::SRGB);
+    return data;
+}
+
+void Texture::createTextureImage()
+{
+    upload(decode(m_TexturePath, m_Format));
+}
+
+void Texture::upload(const TextureData& textureData)
+{
+    // Cooked data brings its own format, otherwise it follows the texture format
+    m_VkFormat = textureData.format;
+    if (m_VkFormat == VK_FORMAT_UNDEFINED)
+    {
+        m_VkFormat = (m_Format == Format::SRGB) ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+    }
 
     // Create texture image
     m_pTextureImage = new Image(m_pDevice, m_Allocator);
     m_pTextureImage->createImage(
-        texWidth,
-        texHeight,
-        vkFormat,
+        textureData.width,
+        textureData.height,
+        m_VkFormat,
         VK_IMAGE_TILING_OPTIMAL,
         VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-        VMA_MEMORY_USAGE_GPU_ONLY
-    );
-
-    // Transition image layouts and copy buffer to image
-    m_pTextureImage->transitionImageLayout(
-        m_pCommandPool,
-        m_pDevice->getGraphicsQueue(),
-        vkFormat,
-        VK_IMAGE_LAYOUT_UNDEFINED,
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+        0,
+        1,
+        VMA_MEMORY_USAGE_GPU_ONLY,
+        static_cast<uint32_t>(textureData.mipOffsets.size())
     );
 
-    m_pTextureImage->copyBufferToImage(
-        m_pCommandPool,
-        stagingBuffer.get(),
-        static_cast<uint32_t>(texWidth),
-        static_cast<uint32_t>(texHeight)
-    );
+    // Staging copy and layout transitions are recorded into the shared upload batch.
+    // Mips come prebuilt from decode(), blits are not available on the transfer queue.
+    m_pUploadBatch->uploadImage(m_pTextureImage, textureData.pixels.data(), textureData.pixels.size(), textureData.mipOffsets);
+    m_UploadValue = m_pUploadBatch->getPendingValue();
 
-    m_pTextureImage->transitionImageLayout(
-        m_pCommandPool,
-        m_pDevice->getGraphicsQueue(),
-        vkFormat,
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-    );
+    createTextureImageView();
 
-    spdlog::info("Texture image created: {} ({}x{}, {} channels, format: {})",
-        m_TexturePath, texWidth, texHeight, texChannels,
-        (m_Format == Format::SRGB ? "SRGB" : "UNORM"));
+    spdlog::info("Texture image created: {} ({}x{}, {} mips, {} channels, format: {}{})",
+        m_TexturePath, textureData.width, textureData.height, textureData.mipOffsets.size(), textureData.channels,
+        (m_Format == Format::SRGB ? "SRGB" : "UNORM"), (textureData.format != VK_FORMAT_UNDEFINED ? ", cooked" : ""));
 }
 
 
 void Texture::createTextureImageView()
 {
-    VkFormat vkFormat = (m_Format == Format::SRGB) ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
     m_TextureImageView = m_pTextureImage->createImageView(
-        vkFormat,
+        m_VkFormat,
         VK_IMAGE_ASPECT_COLOR_BIT
     );
 }
@@ -152,7 +232,8 @@ void Texture::createTextureSampler(VkDevice device, VkPhysicalDevice physicalDev
     samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
     samplerInfo.mipLodBias = 0.0f;
     samplerInfo.minLod = 0.0f;
-    samplerInfo.maxLod = 0.0f;
+    // Trilinear + anisotropic across the whole chain
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
 
     if (vkCreateSampler(device, &samplerInfo, nullptr, &s_textureSampler) != VK_SUCCESS) 
     {
@@ -168,5 +249,14 @@ VkSampler Texture::getTextureSampler()
 
 VkImageView Texture::getTextureImageView() const 
 {
+    if (!isResident() && m_pPlaceholder)
+    {
+        return m_pPlaceholder->getTextureImageView();
+    }
     return m_TextureImageView;
 }
+
+bool Texture::isResident() const
+{
+    return m_TextureImageView != VK_NULL_HANDLE && m_pUploadBatch->isAcquired(m_UploadValue);
+}
@@ -2,9 +2,10 @@
 
 #include <vulkan/vulkan.h>
 #include "vk_mem_alloc.h"
-#include "CommandPool.h"
+#include "UploadBatch.h"
 #include "Image.h"
 #include <string>
+#include <vector>
 
 //
 // Texture sampler will probably not be static later.
@@ -19,13 +20,38 @@ public:
         HDR
     };
 
-    Texture(Device* pDevice, VmaAllocator allocator, CommandPool* pCommandPool,
+    // Decoded RGBA8 pixels or cooked blocks, produced off the main thread by decode().
+    // pixels holds every mip level back to back; mipOffsets[level] is where each one starts.
+    struct TextureData
+    {
+        std::vector<unsigned char> pixels;
+        // Set for cooked data; otherwise RGBA8 in the texture's own format
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        std::vector<VkDeviceSize> mipOffsets{ 0 };
+        uint32_t width = 0;
+        uint32_t height = 0;
+        int channels = 0;
+    };
+
+    // Loads and uploads the texture immediately
+    Texture(Device* pDevice, VmaAllocator allocator, UploadBatch* pUploadBatch,
         const std::string& texturePath, VkPhysicalDevice physicalDevice, Format format = Format::SRGB);
+    // Creates the texture without any image; the placeholder's view is used until upload() is called
+    Texture(Device* pDevice, VmaAllocator allocator, UploadBatch* pUploadBatch,
+        const std::string& texturePath, VkPhysicalDevice physicalDevice, Format format, const Texture* pPlaceholder);
     ~Texture();
 
+    // Safe to call from any thread, touches no Vulkan state. Prefers the cooked .dds next to the
+    // source image while it is up to date; otherwise decodes with stb_image and builds the mip chain on the CPU.
+    static TextureData decode(const std::string& texturePath, Format format);
+    void upload(const TextureData& data);
+
     void createTextureImage();
     void createTextureImageView();
     VkImageView getTextureImageView() const;
+    // True once the upload has been acquired by the graphics queue
+    bool isResident() const;
+    const std::string& getPath() const { return m_TexturePath; }
 
     static void createTextureSampler(VkDevice device, VkPhysicalDevice physicalDevice);
     static VkSampler getTextureSampler();
@@ -33,14 +59,17 @@ public:
 private:
     Device* m_pDevice;
     VmaAllocator m_Allocator;
-    CommandPool* m_pCommandPool;
+    UploadBatch* m_pUploadBatch;
     std::string m_TexturePath;
     VkPhysicalDevice m_PhysicalDevice;
 
     Image* m_pTextureImage;
     VkImageView m_TextureImageView;
+    VkFormat m_VkFormat = VK_FORMAT_UNDEFINED;
 
     Format m_Format; // New member to store the texture format
+    const Texture* m_pPlaceholder;
+    uint64_t m_UploadValue = 0;
 
     static VkSampler s_textureSampler;
     static size_t s_samplerUsers; // Reference count for the sampler
@@ -0,0 +1,120 @@
+#include "TextureCache.h"
+#include "ThreadPool.h"
+#include <spdlog/spdlog.h>
+
+TextureCache::TextureCache(Device* pDevice, VmaAllocator allocator, UploadBatch* pUploadBatch,
+    VkPhysicalDevice physicalDevice, ThreadPool* pThreadPool)
+    : m_pDevice(pDevice), m_Allocator(allocator), m_pUploadBatch(pUploadBatch),
+    m_PhysicalDevice(physicalDevice), m_pThreadPool(pThreadPool)
+{
+    spdlog::debug("TextureCache created");
+}
+
+TextureCache::~TextureCache()
+{
+    // Workers may still be decoding into textures we are about to delete
+    for (PendingTexture& pending : m_Pending)
+    {
+        pending.decoded.wait();
+    }
+    m_Pending.clear();
+
+    for (auto& [key, pTexture] : m_Textures)
+    {
+        delete pTexture;
+    }
+    for (auto& [format, pTexture] : m_Placeholders)
+    {
+        delete pTexture;
+    }
+    spdlog::debug("TextureCache destroyed");
+}
+
+Texture* TextureCache::getTexture(const std::string& texturePath, Texture::Format format)
+{
+    auto key = std::make_pair(texturePath, format);
+    auto it = m_Textures.find(key);
+    if (it != m_Textures.end())
+    {
+        return it->second;
+    }
+
+    Texture* pTexture = new Texture(m_pDevice, m_Allocator, m_pUploadBatch, texturePath, m_PhysicalDevice, format, getPlaceholder(format));
+    m_Textures.emplace(key, pTexture);
+
+    m_Pending.push_back({ pTexture, m_pThreadPool->submit([texturePath, format]() { return Texture::decode(texturePath, format); }) });
+
+    return pTexture;
+}
+
+bool TextureCache::processPendingUploads()
+{
+    bool anyResident = false;
+
+    for (auto it = m_Uploading.begin(); it != m_Uploading.end();)
+    {
+        if ((*it)->isResident())
+        {
+            anyResident = true;
+            it = m_Uploading.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    for (auto it = m_Pending.begin(); it != m_Pending.end();)
+    {
+        if (it->decoded.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            ++it;
+            continue;
+        }
+
+        try
+        {
+            it->pTexture->upload(it->decoded.get());
+            m_Uploading.push_back(it->pTexture);
+        }
+        catch (const std::exception& e)
+        {
+            // The texture keeps showing the placeholder
+            spdlog::error("Texture {} failed to load: {}", it->pTexture->getPath(), e.what());
+        }
+
+        it = m_Pending.erase(it);
+    }
+
+    if (anyResident)
+    {
+        ++m_Generation;
+        if (m_Pending.empty() && m_Uploading.empty())
+        {
+            spdlog::info("All {} textures resident", m_Textures.size());
+        }
+    }
+
+    return anyResident;
+}
+
+Texture* TextureCache::getPlaceholder(Texture::Format format)
+{
+    auto it = m_Placeholders.find(format);
+    if (it != m_Placeholders.end())
+    {
+        return it->second;
+    }
+
+    // Black matches the default texture used for missing material slots
+    Texture::TextureData data{};
+    data.width = 1;
+    data.height = 1;
+    data.channels = 4;
+    data.pixels = { 0, 0, 0, 255 };
+
+    Texture* pPlaceholder = new Texture(m_pDevice, m_Allocator, m_pUploadBatch, "placeholder", m_PhysicalDevice, format, nullptr);
+    pPlaceholder->upload(data);
+    m_Placeholders.emplace(format, pPlaceholder);
+    return pPlaceholder;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Texture.h"
+#include <future>
+#include <map>
+#include <string>
+#include <vector>
+
+class Device;
+class ThreadPool;
+
+//
+// Owns every texture loaded from disk, keyed on path and format, so each file
+// is decoded and uploaded once. Decoding runs on the thread pool; until a texture
+// is resident its image view resolves to a 1x1 placeholder.
+//
+class TextureCache
+{
+public:
+    TextureCache(Device* pDevice, VmaAllocator allocator, UploadBatch* pUploadBatch,
+        VkPhysicalDevice physicalDevice, ThreadPool* pThreadPool);
+    ~TextureCache();
+
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    Texture* getTexture(const std::string& texturePath, Texture::Format format = Texture::Format::SRGB);
+
+    // Records uploads for every texture whose decode has finished and checks which earlier uploads the
+    // graphics queue has acquired. Call once per frame on the render thread, before the upload batch is submitted.
+    // Returns true when at least one texture became resident.
+    bool processPendingUploads();
+
+    // Incremented whenever a texture becomes resident, so descriptor sets know when to refresh
+    uint64_t getGeneration() const { return m_Generation; }
+    size_t getPendingCount() const { return m_Pending.size() + m_Uploading.size(); }
+
+private:
+    struct PendingTexture
+    {
+        Texture* pTexture;
+        std::future<Texture::TextureData> decoded;
+    };
+
+    Texture* getPlaceholder(Texture::Format format);
+
+    Device* m_pDevice;
+    VmaAllocator m_Allocator;
+    UploadBatch* m_pUploadBatch;
+    VkPhysicalDevice m_PhysicalDevice;
+    ThreadPool* m_pThreadPool;
+
+    std::map<std::pair<std::string, Texture::Format>, Texture*> m_Textures;
+    std::map<Texture::Format, Texture*> m_Placeholders;
+    std::vector<PendingTexture> m_Pending;
+    // Uploaded but not yet acquired by the graphics queue
+    std::vector<Texture*> m_Uploading;
+    uint64_t m_Generation = 0;
+};
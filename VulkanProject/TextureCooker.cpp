@@ -0,0 +1,221 @@
+// Offline texture cooker: encodes source images into block-compressed DDS files with full mip chains.
+// Texture::decode picks up the .dds that sits next to a source image, so cooked assets need no
+// changes to the model or its materials.
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "BlockCompressor.h"
+#include "DdsFile.h"
+#include "MipChain.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <optional>
+#include <string>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+    enum class Usage
+    {
+        Albedo,
+        Normal,
+        MetallicRoughness
+    };
+
+    struct CookStats
+    {
+        double megapixels = 0.0;
+        double seconds = 0.0;
+        double squaredError = 0.0;
+        double errorSamples = 0.0;
+        size_t sourceBytes = 0;
+        size_t cookedBytes = 0;
+        uint32_t fileCount = 0;
+    };
+
+    void printUsage()
+    {
+        spdlog::info("Usage: TextureCooker [options] <image>...");
+        spdlog::info("  --albedo    following images are albedo, BC7 sRGB (default)");
+        spdlog::info("  --normal    following images are tangent-space normal maps, BC5");
+        spdlog::info("  --mr        following images are metallic-roughness maps, BC7 linear");
+        spdlog::info("  --bc1 | --bc3 | --bc5 | --bc7   override the format for following images");
+        spdlog::info("  --force     cook even when the .dds is newer than its source");
+        spdlog::info("Each image is written next to its source with .dds appended, e.g. a.png -> a.png.dds.");
+    }
+
+    BlockCompressor::Format chooseFormat(Usage usage, std::optional<BlockCompressor::Format> forcedFormat, bool hasAlpha)
+    {
+        BlockCompressor::Format format = forcedFormat.value_or(
+            usage == Usage::Normal ? BlockCompressor::Format::BC5 : BlockCompressor::Format::BC7);
+
+        // BC1 would throw away the cutout alpha the depth and G-buffer passes test against
+        if (format == BlockCompressor::Format::BC1 && hasAlpha)
+        {
+            format = BlockCompressor::Format::BC3;
+        }
+        return format;
+    }
+
+    uint32_t getDxgiFormat(BlockCompressor::Format format, bool isSrgb)
+    {
+        switch (format)
+        {
+        case BlockCompressor::Format::BC1: return isSrgb ? DdsFile::DXGI_FORMAT_BC1_UNORM_SRGB : DdsFile::DXGI_FORMAT_BC1_UNORM;
+        case BlockCompressor::Format::BC3: return isSrgb ? DdsFile::DXGI_FORMAT_BC3_UNORM_SRGB : DdsFile::DXGI_FORMAT_BC3_UNORM;
+        case BlockCompressor::Format::BC5: return DdsFile::DXGI_FORMAT_BC5_UNORM;
+        case BlockCompressor::Format::BC7: return isSrgb ? DdsFile::DXGI_FORMAT_BC7_UNORM_SRGB : DdsFile::DXGI_FORMAT_BC7_UNORM;
+        }
+        return DdsFile::DXGI_FORMAT_UNKNOWN;
+    }
+
+    // Channels the format is expected to preserve, for the error measurement
+    int getMeasuredChannelCount(BlockCompressor::Format format)
+    {
+        switch (format)
+        {
+        case BlockCompressor::Format::BC1: return 3;
+        case BlockCompressor::Format::BC5: return 2;
+        default: return 4;
+        }
+    }
+
+    bool cookTexture(const std::string& sourcePath, Usage usage, std::optional<BlockCompressor::Format> forcedFormat,
+        bool force, ThreadPool& threadPool, CookStats& stats)
+    {
+        const std::string cookedPath = DdsFile::getCookedPath(sourcePath);
+        if (!force && DdsFile::isCookedUpToDate(cookedPath, sourcePath))
+        {
+            spdlog::info("{} is up to date", cookedPath);
+            return true;
+        }
+
+        int width, height, channels;
+        stbi_uc* pSource = stbi_load(sourcePath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+        if (!pSource)
+        {
+            spdlog::error("Failed to load {}: {}", sourcePath, stbi_failure_reason());
+            return false;
+        }
+
+        std::vector<unsigned char> pixels(pSource, pSource + size_t(width) * height * 4);
+        stbi_image_free(pSource);
+
+        bool hasAlpha = false;
+        for (size_t i = 3; i < pixels.size() && !hasAlpha; i += 4)
+        {
+            hasAlpha = pixels[i] != 255;
+        }
+
+        const bool isSrgb = usage == Usage::Albedo;
+        const BlockCompressor::Format format = chooseFormat(usage, forcedFormat, hasAlpha);
+
+        auto start = std::chrono::high_resolution_clock::now();
+
+        std::vector<uint64_t> mipOffsets;
+        MipChain::generate(pixels, mipOffsets, static_cast<uint32_t>(width), static_cast<uint32_t>(height), isSrgb);
+
+        std::vector<std::vector<unsigned char>> levels;
+        double megapixels = 0.0;
+        for (size_t level = 0; level < mipOffsets.size(); ++level)
+        {
+            const uint32_t levelWidth = std::max(static_cast<uint32_t>(width) >> level, 1u);
+            const uint32_t levelHeight = std::max(static_cast<uint32_t>(height) >> level, 1u);
+            levels.push_back(BlockCompressor::compressImage(format, pixels.data() + mipOffsets[level], levelWidth, levelHeight, &threadPool));
+            megapixels += double(levelWidth) * levelHeight / 1e6;
+        }
+
+        auto end = std::chrono::high_resolution_clock::now();
+        const double seconds = std::chrono::duration<double>(end - start).count();
+
+        // Error is measured on the top level only, against the source texels
+        const std::vector<unsigned char> decoded = BlockCompressor::decompressImage(format, levels[0].data(),
+            static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+        const int channelCount = getMeasuredChannelCount(format);
+        double squaredError = 0.0;
+        for (size_t texel = 0; texel < size_t(width) * height; ++texel)
+        {
+            for (int channel = 0; channel < channelCount; ++channel)
+            {
+                const double delta = double(pixels[texel * 4 + channel]) - double(decoded[texel * 4 + channel]);
+                squaredError += delta * delta;
+            }
+        }
+        const double samples = double(width) * height * channelCount;
+        const double rmse = std::sqrt(squaredError / samples);
+        const double psnr = rmse > 0.0 ? 20.0 * std::log10(255.0 / rmse) : 99.0;
+
+        if (!DdsFile::write(cookedPath, getDxgiFormat(format, isSrgb), static_cast<uint32_t>(width), static_cast<uint32_t>(height), levels))
+        {
+            return false;
+        }
+
+        size_t cookedBytes = 0;
+        for (const std::vector<unsigned char>& level : levels)
+        {
+            cookedBytes += level.size();
+        }
+
+        spdlog::info("{}: {}x{} {}{}, {} mips, {:.1f} ms ({:.1f} MPix/s), RMSE {:.2f}, PSNR {:.2f} dB, {:.1f}:1",
+            cookedPath, width, height, BlockCompressor::getName(format), isSrgb ? " sRGB" : "", levels.size(),
+            seconds * 1000.0, megapixels / seconds, rmse, psnr, double(pixels.size()) / double(cookedBytes));
+
+        stats.megapixels += megapixels;
+        stats.seconds += seconds;
+        stats.squaredError += squaredError;
+        stats.errorSamples += samples;
+        stats.sourceBytes += pixels.size();
+        stats.cookedBytes += cookedBytes;
+        stats.fileCount++;
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        printUsage();
+        return 1;
+    }
+
+    ThreadPool threadPool;
+    CookStats stats;
+    Usage usage = Usage::Albedo;
+    std::optional<BlockCompressor::Format> forcedFormat;
+    bool force = false;
+    uint32_t failures = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        if (argument == "--albedo") { usage = Usage::Albedo; forcedFormat.reset(); }
+        else if (argument == "--normal") { usage = Usage::Normal; forcedFormat.reset(); }
+        else if (argument == "--mr") { usage = Usage::MetallicRoughness; forcedFormat.reset(); }
+        else if (argument == "--bc1") { forcedFormat = BlockCompressor::Format::BC1; }
+        else if (argument == "--bc3") { forcedFormat = BlockCompressor::Format::BC3; }
+        else if (argument == "--bc5") { forcedFormat = BlockCompressor::Format::BC5; }
+        else if (argument == "--bc7") { forcedFormat = BlockCompressor::Format::BC7; }
+        else if (argument == "--force") { force = true; }
+        else if (argument == "--help" || argument == "-h") { printUsage(); return 0; }
+        else if (!cookTexture(argument, usage, forcedFormat, force, threadPool, stats))
+        {
+            failures++;
+        }
+    }
+
+    if (stats.fileCount > 0)
+    {
+        const double rmse = std::sqrt(stats.squaredError / stats.errorSamples);
+        spdlog::info("Cooked {} textures on {} threads: {:.1f} MPix in {:.2f} s ({:.1f} MPix/s), RMSE {:.2f}, PSNR {:.2f} dB, {:.1f} MB -> {:.1f} MB",
+            stats.fileCount, threadPool.getThreadCount(), stats.megapixels, stats.seconds, stats.megapixels / stats.seconds,
+            rmse, rmse > 0.0 ? 20.0 * std::log10(255.0 / rmse) : 99.0,
+            stats.sourceBytes / (1024.0 * 1024.0), stats.cookedBytes / (1024.0 * 1024.0));
+    }
+
+    return failures == 0 ? 0 : 1;
+}
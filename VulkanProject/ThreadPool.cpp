@@ -0,0 +1,122 @@
+#include "ThreadPool.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <atomic>
+
+ThreadPool::ThreadPool(uint32_t threadCount)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    m_Workers.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; ++i)
+    {
+        m_Workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+
+    spdlog::debug("Thread pool created with {} workers", threadCount);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stopping = true;
+    }
+    m_Condition.notify_all();
+
+    for (std::thread& worker : m_Workers)
+    {
+        worker.join();
+    }
+    spdlog::debug("Thread pool destroyed");
+}
+
+void ThreadPool::enqueue(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Jobs.push(std::move(job));
+    }
+    m_Condition.notify_one();
+}
+
+void ThreadPool::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Condition.wait(lock, [this]() { return m_Stopping || !m_Jobs.empty(); });
+            if (m_Stopping && m_Jobs.empty())
+            {
+                return;
+            }
+            job = std::move(m_Jobs.front());
+            m_Jobs.pop();
+        }
+        job();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& job)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    // Workers and the calling thread pull indices from a shared counter, so uneven jobs balance themselves
+    std::atomic<size_t> nextIndex = 0;
+    auto runJobs = [&]()
+    {
+        size_t index;
+        while ((index = nextIndex.fetch_add(1)) < count)
+        {
+            job(index);
+        }
+    };
+
+    const size_t helperCount = std::min<size_t>(m_Workers.size(), count - 1);
+    std::vector<std::future<void>> helpers;
+    helpers.reserve(helperCount);
+    for (size_t i = 0; i < helperCount; ++i)
+    {
+        helpers.push_back(submit(runJobs));
+    }
+
+    // The helpers reference locals of this frame, so always wait for them before leaving, even on failure
+    std::exception_ptr error;
+    try
+    {
+        runJobs();
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+        nextIndex = count;
+    }
+
+    for (std::future<void>& helper : helpers)
+    {
+        try
+        {
+            helper.get();
+        }
+        catch (...)
+        {
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+        }
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
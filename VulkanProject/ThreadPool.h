@@ -0,0 +1,50 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+//
+// Fixed-size pool of worker threads.
+// Jobs are plain std::function objects; submit() hands back a future for the result.
+//
+class ThreadPool
+{
+public:
+    // A thread count of 0 uses one worker per hardware thread
+    ThreadPool(uint32_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    template<typename F>
+    auto submit(F&& job) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+    {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+        auto pTask = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(job));
+        std::future<Result> future = pTask->get_future();
+        enqueue([pTask]() { (*pTask)(); });
+        return future;
+    }
+
+    // Runs job(i) for every i in [0, count) and blocks until all calls returned.
+    // The calling thread helps out; don't call this from inside a pool job.
+    void parallelFor(size_t count, const std::function<void(size_t)>& job);
+
+    uint32_t getThreadCount() const { return static_cast<uint32_t>(m_Workers.size()); }
+
+private:
+    void enqueue(std::function<void()> job);
+    void workerLoop();
+
+    std::vector<std::thread> m_Workers;
+    std::queue<std::function<void()>> m_Jobs;
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    bool m_Stopping = false;
+};
@@ -0,0 +1,51 @@
+// UniformRing.cpp
+#include "UniformRing.h"
+#include "Buffer.h"
+#include <cstring>
+#include <stdexcept>
+
+UniformRing::UniformRing(VmaAllocator allocator, VkDeviceSize frameSize, uint32_t frameCount, VkDeviceSize alignment)
+    : m_Alignment(alignment)
+{
+    // Slices start aligned as well, so every offset handed out is
+    m_FrameSize = (frameSize + alignment - 1) / alignment * alignment;
+    m_pBuffer = new Buffer(
+        allocator,
+        m_FrameSize * frameCount,
+        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+        VMA_MEMORY_USAGE_CPU_TO_GPU,
+        VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+        VMA_ALLOCATION_CREATE_MAPPED_BIT,
+        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    );
+    m_pMappedData = static_cast<char*>(m_pBuffer->map());
+}
+
+UniformRing::~UniformRing()
+{
+    delete m_pBuffer;
+}
+
+void UniformRing::beginFrame(uint32_t frameIndex)
+{
+    m_Offset = m_FrameSize * frameIndex;
+    m_FrameEnd = m_Offset + m_FrameSize;
+}
+
+uint32_t UniformRing::push(const void* pData, VkDeviceSize size)
+{
+    if (m_Offset + size > m_FrameEnd)
+    {
+        throw std::runtime_error("Uniform ring frame slice is full!");
+    }
+
+    const VkDeviceSize offset = m_Offset;
+    memcpy(m_pMappedData + offset, pData, size);
+    m_Offset = (offset + size + m_Alignment - 1) / m_Alignment * m_Alignment;
+    return static_cast<uint32_t>(offset);
+}
+
+VkBuffer UniformRing::get() const
+{
+    return m_pBuffer->get();
+}
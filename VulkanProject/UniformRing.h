@@ -0,0 +1,42 @@
+// UniformRing.h
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include <cstdint>
+
+class Buffer;
+
+//
+// One persistently mapped, host-coherent uniform buffer split into a slice per frame in flight.
+// A frame's constants are bump-allocated from its slice and bound through dynamic uniform buffer
+// offsets, so writing them is a memcpy each, with no mapping or allocation per frame.
+//
+class UniformRing
+{
+public:
+    // alignment is the device's minUniformBufferOffsetAlignment
+    UniformRing(VmaAllocator allocator, VkDeviceSize frameSize, uint32_t frameCount, VkDeviceSize alignment);
+    ~UniformRing();
+
+    UniformRing(const UniformRing&) = delete;
+    UniformRing& operator=(const UniformRing&) = delete;
+
+    // Rewinds to the start of the frame's slice; the frame must not be in flight
+    void beginFrame(uint32_t frameIndex);
+
+    // Copies the data into the current slice and returns its dynamic offset
+    uint32_t push(const void* pData, VkDeviceSize size);
+    template<typename T>
+    uint32_t push(const T& data) { return push(&data, sizeof(T)); }
+
+    VkBuffer get() const;
+
+private:
+    Buffer* m_pBuffer;
+    char* m_pMappedData;
+    VkDeviceSize m_FrameSize;
+    VkDeviceSize m_Alignment;
+    VkDeviceSize m_Offset = 0;
+    VkDeviceSize m_FrameEnd = 0;
+};
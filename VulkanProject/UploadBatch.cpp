@@ -0,0 +1,524 @@
+#include "UploadBatch.h"
+#include "Buffer.h"
+#include "CommandPool.h"
+#include "Device.h"
+#include "Image.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+    // Covers the texel size of every format we upload (up to RGBA32F)
+    constexpr VkDeviceSize STAGING_ALIGNMENT = 16;
+
+    VkImageMemoryBarrier2 makeImageBarrier(Image* pImage,
+        VkImageLayout oldLayout, VkImageLayout newLayout,
+        VkPipelineStageFlags2 srcStageMask, VkPipelineStageFlags2 dstStageMask,
+        VkAccessFlags2 srcAccessMask, VkAccessFlags2 dstAccessMask,
+        VkImageAspectFlags aspectMask, uint32_t layerCount)
+    {
+        // Every barrier covers the whole mip chain
+        VkImageMemoryBarrier2 barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+        barrier.srcStageMask = srcStageMask;
+        barrier.srcAccessMask = srcAccessMask;
+        barrier.dstStageMask = dstStageMask;
+        barrier.dstAccessMask = dstAccessMask;
+        barrier.oldLayout = oldLayout;
+        barrier.newLayout = newLayout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = pImage->getImage();
+        barrier.subresourceRange.aspectMask = aspectMask;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = pImage->getMipLevels();
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = layerCount;
+        return barrier;
+    }
+}
+
+UploadBatch::UploadBatch(Device* pDevice, VmaAllocator allocator,
+    uint32_t transferFamilyIndex, VkQueue transferQueue,
+    uint32_t graphicsFamilyIndex, VkQueue graphicsQueue,
+    VkDeviceSize stagingSize)
+    : m_pDevice(pDevice), m_Allocator(allocator),
+    m_TransferFamilyIndex(transferFamilyIndex), m_GraphicsFamilyIndex(graphicsFamilyIndex),
+    m_TransfersOwnership(transferFamilyIndex != graphicsFamilyIndex), m_StagingSize(stagingSize)
+{
+    createStream(m_Transfer, transferFamilyIndex, transferQueue);
+    createStream(m_Graphics, graphicsFamilyIndex, graphicsQueue);
+
+    m_pStagingBuffer = new Buffer(
+        m_Allocator,
+        m_StagingSize,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VMA_MEMORY_USAGE_CPU_ONLY,
+        VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT
+    );
+    // Stays mapped for the lifetime of the batch
+    m_pStagingData = static_cast<unsigned char*>(m_pStagingBuffer->map());
+
+    spdlog::debug("UploadBatch created with {} MB staging ring on queue family {}{}",
+        m_StagingSize / (1024 * 1024), m_TransferFamilyIndex, m_TransfersOwnership ? " (dedicated transfer)" : "");
+}
+
+UploadBatch::~UploadBatch()
+{
+    flush();
+    retireCompleted();
+
+    destroyStream(m_Transfer);
+    destroyStream(m_Graphics);
+    delete m_pStagingBuffer;
+    spdlog::debug("UploadBatch destroyed");
+}
+
+void UploadBatch::uploadBuffer(Buffer* pDstBuffer, const void* pData, VkDeviceSize size, VkDeviceSize dstOffset,
+    VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask)
+{
+    VkBuffer srcBuffer;
+    VkDeviceSize srcOffset;
+    void* pStaging = allocateStaging(size, srcBuffer, srcOffset);
+    memcpy(pStaging, pData, static_cast<size_t>(size));
+
+    beginIfNeeded(m_Transfer);
+    flushBarriers(m_Transfer);
+
+    VkBufferCopy copyRegion{};
+    copyRegion.srcOffset = srcOffset;
+    copyRegion.dstOffset = dstOffset;
+    copyRegion.size = size;
+    vkCmdCopyBuffer(m_Transfer.commandBuffer, srcBuffer, pDstBuffer->get(), 1, &copyRegion);
+
+    VkBufferMemoryBarrier2 barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+    barrier.srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+    barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    barrier.dstStageMask = dstStageMask;
+    barrier.dstAccessMask = dstAccessMask;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = pDstBuffer->get();
+    barrier.offset = dstOffset;
+    barrier.size = size;
+
+    if (!m_TransfersOwnership)
+    {
+        m_Transfer.bufferBarriers.push_back(barrier);
+        return;
+    }
+
+    // Release on the transfer queue, acquire on the graphics queue with the same ranges
+    barrier.srcQueueFamilyIndex = m_TransferFamilyIndex;
+    barrier.dstQueueFamilyIndex = m_GraphicsFamilyIndex;
+
+    VkBufferMemoryBarrier2 release = barrier;
+    release.dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+    release.dstAccessMask = VK_ACCESS_2_NONE;
+    m_Transfer.bufferBarriers.push_back(release);
+
+    VkBufferMemoryBarrier2 acquire = barrier;
+    acquire.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+    acquire.srcAccessMask = VK_ACCESS_2_NONE;
+    m_AcquireBufferBarriers.push_back(acquire);
+}
+
+void UploadBatch::uploadImage(Image* pImage, const void* pData, VkDeviceSize size,
+    VkImageLayout finalLayout, VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask)
+{
+    uploadImage(pImage, pData, size, { 0 }, finalLayout, dstStageMask, dstAccessMask);
+}
+
+void UploadBatch::uploadImage(Image* pImage, const void* pData, VkDeviceSize size, const std::vector<VkDeviceSize>& mipOffsets,
+    VkImageLayout finalLayout, VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask)
+{
+    VkBuffer srcBuffer;
+    VkDeviceSize srcOffset;
+    void* pStaging = allocateStaging(size, srcBuffer, srcOffset);
+    memcpy(pStaging, pData, static_cast<size_t>(size));
+
+    beginIfNeeded(m_Transfer);
+    m_Transfer.imageBarriers.push_back(makeImageBarrier(pImage,
+        VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        VK_PIPELINE_STAGE_2_NONE, VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+        VK_ACCESS_2_NONE, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+        VK_IMAGE_ASPECT_COLOR_BIT, 1));
+    flushBarriers(m_Transfer);
+
+    std::vector<VkBufferImageCopy> regions(mipOffsets.size());
+    for (uint32_t level = 0; level < regions.size(); ++level)
+    {
+        VkBufferImageCopy& region = regions[level];
+        region.bufferOffset = srcOffset + mipOffsets[level];
+        region.bufferRowLength = 0;
+        region.bufferImageHeight = 0;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = level;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = { 0, 0, 0 };
+        region.imageExtent = { std::max(pImage->getWidth() >> level, 1u), std::max(pImage->getHeight() >> level, 1u), 1 };
+    }
+    vkCmdCopyBufferToImage(m_Transfer.commandBuffer, srcBuffer, pImage->getImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        static_cast<uint32_t>(regions.size()), regions.data());
+
+    VkImageMemoryBarrier2 barrier = makeImageBarrier(pImage,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, finalLayout,
+        VK_PIPELINE_STAGE_2_TRANSFER_BIT, dstStageMask,
+        VK_ACCESS_2_TRANSFER_WRITE_BIT, dstAccessMask,
+        VK_IMAGE_ASPECT_COLOR_BIT, 1);
+    pImage->setImageLayout(finalLayout);
+
+    if (!m_TransfersOwnership)
+    {
+        m_Transfer.imageBarriers.push_back(barrier);
+        return;
+    }
+
+    // The layout transition is part of the release/acquire pair, so both sides name the same layouts
+    barrier.srcQueueFamilyIndex = m_TransferFamilyIndex;
+    barrier.dstQueueFamilyIndex = m_GraphicsFamilyIndex;
+
+    VkImageMemoryBarrier2 release = barrier;
+    release.dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+    release.dstAccessMask = VK_ACCESS_2_NONE;
+    m_Transfer.imageBarriers.push_back(release);
+
+    VkImageMemoryBarrier2 acquire = barrier;
+    acquire.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+    acquire.srcAccessMask = VK_ACCESS_2_NONE;
+    m_AcquireImageBarriers.push_back(acquire);
+}
+
+void UploadBatch::transitionImage(Image* pImage,
+    VkImageLayout oldLayout, VkImageLayout newLayout,
+    VkPipelineStageFlags2 srcStageMask, VkPipelineStageFlags2 dstStageMask,
+    VkAccessFlags2 srcAccessMask, VkAccessFlags2 dstAccessMask,
+    VkImageAspectFlags aspectMask, uint32_t layerCount)
+{
+    m_Graphics.imageBarriers.push_back(makeImageBarrier(pImage,
+        oldLayout, newLayout, srcStageMask, dstStageMask, srcAccessMask, dstAccessMask, aspectMask, layerCount));
+    pImage->setImageLayout(newLayout);
+}
+
+VkCommandBuffer UploadBatch::getCommandBuffer()
+{
+    beginIfNeeded(m_Graphics);
+    flushBarriers(m_Graphics);
+    return m_Graphics.commandBuffer;
+}
+
+uint64_t UploadBatch::submit()
+{
+    return submitInternal(true);
+}
+
+uint64_t UploadBatch::submitStreaming()
+{
+    return submitInternal(false);
+}
+
+uint64_t UploadBatch::submitInternal(bool waitForUploads)
+{
+    if (hasWork(m_Transfer))
+    {
+        beginIfNeeded(m_Transfer);
+        flushBarriers(m_Transfer);
+        const uint64_t transferValue = submitStream(m_Transfer, VK_NULL_HANDLE, 0);
+
+        m_Submissions.push_back({ transferValue, m_WriteCursor, std::move(m_DedicatedStagingBuffers) });
+        m_DedicatedStagingBuffers.clear();
+
+        if (m_TransfersOwnership)
+        {
+            m_PendingAcquires.push_back({ transferValue, std::move(m_AcquireImageBarriers), std::move(m_AcquireBufferBarriers) });
+            m_AcquireImageBarriers.clear();
+            m_AcquireBufferBarriers.clear();
+        }
+        else
+        {
+            // Same queue: submission order alone makes the upload visible to later work
+            m_AcquiredValue = transferValue;
+        }
+    }
+
+    // Streaming only acquires what already finished, so the graphics queue never stalls on a copy
+    const uint64_t readyValue = waitForUploads ? m_Transfer.lastSubmittedValue : getCompletedValue(m_Transfer);
+    uint64_t acquireValue = 0;
+    while (!m_PendingAcquires.empty() && m_PendingAcquires.front().timelineValue <= readyValue)
+    {
+        PendingAcquire& pending = m_PendingAcquires.front();
+        m_Graphics.imageBarriers.insert(m_Graphics.imageBarriers.end(), pending.imageBarriers.begin(), pending.imageBarriers.end());
+        m_Graphics.bufferBarriers.insert(m_Graphics.bufferBarriers.end(), pending.bufferBarriers.begin(), pending.bufferBarriers.end());
+        acquireValue = pending.timelineValue;
+        m_PendingAcquires.pop_front();
+    }
+
+    if (hasWork(m_Graphics))
+    {
+        beginIfNeeded(m_Graphics);
+        flushBarriers(m_Graphics);
+        // The wait is what orders the acquire after the release; it is free when the copy already completed
+        submitStream(m_Graphics, acquireValue != 0 ? m_Transfer.timelineSemaphore : VK_NULL_HANDLE, acquireValue);
+    }
+
+    if (acquireValue != 0)
+    {
+        m_AcquiredValue = acquireValue;
+    }
+
+    return m_Transfer.lastSubmittedValue;
+}
+
+void UploadBatch::wait(uint64_t value)
+{
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &m_Transfer.timelineSemaphore;
+    waitInfo.pValues = &value;
+
+    vkWaitSemaphores(m_pDevice->get(), &waitInfo, UINT64_MAX);
+    retireCompleted();
+}
+
+bool UploadBatch::isComplete(uint64_t value)
+{
+    return getCompletedValue(m_Transfer) >= value;
+}
+
+void UploadBatch::flush()
+{
+    submit();
+
+    VkSemaphore semaphores[] = { m_Transfer.timelineSemaphore, m_Graphics.timelineSemaphore };
+    uint64_t values[] = { m_Transfer.lastSubmittedValue, m_Graphics.lastSubmittedValue };
+
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 2;
+    waitInfo.pSemaphores = semaphores;
+    waitInfo.pValues = values;
+
+    vkWaitSemaphores(m_pDevice->get(), &waitInfo, UINT64_MAX);
+    retireCompleted();
+}
+
+void* UploadBatch::allocateStaging(VkDeviceSize size, VkBuffer& outBuffer, VkDeviceSize& outOffset)
+{
+    // Anything larger than the ring gets its own buffer up front, freed with the submission; the wait below
+    // can only make room for sizes the empty ring holds
+    if (size > m_StagingSize)
+    {
+        Buffer* pBuffer = new Buffer(
+            m_Allocator,
+            size,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VMA_MEMORY_USAGE_CPU_ONLY,
+            VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT
+        );
+        m_DedicatedStagingBuffers.push_back(pBuffer);
+        outBuffer = pBuffer->get();
+        outOffset = 0;
+        return pBuffer->map();
+    }
+
+    uint64_t start;
+    while (true)
+    {
+        // With nothing left in flight the ring is empty, so start over at its beginning. Otherwise a request
+        // that would straddle the end could never fit, however much of the ring the GPU has released.
+        if (m_ReleasedCursor == m_WriteCursor)
+        {
+            m_WriteCursor = (m_WriteCursor + m_StagingSize - 1) / m_StagingSize * m_StagingSize;
+            m_ReleasedCursor = m_WriteCursor;
+        }
+
+        start = (m_WriteCursor + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1);
+        // Allocations never straddle the end of the ring
+        if ((start % m_StagingSize) + size > m_StagingSize)
+        {
+            start = (start / m_StagingSize + 1) * m_StagingSize;
+        }
+
+        if (start + size - m_ReleasedCursor <= m_StagingSize)
+        {
+            break;
+        }
+
+        if (!m_Submissions.empty())
+        {
+            wait(m_Submissions.front().timelineValue);
+        }
+        else
+        {
+            // The open batch itself fills the ring; send it off before reusing its space
+            flush();
+        }
+    }
+
+    m_WriteCursor = start + size;
+    outBuffer = m_pStagingBuffer->get();
+    outOffset = start % m_StagingSize;
+    return m_pStagingData + outOffset;
+}
+
+void UploadBatch::createStream(Stream& stream, uint32_t queueFamilyIndex, VkQueue queue)
+{
+    stream.queue = queue;
+    stream.pCommandPool = new CommandPool(m_pDevice->get(), queueFamilyIndex);
+
+    VkSemaphoreTypeCreateInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    timelineInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &timelineInfo;
+
+    if (vkCreateSemaphore(m_pDevice->get(), &semaphoreInfo, nullptr, &stream.timelineSemaphore) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create upload timeline semaphore!");
+    }
+}
+
+void UploadBatch::destroyStream(Stream& stream)
+{
+    for (VkCommandBuffer commandBuffer : stream.freeCommandBuffers)
+    {
+        stream.pCommandPool->freeCommandBuffer(commandBuffer);
+    }
+    stream.freeCommandBuffers.clear();
+
+    vkDestroySemaphore(m_pDevice->get(), stream.timelineSemaphore, nullptr);
+    delete stream.pCommandPool;
+    stream.pCommandPool = nullptr;
+}
+
+bool UploadBatch::hasWork(const Stream& stream) const
+{
+    return stream.commandBuffer != VK_NULL_HANDLE || !stream.imageBarriers.empty() || !stream.bufferBarriers.empty();
+}
+
+void UploadBatch::beginIfNeeded(Stream& stream)
+{
+    if (stream.commandBuffer != VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    retireCompleted();
+    if (!stream.freeCommandBuffers.empty())
+    {
+        stream.commandBuffer = stream.freeCommandBuffers.back();
+        stream.freeCommandBuffers.pop_back();
+        vkResetCommandBuffer(stream.commandBuffer, 0);
+    }
+    else
+    {
+        stream.commandBuffer = stream.pCommandPool->allocateCommandBuffer();
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(stream.commandBuffer, &beginInfo);
+}
+
+void UploadBatch::flushBarriers(Stream& stream)
+{
+    if (stream.imageBarriers.empty() && stream.bufferBarriers.empty())
+    {
+        return;
+    }
+
+    VkDependencyInfo dependencyInfo{};
+    dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(stream.imageBarriers.size());
+    dependencyInfo.pImageMemoryBarriers = stream.imageBarriers.data();
+    dependencyInfo.bufferMemoryBarrierCount = static_cast<uint32_t>(stream.bufferBarriers.size());
+    dependencyInfo.pBufferMemoryBarriers = stream.bufferBarriers.data();
+    vkCmdPipelineBarrier2(stream.commandBuffer, &dependencyInfo);
+
+    stream.imageBarriers.clear();
+    stream.bufferBarriers.clear();
+}
+
+uint64_t UploadBatch::submitStream(Stream& stream, VkSemaphore waitSemaphore, uint64_t waitValue)
+{
+    vkEndCommandBuffer(stream.commandBuffer);
+
+    const uint64_t signalValue = stream.lastSubmittedValue + 1;
+
+    VkCommandBufferSubmitInfo commandBufferInfo{};
+    commandBufferInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+    commandBufferInfo.commandBuffer = stream.commandBuffer;
+
+    VkSemaphoreSubmitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+    waitInfo.semaphore = waitSemaphore;
+    waitInfo.value = waitValue;
+    waitInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+    VkSemaphoreSubmitInfo signalInfo{};
+    signalInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+    signalInfo.semaphore = stream.timelineSemaphore;
+    signalInfo.value = signalValue;
+    signalInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+    VkSubmitInfo2 submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+    submitInfo.waitSemaphoreInfoCount = waitSemaphore != VK_NULL_HANDLE ? 1 : 0;
+    submitInfo.pWaitSemaphoreInfos = &waitInfo;
+    submitInfo.commandBufferInfoCount = 1;
+    submitInfo.pCommandBufferInfos = &commandBufferInfo;
+    submitInfo.signalSemaphoreInfoCount = 1;
+    submitInfo.pSignalSemaphoreInfos = &signalInfo;
+
+    if (vkQueueSubmit2(stream.queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to submit upload batch!");
+    }
+
+    stream.inFlight.emplace_back(signalValue, stream.commandBuffer);
+    stream.commandBuffer = VK_NULL_HANDLE;
+    stream.lastSubmittedValue = signalValue;
+    return signalValue;
+}
+
+uint64_t UploadBatch::getCompletedValue(const Stream& stream) const
+{
+    uint64_t completedValue = 0;
+    vkGetSemaphoreCounterValue(m_pDevice->get(), stream.timelineSemaphore, &completedValue);
+    return completedValue;
+}
+
+void UploadBatch::retireCompleted()
+{
+    const uint64_t transferCompleted = getCompletedValue(m_Transfer);
+    while (!m_Submissions.empty() && m_Submissions.front().timelineValue <= transferCompleted)
+    {
+        Submission& submission = m_Submissions.front();
+        // Submissions that staged nothing may still carry a cursor from before the ring was rewound
+        m_ReleasedCursor = std::max(m_ReleasedCursor, submission.ringEnd);
+        for (Buffer* pBuffer : submission.dedicatedStagingBuffers)
+        {
+            delete pBuffer;
+        }
+        m_Submissions.pop_front();
+    }
+
+    for (Stream* pStream : { &m_Transfer, &m_Graphics })
+    {
+        const uint64_t completedValue = pStream == &m_Transfer ? transferCompleted : getCompletedValue(*pStream);
+        while (!pStream->inFlight.empty() && pStream->inFlight.front().first <= completedValue)
+        {
+            pStream->freeCommandBuffers.push_back(pStream->inFlight.front().second);
+            pStream->inFlight.pop_front();
+        }
+    }
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include "vk_mem_alloc.h"
+#include <deque>
+#include <vector>
+
+class Device;
+class Buffer;
+class Image;
+class CommandPool;
+
+//
+// Records uploads and layout transitions and submits them together.
+// Copies run on the transfer queue; source data is staged in a persistently mapped ring buffer,
+// and ring space is only reused once the submission that read it has completed.
+// When the transfer queue belongs to its own family, uploaded resources are released to the
+// graphics family and acquired again by a small graphics-queue command buffer that also carries
+// the plain layout transitions. Resources are usable by any later graphics submission once
+// isAcquired() returns true for the value returned by getPendingValue() when they were recorded.
+//
+class UploadBatch
+{
+public:
+    UploadBatch(Device* pDevice, VmaAllocator allocator,
+        uint32_t transferFamilyIndex, VkQueue transferQueue,
+        uint32_t graphicsFamilyIndex, VkQueue graphicsQueue,
+        VkDeviceSize stagingSize = 64ull * 1024 * 1024);
+    ~UploadBatch();
+
+    UploadBatch(const UploadBatch&) = delete;
+    UploadBatch& operator=(const UploadBatch&) = delete;
+
+    // Copies data into pDstBuffer; the barrier makes the write visible to dstStageMask/dstAccessMask
+    void uploadBuffer(Buffer* pDstBuffer, const void* pData, VkDeviceSize size, VkDeviceSize dstOffset,
+        VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask);
+
+    // Uploads tightly packed texels into layer 0 / mip 0 and leaves the image in finalLayout
+    void uploadImage(Image* pImage, const void* pData, VkDeviceSize size,
+        VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VkPipelineStageFlags2 dstStageMask = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+        VkAccessFlags2 dstAccessMask = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT);
+    // Uploads a prebuilt mip chain into layer 0; mipOffsets[level] is where that level starts in pData
+    void uploadImage(Image* pImage, const void* pData, VkDeviceSize size, const std::vector<VkDeviceSize>& mipOffsets,
+        VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        VkPipelineStageFlags2 dstStageMask = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+        VkAccessFlags2 dstAccessMask = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT);
+
+    // Queues a layout transition on the graphics queue; consecutive transitions are emitted as a single barrier
+    void transitionImage(Image* pImage,
+        VkImageLayout oldLayout, VkImageLayout newLayout,
+        VkPipelineStageFlags2 srcStageMask, VkPipelineStageFlags2 dstStageMask,
+        VkAccessFlags2 srcAccessMask, VkAccessFlags2 dstAccessMask,
+        VkImageAspectFlags aspectMask, uint32_t layerCount = 1);
+
+    // Graphics-queue command buffer of the open batch, with all queued transitions already recorded
+    VkCommandBuffer getCommandBuffer();
+
+    // Transfer timeline value that uploads recorded right now will signal
+    uint64_t getPendingValue() const { return m_Transfer.lastSubmittedValue + 1; }
+
+    // Submits everything recorded so far. The graphics queue waits for the uploads on the GPU,
+    // so every upload is acquired when this returns. Returns the last transfer timeline value.
+    uint64_t submit();
+    // Submits the uploads without making the graphics queue wait for them; their acquire is recorded
+    // by a later call once the transfer queue has finished them. Used for streaming while rendering.
+    uint64_t submitStreaming();
+
+    bool isAcquired(uint64_t value) const { return value <= m_AcquiredValue; }
+    void wait(uint64_t value);
+    bool isComplete(uint64_t value);
+    // Submits and blocks until the GPU finished the batch on both queues
+    void flush();
+
+private:
+    // One queue's command buffers and the timeline that tracks them
+    struct Stream
+    {
+        VkQueue queue = VK_NULL_HANDLE;
+        CommandPool* pCommandPool = nullptr;
+        VkSemaphore timelineSemaphore = VK_NULL_HANDLE;
+        uint64_t lastSubmittedValue = 0;
+
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        std::vector<VkImageMemoryBarrier2> imageBarriers;
+        std::vector<VkBufferMemoryBarrier2> bufferBarriers;
+
+        std::deque<std::pair<uint64_t, VkCommandBuffer>> inFlight;
+        std::vector<VkCommandBuffer> freeCommandBuffers;
+    };
+
+    struct Submission
+    {
+        uint64_t timelineValue;
+        uint64_t ringEnd;
+        std::vector<Buffer*> dedicatedStagingBuffers;
+    };
+
+    // Ownership acquires for one transfer submission, recorded on the graphics queue once it completed
+    struct PendingAcquire
+    {
+        uint64_t timelineValue;
+        std::vector<VkImageMemoryBarrier2> imageBarriers;
+        std::vector<VkBufferMemoryBarrier2> bufferBarriers;
+    };
+
+    uint64_t submitInternal(bool waitForUploads);
+
+    // Returns the mapped pointer and the buffer/offset to copy from
+    void* allocateStaging(VkDeviceSize size, VkBuffer& outBuffer, VkDeviceSize& outOffset);
+    void createStream(Stream& stream, uint32_t queueFamilyIndex, VkQueue queue);
+    void destroyStream(Stream& stream);
+    bool hasWork(const Stream& stream) const;
+    void beginIfNeeded(Stream& stream);
+    void flushBarriers(Stream& stream);
+    uint64_t submitStream(Stream& stream, VkSemaphore waitSemaphore, uint64_t waitValue);
+    uint64_t getCompletedValue(const Stream& stream) const;
+    void retireCompleted();
+
+    Device* m_pDevice;
+    VmaAllocator m_Allocator;
+    uint32_t m_TransferFamilyIndex;
+    uint32_t m_GraphicsFamilyIndex;
+    bool m_TransfersOwnership;
+
+    Stream m_Transfer;
+    Stream m_Graphics;
+
+    Buffer* m_pStagingBuffer;
+    unsigned char* m_pStagingData;
+    VkDeviceSize m_StagingSize;
+
+    // Monotonic byte cursors into the ring; the physical offset is cursor % m_StagingSize
+    uint64_t m_WriteCursor = 0;
+    uint64_t m_ReleasedCursor = 0;
+
+    std::vector<Buffer*> m_DedicatedStagingBuffers;
+    std::deque<Submission> m_Submissions;
+
+    std::vector<VkImageMemoryBarrier2> m_AcquireImageBarriers;
+    std::vector<VkBufferMemoryBarrier2> m_AcquireBufferBarriers;
+    std::deque<PendingAcquire> m_PendingAcquires;
+    uint64_t m_AcquiredValue = 0;
+};
@@ -0,0 +1,166 @@
+#include "VertexDeduplicator.h"
+#include "Model.h"
+
+#include <cstring>
+#include <bit>
+
+namespace
+{
+    // Drops the lowest mantissa bits, which keeps ~4-5 significant decimal digits
+    uint32_t quantizeFloat(float value)
+    {
+        constexpr uint32_t MANTISSA_MASK = ~((1u << 8) - 1u);
+        if (value == 0.0f)
+        {
+            return 0; // folds -0 into +0
+        }
+        return std::bit_cast<uint32_t>(value) & MANTISSA_MASK;
+    }
+
+    int16_t quantizeUnit(float value)
+    {
+        return static_cast<int16_t>(glm::round(glm::clamp(value, -1.0f, 1.0f) * 32767.0f));
+    }
+
+    uint64_t mix(uint64_t hash, uint64_t value)
+    {
+        hash ^= value;
+        hash *= 0x100000001b3ull;
+        return hash ^ (hash >> 29);
+    }
+}
+
+Vertex readAssimpVertex(const aiMesh& mesh, unsigned int index, const glm::mat4& transform)
+{
+    Vertex vertex{};
+
+    // Apply the transformation to the vertex position
+    glm::vec4 pos(mesh.mVertices[index].x, mesh.mVertices[index].y, mesh.mVertices[index].z, 1.0f);
+    pos = transform * pos;
+    vertex.pos = glm::vec3(pos);
+
+    if (mesh.HasNormals())
+    {
+        // Transform the normal
+        glm::vec4 normal(mesh.mNormals[index].x, mesh.mNormals[index].y, mesh.mNormals[index].z, 0.0f);
+        normal = transform * normal;
+        vertex.normal = glm::normalize(glm::vec3(normal));
+    }
+
+    if (mesh.mTextureCoords[0])
+    {
+        vertex.texCoord = glm::vec2(mesh.mTextureCoords[0][index].x, mesh.mTextureCoords[0][index].y);
+    }
+
+    vertex.tangent.w = 1.0f;
+    if (mesh.HasTangentsAndBitangents())
+    {
+        glm::vec3 tangent = glm::vec3(transform * glm::vec4(mesh.mTangents[index].x, mesh.mTangents[index].y, mesh.mTangents[index].z, 0.0f));
+        glm::vec3 bitangent = glm::vec3(transform * glm::vec4(mesh.mBitangents[index].x, mesh.mBitangents[index].y, mesh.mBitangents[index].z, 0.0f));
+
+        // Re-orthogonalize the tangent against the transformed normal. The bitangent is rebuilt from the
+        // two in the vertex shader, so only its handedness is kept.
+        tangent = glm::normalize(tangent - vertex.normal * glm::dot(vertex.normal, tangent));
+        const float bitangentSign = glm::dot(glm::cross(vertex.normal, tangent), bitangent) < 0.0f ? -1.0f : 1.0f;
+        vertex.tangent = glm::vec4(tangent, bitangentSign);
+    }
+
+    return vertex;
+}
+
+VertexDeduplicator::VertexDeduplicator(size_t expectedVertexCount)
+{
+    size_t capacity = 64;
+    while (capacity < expectedVertexCount * 2)
+    {
+        capacity <<= 1;
+    }
+    m_Slots.assign(capacity, EMPTY_SLOT);
+    m_Keys.reserve(expectedVertexCount);
+    m_Hashes.reserve(expectedVertexCount);
+}
+
+bool VertexDeduplicator::Key::operator==(const Key& other) const
+{
+    return memcmp(this, &other, sizeof(Key)) == 0;
+}
+
+VertexDeduplicator::Key VertexDeduplicator::makeKey(const Vertex& vertex)
+{
+    Key key{};
+    for (int i = 0; i < 3; ++i)
+    {
+        key.pos[i] = quantizeFloat(vertex.pos[i]);
+        key.normal[i] = quantizeUnit(vertex.normal[i]);
+        key.tangent[i] = quantizeUnit(vertex.tangent[i]);
+    }
+    key.tangent[3] = quantizeUnit(vertex.tangent.w);
+    key.texCoord[0] = quantizeFloat(vertex.texCoord.x);
+    key.texCoord[1] = quantizeFloat(vertex.texCoord.y);
+    return key;
+}
+
+uint64_t VertexDeduplicator::hashKey(const Key& key)
+{
+    static_assert(sizeof(Key) % sizeof(uint64_t) == 0, "Key must be a whole number of 64-bit words");
+
+    uint64_t words[sizeof(Key) / sizeof(uint64_t)];
+    memcpy(words, &key, sizeof(Key));
+
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (uint64_t word : words)
+    {
+        hash = mix(hash, word);
+    }
+    return hash;
+}
+
+uint32_t VertexDeduplicator::insert(const Vertex& vertex, std::vector<Vertex>& outVertices)
+{
+    ++m_LookupCount;
+
+    const Key key = makeKey(vertex);
+    const uint64_t hash = hashKey(key);
+    const size_t mask = m_Slots.size() - 1;
+
+    // Linear probing; the table is kept at most half full so probe chains stay short
+    size_t slot = static_cast<size_t>(hash) & mask;
+    while (m_Slots[slot] != EMPTY_SLOT)
+    {
+        const uint32_t candidate = m_Slots[slot];
+        if (m_Hashes[candidate] == hash && m_Keys[candidate] == key)
+        {
+            return static_cast<uint32_t>(outVertices.size() - m_Keys.size()) + candidate;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    const uint32_t local = static_cast<uint32_t>(m_Keys.size());
+    m_Slots[slot] = local;
+    m_Keys.push_back(key);
+    m_Hashes.push_back(hash);
+    outVertices.push_back(vertex);
+
+    if (m_Keys.size() * 2 > m_Slots.size())
+    {
+        grow();
+    }
+
+    return static_cast<uint32_t>(outVertices.size() - 1);
+}
+
+void VertexDeduplicator::grow()
+{
+    m_Slots.assign(m_Slots.size() * 2, EMPTY_SLOT);
+    const size_t mask = m_Slots.size() - 1;
+
+    for (uint32_t i = 0; i < static_cast<uint32_t>(m_Keys.size()); ++i)
+    {
+        size_t slot = static_cast<size_t>(m_Hashes[i]) & mask;
+        while (m_Slots[slot] != EMPTY_SLOT)
+        {
+            slot = (slot + 1) & mask;
+        }
+        m_Slots[slot] = i;
+    }
+}
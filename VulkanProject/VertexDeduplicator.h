@@ -0,0 +1,53 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+struct Vertex;
+struct aiMesh;
+
+// The importer's vertex for one of mesh's vertices, with the node transform applied
+Vertex readAssimpVertex(const aiMesh& mesh, unsigned int index, const glm::mat4& transform);
+
+//
+// Open-addressing hash table that maps vertices to deduplicated output indices.
+// Vertices are compared on quantized attributes, so values that only differ
+// by float noise from the importer collapse into one vertex.
+//
+class VertexDeduplicator
+{
+public:
+    VertexDeduplicator(size_t expectedVertexCount = 0);
+
+    // Returns the index of an equal vertex that was inserted before,
+    // or appends the vertex to outVertices and returns its new index.
+    uint32_t insert(const Vertex& vertex, std::vector<Vertex>& outVertices);
+
+    size_t getLookupCount() const { return m_LookupCount; }
+    size_t getUniqueCount() const { return m_Keys.size(); }
+
+private:
+    struct Key
+    {
+        uint32_t pos[3];
+        uint32_t texCoord[2];
+        int16_t normal[3];
+        int16_t tangent[4];
+        int16_t padding[3];
+
+        bool operator==(const Key& other) const;
+    };
+
+    static Key makeKey(const Vertex& vertex);
+    static uint64_t hashKey(const Key& key);
+    void grow();
+
+    static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+
+    // Slots hold indices into m_Keys; m_Keys[i] is the i-th vertex this table appended to the output
+    std::vector<uint32_t> m_Slots;
+    std::vector<Key> m_Keys;
+    std::vector<uint64_t> m_Hashes;
+    size_t m_LookupCount = 0;
+};
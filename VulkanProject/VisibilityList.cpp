@@ -0,0 +1,68 @@
+// VisibilityList.cpp
+#include "VisibilityList.h"
+#include "Buffer.h"
+#include "UploadBatch.h"
+#include <algorithm>
+
+VisibilityList::VisibilityList(VmaAllocator allocator, UploadBatch* pUploadBatch, size_t frameCount, uint32_t submeshCount)
+    : m_MaxDrawCount(std::max(submeshCount, 1u))
+    , m_Frames(frameCount)
+{
+    // Written by cull.comp, then read as indirect draws and by the occlusion and meshlet passes
+    for (FrameBuffers& frame : m_Frames)
+    {
+        frame.pDrawBuffer = new Buffer(
+            allocator,
+            sizeof(VkDrawIndexedIndirectCommand) * m_MaxDrawCount,
+            VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY
+        );
+        frame.pDrawBoundsBuffer = new Buffer(
+            allocator,
+            sizeof(DrawBounds) * m_MaxDrawCount,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY
+        );
+    }
+
+    // Every submesh starts at full detail
+    const std::vector<uint32_t> lods(m_MaxDrawCount, 0);
+    m_pLodBuffer = new Buffer(
+        allocator,
+        getLodBufferSize(),
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY
+    );
+    pUploadBatch->uploadBuffer(m_pLodBuffer, lods.data(), getLodBufferSize(), 0,
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+}
+
+VisibilityList::~VisibilityList()
+{
+    for (FrameBuffers& frame : m_Frames)
+    {
+        delete frame.pDrawBuffer;
+        delete frame.pDrawBoundsBuffer;
+    }
+    delete m_pLodBuffer;
+}
+
+VkBuffer VisibilityList::getDrawBuffer(size_t frameIndex) const
+{
+    return m_Frames[frameIndex].pDrawBuffer->get();
+}
+
+VkBuffer VisibilityList::getDrawBoundsBuffer(size_t frameIndex) const
+{
+    return m_Frames[frameIndex].pDrawBoundsBuffer->get();
+}
+
+VkBuffer VisibilityList::getLodBuffer() const
+{
+    return m_pLodBuffer->get();
+}
+
+VkDeviceSize VisibilityList::getLodBufferSize() const
+{
+    return sizeof(uint32_t) * m_MaxDrawCount;
+}
@@ -0,0 +1,58 @@
+// VisibilityList.h
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+class Buffer;
+class UploadBatch;
+
+//
+// The submeshes one view draws this frame, as GPU buffers shared by every pass that renders the view.
+// cull.comp fills them each frame: it tests every submesh against the frustum, picks the coarsest level
+// of detail whose error stays under a pixel on screen and compacts the survivors in submesh order, which
+// Model keeps grouped by material. Their count is written next to the culling statistics and serves as
+// the indirect draw count, so the CPU never sees the list.
+//
+class VisibilityList
+{
+public:
+    // Per-draw input of the GPU culling passes; matches DrawBounds in cull.comp, occlusion.comp and meshlet_cull.comp
+    struct DrawBounds
+    {
+        glm::vec3 boundsMin;
+        uint32_t meshletStart;
+        glm::vec3 boundsMax;
+        uint32_t meshletCount;
+    };
+
+    VisibilityList(VmaAllocator allocator, UploadBatch* pUploadBatch, size_t frameCount, uint32_t submeshCount);
+    ~VisibilityList();
+
+    VisibilityList(const VisibilityList&) = delete;
+    VisibilityList& operator=(const VisibilityList&) = delete;
+
+    // One indexed draw per visible submesh, with the material index in firstInstance
+    VkBuffer getDrawBuffer(size_t frameIndex) const;
+    // Model-space bounds and meshlet range of each draw, in the same order as the draws
+    VkBuffer getDrawBoundsBuffer(size_t frameIndex) const;
+    // Level of detail each submesh last drew. Frames cull in submission order, so they share one copy.
+    VkBuffer getLodBuffer() const;
+    VkDeviceSize getLodBufferSize() const;
+    // Every submesh visible at once
+    uint32_t getMaxDrawCount() const { return m_MaxDrawCount; }
+
+private:
+    struct FrameBuffers
+    {
+        Buffer* pDrawBuffer = nullptr;
+        Buffer* pDrawBoundsBuffer = nullptr;
+    };
+
+    uint32_t m_MaxDrawCount;
+    std::vector<FrameBuffers> m_Frames;
+    Buffer* m_pLodBuffer = nullptr;
+};
@@ -31,6 +31,19 @@ int main() {
         if (elapsed.count() >= 1.0f) {
             float fps = frameCount / elapsed.count();
             spdlog::info("FPS: {:.2f}", fps);
+
+            const Renderer::CullStatistics& cullStatistics = renderer.getCullStatistics();
+            spdlog::info("Submeshes: {} total, {} in frustum, {} occluded, {} drawn",
+                cullStatistics.submeshCount, cullStatistics.frustumVisibleCount,
+                cullStatistics.occludedCount, cullStatistics.drawnCount);
+            spdlog::info("Submeshes in frustum by LOD: {} / {} / {} / {}",
+                cullStatistics.lodDrawCounts[0], cullStatistics.lodDrawCounts[1],
+                cullStatistics.lodDrawCounts[2], cullStatistics.lodDrawCounts[3]);
+            spdlog::info("Meshlets of drawn submeshes: {} outside frustum, {} backfacing, {} occluded, {} drawn",
+                cullStatistics.meshletFrustumCulledCount, cullStatistics.meshletBackfaceCulledCount,
+                cullStatistics.meshletOccludedCount, cullStatistics.meshletDrawnCount);
+            spdlog::info("Shadow cascades: {} of {} re-rendered, {} caster draws",
+                cullStatistics.shadowCascadeRenderCount, SHADOW_CASCADE_COUNT, cullStatistics.shadowCasterDrawCount);
             frameCount = 0;
             lastTime = currentTime;
         }
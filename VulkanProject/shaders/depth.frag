@@ -1,12 +1,25 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
 layout(location = 0) in vec2 fragTexCoord;
+layout(location = 1) flat in uint fragMaterialIndex;
 
-layout(binding = 1) uniform sampler2D diffuseSampler;
+struct Material {
+    uint diffuseTextureIndex;
+    uint normalTextureIndex;
+    uint metallicRoughnessTextureIndex;
+    uint padding;
+};
+
+layout(std430, binding = 1) readonly buffer MaterialBuffer {
+    Material materials[];
+};
+
+layout(binding = 2) uniform sampler2D textures[];
 
 void main() 
 {
-   if(texture(diffuseSampler, fragTexCoord).a < 0.5) 
+   if(texture(textures[nonuniformEXT(materials[fragMaterialIndex].diffuseTextureIndex)], fragTexCoord).a < 0.5) 
    {
 	  discard; // Discard fragments with low alpha
    }
@@ -1,17 +1,28 @@
 #version 450
 
-layout(location = 0) in vec3 inPosition;
+layout(location = 0) in vec3 inPosition;    // quantized over the model bounds
 layout(location = 1) in vec2 inTexCoord;
 
 layout(location = 0) out vec2 fragTexCoord;
+layout(location = 1) flat out uint fragMaterialIndex;
 
 layout(binding = 0) uniform UBO {
     mat4 model;
     mat4 view;
     mat4 proj;
+    vec3 cameraPosition;
+    vec2 viewportSize;
+    vec4 positionScale;
+    vec4 positionOffset;
 } ubo;
 
+// The depth pre-pass and the G-buffer pass must produce identical depths for the EQUAL test
+invariant gl_Position;
+
 void main() {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
+    vec3 position = inPosition * ubo.positionScale.xyz + ubo.positionOffset.xyz;
+    vec4 worldPosition = ubo.model * vec4(position, 1.0);
+    gl_Position = ubo.proj * ubo.view * worldPosition;
     fragTexCoord = inTexCoord;
+    fragMaterialIndex = gl_InstanceIndex; // firstInstance of the draw
 }
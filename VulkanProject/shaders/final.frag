@@ -1,4 +1,8 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "light_clusters.glsl"
+
 layout(location = 0) in vec2 fragTexCoord;
 layout(location = 0) out vec4 outColor;
 
@@ -30,13 +34,23 @@ layout(std430, binding = 5) readonly buffer LightsBuffer {
 layout(binding = 6) uniform samplerCube skyboxSampler;
 layout(binding = 7) uniform samplerCube irradianceSampler;
 
-layout(binding = 8) uniform sampler2D shadowMapSampler;
+// One layer per cascade
+layout(binding = 8) uniform sampler2DArray shadowMapSampler;
+
+const int SHADOW_CASCADE_COUNT = 4;
 
 layout(binding = 9) uniform SunMatrices {
-    mat4 lightProj;
-    mat4 lightView;
+    mat4 lightProj[SHADOW_CASCADE_COUNT];
+    mat4 lightView[SHADOW_CASCADE_COUNT];
+    vec4 cascadeSplits;    // view-space distance at which each cascade ends
 } sunMatrices;
 
+// Per-cluster light lists written by light_cull.comp
+layout(std430, binding = 10) readonly buffer LightClusterBuffer {
+    uint clusterLightCounts[LIGHT_CLUSTER_COUNT];
+    uint clusterLightIndices[];     // MAX_LIGHTS_PER_CLUSTER per cluster
+};
+
 layout(push_constant) uniform PushConstants {
     int debugMode;
     float iblIntensity;
@@ -177,30 +191,38 @@ void main()
             float NdotL = max(dot(N, L), 0.0);
             
             if (NdotL > 0.0) {
-                // Shadow mapping calculation
-                vec4 lightSpacePosition = sunMatrices.lightProj * sunMatrices.lightView * vec4(worldPos, 1.0);
-                lightSpacePosition /= lightSpacePosition.w;
-                vec3 shadowMapUV = lightSpacePosition.xyz * 0.5 + 0.5;
-                shadowMapUV.z = lightSpacePosition.z;
-
-                ivec2 shadowMapSize = textureSize(shadowMapSampler, 0);
-                float bias = max(0.005 * (1.0 - dot(N, L)), 0.001);
-
-                // PCF filtering
-                float shadowTerm = 0.0;
-                int kernelSize = 1;
-                int samples = 0;
-                for (int x = -kernelSize; x <= kernelSize; ++x) {
-                    for (int y = -kernelSize; y <= kernelSize; ++y) {
-                        vec2 offset = vec2(x, y) / vec2(shadowMapSize);
-                        vec2 sampleUV = shadowMapUV.xy + offset;
-                        float sampleDepth = texture(shadowMapSampler, sampleUV).r;
-                        if (shadowMapUV.z <= sampleDepth + bias)
-                            shadowTerm += 1.0;
-                        samples++;
+                // Shadow mapping calculation: the first cascade that reaches this pixel's view depth
+                float viewDepth = -(ubo.view * vec4(worldPos, 1.0)).z;
+                int cascade = 0;
+                while (cascade < SHADOW_CASCADE_COUNT - 1 && viewDepth > sunMatrices.cascadeSplits[cascade])
+                    cascade++;
+
+                float shadowTerm = 1.0;
+                if (viewDepth <= sunMatrices.cascadeSplits[SHADOW_CASCADE_COUNT - 1]) {
+                    vec4 lightSpacePosition = sunMatrices.lightProj[cascade] * sunMatrices.lightView[cascade] * vec4(worldPos, 1.0);
+                    lightSpacePosition /= lightSpacePosition.w;
+                    vec3 shadowMapUV = lightSpacePosition.xyz * 0.5 + 0.5;
+                    shadowMapUV.z = lightSpacePosition.z;
+
+                    ivec2 shadowMapSize = textureSize(shadowMapSampler, 0).xy;
+                    float bias = max(0.005 * (1.0 - dot(N, L)), 0.001);
+
+                    // PCF filtering
+                    shadowTerm = 0.0;
+                    int kernelSize = 1;
+                    int samples = 0;
+                    for (int x = -kernelSize; x <= kernelSize; ++x) {
+                        for (int y = -kernelSize; y <= kernelSize; ++y) {
+                            vec2 offset = vec2(x, y) / vec2(shadowMapSize);
+                            vec2 sampleUV = shadowMapUV.xy + offset;
+                            float sampleDepth = texture(shadowMapSampler, vec3(sampleUV, float(cascade))).r;
+                            if (shadowMapUV.z <= sampleDepth + bias)
+                                shadowTerm += 1.0;
+                            samples++;
+                        }
                     }
+                    shadowTerm /= float(samples);
                 }
-                shadowTerm /= float(samples);
 
                 vec3 H = normalize(V + L);
                 float NDF = DistributionGGX(N, H, roughness);
@@ -221,9 +243,12 @@ void main()
                 Lo += (kD * albedo / PI + specular) * radiance * NdotL * shadowTerm;
             }
             
-            // Point lights calculation
-            for (uint i = 0; i < lightCount; i++) {
-                Light light = lights[i];
+            // Point lights calculation, only those listed in this pixel's cluster
+            uint cluster = getLightClusterIndex(getLightClusterTile(uvec2(texelCoord), uvec2(ubo.viewportSize)),
+                getLightClusterSlice(getLightClusterDepth(depth, ubo.proj)));
+            uint clusterLightCount = clusterLightCounts[cluster];
+            for (uint i = 0; i < clusterLightCount; i++) {
+                Light light = lights[clusterLightIndices[cluster * MAX_LIGHTS_PER_CLUSTER + i]];
                 vec3 L = normalize(light.position - worldPos);
                 float distance = length(light.position - worldPos);
                 float attenuation = calculateAttenuation(distance, light.radius);
@@ -0,0 +1,39 @@
+// Froxel grid shared by light_cull.comp and final.frag. Matches LightClusters.h.
+const uint LIGHT_CLUSTER_GRID_X = 16;
+const uint LIGHT_CLUSTER_GRID_Y = 9;
+const uint LIGHT_CLUSTER_GRID_Z = 24;
+const uint LIGHT_CLUSTER_COUNT = LIGHT_CLUSTER_GRID_X * LIGHT_CLUSTER_GRID_Y * LIGHT_CLUSTER_GRID_Z;
+const uint MAX_LIGHTS_PER_CLUSTER = 256;
+const float LIGHT_CLUSTER_NEAR_DEPTH = 0.1;
+const float LIGHT_CLUSTER_FAR_DEPTH = 100.0;
+
+// View depth (distance along -z) of a depth buffer value
+float getLightClusterDepth(float depth, mat4 projection)
+{
+    // Solves depth = (P[2][2] z + P[3][2]) / (P[2][3] z + P[3][3]) for the view-space z
+    float z = (projection[3][2] - depth * projection[3][3]) / (depth * projection[2][3] - projection[2][2]);
+    return -z;
+}
+
+// Everything nearer than LIGHT_CLUSTER_NEAR_DEPTH is in the first slice; the others grow exponentially
+uint getLightClusterSlice(float viewDepth)
+{
+    if (viewDepth < LIGHT_CLUSTER_NEAR_DEPTH)
+    {
+        return 0;
+    }
+    float slice = log(viewDepth / LIGHT_CLUSTER_NEAR_DEPTH) /
+        log(LIGHT_CLUSTER_FAR_DEPTH / LIGHT_CLUSTER_NEAR_DEPTH) * float(LIGHT_CLUSTER_GRID_Z - 1);
+    return min(uint(slice) + 1, LIGHT_CLUSTER_GRID_Z - 1);
+}
+
+uvec2 getLightClusterTile(uvec2 pixel, uvec2 viewportSize)
+{
+    vec2 tile = (vec2(pixel) + 0.5) * vec2(LIGHT_CLUSTER_GRID_X, LIGHT_CLUSTER_GRID_Y) / vec2(viewportSize);
+    return min(uvec2(tile), uvec2(LIGHT_CLUSTER_GRID_X - 1, LIGHT_CLUSTER_GRID_Y - 1));
+}
+
+uint getLightClusterIndex(uvec2 tile, uint slice)
+{
+    return (slice * LIGHT_CLUSTER_GRID_Y + tile.y) * LIGHT_CLUSTER_GRID_X + tile.x;
+}
@@ -0,0 +1,53 @@
+// Hi-Z test shared by occlusion.comp and meshlet_cull.comp. The depth pyramid keeps the farthest depth
+// per texel, with level 0 at half the depth buffer's resolution.
+bool isOccluded(vec3 boxMin, vec3 boxMax, mat4 viewProjection, sampler2D depthPyramid, vec2 depthSize, uint pyramidLevelCount)
+{
+    vec2 screenMin = vec2(1.0);
+    vec2 screenMax = vec2(0.0);
+    float nearestDepth = 1.0;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        vec3 corner = mix(boxMin, boxMax, vec3(i & 1, (i >> 1) & 1, (i >> 2) & 1));
+        vec4 clip = viewProjection * vec4(corner, 1.0);
+
+        // Boxes reaching behind the camera are too close to test
+        if (clip.w <= 0.0)
+        {
+            return false;
+        }
+
+        vec3 ndc = clip.xyz / clip.w;
+        screenMin = min(screenMin, ndc.xy * 0.5 + 0.5);
+        screenMax = max(screenMax, ndc.xy * 0.5 + 0.5);
+        nearestDepth = min(nearestDepth, ndc.z);
+    }
+
+    if (nearestDepth <= 0.0)
+    {
+        return false;
+    }
+
+    ivec2 pixelMin = ivec2(clamp(screenMin, 0.0, 1.0) * depthSize);
+    ivec2 pixelMax = ivec2(clamp(screenMax, 0.0, 1.0) * depthSize);
+
+    // Level L texels cover 2^(L+1) pixels, so this level spans the rectangle with at most 2x2 texels
+    int pixelExtent = max(max(pixelMax.x - pixelMin.x, pixelMax.y - pixelMin.y), 1);
+    int level = clamp(findMSB(pixelExtent), 0, int(pyramidLevelCount) - 1);
+
+    // The last texel of a level also covers the pixels its rounded-down size leaves over
+    ivec2 levelSize = textureSize(depthPyramid, level);
+    ivec2 texelMin = min(pixelMin >> (level + 1), levelSize - 1);
+    ivec2 texelMax = min(pixelMax >> (level + 1), levelSize - 1);
+
+    float farthestDepth = 0.0;
+    for (int y = texelMin.y; y <= texelMax.y; ++y)
+    {
+        for (int x = texelMin.x; x <= texelMax.x; ++x)
+        {
+            farthestDepth = max(farthestDepth, texelFetch(depthPyramid, ivec2(x, y), level).r);
+        }
+    }
+
+    return nearestDepth > farthestDepth;
+}
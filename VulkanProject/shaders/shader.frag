@@ -1,10 +1,12 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
 layout(location = 0) in vec2 fragTexCoord;
 layout(location = 1) in vec3 fragWorldPos;
 layout(location = 2) in vec3 fragNormal;
 layout(location = 3) in vec3 fragTangent;
 layout(location = 4) in vec3 fragBitangent;
+layout(location = 5) flat in uint fragMaterialIndex;
 
 layout(location = 0) out vec4 outColor;
 layout(location = 1) out vec4 outNormal;
@@ -17,15 +19,28 @@ layout(binding = 0) uniform UBO {
     vec3 cameraPosition; // Moved cameraPosition here
 } ubo;
 
-layout(binding = 1) uniform sampler2D diffuseSampler;
-layout(binding = 2) uniform sampler2D normalSampler;
-layout(binding = 3) uniform sampler2D metallicRoughnessSampler;
+struct Material {
+    uint diffuseTextureIndex;
+    uint normalTextureIndex;
+    uint metallicRoughnessTextureIndex;
+    uint padding;
+};
+
+layout(std430, binding = 1) readonly buffer MaterialBuffer {
+    Material materials[];
+};
+
+layout(binding = 2) uniform sampler2D textures[];
 
 void main() {
+    Material material = materials[fragMaterialIndex];
+
     // Sample textures
-    vec4 diffuseColor = texture(diffuseSampler, fragTexCoord);
-    vec3 normalMap = normalize(texture(normalSampler, fragTexCoord).rgb * 2.0 - 1.0); // Convert to [-1,1] range and normalize
-    vec4 metallicRoughnessColor = texture(metallicRoughnessSampler, fragTexCoord);
+    vec4 diffuseColor = texture(textures[nonuniformEXT(material.diffuseTextureIndex)], fragTexCoord);
+    // Z is rebuilt from XY so two-channel (BC5) normal maps work the same as RGBA ones
+    vec2 normalXY = texture(textures[nonuniformEXT(material.normalTextureIndex)], fragTexCoord).rg * 2.0 - 1.0;
+    vec3 normalMap = vec3(normalXY, sqrt(max(1.0 - dot(normalXY, normalXY), 0.0)));
+    vec4 metallicRoughnessColor = texture(textures[nonuniformEXT(material.metallicRoughnessTextureIndex)], fragTexCoord);
 
     if (diffuseColor.a < 0.5) {
         discard; // Discard fragments with low alpha
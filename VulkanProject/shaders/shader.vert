@@ -1,35 +1,51 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
 
-layout(location = 0) in vec3 inPosition;
+#include "vertex_format.glsl"
+
+layout(location = 0) in vec3 inPosition;        // quantized over the model bounds
 layout(location = 1) in vec2 inTexCoord;
-layout(location = 2) in vec3 inNormal;
-layout(location = 3) in vec3 inTangent;
-layout(location = 4) in vec3 inBitangent;
+layout(location = 2) in vec2 inNormal;          // octahedral
+layout(location = 3) in vec4 inTangent;         // octahedral in xy, bitangent sign in z
 
 layout(location = 0) out vec2 fragTexCoord;
 layout(location = 1) out vec3 fragWorldPos;
 layout(location = 2) out vec3 fragNormal;
 layout(location = 3) out vec3 fragTangent;
 layout(location = 4) out vec3 fragBitangent;
+layout(location = 5) flat out uint fragMaterialIndex;
 
 layout(binding = 0) uniform UBO {
     mat4 model;
     mat4 view;
     mat4 proj;
+    vec3 cameraPosition;
+    vec2 viewportSize;
+    vec4 positionScale;
+    vec4 positionOffset;
 } ubo;
 
+// The depth pre-pass and the G-buffer pass must produce identical depths for the EQUAL test
+invariant gl_Position;
+
 void main() {
-    vec4 worldPosition = ubo.model * vec4(inPosition, 1.0);
+    vec3 position = inPosition * ubo.positionScale.xyz + ubo.positionOffset.xyz;
+    vec4 worldPosition = ubo.model * vec4(position, 1.0);
     gl_Position = ubo.proj * ubo.view * worldPosition;
 
     fragTexCoord = inTexCoord;
+    fragMaterialIndex = gl_InstanceIndex; // firstInstance of the draw
     fragWorldPos = worldPosition.xyz;
 
     // Compute normal matrix for transforming normals correctly
     mat3 normalMatrix = transpose(inverse(mat3(ubo.model)));
 
+    vec3 normal = decodeOctahedral(inNormal);
+    vec3 tangent = decodeOctahedral(inTangent.xy);
+    vec3 bitangent = cross(normal, tangent) * inTangent.z;
+
     // Transform and normalize each component
-    fragNormal = normalize(normalMatrix * inNormal);                    // Use normal matrix for normal
-    fragTangent = normalize(mat3(ubo.model) * inTangent);              // Use model matrix for tangent
-    fragBitangent = normalize(mat3(ubo.model) * inBitangent);          // Use model matrix for bitangent
+    fragNormal = normalize(normalMatrix * normal);                      // Use normal matrix for normal
+    fragTangent = normalize(mat3(ubo.model) * tangent);                // Use model matrix for tangent
+    fragBitangent = normalize(mat3(ubo.model) * bitangent);            // Use model matrix for bitangent
 }
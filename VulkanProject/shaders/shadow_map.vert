@@ -1,6 +1,6 @@
 #version 450
 
-layout(location = 0) in vec3 inPosition;
+layout(location = 0) in vec3 inPosition;    // quantized; lightView includes the dequantization
 
 // Push constants for lightView and lightProj
 layout(push_constant) uniform ShadowPushConstants {
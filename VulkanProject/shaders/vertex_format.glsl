@@ -0,0 +1,10 @@
+// Decoding of the packed vertex streams written by Model::createVertexBuffer
+
+// Inverse of the octahedral mapping: folds the lower hemisphere back from the square's corners
+vec3 decodeOctahedral(vec2 p)
+{
+    vec3 v = vec3(p, 1.0 - abs(p.x) - abs(p.y));
+    float t = max(-v.z, 0.0);
+    v.xy += mix(vec2(t), vec2(-t), greaterThanEqual(v.xy, vec2(0.0)));
+    return normalize(v);
+}